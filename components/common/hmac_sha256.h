@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Portable SHA-256 and HMAC-SHA256 for authenticating small messages, e.g. IR peer frames.
+// Make sure this file also compiles natively and all functions are covered by unit tests.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define SHA256_DIGEST_SIZE 32
+
+/// @brief Calculate the SHA-256 digest of a byte buffer.
+/// @param data buffer
+/// @param len length of buffer
+/// @param digest output buffer for the digest.
+void sha256(const uint8_t *data, size_t len, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+/// @brief Calculate the HMAC-SHA256 of a byte buffer (RFC 2104).
+/// @param key key, any length.
+/// @param keyLen length of key
+/// @param data buffer
+/// @param len length of buffer
+/// @param mac output buffer for the message authentication code.
+void hmacSha256(const uint8_t *key, size_t keyLen, const uint8_t *data, size_t len, uint8_t mac[SHA256_DIGEST_SIZE]);
+
+/// @brief Compare two byte buffers in constant time, e.g. to verify a message authentication code.
+/// @return true if the buffers are equal.
+bool constantTimeEqual(const uint8_t *a, const uint8_t *b, size_t len);
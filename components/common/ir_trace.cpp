@@ -0,0 +1,200 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ir_trace.h"
+
+#include <algorithm>
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#else
+#include <chrono>
+#endif
+
+static const char *const trace_point_names[] = {
+    "ws_received", "request_parsed", "enqueued", "dequeued", "first_mark", "last_space", "response_sent",
+};
+
+static_assert(sizeof(trace_point_names) / sizeof(trace_point_names[0]) == (size_t)IrTracePoint::COUNT,
+              "trace point names don't match IrTracePoint");
+
+const char *ir_trace_point_name(IrTracePoint point) {
+    if (point >= IrTracePoint::COUNT) {
+        return "unknown";
+    }
+    return trace_point_names[(size_t)point];
+}
+
+const size_t IrTraceBuffer::capacity;
+
+uint32_t IrTraceBuffer::nextId() {
+    uint32_t id;
+    do {
+        id = nextId_.fetch_add(1, std::memory_order_relaxed) + 1;
+    } while (id == 0);
+    return id;
+}
+
+void IrTraceBuffer::record(uint32_t id, IrTracePoint point, uint32_t timestamp) {
+    uint32_t index = writeIndex_.fetch_add(1, std::memory_order_relaxed);
+    Slot    &slot = slots_[index % capacity];
+
+    // mark slot as being written
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.id = id;
+    slot.timestamp = timestamp;
+    slot.point = point;
+    // publish entry
+    slot.seq.store(index + 1, std::memory_order_release);
+}
+
+size_t IrTraceBuffer::snapshot(IrTraceEntry *entries, size_t max) const {
+    uint32_t end = writeIndex_.load(std::memory_order_acquire);
+    uint32_t start = end > capacity ? end - capacity : 0;
+    size_t   count = 0;
+
+    for (uint32_t index = start; index != end && count < max; index++) {
+        const Slot &slot = slots_[index % capacity];
+        if (slot.seq.load(std::memory_order_acquire) != index + 1) {
+            // not yet published or already overwritten
+            continue;
+        }
+        IrTraceEntry entry = {slot.id, slot.timestamp, slot.point};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // skip if overwritten while copying
+        if (slot.seq.load(std::memory_order_relaxed) != index + 1) {
+            continue;
+        }
+        entries[count++] = entry;
+    }
+
+    return count;
+}
+
+void IrTraceBuffer::clear() {
+    for (auto &slot : slots_) {
+        slot.seq.store(0, std::memory_order_relaxed);
+    }
+}
+
+/// Nearest-rank percentile of a sorted array.
+static uint32_t percentile(const uint32_t *sorted, size_t count, uint32_t percent) {
+    size_t rank = (percent * count + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+size_t ir_trace_summary(IrTraceEntry *entries, size_t count, IrTraceStats stats[(size_t)IrTracePoint::COUNT]) {
+    for (size_t p = 0; p < (size_t)IrTracePoint::COUNT; p++) {
+        stats[p] = {};
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    // group entries by trace: stable sort keeps the recording order within a trace
+    std::stable_sort(entries, entries + count,
+                     [](const IrTraceEntry &a, const IrTraceEntry &b) { return a.id < b.id; });
+
+    uint32_t *latencies = new uint32_t[count];
+    size_t    traces = 0;
+
+    for (size_t p = 0; p < (size_t)IrTracePoint::COUNT; p++) {
+        size_t n = 0;
+        size_t i = 0;
+        while (i < count) {
+            // find start of trace: earliest timestamp. Signed difference handles timestamp wrap around.
+            size_t   end = i;
+            uint32_t startTs = entries[i].timestamp;
+            while (end < count && entries[end].id == entries[i].id) {
+                if (static_cast<int32_t>(entries[end].timestamp - startTs) < 0) {
+                    startTs = entries[end].timestamp;
+                }
+                end++;
+            }
+            if (p == 0) {
+                traces++;
+            }
+            for (size_t j = i; j < end; j++) {
+                if ((size_t)entries[j].point == p) {
+                    latencies[n++] = entries[j].timestamp - startTs;
+                    break;
+                }
+            }
+            i = end;
+        }
+
+        if (n == 0) {
+            continue;
+        }
+        std::sort(latencies, latencies + n);
+        stats[p].count = n;
+        stats[p].p50 = percentile(latencies, n, 50);
+        stats[p].p90 = percentile(latencies, n, 90);
+        stats[p].p99 = percentile(latencies, n, 99);
+        stats[p].max = latencies[n - 1];
+    }
+
+    delete[] latencies;
+    return traces;
+}
+
+IrTraceBuffer &ir_trace() {
+    static IrTraceBuffer buffer;
+    return buffer;
+}
+
+uint32_t ir_trace_now() {
+#ifdef ESP_PLATFORM
+    return static_cast<uint32_t>(esp_timer_get_time());
+#else
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+#endif
+}
+
+/// Remembered trace point timestamps of the current task, 0 if not set.
+static thread_local uint32_t pending_points[(size_t)IrTracePoint::COUNT];
+static thread_local bool     has_pending = false;
+
+void ir_trace_pending(IrTracePoint point) {
+    if (point < IrTracePoint::COUNT) {
+        uint32_t now = ir_trace_now();
+        // 0 is used as unset marker
+        pending_points[(size_t)point] = now ? now : 1;
+        has_pending = true;
+    }
+}
+
+void ir_trace_clear_pending() {
+    if (has_pending) {
+        for (auto &ts : pending_points) {
+            ts = 0;
+        }
+        has_pending = false;
+    }
+}
+
+uint32_t ir_trace_begin() {
+    IrTraceBuffer &buffer = ir_trace();
+    uint32_t       id = buffer.nextId();
+
+    if (has_pending) {
+        for (size_t p = 0; p < (size_t)IrTracePoint::COUNT; p++) {
+            if (pending_points[p]) {
+                buffer.record(id, static_cast<IrTracePoint>(p), pending_points[p]);
+            }
+        }
+        ir_trace_clear_pending();
+    }
+
+    return id;
+}
+
+void ir_trace_point(uint32_t id, IrTracePoint point) {
+    if (id) {
+        ir_trace().record(id, point, ir_trace_now());
+    }
+}
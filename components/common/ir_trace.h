@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#ifndef CONFIG_UCD_IR_TRACE_ENTRIES
+#define CONFIG_UCD_IR_TRACE_ENTRIES 128
+#endif
+
+/// IR send trace points in processing order.
+enum class IrTracePoint : uint8_t {
+    /// WebSocket frame received in the web server.
+    WS_RECEIVED = 0,
+    /// JSON request parsed.
+    REQUEST_PARSED,
+    /// IR send message queued for the IR send task.
+    ENQUEUED,
+    /// IR send message taken from the queue by the IR send task.
+    DEQUEUED,
+    /// IR code parsed, start of IR output.
+    FIRST_MARK,
+    /// End of IR output including repeats.
+    LAST_SPACE,
+    /// IR send response sent to the WebSocket client.
+    RESPONSE_SENT,
+    COUNT
+};
+
+/// @brief Get the name of a trace point, e.g. `ws_received`.
+const char *ir_trace_point_name(IrTracePoint point);
+
+struct IrTraceEntry {
+    /// Trace identifier of an IR send request, never 0.
+    uint32_t id;
+    /// Timestamp in microseconds. Wraps around after ~71 minutes, only use for differences within a trace.
+    uint32_t timestamp;
+    IrTracePoint point;
+};
+
+/// Latency statistics of a trace point relative to the start of the trace in microseconds.
+struct IrTraceStats {
+    uint32_t count;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+};
+
+/// @brief Fixed size lock-free ring buffer of trace entries.
+///
+/// Writers reserve a slot with an atomic index and publish the entry with a sequence number. Readers skip entries
+/// which are being overwritten while taking a snapshot. The oldest entries are overwritten when the buffer is full.
+class IrTraceBuffer {
+ public:
+    static const size_t capacity = CONFIG_UCD_IR_TRACE_ENTRIES;
+
+    IrTraceBuffer() = default;
+
+    /// @brief Allocate a new trace identifier.
+    uint32_t nextId();
+
+    /// @brief Record a trace point. Lock-free, can be called from any task.
+    void record(uint32_t id, IrTracePoint point, uint32_t timestamp);
+
+    /// @brief Copy the current entries, oldest first.
+    /// @param entries output array.
+    /// @param max size of the output array.
+    /// @return number of copied entries.
+    size_t snapshot(IrTraceEntry *entries, size_t max) const;
+
+    /// @brief Remove all entries.
+    void clear();
+
+ private:
+    IrTraceBuffer(const IrTraceBuffer &) = delete;  // no copying
+    IrTraceBuffer &operator=(const IrTraceBuffer &) = delete;
+
+    struct Slot {
+        /// Write index + 1 of the published entry, 0 while the slot is being written.
+        std::atomic<uint32_t> seq{0};
+        uint32_t              id = 0;
+        uint32_t              timestamp = 0;
+        IrTracePoint          point = IrTracePoint::WS_RECEIVED;
+    };
+
+    std::atomic<uint32_t> writeIndex_{0};
+    std::atomic<uint32_t> nextId_{0};
+    Slot                  slots_[capacity];
+};
+
+/// @brief Calculate the latency statistics of each trace point relative to the start of its trace.
+///
+/// The start of a trace is the earliest entry with the same trace id. Percentiles use the nearest-rank method.
+/// @param entries trace entries, e.g. from `IrTraceBuffer::snapshot`. The array is reordered!
+/// @param count number of entries.
+/// @param stats output statistics, indexed by `IrTracePoint`.
+/// @return number of traces.
+size_t ir_trace_summary(IrTraceEntry *entries, size_t count, IrTraceStats stats[(size_t)IrTracePoint::COUNT]);
+
+/// @brief Global IR send trace buffer.
+IrTraceBuffer &ir_trace();
+
+/// @brief Current timestamp in microseconds for trace entries.
+uint32_t ir_trace_now();
+
+/// @brief Remember a trace point of the current task until the trace id is known with `ir_trace_begin`.
+///
+/// This allows tracing the request processing steps before it's known if the request is an IR send request.
+void ir_trace_pending(IrTracePoint point);
+
+/// @brief Discard remembered trace points of the current task.
+void ir_trace_clear_pending();
+
+/// @brief Start a new trace and record the remembered trace points of the current task.
+/// @return trace identifier.
+uint32_t ir_trace_begin();
+
+/// @brief Record a trace point with the current timestamp. Ignored if `id` is 0.
+void ir_trace_point(uint32_t id, IrTracePoint point);
@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mem_tag.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "cJSON.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#else
+#include <malloc.h>
+#endif
+
+typedef struct {
+    const char *name;
+    /// Preferred heap capabilities. Internal RAM is used as fallback.
+    uint32_t caps;
+} mem_tag_policy_t;
+
+#ifdef ESP_PLATFORM
+#define CAPS_PSRAM (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#define CAPS_INTERNAL (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#else
+#define CAPS_PSRAM 1
+#define CAPS_INTERNAL 0
+#endif
+
+// Allocation policy table, indexed by mem_tag_t.
+// Attention: PSRAM can't be accessed while the flash cache is disabled, e.g. during NVS or OTA flash writes. Memory
+// used in ISRs, for DMA or in timing critical code must stay in internal RAM.
+static const mem_tag_policy_t mem_tag_policies[MEM_TAG_COUNT] = {
+    // IR code arrays are read in the timing critical IR send loop
+    {"ir", CAPS_INTERNAL},
+    // copied into lwIP buffers
+    {"web", CAPS_PSRAM},
+    {"json", CAPS_PSRAM},
+    {"ui", CAPS_PSRAM},
+};
+
+typedef struct {
+    atomic_uint allocs;
+    atomic_uint psram_allocs;
+    atomic_uint failures;
+    atomic_uint frees;
+    atomic_int  bytes;
+    atomic_int  peak_bytes;
+} mem_tag_counters_t;
+
+static mem_tag_counters_t mem_tag_counters[MEM_TAG_COUNT];
+
+static size_t allocated_size(void *ptr) {
+#ifdef ESP_PLATFORM
+    return heap_caps_get_allocated_size(ptr);
+#else
+    return malloc_usable_size(ptr);
+#endif
+}
+
+static void count_alloc(mem_tag_t tag, void *ptr) {
+    mem_tag_counters_t *counters = &mem_tag_counters[tag];
+
+    if (!ptr) {
+        atomic_fetch_add_explicit(&counters->failures, 1, memory_order_relaxed);
+        return;
+    }
+
+    atomic_fetch_add_explicit(&counters->allocs, 1, memory_order_relaxed);
+#ifdef ESP_PLATFORM
+    if (esp_ptr_external_ram(ptr)) {
+        atomic_fetch_add_explicit(&counters->psram_allocs, 1, memory_order_relaxed);
+    }
+#endif
+
+    int size = (int)allocated_size(ptr);
+    int bytes = atomic_fetch_add_explicit(&counters->bytes, size, memory_order_relaxed) + size;
+    int peak = atomic_load_explicit(&counters->peak_bytes, memory_order_relaxed);
+    while (bytes > peak &&
+           !atomic_compare_exchange_weak_explicit(&counters->peak_bytes, &peak, bytes, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+void *mem_tag_malloc(mem_tag_t tag, size_t size) {
+    if (tag >= MEM_TAG_COUNT) {
+        return NULL;
+    }
+
+    void *ptr;
+#ifdef ESP_PLATFORM
+    ptr = heap_caps_malloc_prefer(size, 2, mem_tag_policies[tag].caps, CAPS_INTERNAL);
+#else
+    ptr = malloc(size);
+#endif
+    count_alloc(tag, ptr);
+    return ptr;
+}
+
+void *mem_tag_calloc(mem_tag_t tag, size_t n, size_t size) {
+    if (tag >= MEM_TAG_COUNT) {
+        return NULL;
+    }
+
+    void *ptr;
+#ifdef ESP_PLATFORM
+    ptr = heap_caps_calloc_prefer(n, size, 2, mem_tag_policies[tag].caps, CAPS_INTERNAL);
+#else
+    ptr = calloc(n, size);
+#endif
+    count_alloc(tag, ptr);
+    return ptr;
+}
+
+char *mem_tag_strdup(mem_tag_t tag, const char *source) {
+    size_t size = strlen(source) + 1;
+    char  *dest = (char *)mem_tag_malloc(tag, size);
+    if (dest) {
+        memcpy(dest, source, size);
+    }
+    return dest;
+}
+
+void mem_tag_free(mem_tag_t tag, void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    if (tag < MEM_TAG_COUNT) {
+        mem_tag_counters_t *counters = &mem_tag_counters[tag];
+        atomic_fetch_add_explicit(&counters->frees, 1, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&counters->bytes, (int)allocated_size(ptr), memory_order_relaxed);
+    }
+    free(ptr);
+}
+
+const char *mem_tag_name(mem_tag_t tag) {
+    if (tag >= MEM_TAG_COUNT) {
+        return "unknown";
+    }
+    return mem_tag_policies[tag].name;
+}
+
+void mem_tag_get_stats(mem_tag_t tag, mem_tag_stats_t *stats) {
+    memset(stats, 0, sizeof(mem_tag_stats_t));
+    if (tag >= MEM_TAG_COUNT) {
+        return;
+    }
+
+    mem_tag_counters_t *counters = &mem_tag_counters[tag];
+    stats->allocs = atomic_load_explicit(&counters->allocs, memory_order_relaxed);
+    stats->psram_allocs = atomic_load_explicit(&counters->psram_allocs, memory_order_relaxed);
+    stats->failures = atomic_load_explicit(&counters->failures, memory_order_relaxed);
+    stats->frees = atomic_load_explicit(&counters->frees, memory_order_relaxed);
+    stats->bytes = atomic_load_explicit(&counters->bytes, memory_order_relaxed);
+    stats->peak_bytes = atomic_load_explicit(&counters->peak_bytes, memory_order_relaxed);
+}
+
+#ifdef ESP_PLATFORM
+static void *cjson_malloc(size_t size) {
+    return mem_tag_malloc(MEM_TAG_JSON, size);
+}
+
+static void cjson_free(void *ptr) {
+    mem_tag_free(MEM_TAG_JSON, ptr);
+}
+#endif
+
+void mem_tag_init_cjson(void) {
+#ifdef ESP_PLATFORM
+    cJSON_Hooks hooks = {
+        .malloc_fn = cjson_malloc,
+        .free_fn = cjson_free,
+    };
+    cJSON_InitHooks(&hooks);
+#endif
+}
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Tagged heap allocations with per subsystem accounting.
+//
+// Each tag has an allocation policy defining the preferred memory: allocations which are not used by DMA or in ISRs
+// are routed to PSRAM to keep the internal RAM available. Allocations fall back to internal RAM if PSRAM is not
+// available or exhausted.
+//
+// Memory allocated with a tag must be freed with `mem_tag_free` and the same tag, otherwise the counters are off.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    /// IR send and learn buffers
+    MEM_TAG_IR = 0,
+    /// WebSocket message payloads
+    MEM_TAG_WEB,
+    /// cJSON documents and print buffers
+    MEM_TAG_JSON,
+    /// Display event data
+    MEM_TAG_UI,
+    MEM_TAG_COUNT
+} mem_tag_t;
+
+typedef struct {
+    /// Number of successful allocations
+    uint32_t allocs;
+    /// Number of allocations in PSRAM
+    uint32_t psram_allocs;
+    /// Number of failed allocations
+    uint32_t failures;
+    /// Number of frees
+    uint32_t frees;
+    /// Currently allocated bytes, including heap block overhead
+    int32_t bytes;
+    /// Maximum allocated bytes
+    int32_t peak_bytes;
+} mem_tag_stats_t;
+
+/// @brief Allocate memory according to the allocation policy of the tag.
+/// @return pointer to the allocated memory, NULL if out of memory.
+void *mem_tag_malloc(mem_tag_t tag, size_t size);
+
+/// @brief Allocate zero-initialized memory according to the allocation policy of the tag.
+void *mem_tag_calloc(mem_tag_t tag, size_t n, size_t size);
+
+/// @brief Duplicate a string with memory allocated according to the allocation policy of the tag.
+char *mem_tag_strdup(mem_tag_t tag, const char *source);
+
+/// @brief Free memory allocated with one of the `mem_tag_*` allocation functions.
+/// @param tag tag used for the allocation.
+/// @param ptr memory to free, may be NULL.
+void mem_tag_free(mem_tag_t tag, void *ptr);
+
+/// @brief Get the tag name, e.g. `json`.
+const char *mem_tag_name(mem_tag_t tag);
+
+/// @brief Get the allocation statistics of a tag.
+void mem_tag_get_stats(mem_tag_t tag, mem_tag_stats_t *stats);
+
+/// @brief Use tagged allocations with `MEM_TAG_JSON` for all cJSON allocations.
+///
+/// Must be called at startup before any cJSON object is created. Strings returned by `cJSON_Print*` must be freed
+/// with `cJSON_free`.
+void mem_tag_init_cjson(void);
+
+#ifdef __cplusplus
+}
+#endif
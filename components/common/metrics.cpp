@@ -0,0 +1,205 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "metrics.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *metric_type_name(MetricType type) {
+    switch (type) {
+        case MetricType::COUNTER:
+            return "counter";
+        case MetricType::GAUGE:
+            return "gauge";
+        case MetricType::HISTOGRAM:
+            return "histogram";
+    }
+    return "untyped";
+}
+
+void metrics_write_header(std::string &out, const char *name, const char *help, MetricType type) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += metric_type_name(type);
+    out += '\n';
+}
+
+void metrics_write_sample(std::string &out, const char *name, const char *labels, int64_t value) {
+    char buf[24];
+
+    out += name;
+    if (labels && labels[0]) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    snprintf(buf, sizeof(buf), " %" PRId64 "\n", value);
+    out += buf;
+}
+
+Metric::Metric(const char *name, const char *help, const char *labels, MetricType type, MetricsRegistry &registry)
+    : name_(name), help_(help), labels_(labels), type_(type), registry_(registry) {
+    registry_.add(this);
+}
+
+Metric::~Metric() {
+    registry_.remove(this);
+}
+
+Counter::Counter(const char *name, const char *help, const char *labels)
+    : Metric(name, help, labels, MetricType::COUNTER, MetricsRegistry::instance()) {}
+
+Counter::Counter(const char *name, const char *help, const char *labels, MetricsRegistry &registry)
+    : Metric(name, help, labels, MetricType::COUNTER, registry) {}
+
+void Counter::write(std::string &out) const {
+    metrics_write_sample(out, name(), labels(), value());
+}
+
+Gauge::Gauge(const char *name, const char *help, const char *labels)
+    : Metric(name, help, labels, MetricType::GAUGE, MetricsRegistry::instance()) {}
+
+Gauge::Gauge(const char *name, const char *help, const char *labels, MetricsRegistry &registry)
+    : Metric(name, help, labels, MetricType::GAUGE, registry) {}
+
+void Gauge::write(std::string &out) const {
+    metrics_write_sample(out, name(), labels(), value());
+}
+
+Histogram::Histogram(const char *name, const char *help, const char *labels, MetricsRegistry &registry,
+                     const uint32_t *bounds, std::atomic<uint32_t> *buckets, size_t bucketCount)
+    : Metric(name, help, labels, MetricType::HISTOGRAM, registry),
+      bounds_(bounds),
+      buckets_(buckets),
+      bucketCount_(bucketCount) {}
+
+void Histogram::observe(uint32_t value) {
+    size_t i = 0;
+    while (i < bucketCount_ && value > bounds_[i]) {
+        i++;
+    }
+    buckets_[i].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Histogram::write(std::string &out) const {
+    // name + "_bucket" / "_count" / "_sum"
+    std::string sampleName = name();
+    size_t      nameLen = sampleName.length();
+    std::string sampleLabels;
+    char        le[20];
+    uint32_t    cumulative = 0;
+
+    sampleName += "_bucket";
+    for (size_t i = 0; i <= bucketCount_; i++) {
+        cumulative += buckets_[i].load(std::memory_order_relaxed);
+        if (i < bucketCount_) {
+            snprintf(le, sizeof(le), "le=\"%" PRIu32 "\"", bounds_[i]);
+        } else {
+            strcpy(le, "le=\"+Inf\"");
+        }
+        sampleLabels.clear();
+        if (labels() && labels()[0]) {
+            sampleLabels = labels();
+            sampleLabels += ',';
+        }
+        sampleLabels += le;
+        metrics_write_sample(out, sampleName.c_str(), sampleLabels.c_str(), cumulative);
+    }
+
+    sampleName.resize(nameLen);
+    sampleName += "_sum";
+    metrics_write_sample(out, sampleName.c_str(), labels(), sum());
+    sampleName.resize(nameLen);
+    sampleName += "_count";
+    // use the cumulative bucket count to be consistent with the +Inf bucket during concurrent updates
+    metrics_write_sample(out, sampleName.c_str(), labels(), cumulative);
+}
+
+MetricsRegistry &MetricsRegistry::instance() {
+    // function local static: safe to use from static metric constructors in other translation units
+    static MetricsRegistry registry;
+    return registry;
+}
+
+bool MetricsRegistry::addCollector(MetricsCollector collector) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &c : collectors_) {
+        if (c == nullptr || c == collector) {
+            c = collector;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MetricsRegistry::add(Metric *metric) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // keep registration order for a stable export order
+    metric->next_ = nullptr;
+    if (tail_) {
+        tail_->next_ = metric;
+    } else {
+        head_ = metric;
+    }
+    tail_ = metric;
+}
+
+void MetricsRegistry::remove(Metric *metric) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Metric                     *prev = nullptr;
+    for (Metric *m = head_; m; prev = m, m = m->next_) {
+        if (m != metric) {
+            continue;
+        }
+        if (prev) {
+            prev->next_ = m->next_;
+        } else {
+            head_ = m->next_;
+        }
+        if (tail_ == m) {
+            tail_ = prev;
+        }
+        return;
+    }
+}
+
+void MetricsRegistry::write(std::string &out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (Metric *m = head_; m; m = m->next_) {
+        // metrics with the same name are written as one metric family: skip if already written
+        bool written = false;
+        for (Metric *p = head_; p != m; p = p->next_) {
+            if (strcmp(p->name_, m->name_) == 0) {
+                written = true;
+                break;
+            }
+        }
+        if (written) {
+            continue;
+        }
+
+        metrics_write_header(out, m->name_, m->help_, m->type_);
+        for (Metric *s = m; s; s = s->next_) {
+            if (s == m || strcmp(s->name_, m->name_) == 0) {
+                s->write(out);
+            }
+        }
+    }
+
+    for (auto collector : collectors_) {
+        if (collector) {
+            collector(out);
+        }
+    }
+}
@@ -0,0 +1,181 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+class MetricsRegistry;
+
+/// Metric types of the Prometheus text exposition format.
+enum class MetricType { COUNTER, GAUGE, HISTOGRAM };
+
+/// @brief Base class of a metric. Metrics register themselves in a registry on construction.
+///
+/// Metrics are intended to be defined as static objects. Updating a metric value is lock-free and can be used in time
+/// critical code paths. Only 32 bit atomics are used, 64 bit atomics are not lock-free on the ESP32.
+///
+/// Multiple metrics may share the same name with different labels, e.g. `format="pronto"` and `format="hex"`.
+class Metric {
+ public:
+    /// @brief Create and register a metric.
+    /// @param name metric name, e.g. `ucd_ir_send_total`. Must be a static string.
+    /// @param help metric description. Must be a static string.
+    /// @param labels optional label list without braces, e.g. `format="pronto"`. Must be a static string.
+    /// @param type metric type.
+    /// @param registry registry to add the metric to.
+    Metric(const char *name, const char *help, const char *labels, MetricType type, MetricsRegistry &registry);
+    virtual ~Metric();
+
+    Metric(const Metric &) = delete;  // no copying
+    Metric &operator=(const Metric &) = delete;
+
+    const char *name() const { return name_; }
+    const char *help() const { return help_; }
+    const char *labels() const { return labels_; }
+    MetricType  type() const { return type_; }
+
+    /// @brief Append the metric samples in text exposition format.
+    virtual void write(std::string &out) const = 0;
+
+ private:
+    friend class MetricsRegistry;
+
+    const char      *name_;
+    const char      *help_;
+    const char      *labels_;
+    MetricType       type_;
+    MetricsRegistry &registry_;
+    Metric          *next_ = nullptr;
+};
+
+/// Monotonic increasing counter.
+class Counter : public Metric {
+ public:
+    Counter(const char *name, const char *help, const char *labels = nullptr);
+    Counter(const char *name, const char *help, const char *labels, MetricsRegistry &registry);
+
+    void inc(uint32_t value = 1) { value_.fetch_add(value, std::memory_order_relaxed); }
+
+    uint32_t value() const { return value_.load(std::memory_order_relaxed); }
+
+    void write(std::string &out) const override;
+
+ private:
+    std::atomic<uint32_t> value_{0};
+};
+
+/// Gauge value which can go up and down.
+class Gauge : public Metric {
+ public:
+    Gauge(const char *name, const char *help, const char *labels = nullptr);
+    Gauge(const char *name, const char *help, const char *labels, MetricsRegistry &registry);
+
+    void set(int32_t value) { value_.store(value, std::memory_order_relaxed); }
+    void inc(int32_t value = 1) { value_.fetch_add(value, std::memory_order_relaxed); }
+    void dec(int32_t value = 1) { value_.fetch_sub(value, std::memory_order_relaxed); }
+
+    int32_t value() const { return value_.load(std::memory_order_relaxed); }
+
+    void write(std::string &out) const override;
+
+ private:
+    std::atomic<int32_t> value_{0};
+};
+
+/// @brief Histogram with fixed bucket upper bounds. Use `HistogramN` to define a histogram.
+class Histogram : public Metric {
+ public:
+    /// @brief Record an observed value.
+    void observe(uint32_t value);
+
+    uint32_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint32_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+    void write(std::string &out) const override;
+
+ protected:
+    Histogram(const char *name, const char *help, const char *labels, MetricsRegistry &registry,
+              const uint32_t *bounds, std::atomic<uint32_t> *buckets, size_t bucketCount);
+
+ private:
+    /// Ascending bucket upper bounds.
+    const uint32_t *bounds_;
+    /// Non-cumulative bucket counters. One more than the number of bounds for the +Inf bucket.
+    std::atomic<uint32_t> *buckets_;
+    size_t                 bucketCount_;
+    std::atomic<uint32_t>  count_{0};
+    std::atomic<uint32_t>  sum_{0};
+};
+
+/// @brief Histogram with N bucket upper bounds.
+/// @tparam N number of bucket upper bounds, excluding the +Inf bucket.
+template <size_t N>
+class HistogramN : public Histogram {
+ public:
+    HistogramN(const char *name, const char *help, const char *labels, const uint32_t (&bounds)[N]);
+    HistogramN(const char *name, const char *help, const char *labels, const uint32_t (&bounds)[N],
+               MetricsRegistry &registry)
+        : Histogram(name, help, labels, registry, bounds, buckets_, N) {}
+
+ private:
+    std::atomic<uint32_t> buckets_[N + 1] = {};
+};
+
+/// @brief Collector function to append dynamic metrics at export time, e.g. sampled values or per task metrics.
+///
+/// Use `metrics_write_header` and `metrics_write_sample` to write the metrics.
+typedef void (*MetricsCollector)(std::string &out);
+
+/// @brief Registry of all metrics with Prometheus text exposition format export.
+///
+/// Registering and exporting metrics is protected by a mutex, updating metric values is lock-free.
+class MetricsRegistry {
+ public:
+    MetricsRegistry() = default;
+
+    /// @brief Default registry used by all metrics without an explicit registry.
+    static MetricsRegistry &instance();
+
+    /// @brief Add a collector function which is called for every export.
+    /// @return false if the maximum number of collectors is reached.
+    bool addCollector(MetricsCollector collector);
+
+    /// @brief Append all metrics in Prometheus text exposition format.
+    void write(std::string &out);
+
+ private:
+    friend class Metric;
+
+    MetricsRegistry(const MetricsRegistry &) = delete;  // no copying
+    MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+    void add(Metric *metric);
+    void remove(Metric *metric);
+
+    static const size_t maxCollectors = 4;
+
+    std::mutex       mutex_;
+    Metric          *head_ = nullptr;
+    Metric          *tail_ = nullptr;
+    MetricsCollector collectors_[maxCollectors] = {};
+};
+
+template <size_t N>
+HistogramN<N>::HistogramN(const char *name, const char *help, const char *labels, const uint32_t (&bounds)[N])
+    : Histogram(name, help, labels, MetricsRegistry::instance(), bounds, buckets_, N) {}
+
+/// @brief Write the `# HELP` and `# TYPE` lines of a metric.
+void metrics_write_header(std::string &out, const char *name, const char *help, MetricType type);
+
+/// @brief Write a metric sample line.
+/// @param out output buffer.
+/// @param name metric name.
+/// @param labels optional label list without braces, nullptr or empty string if not used.
+/// @param value sample value.
+void metrics_write_sample(std::string &out, const char *name, const char *labels, int64_t value);
@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+/// @brief Fixed size object pool without heap allocations.
+///
+/// Slots are reserved with an atomic bit mask: acquiring and releasing objects is lock-free and can be used from
+/// multiple tasks. Objects are constructed when acquired and destroyed when released.
+/// @tparam T object type.
+/// @tparam N number of objects, at most 32.
+template <typename T, size_t N>
+class ObjectPool {
+    static_assert(N > 0 && N <= 32, "ObjectPool supports 1 to 32 objects");
+
+ public:
+    ObjectPool() = default;
+
+    ObjectPool(const ObjectPool &) = delete;  // no copying
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    /// @brief Acquire and construct an object.
+    /// @return the object, or nullptr if all objects are in use.
+    template <typename... Args>
+    T *acquire(Args &&...args) {
+        uint32_t used = used_.load(std::memory_order_relaxed);
+        while (true) {
+            int index = freeIndex(used);
+            if (index < 0) {
+                exhausted_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            if (used_.compare_exchange_weak(used, used | (1u << index), std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+                return new (slots_[index].storage) T(std::forward<Args>(args)...);
+            }
+        }
+    }
+
+    /// @brief Destroy and release an object acquired from this pool.
+    /// @param object object to release, ignored if nullptr or not from this pool.
+    void release(T *object) {
+        int i = index(object);
+        if (i < 0) {
+            return;
+        }
+        object->~T();
+        used_.fetch_and(~(1u << i), std::memory_order_release);
+    }
+
+    /// @brief Get the slot index of an object, e.g. to address associated per slot buffers.
+    /// @return slot index, -1 if the object is not from this pool.
+    int index(const T *object) const {
+        auto address = reinterpret_cast<uintptr_t>(object);
+        auto first = reinterpret_cast<uintptr_t>(&slots_[0]);
+        if (object == nullptr || address < first || address >= first + sizeof(slots_) ||
+            (address - first) % sizeof(Slot) != 0) {
+            return -1;
+        }
+        return static_cast<int>((address - first) / sizeof(Slot));
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+    /// @brief Number of objects in use.
+    size_t used() const { return __builtin_popcount(used_.load(std::memory_order_relaxed)); }
+
+    /// @brief Number of failed acquire calls because all objects were in use.
+    uint32_t exhausted() const { return exhausted_.load(std::memory_order_relaxed); }
+
+ private:
+    static int freeIndex(uint32_t used) {
+        for (size_t i = 0; i < N; i++) {
+            if (!(used & (1u << i))) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    Slot                  slots_[N];
+    std::atomic<uint32_t> used_{0};
+    std::atomic<uint32_t> exhausted_{0};
+};
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "response_template.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+// Attention: field order and number format must match the cJSON documents previously used for these replies!
+// cJSON prints integral numbers without decimal places and doesn't insert any whitespace in unformatted output.
+// Macros instead of variables for compile time format string checks.
+#define TPL_IR_SEND "{\"type\":\"dock\",\"msg\":\"ir_send\",\"req_id\":%" PRIu32 ",\"code\":%u}"
+#define TPL_DOCK "{\"req_id\":%d,\"type\":\"dock\",\"msg\":\"%s\",\"code\":%u}"
+#define TPL_DOCK_NO_ID "{\"type\":\"dock\",\"msg\":\"%s\",\"code\":%u}"
+
+static int checked_length(int len, size_t size) {
+    return (len < 0 || static_cast<size_t>(len) >= size) ? -1 : len;
+}
+
+static bool is_plain_name(const char *name) {
+    if (!name || !name[0]) {
+        return false;
+    }
+    for (const char *c = name; *c; c++) {
+        if (!((*c >= 'a' && *c <= 'z') || (*c >= '0' && *c <= '9') || *c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int response_format_ir_send(char *buf, size_t size, uint32_t reqId, uint16_t code) {
+    return checked_length(snprintf(buf, size, TPL_IR_SEND, reqId, code), size);
+}
+
+int response_format_dock(char *buf, size_t size, const int *reqId, const char *msg, uint16_t code) {
+    if (!is_plain_name(msg)) {
+        return -1;
+    }
+    int len = reqId ? snprintf(buf, size, TPL_DOCK, *reqId, msg, code) : snprintf(buf, size, TPL_DOCK_NO_ID, msg, code);
+    return checked_length(len, size);
+}
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Precomputed JSON templates for high-frequency API replies.
+//
+// The formatted messages are byte-identical to the unformatted cJSON output of the equivalent documents, but don't
+// require building, printing and freeing a cJSON tree.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// Maximum length of a formatted response template including NUL terminator.
+#define RESPONSE_TEMPLATE_MAX_LENGTH 96
+
+/// @brief Format the asynchronous `ir_send` response.
+///
+/// `{"type":"dock","msg":"ir_send","req_id":<req_id>,"code":<code>}`
+/// @param buf output buffer.
+/// @param size output buffer size.
+/// @param reqId request message identifier.
+/// @param code response code.
+/// @return length of the message, -1 if the buffer is too small.
+int response_format_ir_send(char *buf, size_t size, uint32_t reqId, uint16_t code);
+
+/// @brief Format a dock command reply without additional fields, e.g. the `pong` reply of a `ping` message.
+///
+/// `{"req_id":<req_id>,"type":"dock","msg":"<msg>","code":<code>}`
+/// @param buf output buffer.
+/// @param size output buffer size.
+/// @param reqId optional request message identifier, the `req_id` field is omitted if nullptr.
+/// @param msg message name. Only `a-z`, `0-9` and `_` are allowed, since the value is not escaped.
+/// @param code response code.
+/// @return length of the message, -1 if the buffer is too small or the message name is not allowed.
+int response_format_dock(char *buf, size_t size, const int *reqId, const char *msg, uint16_t code);
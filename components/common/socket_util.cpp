@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "socket_util.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "esp_log.h"
+#include "esp_netif.h"
+
+int socket_tcp_listen(uint16_t port, int backlog, const char *tag) {
+    struct sockaddr_storage addr = {};
+    socklen_t               addrLen;
+#if CONFIG_LWIP_IPV6
+    int                  family = AF_INET6;
+    struct sockaddr_in6 *addr6 = reinterpret_cast<struct sockaddr_in6 *>(&addr);
+    addr6->sin6_family = AF_INET6;
+    addr6->sin6_addr = in6addr_any;
+    addr6->sin6_port = htons(port);
+    addrLen = sizeof(struct sockaddr_in6);
+#else
+    int                 family = AF_INET;
+    struct sockaddr_in *addr4 = reinterpret_cast<struct sockaddr_in *>(&addr);
+    addr4->sin_family = AF_INET;
+    addr4->sin_addr.s_addr = htonl(INADDR_ANY);
+    addr4->sin_port = htons(port);
+    addrLen = sizeof(struct sockaddr_in);
+#endif
+
+    int sock = socket(family, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        ESP_LOGE(tag, "Unable to create socket: errno %d", errno);
+        return -1;
+    }
+    int opt = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+#if CONFIG_LWIP_IPV6
+    // dual-stack: also accept IPv4 connections
+    opt = 0;
+    setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &opt, sizeof(opt));
+#endif
+
+    if (bind(sock, reinterpret_cast<struct sockaddr *>(&addr), addrLen) != 0) {
+        ESP_LOGE(tag, "Socket unable to bind: errno %d", errno);
+        close(sock);
+        return -1;
+    }
+    if (listen(sock, backlog) != 0) {
+        ESP_LOGE(tag, "Error occurred during listen: errno %d", errno);
+        close(sock);
+        return -1;
+    }
+
+    ESP_LOGI(tag, "Socket listening on port %d (%s)", port, family == AF_INET6 ? "IPv4 & IPv6" : "IPv4");
+    return sock;
+}
+
+int socket_udp_multicast(int family, uint16_t port, const char *tag) {
+#if !CONFIG_LWIP_IPV6
+    if (family == AF_INET6) {
+        return -1;
+    }
+#endif
+    if (family != AF_INET && family != AF_INET6) {
+        return -1;
+    }
+
+    int sock = socket(family, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(tag, "Unable to create UDP socket: errno %d", errno);
+        return -1;
+    }
+    int opt = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_storage addr = {};
+    socklen_t               addrLen;
+    if (family == AF_INET6) {
+        struct sockaddr_in6 *addr6 = reinterpret_cast<struct sockaddr_in6 *>(&addr);
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_addr = in6addr_any;
+        addr6->sin6_port = htons(port);
+        addrLen = sizeof(struct sockaddr_in6);
+        setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &opt, sizeof(opt));
+    } else {
+        struct sockaddr_in *addr4 = reinterpret_cast<struct sockaddr_in *>(&addr);
+        addr4->sin_family = AF_INET;
+        addr4->sin_addr.s_addr = htonl(INADDR_ANY);
+        addr4->sin_port = htons(port);
+        addrLen = sizeof(struct sockaddr_in);
+    }
+
+    if (bind(sock, reinterpret_cast<struct sockaddr *>(&addr), addrLen) != 0) {
+        ESP_LOGE(tag, "Bind to UDP port %d failed: errno %d", port, errno);
+        close(sock);
+        return -1;
+    }
+
+#if CONFIG_LWIP_IPV6
+    if (family == AF_INET6) {
+        // link-local multicast requires an outgoing interface
+        int ifIndex = esp_netif_get_netif_impl_index(esp_netif_get_default_netif());
+        if (ifIndex > 0) {
+            setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_IF, &ifIndex, sizeof(ifIndex));
+        }
+    }
+#endif
+
+    return sock;
+}
+
+const char *socket_addr_str(const struct sockaddr_storage *addr, char *buf, size_t size) {
+    if (size == 0) {
+        return buf;
+    }
+    buf[0] = 0;
+
+    uint16_t port = 0;
+    if (addr->ss_family == AF_INET) {
+        auto addr4 = reinterpret_cast<const struct sockaddr_in *>(addr);
+        inet_ntop(AF_INET, &addr4->sin_addr, buf, size);
+        port = ntohs(addr4->sin_port);
+    }
+#if CONFIG_LWIP_IPV6
+    if (addr->ss_family == AF_INET6 && size > 2) {
+        static const uint8_t v4MappedPrefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+
+        auto           addr6 = reinterpret_cast<const struct sockaddr_in6 *>(addr);
+        const uint8_t *bytes = addr6->sin6_addr.s6_addr;
+        if (memcmp(bytes, v4MappedPrefix, sizeof(v4MappedPrefix)) == 0) {
+            // IPv4 client of a dual-stack socket
+            inet_ntop(AF_INET, bytes + sizeof(v4MappedPrefix), buf, size);
+        } else {
+            buf[0] = '[';
+            inet_ntop(AF_INET6, &addr6->sin6_addr, buf + 1, size - 2);
+            strcat(buf, "]");
+        }
+        port = ntohs(addr6->sin6_port);
+    }
+#endif
+
+    if (port) {
+        size_t len = strlen(buf);
+        snprintf(buf + len, size - len, ":%u", port);
+    }
+    return buf;
+}
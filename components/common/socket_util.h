@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Socket setup shared by the TCP servers and the discovery beacon.
+// IPv6 is used if enabled in lwIP (CONFIG_LWIP_IPV6): server sockets are dual-stack and accept IPv4 clients with
+// IPv4-mapped IPv6 addresses.
+
+#pragma once
+
+#include <lwip/sockets.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+/// Maximum length of a formatted socket address, see `socket_addr_str`.
+#define SOCKET_ADDR_STR_LEN 48
+
+/// @brief Create a TCP server socket listening on all interfaces.
+/// @param port TCP port.
+/// @param backlog maximum number of pending connections.
+/// @param tag log tag of the server.
+/// @return listening socket, -1 if the socket can't be created.
+int socket_tcp_listen(uint16_t port, int backlog, const char *tag);
+
+/// @brief Create a UDP socket for sending multicast messages on the default network interface.
+/// @param family AF_INET or AF_INET6.
+/// @param port local port, 0 for an ephemeral port.
+/// @param tag log tag.
+/// @return socket, -1 if the socket can't be created or the address family isn't supported.
+int socket_udp_multicast(int family, uint16_t port, const char *tag);
+
+/// @brief Format a socket address for logging. IPv4-mapped IPv6 addresses are formatted as IPv4 address.
+/// @param addr socket address, e.g. from `accept`.
+/// @param buf output buffer, at least SOCKET_ADDR_STR_LEN characters.
+/// @param size size of the output buffer.
+/// @return buf
+const char *socket_addr_str(const struct sockaddr_storage *addr, char *buf, size_t size);
@@ -44,3 +44,57 @@ int replacechar(char *str, char orig, char rep) {
     }
     return n;
 }
+
+bool isTextData(const uint8_t *buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = buf[i];
+        if ((c < 0x20 || c > 0x7e) && c != '\r' && c != '\n' && c != '\t') {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string hexEncode(const uint8_t *buf, size_t len) {
+    static const char digits[] = "0123456789ABCDEF";
+
+    std::string hex;
+    hex.reserve(len * 2);
+    for (size_t i = 0; i < len; i++) {
+        hex += digits[buf[i] >> 4];
+        hex += digits[buf[i] & 0x0f];
+    }
+    return hex;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+int hexDecode(const char *hex, uint8_t *out, size_t size) {
+    if (hex == NULL) {
+        return -1;
+    }
+    size_t len = strlen(hex);
+    if (len % 2 || len / 2 > size) {
+        return -1;
+    }
+    for (size_t i = 0; i < len; i += 2) {
+        int high = hexValue(hex[i]);
+        int low = hexValue(hex[i + 1]);
+        if (high < 0 || low < 0) {
+            return -1;
+        }
+        out[i / 2] = (high << 4) | low;
+    }
+    return len / 2;
+}
@@ -27,3 +27,22 @@ std::string toPrintableString(const uint8_t *buf, size_t len);
 /// @param rep replacement character
 /// @return number of characters replaced
 int replacechar(char *str, char orig, char rep);
+
+/// @brief Check if a byte buffer only contains printable ASCII characters, carriage return, line feed or tab.
+/// @param buf buffer
+/// @param len length of buffer
+/// @return true if the buffer can be represented as text.
+bool isTextData(const uint8_t *buf, size_t len);
+
+/// @brief Encode a byte buffer as hex string with upper case characters.
+/// @param buf buffer
+/// @param len length of buffer
+/// @return hex string with two characters per byte.
+std::string hexEncode(const uint8_t *buf, size_t len);
+
+/// @brief Decode a hex string into a byte buffer.
+/// @param hex hex string with two characters per byte, upper or lower case.
+/// @param out output buffer
+/// @param size size of the output buffer
+/// @return number of decoded bytes, -1 if the hex string is invalid or doesn't fit into the output buffer.
+int hexDecode(const char *hex, uint8_t *out, size_t size);
@@ -21,7 +21,7 @@
 #include "board.h"
 #include "font/lv_font.h"
 #include "lvgl.h"
-#include "mem_util.h"
+#include "mem_tag.h"
 #include "uc_events.h"
 
 ESP_EVENT_DEFINE_BASE(UC_DOCK_EVENTS);
@@ -68,7 +68,7 @@ static void queue_ui_sm_event(DisplaySm::EventId event, void *event_data, size_t
 
     msg.event_id = static_cast<uint8_t>(event);
     if (event_data && event_data_size) {
-        msg.event_data = malloc(event_data_size);
+        msg.event_data = mem_tag_malloc(MEM_TAG_UI, event_data_size);
         if (msg.event_data) {
             memcpy(msg.event_data, event_data, event_data_size);
         } else {
@@ -85,6 +85,7 @@ static void queue_ui_sm_event(DisplaySm::EventId event, void *event_data, size_t
     }
     if (ret != pdTRUE) {
         ESP_LOGE(TAG, "Failed to enqueue display event");
+        mem_tag_free(MEM_TAG_UI, msg.event_data);
     }
 }
 
@@ -648,7 +649,7 @@ void DisplayDriver::onEventQueueTimer(TimerHandle_t timer) {
 
     if (msg.event_id >= DisplaySm::EventIdCount) {
         ESP_LOGE(TAG, "Invalid event: %u", msg.event_id);
-        FREE_AND_NULL(msg.event_data);
+        mem_tag_free(MEM_TAG_UI, msg.event_data);
         return;
     }
     DisplaySm::EventId eventId = static_cast<DisplaySm::EventId>(msg.event_id);
@@ -673,7 +674,7 @@ void DisplayDriver::onEventQueueTimer(TimerHandle_t timer) {
 
     displaySm.dispatchEvent(eventId);
 
-    FREE_AND_NULL(msg.event_data);
+    mem_tag_free(MEM_TAG_UI, msg.event_data);
 
     auto newState = displaySm.stateId;
     ESP_LOGI(TAG, "UI SM transition: %s -> %s", DisplaySm::stateIdToString(oldState),
@@ -4,6 +4,7 @@
 
 #include "external_port.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "driver/gpio.h"
@@ -15,11 +16,23 @@
 
 #include "board.h"
 #include "mem_util.h"
+#include "metrics.h"
 #include "sdkconfig.h"
+#include "uart_framer.h"
 #include "uc_events.h"
 
 static const char *const TAG = "PORT";
 
+// maximum frame length forwarded to the RX handler
+#define UART_RX_FRAME_MAX 256
+// XON/XOFF thresholds: number of bytes in the RX FIFO
+#define UART_XON_THRESHOLD 32
+#define UART_XOFF_THRESHOLD 96
+
+static Counter uartRxBytes("ucd_uart_rx_bytes_total", "Number of bytes received on the external port UARTs");
+static Counter uartTxBytes("ucd_uart_tx_bytes_total", "Number of bytes sent on the external port UARTs");
+static Counter uartRxOverflows("ucd_uart_rx_overflows_total", "Number of UART RX buffer overflows");
+
 typedef struct {
     int expected_rx;
     int voltage_min;
@@ -103,9 +116,6 @@ static bool match_signature(const port_signature_t *sig, size_t count, const int
     return true;
 }
 
-// TODO static or dynamic config option?
-#define CONFIG_PORT_UART_RING_BUFFER_SIZE 512
-
 ExternalPort::ExternalPort(uint8_t port, ext_port_config_t config, std::unique_ptr<AdcReader> reader,
                            std::shared_ptr<AdcReader> vcc_reader)
     : port_(port),
@@ -116,8 +126,17 @@ ExternalPort::ExternalPort(uint8_t port, ext_port_config_t config, std::unique_p
       trigger_timer_(nullptr),
       port_lock_(xSemaphoreCreateMutex()),
       vcc_reader_(vcc_reader),
-      uart_event_queue_(nullptr) {
+      uart_event_queue_(nullptr),
+      uart_lock_(xSemaphoreCreateMutex()),
+      uart_task_stop_(false),
+      uart_task_done_(xSemaphoreCreateBinary()),
+      uart_task_(nullptr),
+      uart_rx_handler_lock_(xSemaphoreCreateMutex()),
+      uart_rx_handler_(nullptr) {
     assert(port_lock_);
+    assert(uart_lock_);
+    assert(uart_task_done_);
+    assert(uart_rx_handler_lock_);
     if (asprintf(&tag_, "EXT%d", port) < 0) {
         tag_ = nullptr;
     }
@@ -344,6 +363,53 @@ esp_err_t ExternalPort::setUartConfig(std::unique_ptr<UartConfig> config) {
     return ESP_OK;
 }
 
+void ExternalPort::setUartRxHandler(uart_rx_handler_t handler) {
+    xSemaphoreTake(uart_rx_handler_lock_, portMAX_DELAY);
+    uart_rx_handler_ = std::move(handler);
+    xSemaphoreGive(uart_rx_handler_lock_);
+}
+
+esp_err_t ExternalPort::writeUart(const void *data, size_t len, TickType_t wait) {
+    if (len > CONFIG_UCD_UART_BUFFER_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (xSemaphoreTake(uart_lock_, wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    esp_err_t  ret = ESP_OK;
+    TickType_t start = xTaskGetTickCount();
+    if (mode_ != RS232 || !uart_is_driver_installed(config_.uart_port)) {
+        ret = ESP_ERR_INVALID_STATE;
+        goto done;
+    }
+
+    // uart_write_bytes blocks until all data is in the TX buffer: only write if it fits
+    while (true) {
+        size_t available = 0;
+        ESP_GOTO_ON_ERROR(uart_get_tx_buffer_free_size(config_.uart_port, &available), done, tag_,
+                          "Failed to get TX buffer size");
+        if (available >= len) {
+            break;
+        }
+        if (xTaskGetTickCount() - start >= wait) {
+            ret = ESP_ERR_TIMEOUT;
+            goto done;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    if (uart_write_bytes(config_.uart_port, data, len) != static_cast<int>(len)) {
+        ret = ESP_FAIL;
+    } else {
+        uartTxBytes.inc(len);
+    }
+
+done:
+    xSemaphoreGive(uart_lock_);
+    return ret;
+}
+
 bool ExternalPort::isTriggerOn() {
     if (mode_ != TRIGGER_5V) {
         return false;
@@ -459,17 +525,15 @@ esp_err_t ExternalPort::initUart() {
 
     uart_config_t uart_config = uart_cfg_->toConfig();
 
-    // TODO finalize init uart with queue etc
     int event_queue_size = 16;
     int intr_alloc_flags = 0;
 
 #if CONFIG_UART_ISR_IN_IRAM
     intr_alloc_flags = ESP_INTR_FLAG_IRAM;
 #endif
-    ESP_GOTO_ON_ERROR(
-        uart_driver_install(config_.uart_port, CONFIG_PORT_UART_RING_BUFFER_SIZE, CONFIG_PORT_UART_RING_BUFFER_SIZE,
-                            event_queue_size, &uart_event_queue_, intr_alloc_flags),
-        err_uart_install, tag_, "install uart driver failed");
+    ESP_GOTO_ON_ERROR(uart_driver_install(config_.uart_port, CONFIG_UCD_UART_BUFFER_SIZE, CONFIG_UCD_UART_BUFFER_SIZE,
+                                          event_queue_size, &uart_event_queue_, intr_alloc_flags),
+                      err_uart_install, tag_, "install uart driver failed");
     ESP_GOTO_ON_ERROR(uart_param_config(config_.uart_port, &uart_config), err_uart_config, tag_,
                       "config uart parameter failed");
     ESP_GOTO_ON_ERROR(
@@ -478,28 +542,116 @@ esp_err_t ExternalPort::initUart() {
 
     ESP_GOTO_ON_ERROR(uart_set_line_inverse(config_.uart_port, UART_SIGNAL_TXD_INV | UART_SIGNAL_RXD_INV),
                       err_uart_config, tag_, "uart line inverse failed");
+    if (uart_cfg_->xonxoff) {
+        ESP_GOTO_ON_ERROR(
+            uart_set_sw_flow_ctrl(config_.uart_port, true, UART_XON_THRESHOLD, UART_XOFF_THRESHOLD),
+            err_uart_config, tag_, "uart flow control failed");
+    }
+
+    uart_task_stop_ = false;
+    if (xTaskCreatePinnedToCore(uartTask,     // task function
+                                tag_,         // task name
+                                3072,         // stack size
+                                this,         // task parameter
+                                4,            // task priority
+                                &uart_task_,  // Task handle to keep track of created task
+                                0) != pdPASS) {
+        ESP_LOGE(tag_, "Failed to create UART task");
+        ret = ESP_ERR_NO_MEM;
+        goto err_uart_config;
+    }
 
     return ESP_OK;
 
-err_uart_install:
-    uart_driver_delete(config_.uart_port);
 err_uart_config:
+    uart_driver_delete(config_.uart_port);
+    uart_event_queue_ = nullptr;
+err_uart_install:
     return ret;
 }
 
 void ExternalPort::deinitUart() {
-    // TODO(zehnm) stop task & event loop
-    // vTaskDelete(uart_tsk_hdl_);
-    // esp_event_loop_delete(uear_event_loop_hdl_);
+    if (uart_task_) {
+        uart_task_stop_ = true;
+        xSemaphoreTake(uart_task_done_, portMAX_DELAY);
+        uart_task_ = nullptr;
+    }
 
+    xSemaphoreTake(uart_lock_, portMAX_DELAY);
     if (uart_event_queue_) {
         xQueueReset(uart_event_queue_);
         uart_event_queue_ = nullptr;
     }
-    if (config_.uart_port != UART_NUM_MAX) {
+    if (config_.uart_port != UART_NUM_MAX && uart_is_driver_installed(config_.uart_port)) {
         uart_driver_delete(config_.uart_port);
-        config_.uart_port = UART_NUM_MAX;
     }
+    xSemaphoreGive(uart_lock_);
+}
+
+/// @brief UART RX task: reads received data and forwards it in frames to the RX handler.
+/// @param param ExternalPort instance. The task signals `uart_task_done_` when stopped with `uart_task_stop_`.
+void ExternalPort::uartTask(void *param) {
+    ExternalPort *that = reinterpret_cast<ExternalPort *>(param);
+    uart_port_t   uart_port = that->config_.uart_port;
+    QueueHandle_t queue = that->uart_event_queue_;
+    TickType_t    rx_timeout = pdMS_TO_TICKS(that->uart_cfg_->rx_timeout);
+
+    UartFramer framer(that->uart_cfg_->rx_delimiter, UART_RX_FRAME_MAX, [that](const uint8_t *data, size_t len) {
+        xSemaphoreTake(that->uart_rx_handler_lock_, portMAX_DELAY);
+        if (that->uart_rx_handler_) {
+            that->uart_rx_handler_(that->port_, data, len);
+        }
+        xSemaphoreGive(that->uart_rx_handler_lock_);
+    });
+    uint8_t buffer[128];
+
+    ESP_LOGI(that->tag_, "UART task started");
+
+    while (!that->uart_task_stop_) {
+        uart_event_t event;
+        // pending data is forwarded after the idle timeout. The stop flag is checked at least every 100ms.
+        TickType_t wait = framer.pending() ? rx_timeout : pdMS_TO_TICKS(100);
+        if (xQueueReceive(queue, &event, wait) != pdTRUE) {
+            framer.flush();
+            continue;
+        }
+
+        switch (event.type) {
+            case UART_DATA: {
+                size_t remaining = event.size;
+                while (remaining > 0) {
+                    int len = uart_read_bytes(uart_port, buffer, std::min(remaining, sizeof(buffer)), 0);
+                    if (len <= 0) {
+                        break;
+                    }
+                    uartRxBytes.inc(len);
+                    framer.feed(buffer, len);
+                    remaining -= len;
+                }
+                break;
+            }
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                // the RX handler is too slow, or the peer ignores flow control
+                ESP_LOGW(that->tag_, "UART RX overflow: discarding received data");
+                uartRxOverflows.inc();
+                uart_flush_input(uart_port);
+                xQueueReset(queue);
+                framer.reset();
+                break;
+            case UART_BREAK:
+            case UART_FRAME_ERR:
+            case UART_PARITY_ERR:
+                ESP_LOGD(that->tag_, "UART RX error event: %d", event.type);
+                break;
+            default:
+                break;
+        }
+    }
+
+    ESP_LOGI(that->tag_, "UART task stopped");
+    xSemaphoreGive(that->uart_task_done_);
+    vTaskDelete(NULL);
 }
 
 void ExternalPort::applyVector(int g, int e, int t, bool is_mono) {
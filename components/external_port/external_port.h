@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
 
@@ -11,6 +13,7 @@
 #include "esp_adc/adc_oneshot.h"
 #include "esp_err.h"
 #include "esp_timer.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "hal/adc_types.h"
 #include "soc/gpio_num.h"
@@ -23,6 +26,12 @@
 class ExternalPort;
 typedef std::map<uint8_t, std::shared_ptr<ExternalPort>> port_map_t;
 
+/// @brief Handler for received UART data in RS232 mode.
+/// @param port 1-based external port number.
+/// @param data received frame, only valid during the call.
+/// @param len frame length.
+typedef std::function<void(uint8_t port, const uint8_t *data, size_t len)> uart_rx_handler_t;
+
 /// @brief GPIO configuration & UART settings for an external port
 // TODO this should be refactored and separated from ExternalPort: create an ExternalPortDriver which takes care of all
 //      the hardware communication. -> simplifies writing unit tests and reduces mocking IDF files!
@@ -84,6 +93,23 @@ class ExternalPort {
     /// @return ESP_OK if settings are valid.
     esp_err_t setUartConfig(std::unique_ptr<UartConfig> uart_cfg);
 
+    /// @brief Set the handler for received UART data.
+    ///
+    /// Received data is split into frames with the RX delimiter and idle timeout of the UART configuration. The
+    /// handler is called from the UART task of the port and must not block.
+    /// @param handler RX handler, nullptr to discard received data.
+    void setUartRxHandler(uart_rx_handler_t handler);
+
+    /// @brief Write data to the UART in RS232 operation mode.
+    /// @param data data to send.
+    /// @param len data length, at most the TX buffer size (CONFIG_UCD_UART_BUFFER_SIZE).
+    /// @param wait maximum time to wait for free space in the TX buffer. The TX buffer drains slowly with low baud
+    ///             rates, or not at all while the peer paused transmission with XOFF.
+    /// @return ESP_OK if the data was written to the TX buffer, ESP_ERR_INVALID_STATE if the port is not in RS232 mode,
+    ///         ESP_ERR_INVALID_SIZE if the data doesn't fit into the TX buffer, ESP_ERR_TIMEOUT if the TX buffer is
+    ///         full.
+    esp_err_t writeUart(const void *data, size_t len, TickType_t wait);
+
     /// @brief Return the current trigger mode if operation mode is `5V_TRIGGER`.
     /// @return true if trigger is active, false otherwise or if a different operation mode is set.
     bool isTriggerOn();
@@ -120,6 +146,7 @@ class ExternalPort {
     bool is_ir_blaster();
 
     static void triggerTimerCb(void *timer_id);
+    static void uartTask(void *param);
 
  private:
     // logging tag, based on port number
@@ -133,6 +160,13 @@ class ExternalPort {
     esp_timer_handle_t          trigger_timer_;
     SemaphoreHandle_t           port_lock_;
     std::shared_ptr<AdcReader>  vcc_reader_;
-    // TODO do we need an event queue?
-    QueueHandle_t uart_event_queue_;
+    QueueHandle_t               uart_event_queue_;
+    // protects the UART driver while writing and uninstalling
+    SemaphoreHandle_t uart_lock_;
+    // RX task: stop flag and completion signal
+    std::atomic<bool> uart_task_stop_;
+    SemaphoreHandle_t uart_task_done_;
+    TaskHandle_t      uart_task_;
+    SemaphoreHandle_t uart_rx_handler_lock_;
+    uart_rx_handler_t uart_rx_handler_;
 };
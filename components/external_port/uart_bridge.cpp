@@ -0,0 +1,203 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "uart_bridge.h"
+
+#include <lwip/sockets.h>
+
+#include <algorithm>
+#include <string>
+
+#include "cJSON.h"
+#include "esp_log.h"
+#include "freertos/task.h"
+
+#include "metrics.h"
+#include "socket_util.h"
+#include "string_util.h"
+
+static const char *const TAG = "UARTB";
+
+// maximum time to wait for free space in the UART TX buffer before TCP data is discarded
+#define UART_BRIDGE_TX_TIMEOUT_MS 5000
+
+static Counter uartBridgeConnections("ucd_uart_bridge_connections_total",
+                                     "Number of accepted serial bridge TCP connections");
+static Counter uartBridgeDropped("ucd_uart_bridge_dropped_total",
+                                 "Number of bytes discarded by the serial bridge because of a full buffer");
+
+UartBridge &UartBridge::getInstance() {
+    static UartBridge instance;
+    return instance;
+}
+
+esp_err_t UartBridge::init(const port_map_t &ports, UartBridgeEventCallback eventCallback) {
+    event_callback_ = eventCallback;
+
+    for (const auto &[number, port] : ports) {
+        if (number < 1 || number > EXTERNAL_PORT_COUNT || !port->isModeSupported(RS232)) {
+            continue;
+        }
+
+        PortServer *server = &servers_[number - 1];
+        server->bridge = this;
+        server->port = port;
+        server->tcpPort = CONFIG_UCD_UART_BRIDGE_TCP_PORT + number - 1;
+        server->lock = xSemaphoreCreateMutex();
+        if (server->lock == nullptr) {
+            return ESP_ERR_NO_MEM;
+        }
+        for (int &client : server->clients) {
+            client = -1;
+        }
+
+        port->setUartRxHandler(
+            [this, server](uint8_t, const uint8_t *data, size_t len) { onUartRx(server, data, len); });
+
+        xTaskCreatePinnedToCore(server_task,     // task function
+                                "UART bridge",   // task name
+                                3072,            // stack size
+                                server,          // task parameter
+                                3,               // task priority
+                                NULL,            // Task handle to keep track of created task
+                                0);              // core
+    }
+
+    return ESP_OK;
+}
+
+/// @brief Forward received UART data to the TCP clients and WebSocket subscribers.
+///
+/// Called from the UART task of the port: TCP clients which can't keep up lose data instead of blocking the UART.
+void UartBridge::onUartRx(PortServer *server, const uint8_t *data, size_t len) {
+    xSemaphoreTake(server->lock, portMAX_DELAY);
+    for (int client : server->clients) {
+        if (client < 0) {
+            continue;
+        }
+        int sent = send(client, data, len, MSG_DONTWAIT);
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            uartBridgeDropped.inc(len);
+        } else if (sent < 0) {
+            // closed by the server task
+            shutdown(client, SHUT_RDWR);
+        } else if (sent < static_cast<int>(len)) {
+            uartBridgeDropped.inc(len - sent);
+        }
+    }
+    xSemaphoreGive(server->lock);
+
+    if (!event_callback_) {
+        return;
+    }
+
+    cJSON *event = cJSON_CreateObject();
+    cJSON_AddStringToObject(event, "type", "event");
+    cJSON_AddStringToObject(event, "msg", "uart_rx");
+    cJSON_AddNumberToObject(event, "port", server->port->getPortNumber());
+    if (isTextData(data, len)) {
+        cJSON_AddStringToObject(event, "format", "text");
+        cJSON_AddStringToObject(event, "data", std::string(reinterpret_cast<const char *>(data), len).c_str());
+    } else {
+        cJSON_AddStringToObject(event, "format", "hex");
+        cJSON_AddStringToObject(event, "data", hexEncode(data, len).c_str());
+    }
+
+    char *message = cJSON_PrintUnformatted(event);
+    cJSON_Delete(event);
+    if (message) {
+        event_callback_(message);
+        cJSON_free(message);
+    }
+}
+
+/// @brief Raw TCP server of an external port.
+/// @param param PortServer of the external port.
+void UartBridge::server_task(void *param) {
+    PortServer *server = reinterpret_cast<PortServer *>(param);
+    char        tag[10];
+    snprintf(tag, sizeof(tag), "%s%d", TAG, server->port->getPortNumber());
+
+    int listen_sock = socket_tcp_listen(server->tcpPort, 1, tag);
+    if (listen_sock < 0) {
+        vTaskDelete(NULL);
+        return;
+    }
+
+    uint8_t buffer[128];
+
+    while (true) {
+        fd_set readFds;
+        FD_ZERO(&readFds);
+        FD_SET(listen_sock, &readFds);
+        int maxFd = listen_sock;
+        // only the server task modifies the client sockets: no lock required for reading
+        for (int client : server->clients) {
+            if (client >= 0) {
+                FD_SET(client, &readFds);
+                maxFd = std::max(maxFd, client);
+            }
+        }
+
+        if (select(maxFd + 1, &readFds, nullptr, nullptr, nullptr) < 0) {
+            ESP_LOGE(tag, "select failed: errno %d", errno);
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+
+        if (FD_ISSET(listen_sock, &readFds)) {
+            struct sockaddr_storage source_addr;
+            socklen_t               addr_len = sizeof(source_addr);
+            int sock = accept(listen_sock, reinterpret_cast<struct sockaddr *>(&source_addr), &addr_len);
+            if (sock >= 0) {
+                char addr_str[SOCKET_ADDR_STR_LEN];
+                socket_addr_str(&source_addr, addr_str, sizeof(addr_str));
+
+                int *slot = nullptr;
+                for (int &client : server->clients) {
+                    if (client < 0) {
+                        slot = &client;
+                        break;
+                    }
+                }
+                if (slot == nullptr) {
+                    ESP_LOGW(tag, "Rejecting client %s: too many connections", addr_str);
+                    close(sock);
+                } else {
+                    int noDelay = 1;
+                    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+                    xSemaphoreTake(server->lock, portMAX_DELAY);
+                    *slot = sock;
+                    xSemaphoreGive(server->lock);
+                    uartBridgeConnections.inc();
+                    ESP_LOGI(tag, "[%d] Client connected: %s", sock, addr_str);
+                }
+            }
+        }
+
+        for (int &client : server->clients) {
+            if (client < 0 || !FD_ISSET(client, &readFds)) {
+                continue;
+            }
+
+            int len = recv(client, buffer, sizeof(buffer), 0);
+            if (len <= 0) {
+                ESP_LOGI(tag, "[%d] Client disconnected", client);
+                xSemaphoreTake(server->lock, portMAX_DELAY);
+                close(client);
+                client = -1;
+                xSemaphoreGive(server->lock);
+                continue;
+            }
+
+            // blocks while the TX buffer is full: TCP flow control slows down the client
+            esp_err_t ret = server->port->writeUart(buffer, len, pdMS_TO_TICKS(UART_BRIDGE_TX_TIMEOUT_MS));
+            if (ret != ESP_OK) {
+                ESP_LOGW(tag, "[%d] Discarding %d bytes: %s", client, len,
+                         ret == ESP_ERR_INVALID_STATE ? "port is not in RS232 mode" : esp_err_to_name(ret));
+                uartBridgeDropped.inc(len);
+            }
+        }
+    }
+}
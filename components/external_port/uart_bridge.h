@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Serial bridge of the external ports in RS232 mode.
+//
+// Every external port has a raw TCP server, like the serial ports of an iTach IP2SL: port 1 listens on
+// CONFIG_UCD_UART_BRIDGE_TCP_PORT (4999), port 2 on the next port. Data received from a TCP client is sent on the
+// UART, received UART data is sent to all TCP clients of the port and as `uart_rx` event to subscribed WebSocket
+// clients.
+
+#pragma once
+
+#include <functional>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "board.h"
+#include "external_port.h"
+#include "sdkconfig.h"
+
+/// @brief Callback for `uart_rx` WebSocket event messages.
+typedef std::function<void(const char *message)> UartBridgeEventCallback;
+
+class UartBridge {
+ public:
+    static UartBridge &getInstance();
+
+    /// @brief Start the TCP servers and forward received UART data of all external ports.
+    /// @param ports external ports.
+    /// @param eventCallback broadcasts the `uart_rx` event message to subscribed WebSocket clients.
+    /// @return ESP_OK if started.
+    esp_err_t init(const port_map_t &ports, UartBridgeEventCallback eventCallback);
+
+ private:
+    UartBridge() = default;
+    UartBridge(const UartBridge &) = delete;  // no copying
+    UartBridge &operator=(const UartBridge &) = delete;
+
+    struct PortServer {
+        UartBridge                   *bridge;
+        std::shared_ptr<ExternalPort> port;
+        uint16_t                      tcpPort;
+        // protects the client sockets: written by the server task, read by the UART task of the port
+        SemaphoreHandle_t lock;
+        // client sockets, -1 if not connected
+        int clients[CONFIG_UCD_UART_BRIDGE_MAX_CLIENTS];
+    };
+
+    static void server_task(void *param);
+    void        onUartRx(PortServer *server, const uint8_t *data, size_t len);
+
+    PortServer              servers_[EXTERNAL_PORT_COUNT] = {};
+    UartBridgeEventCallback event_callback_;
+};
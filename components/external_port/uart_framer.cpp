@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "uart_framer.h"
+
+#include <string.h>
+
+UartFramer::UartFramer(int16_t delimiter, size_t maxLength, FrameCallback onFrame)
+    : delimiter_(delimiter),
+      maxLength_(maxLength ? maxLength : 1),
+      length_(0),
+      buffer_(new uint8_t[maxLength_]),
+      onFrame_(std::move(onFrame)) {}
+
+void UartFramer::feed(const uint8_t *data, size_t len) {
+    while (len > 0) {
+        size_t count = maxLength_ - length_;
+        if (count > len) {
+            count = len;
+        }
+
+        bool complete = false;
+        if (delimiter_ >= 0) {
+            auto end = static_cast<const uint8_t *>(memchr(data, delimiter_, count));
+            if (end) {
+                count = end - data + 1;
+                complete = true;
+            }
+        }
+
+        memcpy(buffer_.get() + length_, data, count);
+        length_ += count;
+        data += count;
+        len -= count;
+
+        if (complete || length_ == maxLength_) {
+            flush();
+        }
+    }
+}
+
+void UartFramer::flush() {
+    if (length_ == 0) {
+        return;
+    }
+    if (onFrame_) {
+        onFrame_(buffer_.get(), length_);
+    }
+    length_ = 0;
+}
@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+
+/// @brief Splits received UART data into frames for the serial bridge.
+///
+/// A frame ends with the delimiter character, which is included in the frame. Pending data is emitted as frame when
+/// the maximum frame length is reached or with `flush` after the RX idle timeout.
+class UartFramer {
+ public:
+    typedef std::function<void(const uint8_t *data, size_t len)> FrameCallback;
+
+    /// @brief Create a new framer.
+    /// @param delimiter frame delimiter character, or a negative value to only frame with `flush`.
+    /// @param maxLength maximum frame length.
+    /// @param onFrame callback for completed frames. The data is only valid during the callback.
+    UartFramer(int16_t delimiter, size_t maxLength, FrameCallback onFrame);
+
+    /// @brief Add received data. Completed frames are emitted immediately.
+    void feed(const uint8_t *data, size_t len);
+
+    /// @brief Emit pending data as frame, e.g. after the RX idle timeout.
+    void flush();
+
+    /// @brief Discard pending data, e.g. after an RX buffer overflow.
+    void reset() { length_ = 0; }
+
+    /// @brief Number of received bytes not yet emitted.
+    size_t pending() const { return length_; }
+
+ private:
+    int16_t                    delimiter_;
+    size_t                     maxLength_;
+    size_t                     length_;
+    std::unique_ptr<uint8_t[]> buffer_;
+    FrameCallback              onFrame_;
+};
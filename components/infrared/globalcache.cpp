@@ -4,6 +4,8 @@
 
 #include "globalcache.h"
 
+#include <ctype.h>
+
 uint8_t parseGcRequest(const char *request, GCMsg *msg) {
     if (request == nullptr || msg == nullptr) {
         return false;
@@ -73,3 +75,256 @@ uint8_t parseGcRequest(const char *request, GCMsg *msg) {
 
     return 0;
 }
+
+/// @brief Parse an unsigned decimal number at the current position. Surrounding spaces are skipped.
+/// @param pos parse position, advanced to the character after the number.
+/// @param max maximum allowed value.
+/// @param value parsed number.
+/// @return false if there's no number or the number is larger than max.
+static bool parseNumber(const char **pos, uint32_t max, uint32_t *value) {
+    const char *p = *pos;
+    while (*p == ' ') {
+        p++;
+    }
+    if (*p < '0' || *p > '9') {
+        return false;
+    }
+    uint32_t number = 0;
+    while (*p >= '0' && *p <= '9') {
+        uint32_t digit = *p - '0';
+        if (number > (max - digit) / 10) {
+            return false;
+        }
+        number = number * 10 + digit;
+        p++;
+    }
+    while (*p == ' ') {
+        p++;
+    }
+    *pos = p;
+    *value = number;
+    return true;
+}
+
+/// @brief Parse a number which must be followed by a comma.
+static bool parseField(const char **pos, uint32_t max, uint32_t *value) {
+    if (!parseNumber(pos, max, value) || **pos != ',') {
+        return false;
+    }
+    (*pos)++;
+    return true;
+}
+
+uint8_t parseGcSendIr(const char *request, GCSendIr *sendir, uint16_t *codeBuffer, uint16_t bufferSize) {
+    if (request == nullptr || sendir == nullptr || codeBuffer == nullptr || bufferSize < 3) {
+        return 23;  // invalid parameter
+    }
+
+    const char *pos = request;
+    uint32_t    value;
+
+    sendir->module = 0;
+    sendir->port = 0;
+    sendir->id = 0;
+    if (strncmp(pos, "sendir,", 7) == 0) {
+        pos += 7;
+        if (!parseNumber(&pos, UINT8_MAX, &value) || value != 1 || *pos++ != ':') {
+            return 2;  // invalid module address
+        }
+        sendir->module = value;
+        if (!parseField(&pos, 15, &value) || value < 1) {
+            return 3;  // invalid port address
+        }
+        sendir->port = value;
+        if (!parseField(&pos, UINT32_MAX, &value)) {
+            return 4;  // invalid ID
+        }
+        sendir->id = value;
+    }
+
+    if (!parseField(&pos, UINT16_MAX, &value) || value < 15000) {
+        return 5;  // invalid frequency
+    }
+    sendir->frequency = value;
+    if (!parseField(&pos, 50, &value) || value < 1) {
+        return 6;  // invalid repeat
+    }
+    sendir->repeat = value;
+    if (!parseField(&pos, UINT16_MAX, &value)) {
+        return 7;  // invalid offset
+    }
+    sendir->offset = value;
+
+    codeBuffer[0] = sendir->frequency;
+    codeBuffer[1] = sendir->repeat;
+    codeBuffer[2] = sendir->offset;
+    uint16_t count = 3;
+    while (true) {
+        if (count == bufferSize) {
+            return 20;  // above designated IR <on>|<off> pair limit
+        }
+        if (!parseNumber(&pos, UINT16_MAX, &value) || value == 0) {
+            return 9;  // invalid pulse data
+        }
+        codeBuffer[count++] = value;
+        if (*pos == 0) {
+            break;
+        }
+        if (*pos++ != ',') {
+            return 9;  // invalid pulse data
+        }
+    }
+
+    uint16_t timings = count - 3;
+    if (timings < 2) {
+        return 8;  // invalid pulse count
+    }
+    if (timings % 2) {
+        return 10;  // uneven amount of <on>|<off> statements
+    }
+    if (sendir->offset < 1 || sendir->offset > timings || sendir->offset % 2 == 0) {
+        return 7;  // invalid offset
+    }
+
+    sendir->count = count;
+    sendir->code = codeBuffer;
+    return 0;
+}
+
+bool gcSendIrEqual(const GCSendIr *a, const GCSendIr *b) {
+    if (a == nullptr || b == nullptr) {
+        return false;
+    }
+    return a->module == b->module && a->port == b->port && a->id == b->id && a->count == b->count &&
+           memcmp(a->code, b->code, a->count * sizeof(uint16_t)) == 0;
+}
+
+/// @brief Append an unsigned decimal number and a separator to a string buffer.
+/// @return position after the appended number, nullptr if the buffer is too small.
+static char *appendNumber(char *pos, const char *end, uint32_t value, char separator) {
+    char  digits[10];
+    char *d = digits;
+    do {
+        *d++ = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    if (end - pos < d - digits + 1) {
+        return nullptr;
+    }
+    while (d > digits) {
+        *pos++ = *--d;
+    }
+    *pos++ = separator;
+    return pos;
+}
+
+int formatGcSendIr(const uint16_t *durations, uint16_t count, uint16_t frequency, char *buf, size_t size) {
+    if (durations == nullptr || count < 2 || frequency < 15000 || buf == nullptr || size == 0) {
+        return -1;
+    }
+
+    // carrier cycles per µs as 16.16 fixed point number: one multiplication per duration
+    const uint32_t cyclesPerUs = ((static_cast<uint64_t>(frequency) << 16) + 500000) / 1000000;
+    auto           toCycles = [cyclesPerUs](uint32_t us) -> uint32_t {
+        uint32_t cycles = (us * cyclesPerUs + 0x8000) >> 16;
+        return std::max<uint32_t>(1, std::min<uint32_t>(cycles, UINT16_MAX));
+    };
+
+    // every number is appended with a separator, the NUL terminator replaces the last one
+    const char *end = buf + size;
+    const char *prefix = "sendir,1:1,1,";
+    size_t      prefixLength = strlen(prefix);
+    if (size < prefixLength) {
+        return -1;
+    }
+    memcpy(buf, prefix, prefixLength);
+    char *pos = buf + prefixLength;
+
+    pos = appendNumber(pos, end, frequency, ',');
+    // repeat and offset
+    pos = pos ? appendNumber(pos, end, 1, ',') : nullptr;
+    pos = pos ? appendNumber(pos, end, 1, ',') : nullptr;
+    for (uint16_t i = 0; i < count && pos; i++) {
+        pos = appendNumber(pos, end, toCycles(durations[i]), ',');
+    }
+    if (pos && count % 2) {
+        pos = appendNumber(pos, end, toCycles(GC_LEARN_TRAILING_GAP), ',');
+    }
+    if (pos == nullptr) {
+        return -1;
+    }
+
+    *--pos = 0;
+    return pos - buf;
+}
+
+bool isGcBeaconProbe(const char *data, size_t length) {
+    static const char prefix[] = "AMXB";
+    static const char uuid[] = "<-UUID=";
+
+    if (data == nullptr || length < sizeof(prefix) - 1 || memcmp(data, prefix, sizeof(prefix) - 1) != 0) {
+        return false;
+    }
+    return std::search(data, data + length, uuid, uuid + sizeof(uuid) - 1) == data + length;
+}
+
+/// @brief Skip all non graphical representation characters, e.g. a line feed after a carriage return.
+/// https://en.cppreference.com/w/c/string/byte/isgraph
+static const char *skipNonGraphical(const char *str) {
+    while (*str && !isgraph(static_cast<unsigned char>(*str))) {
+        str++;
+    }
+    return str;
+}
+
+char *GcRequestFramer::rxBuffer(size_t *available) {
+    *available = kCapacity - m_length;
+    return m_buffer + m_length;
+}
+
+void GcRequestFramer::received(size_t length) {
+    m_length += std::min(length, kCapacity - m_length);
+    // Null-terminate whatever is received and treat it like a string
+    m_buffer[m_length] = 0;
+}
+
+GcRequestFramer::Result GcRequestFramer::next(const char **message) {
+    while (true) {
+        char *start = m_buffer + m_pos;
+        char *end = static_cast<char *>(memchr(start, '\r', m_length - m_pos));
+        if (end == nullptr) {
+            break;
+        }
+        *end = 0;
+        m_pos = end - m_buffer + 1;
+        if (m_discard) {
+            m_discard = false;
+            continue;
+        }
+        const char *msg = skipNonGraphical(start);
+        if (*msg == 0) {
+            // ignore, no error (as iTach device)
+            continue;
+        }
+        *message = msg;
+        return Result::MESSAGE;
+    }
+
+    // keep an incomplete message for the next segment
+    m_length -= m_pos;
+    memmove(m_buffer, m_buffer + m_pos, m_length + 1);
+    m_pos = 0;
+
+    if (m_length < kCapacity) {
+        return Result::NEED_MORE;
+    }
+
+    // error: code too long / no carriage return
+    m_length = 0;
+    if (m_discard) {
+        return Result::NEED_MORE;
+    }
+    m_discard = true;
+    *message = skipNonGraphical(m_buffer);
+    return Result::OVERSIZED;
+}
@@ -14,6 +14,9 @@
 
 #include "util_types.h"
 
+/// Gap in µs appended to learned IR timings ending with a mark.
+#define GC_LEARN_TRAILING_GAP 40000
+
 /// @brief Parse a GlobalCache request message
 /// @param request request message string **without** terminating line feed.
 /// @param msg the GCMsg struct to store the parsed request.
@@ -28,4 +31,79 @@
 /// - stopir,<module>:<port>
 /// - get_IRL
 /// - stop_IRL
-uint8_t parseGcRequest(const char *request, GCMsg *msg);
\ No newline at end of file
+uint8_t parseGcRequest(const char *request, GCMsg *msg);
+
+/// @brief Parse a GlobalCache sendir request in a single pass.
+/// @param request `sendir,<module>:<port>,<ID>,<freq>,<repeat>,<offset>,<on1>,<off1>,...,<onN>,<offN>` request
+///                message **without** terminating carriage return, or only the IR code starting with `<freq>`.
+/// @param sendir the GCSendIr struct to store the parsed request. `code` points to `codeBuffer`.
+/// @param codeBuffer buffer for the code array.
+/// @param bufferSize number of values fitting into `codeBuffer`.
+/// @return 0 if successful, iTach error code otherwise.
+/// @details Values are validated according to the iTach API: module 1, port 1..15, frequency 15000..65535 Hz,
+/// repeat 1..50, odd offset within the timing data and an even number of timing values in range 1..65535.
+uint8_t parseGcSendIr(const char *request, GCSendIr *sendir, uint16_t *codeBuffer, uint16_t bufferSize);
+
+/// @brief Check if two parsed sendir requests are the same, including module, port and ID.
+bool gcSendIrEqual(const GCSendIr *a, const GCSendIr *b);
+
+/// @brief Format learned IR timings as sendir request, like the IR learner of an iTach device.
+/// @param durations alternating mark and space durations in µs, starting with a mark. A trailing gap of
+///                  GC_LEARN_TRAILING_GAP is added if the timings end with a mark.
+/// @param count number of durations, at least 2.
+/// @param frequency carrier frequency in Hz, 15000..65535. Durations are converted to carrier cycles.
+/// @param buf output buffer for the NUL terminated `sendir,1:1,1,<freq>,1,1,<on1>,<off1>,...` request without
+///            terminating carriage return.
+/// @param size size of the output buffer.
+/// @return length of the request, -1 if the timings are invalid or the buffer is too small.
+int formatGcSendIr(const uint16_t *durations, uint16_t count, uint16_t frequency, char *buf, size_t size);
+
+/// @brief Check if a datagram received on the AMXB beacon port is a discovery probe.
+/// @param data received datagram, not necessarily NUL terminated.
+/// @param length length of the datagram.
+/// @return true if the datagram starts with `AMXB` and has no `<-UUID=` field. Beacons of other devices always contain
+///         their UUID.
+bool isGcBeaconProbe(const char *data, size_t length);
+
+/// Maximum length of an iTach request message without terminating carriage return.
+#define GC_REQUEST_MAX_LENGTH 1023
+
+/// @brief Split the received byte stream of an iTach client connection into request messages.
+///
+/// Request messages are terminated with a carriage return. A message may be split over multiple TCP segments, and
+/// multiple pipelined messages may be received in one segment. Non-graphical characters before a message, e.g. the line
+/// feed of a CRLF terminator, are skipped and empty messages are ignored, like on an iTach device.
+class GcRequestFramer {
+ public:
+    enum class Result {
+        /// a complete request message is available
+        MESSAGE,
+        /// the request message exceeds GC_REQUEST_MAX_LENGTH. Only reported once, the rest of the message is discarded.
+        OVERSIZED,
+        /// more data must be received
+        NEED_MORE,
+    };
+
+    /// @brief Get the buffer to receive the next data into.
+    /// @param available output parameter for the available buffer size, always > 0.
+    char *rxBuffer(size_t *available);
+
+    /// @brief Add the data received into the buffer of `rxBuffer`.
+    void received(size_t length);
+
+    /// @brief Get the next request message. Call until `NEED_MORE` is returned before receiving more data.
+    /// @param message output parameter for the NUL terminated message without carriage return, or the beginning of an
+    ///                oversized message. Valid until `received` is called.
+    Result next(const char **message);
+
+ private:
+    // maximum message with carriage return
+    static constexpr size_t kCapacity = GC_REQUEST_MAX_LENGTH + 1;
+
+    char   m_buffer[kCapacity + 1] = {};
+    size_t m_length = 0;
+    // start of the unprocessed data
+    size_t m_pos = 0;
+    // skip the remaining part of an oversized message up to its terminator
+    bool m_discard = false;
+};
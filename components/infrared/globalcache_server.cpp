@@ -10,23 +10,23 @@
 #include <freertos/semphr.h>
 #include <freertos/task.h>
 #include <lwip/err.h>
-#include <lwip/ip4_addr.h>
 #include <lwip/netdb.h>
 #include <lwip/sockets.h>
 #include <lwip/sys.h>
 
+#include <algorithm>
 #include <cstdio>
 
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "globalcache.h"
+#include "metrics.h"
+#include "socket_util.h"
 #include "string_util.h"
 #include "uc_events.h"
 
-// TODO(#28) use IDF LWIP_IPV6 & LWIP_IPV4 and test IPv6
-#define USE_IPV4
-
 #define MAX_TCP_CLIENT_COUNT 8
 
 #define TCP_API_PORT 4998
@@ -34,13 +34,23 @@
 #define KEEPALIVE_INTERVAL 5
 #define KEEPALIVE_COUNT 3
 
-#define BEACON_INTERVAL_SEC 30
 #define BEACON_BROADCAST_PORT 9131
 #define BEACON_BROADCAST_IP_ADDR "239.255.250.250"
+// all nodes on the link: clients don't have to join a multicast group
+#define BEACON_BROADCAST_IP6_ADDR "ff02::1"
+// minimal time between two answers to discovery probes
+#define BEACON_PROBE_HOLDOFF_MS 1000
+// maximum delay to refresh the beacon after an IP event
+#define BEACON_REFRESH_CHECK_MS 1000
 
 static const char *TAG_GC = "GC";
 static const char *TAG_BEACON = "GCB";
 
+static Counter gcConnections("ucd_gc_connections_total", "Number of accepted iTach TCP connections");
+static Gauge   gcActiveConnections("ucd_gc_connections_active", "Number of active iTach TCP connections");
+static Counter gcBeacons("ucd_gc_beacons_total", "Number of sent iTach discovery beacons");
+static Counter gcBeaconProbes("ucd_gc_beacon_probes_total", "Number of answered iTach discovery probes");
+
 /// Parameters for client socket task `socket_task`
 struct GCClient {
     /// Client socket identifier
@@ -97,15 +107,12 @@ GlobalCacheServer::GlobalCacheServer(InfraredService *irService, Config *config,
 /// @details Socket TCP server code inspired from:
 ///  https://github.com/espressif/esp-idf/blob/master/examples/protocols/sockets/tcp_server/main/tcp_server.c
 void GlobalCacheServer::tcp_server_task(void *param) {
-    char                    addr_str[128];
-    int                     addr_family = AF_INET;
-    int                     ip_protocol = 0;
-    int                     keepAlive = 1;
-    int                     keepIdle = KEEPALIVE_IDLE;
-    int                     keepInterval = KEEPALIVE_INTERVAL;
-    int                     keepCount = KEEPALIVE_COUNT;
-    struct sockaddr_storage dest_addr;
-    SemaphoreHandle_t       clientCountSemaphore;
+    char              addr_str[SOCKET_ADDR_STR_LEN];
+    int               keepAlive = 1;
+    int               keepIdle = KEEPALIVE_IDLE;
+    int               keepInterval = KEEPALIVE_INTERVAL;
+    int               keepCount = KEEPALIVE_COUNT;
+    SemaphoreHandle_t clientCountSemaphore;
 
     GlobalCacheServer *gc = reinterpret_cast<GlobalCacheServer *>(param);
 
@@ -116,50 +123,11 @@ void GlobalCacheServer::tcp_server_task(void *param) {
         return;
     }
 
-#ifdef USE_IPV6
-    addr_family = AF_INET6;
-    struct sockaddr_in6 *dest_addr_ip6 = (struct sockaddr_in6 *)&dest_addr;
-    bzero(&dest_addr_ip6->sin6_addr.un, sizeof(dest_addr_ip6->sin6_addr.un));
-    dest_addr_ip6->sin6_family = AF_INET6;
-    dest_addr_ip6->sin6_port = htons(TCP_API_PORT);
-    ip_protocol = IPPROTO_IPV6;
-#endif
-#ifdef USE_IPV4
-    if (addr_family == AF_INET) {
-        struct sockaddr_in *dest_addr_ip4 = (struct sockaddr_in *)&dest_addr;
-        dest_addr_ip4->sin_addr.s_addr = htonl(INADDR_ANY);
-        dest_addr_ip4->sin_family = AF_INET;
-        dest_addr_ip4->sin_port = htons(TCP_API_PORT);
-        ip_protocol = IPPROTO_IP;
-    }
-#endif
-
-    int listen_sock = socket(addr_family, SOCK_STREAM, ip_protocol);
+    int listen_sock = socket_tcp_listen(TCP_API_PORT, 1, TAG_GC);
     if (listen_sock < 0) {
-        ESP_LOGE(TAG_GC, "Unable to create socket: errno %d", errno);
         vTaskDelete(NULL);
         return;
     }
-    int opt = 1;
-    setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-#if defined(USE_IPV4) && defined(USE_IPV6)
-    // Note that by default IPV6 binds to both protocols, it must be disabled
-    // if both protocols used at the same time (used in CI)
-    setsockopt(listen_sock, IPPROTO_IPV6, IPV6_V6ONLY, &opt, sizeof(opt));
-#endif
-
-    int err = bind(listen_sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr));
-    if (err != 0) {
-        ESP_LOGE(TAG_GC, "Socket unable to bind: errno %d", errno);
-        goto CLEAN_UP;
-    }
-    ESP_LOGI(TAG_GC, "Socket bound, port %d", TCP_API_PORT);
-
-    err = listen(listen_sock, 1);
-    if (err != 0) {
-        ESP_LOGE(TAG_GC, "Error occurred during listen: errno %d", errno);
-        goto CLEAN_UP;
-    }
 
     while (true) {
         // limit number of clients, wait until a client slot is available
@@ -177,6 +145,7 @@ void GlobalCacheServer::tcp_server_task(void *param) {
         int                     sock = accept(listen_sock, (struct sockaddr *)&source_addr, &addr_len);
         if (sock < 0) {
             ESP_LOGE(TAG_GC, "Unable to accept connection: errno %d", errno);
+            xSemaphoreGive(clientCountSemaphore);
             continue;
         }
 
@@ -185,18 +154,10 @@ void GlobalCacheServer::tcp_server_task(void *param) {
         setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &keepIdle, sizeof(int));
         setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &keepInterval, sizeof(int));
         setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &keepCount, sizeof(int));
-        // Convert ip address to string
-#ifdef USE_IPV4
-        if (source_addr.ss_family == PF_INET) {
-            inet_ntoa_r(((struct sockaddr_in *)&source_addr)->sin_addr, addr_str, sizeof(addr_str) - 1);
-        }
-#endif
-#ifdef USE_IPV6
-        if (source_addr.ss_family == PF_INET6) {
-            inet6_ntoa_r(((struct sockaddr_in6 *)&source_addr)->sin6_addr, addr_str, sizeof(addr_str) - 1);
-        }
-#endif
-        ESP_LOGI(TAG_GC, "Socket accepted client: %s", addr_str);
+        ESP_LOGI(TAG_GC, "[%d] Socket accepted client: %s", sock,
+                 socket_addr_str(&source_addr, addr_str, sizeof(addr_str)));
+        gcConnections.inc();
+        gcActiveConnections.inc();
 
         // hand over to new client Task
         GCClient *client = new GCClient();
@@ -212,149 +173,125 @@ void GlobalCacheServer::tcp_server_task(void *param) {
                                 NULL,         // Task handle to keep track of created task
                                 1);           // core
     }
+}
 
-CLEAN_UP:
-    close(listen_sock);
-    vTaskDelete(NULL);
+/// @brief Process a single request message.
+/// @param client client connection.
+/// @param request request message without the terminating carriage return.
+/// @return false if sending the reply failed and the connection must be closed.
+static bool process_request(GCClient *client, const char *request) {
+    GCMsg req;
+    auto  result = parseGcRequest(request, &req);
+    if (result) {
+        char buf[16];
+        // global cache iTach error code
+        snprintf(buf, sizeof(buf), "ERR_1:1,%03d\r", result);
+        return send_string_to_socket(client->socket, buf);
+    }
+
+    if (strcmp(req.command, "sendir") == 0) {
+        int16_t  clientId = IR_CLIENT_GC;
+        uint32_t msgId = atoi(req.param);  // this _should_ point to ID
+        auto     result = client->irService->sendGlobalCache(clientId, msgId, request, client->socket);
+        ESP_LOGD(TAG_GC, "[%d] sendGlobalCache result: %d", client->socket, result);
+
+        char        buf[17];
+        const char *msg = nullptr;
+        if (result == 0 || result == 200) {
+            // OK, async callback over the passed socket (code 200 shouldn't be used anymore)
+        } else if (result == 202) {
+            // accepted IR repeat. Original iTach device doesn't send a reply, so we do the same!
+        } else if (result > 0 && result < 100) {
+            // global cache iTach error code
+            snprintf(buf, sizeof(buf), "ERR_%d:%d,%03d\r", req.module, req.port, result);
+            msg = buf;
+        } else if (result == 500) {
+            // invalid parameter
+            snprintf(buf, sizeof(buf), "ERR_%d:%d,023\r", req.module, req.port);
+            msg = buf;
+        } else if (result == 429 || result == 503) {
+            msg = "busyir\r";
+        } else {
+            // invalid command (unknown)
+            snprintf(buf, sizeof(buf), "ERR_%d:%d,001\r", req.module, req.port);
+            msg = buf;
+        }
+
+        return msg == nullptr || send_string_to_socket(client->socket, msg);
+    } else if (strcmp(req.command, "stopir") == 0) {
+        client->irService->stopSend();
+        // reply is the request message
+        return send_string_to_socket(client->socket, request) && send_string_to_socket(client->socket, "\r");
+    } else if (strcmp(req.command, "getdevices") == 0) {
+        if (!send_string_to_socket(client->socket, "device,0,0 ETHERNET\r")) {
+            return false;
+        }
+        int  ports = 4;
+        char msg[64];
+        snprintf(msg, sizeof(msg), "device,0,0 WIFI\rdevice,1,%d IR\rendlistdevices\r", ports);
+        return send_string_to_socket(client->socket, msg);
+    } else if (strcmp(req.command, "getversion") == 0) {
+        // GlobalCache iHelp doesn't like dots in version string, or device doesn't show up!
+        char version[30];
+        snprintf(version, sizeof(version), "%s\r", DOCK_VERSION[0] == 'v' ? DOCK_VERSION + 1 : DOCK_VERSION);
+        replacechar(version, '.', '-');
+        replacechar(version, '+', '-');
+        return send_string_to_socket(client->socket, version);
+    } else if (strcmp(req.command, "getmac") == 0) {
+        // command discovered with iHelp
+        char mac[30];
+        snprintf(mac, sizeof(mac), "MACaddress,%s\r", client->mac);
+        return send_string_to_socket(client->socket, mac);
+    } else if (strcmp(req.command, "blink") == 0) {
+        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_event_post(UC_DOCK_EVENTS, UC_ACTION_IDENTIFY, NULL, 0, pdMS_TO_TICKS(200)));
+        return true;
+    } else if (strcmp(req.command, "get_IRL") == 0) {
+        // learned IR codes are sent as sendir messages until the learner is disabled or the connection is closed
+        client->irService->startIrLearn(client->socket);
+        return send_string_to_socket(client->socket, "IR Learner Enabled\r");
+    } else if (strcmp(req.command, "stop_IRL") == 0) {
+        client->irService->stopIrLearn();
+        return send_string_to_socket(client->socket, "IR Learner Disabled\r");
+    }
+
+    // Command unrecognized
+    char buf[17];
+    snprintf(buf, sizeof(buf), "ERR_%d:%d,001\r", req.module, req.port);
+    return send_string_to_socket(client->socket, buf);
 }
 
 /// @brief Client socket task to process request messages
 ///  The protocol is described e.g. http://www.globalcache.com/files/docs/API-GC-100.pdf.
 /// @param param point to GCClient struct. The task is responsible to delete the struct when terminating.
+/// @details Request messages are split with `GcRequestFramer`: pipelined messages are processed in order and a message
+///  may be split over multiple TCP segments.
 void GlobalCacheServer::socket_task(void *param) {
     GCClient *client = reinterpret_cast<GCClient *>(param);
 
-    int  len = 0;
-    char rx_buffer[1024];
+    int len = 0;
+    // max request message size is limited to 1 KB, but that should be sufficient for large IR commands.
+    GcRequestFramer framer;
+    bool            ok = true;
 
-    while (true) {
-        // Optimistic reading, get as much data as possible, max request message size is limited to 1 KB,
-        // but that should be sufficient for large IR commands.
-        // TODO(zehnm) read until message terminator / buffer full.
-        len = recv(client->socket, rx_buffer, sizeof(rx_buffer) - 1, 0);
+    while (ok) {
+        size_t available;
+        char  *rx_buffer = framer.rxBuffer(&available);
+        len = recv(client->socket, rx_buffer, available, 0);
         if (len <= 0) {
             break;
         }
-        // Null-terminate whatever is received and treat it like a string
-        rx_buffer[len] = 0;
-        ESP_LOGD(TAG_GC, "[%d] Received %d bytes: %s", client->socket, len, rx_buffer);
-
-        // find message terminator
-        char *end = strchr(rx_buffer, '\r');
-        if (end == NULL) {
-            // error: code too long / no carriage return
-            const char *msg = (strncmp(rx_buffer, "sendir,", 7) == 0) ? "ERR 020\r" : "ERR 016\r";
-            if (!send_string_to_socket(client->socket, msg)) {
-                break;
-            }
-            continue;
-        }
-        *end = 0;
-
-        // find start of message, skip all non graphical representation characters
-        // https://en.cppreference.com/w/c/string/byte/isgraph
-        const char *start = rx_buffer;
-        while (start != end && !isgraph(*start)) {
-            start++;
-        }
-        if (start == end) {
-            // ignore, no error (as iTach device)
-            continue;
-        }
-
-        GCMsg req;
-        auto  result = parseGcRequest(rx_buffer, &req);
-        if (result) {
-            char buf[16];
-            // global cache iTach error code
-            snprintf(buf, sizeof(buf), "ERR_1:1,%03d\r", result);
-            if (!send_string_to_socket(client->socket, buf)) {
-                break;
-            }
-            continue;
-        }
-
-        if (strcmp(req.command, "sendir") == 0) {
-            int16_t  clientId = IR_CLIENT_GC;
-            uint32_t msgId = atoi(req.param);  // this _should_ point to ID
-            auto     result = client->irService->sendGlobalCache(clientId, msgId, rx_buffer, client->socket);
-            ESP_LOGD(TAG_GC, "[%d] sendGlobalCache result: %d", client->socket, result);
-
-            char        buf[17];
-            const char *msg = nullptr;
-            if (result == 0 || result == 200) {
-                // OK, async callback over the passed socket (code 200 shouldn't be used anymore)
-            } else if (result == 202) {
-                // accepted IR repeat. Original iTach device doesn't send a reply, so we do the same!
-            } else if (result > 0 && result < 100) {
-                // global cache iTach error code
-                snprintf(buf, sizeof(buf), "ERR_%d:%d,%03d\r", req.module, req.port, result);
-                msg = buf;
-            } else if (result == 500) {
-                // invalid parameter
-                snprintf(buf, sizeof(buf), "ERR_%d:%d,023\r", req.module, req.port);
-                msg = buf;
-            } else if (result == 429 || result == 503) {
-                msg = "busyir\r";
+        ESP_LOGD(TAG_GC, "[%d] Received %d bytes", client->socket, len);
+        framer.received(len);
+
+        const char             *msg;
+        GcRequestFramer::Result result;
+        while (ok && (result = framer.next(&msg)) != GcRequestFramer::Result::NEED_MORE) {
+            if (result == GcRequestFramer::Result::MESSAGE) {
+                ok = process_request(client, msg);
             } else {
-                // invalid command (unknown)
-                snprintf(buf, sizeof(buf), "ERR_%d:%d,001\r", req.module, req.port);
-                msg = buf;
-            }
-
-            if (msg && !send_string_to_socket(client->socket, msg)) {
-                break;
-            }
-        } else if (strcmp(req.command, "stopir") == 0) {
-            client->irService->stopSend();
-            if (!send_string_to_socket(client->socket, rx_buffer)) {
-                break;
-            }
-        } else if (strcmp(req.command, "getdevices") == 0) {
-            if (!send_string_to_socket(client->socket, "device,0,0 ETHERNET\r")) {
-                break;
-            }
-            int  ports = 4;
-            char msg[64];
-            snprintf(msg, sizeof(msg), "device,0,0 WIFI\rdevice,1,%d IR\rendlistdevices\r", ports);
-            if (!send_string_to_socket(client->socket, msg)) {
-                break;
-            }
-        } else if (strcmp(req.command, "getversion") == 0) {
-            // GlobalCache iHelp doesn't like dots in version string, or device doesn't show up!
-            char version[30];
-            snprintf(version, sizeof(version), "%s\r", DOCK_VERSION[0] == 'v' ? DOCK_VERSION + 1 : DOCK_VERSION);
-            replacechar(version, '.', '-');
-            replacechar(version, '+', '-');
-            if (!send_string_to_socket(client->socket, version)) {
-                break;
-            }
-        } else if (strcmp(req.command, "getmac") == 0) {
-            // command discovered with iHelp
-            char mac[30];
-            snprintf(mac, sizeof(mac), "MACaddress,%s\r", client->mac);
-            if (!send_string_to_socket(client->socket, mac)) {
-                break;
-            }
-        } else if (strcmp(req.command, "blink") == 0) {
-            ESP_ERROR_CHECK_WITHOUT_ABORT(
-                esp_event_post(UC_DOCK_EVENTS, UC_ACTION_IDENTIFY, NULL, 0, pdMS_TO_TICKS(200)));
-        } else if (strcmp(req.command, "get_IRL") == 0) {
-            client->irService->startIrLearn();
-            if (!send_string_to_socket(client->socket, "IR Learner Enabled")) {
-                break;
-            }
-        } else if (strcmp(req.command, "stop_IRL") == 0) {
-            client->irService->stopIrLearn();
-            if (!send_string_to_socket(client->socket, "IR Learner Disabled")) {
-                break;
-            }
-        } else {
-            // Command unrecognized
-            char buf[17];
-            snprintf(buf, sizeof(buf), "ERR_%d:%d,001\r", req.module, req.port);
-            if (!send_string_to_socket(client->socket, buf)) {
-                break;
+                // error: code too long / no carriage return
+                ok = send_string_to_socket(client->socket,
+                                           strncmp(msg, "sendir,", 7) == 0 ? "ERR 020\r" : "ERR 016\r");
             }
         }
     }
@@ -365,52 +302,135 @@ void GlobalCacheServer::socket_task(void *param) {
         ESP_LOGI(TAG_GC, "[%d] Connection closed", client->socket);
     }
 
+    client->irService->stopGcIrLearn(client->socket);
     shutdown(client->socket, 0);
     close(client->socket);
     // release client slot
     xSemaphoreGive(client->semaphore);
+    gcActiveConnections.dec();
 
     delete client;
     vTaskDelete(NULL);
 }
 
-/// @brief AMXB beacon advertisement with UDP broadcast.
-/// @param param pointer to GlobalCacheServer instance
-void GlobalCacheServer::beacon_task(void *param) {
-    GlobalCacheServer *gc = reinterpret_cast<GlobalCacheServer *>(param);
+/// @brief Build the AMXB beacon payload with the current IP address of the default network interface.
+/// @param buf output buffer.
+/// @param size size of the output buffer.
+/// @param fields pre-formatted UUID, model, revision and serial number.
+/// @param ipv6 use the global IPv6 address if the interface doesn't have an IPv4 address.
+/// @return payload length, 0 if the interface doesn't have an IP address (yet).
+static int build_beacon(char *buf, size_t size, const char *uuid, const char *model, const char *version,
+                        const char *serial, bool ipv6) {
+    esp_netif_t        *netif = esp_netif_get_default_netif();
+    esp_netif_ip_info_t ipInfo;
+    esp_err_t           err = esp_netif_get_ip_info(netif, &ipInfo);
+
+    // configuration URL: prefer IPv4, use the global IPv6 address in IPv6-only networks
+    char ip_buf[SOCKET_ADDR_STR_LEN];
+    if (err == ESP_OK && ipInfo.ip.addr != 0) {
+        snprintf(ip_buf, sizeof(ip_buf), IPSTR, IP2STR(&ipInfo.ip));
+    } else {
+#if CONFIG_LWIP_IPV6
+        esp_ip6_addr_t ip6;
+        err = ipv6 ? esp_netif_get_ip6_global(netif, &ip6) : ESP_FAIL;
+        if (err == ESP_OK) {
+            ip_buf[0] = '[';
+            inet_ntop(AF_INET6, ip6.addr, ip_buf + 1, sizeof(ip_buf) - 2);
+            strcat(ip_buf, "]");
+        }
+#endif
+        if (err != ESP_OK) {
+            return 0;
+        }
+    }
 
-    int                socket_fd;
-    struct sockaddr_in sa, ra;
-    char               buffer[220];
+    int len = snprintf(buf, size,
+                       "AMXB<-UUID=%s><-SDKClass=Utility><-Make=Unfolded "
+                       "Circle><-Model=%s><-Revision=%s><-Config-URL=http://%s><-PCB_PN=%s><-Status=Ready>",
+                       uuid, model, version, ip_buf, serial);
+    return len < static_cast<int>(size) ? len : 0;
+}
 
-    // Simple UDP broadcast functionality with BSD socket
-    // If we need IPv6: https://github.com/espressif/esp-idf/tree/master/examples/protocols/sockets/udp_multicast
-    socket_fd = socket(PF_INET, SOCK_DGRAM, 0);
-    if (socket_fd < 0) {
-        ESP_LOGE(TAG_BEACON, "socket call failed: %d", socket_fd);
-        vTaskDelete(NULL);
+/// @brief Answer a discovery probe with the beacon payload, sent directly to the prober.
+static void answer_probe(int sock, const char *payload, int len, int64_t *lastAnswer) {
+    char                    probe[64];
+    struct sockaddr_storage source_addr;
+    socklen_t               addr_len = sizeof(source_addr);
+
+    int received = recvfrom(sock, probe, sizeof(probe), 0, reinterpret_cast<struct sockaddr *>(&source_addr),
+                            &addr_len);
+    if (received <= 0 || len == 0 || !isGcBeaconProbe(probe, received)) {
         return;
     }
 
-    memset(&sa, 0, sizeof(struct sockaddr_in));
-    sa.sin_family = AF_INET;
-    sa.sin_addr.s_addr = IPADDR_ANY;
-    sa.sin_port = htons(BEACON_BROADCAST_PORT);
+    // rate limit: a broadcasted probe reaches the dock over both IPv4 and IPv6
+    int64_t now = esp_timer_get_time();
+    if (now - *lastAnswer < BEACON_PROBE_HOLDOFF_MS * 1000) {
+        return;
+    }
+    *lastAnswer = now;
+
+    char addr_str[SOCKET_ADDR_STR_LEN];
+    ESP_LOGD(TAG_BEACON, "Discovery probe from %s", socket_addr_str(&source_addr, addr_str, sizeof(addr_str)));
+    sendto(sock, payload, len, 0, reinterpret_cast<struct sockaddr *>(&source_addr), addr_len);
+    gcBeaconProbes.inc();
+}
 
-    if (bind(socket_fd, (struct sockaddr *)&sa, sizeof(struct sockaddr_in)) == -1) {
-        ESP_LOGE(TAG_BEACON, "Bind to port number %d failed: errno %d", BEACON_BROADCAST_PORT, errno);
-        close(socket_fd);
+void GlobalCacheServer::ip_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id,
+                                         void *event_data) {
+    GlobalCacheServer *gc = reinterpret_cast<GlobalCacheServer *>(arg);
+    gc->m_beaconRefresh = true;
+}
+
+/// @brief AMXB beacon advertisement with UDP multicast, over IPv4 and IPv6.
+///
+/// Beacons are sent in a burst after a network connection or IP address change: the interval starts with
+/// CONFIG_UCD_GC_BEACON_INTERVAL_MIN and doubles with every beacon up to CONFIG_UCD_GC_BEACON_INTERVAL_MAX.
+/// The payload is only rebuilt after IP events. Discovery probes received on the beacon port are answered immediately.
+/// @param param pointer to GlobalCacheServer instance
+void GlobalCacheServer::beacon_task(void *param) {
+    GlobalCacheServer *gc = reinterpret_cast<GlobalCacheServer *>(param);
+
+    int socket4 = socket_udp_multicast(AF_INET, BEACON_BROADCAST_PORT, TAG_BEACON);
+#if CONFIG_LWIP_IPV6
+    int socket6 = socket_udp_multicast(AF_INET6, BEACON_BROADCAST_PORT, TAG_BEACON);
+#else
+    int socket6 = -1;
+#endif
+    if (socket4 < 0 && socket6 < 0) {
         vTaskDelete(NULL);
         return;
     }
 
-    ESP_LOGI(TAG_BEACON, "Sending discovery beacons every %ds", BEACON_INTERVAL_SEC);
-
-    memset(&ra, 0, sizeof(struct sockaddr_in));
+    struct sockaddr_in ra = {};
     ra.sin_family = AF_INET;
     ra.sin_addr.s_addr = inet_addr(BEACON_BROADCAST_IP_ADDR);
     ra.sin_port = htons(BEACON_BROADCAST_PORT);
 
+    if (socket4 >= 0) {
+        // receive discovery probes sent to the beacon group
+        struct ip_mreq mreq = {};
+        mreq.imr_multiaddr.s_addr = ra.sin_addr.s_addr;
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(socket4, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+            ESP_LOGW(TAG_BEACON, "Failed to join multicast group: errno %d", errno);
+        }
+    }
+
+#if CONFIG_LWIP_IPV6
+    struct sockaddr_in6 ra6 = {};
+    ra6.sin6_family = AF_INET6;
+    inet_pton(AF_INET6, BEACON_BROADCAST_IP6_ADDR, &ra6.sin6_addr);
+    ra6.sin6_port = htons(BEACON_BROADCAST_PORT);
+#endif
+
+    if (esp_event_handler_register(IP_EVENT, ESP_EVENT_ANY_ID, &GlobalCacheServer::ip_event_handler, gc) != ESP_OK) {
+        ESP_LOGW(TAG_BEACON, "Failed to register IP event handler: beacon payload is not updated");
+    }
+
+    ESP_LOGI(TAG_BEACON, "Sending discovery beacons every %d..%ds (%s%s)", CONFIG_UCD_GC_BEACON_INTERVAL_MIN,
+             CONFIG_UCD_GC_BEACON_INTERVAL_MAX, socket4 >= 0 ? "IPv4" : "", socket6 >= 0 ? " IPv6" : "");
+
     // GlobalCache iHelp doesn't like dots and other characters in version string, or device doesn't show up!
     // This worked in older versions, new versions check more data.
     char version[30];
@@ -420,31 +440,67 @@ void GlobalCacheServer::beacon_task(void *param) {
     char uuid[30];
     snprintf(uuid, sizeof(uuid), "UnfoldedCircle_%s", gc->m_config->getHostName() + 9);
 
-    esp_netif_ip_info_t ipInfo;
+    char       payload[240];
+    int        len = 0;
+    uint32_t   interval = CONFIG_UCD_GC_BEACON_INTERVAL_MIN * 1000;
+    TickType_t nextBeacon = 0;
+    int64_t    lastProbeAnswer = INT64_MIN / 2;
 
     while (true) {
-        esp_netif_t *netif = esp_netif_get_default_netif();
-        // TODO(#28) ipv6?
-        esp_err_t err = esp_netif_get_ip_info(netif, &ipInfo);
-        if (err != ESP_OK) {
-            vTaskDelay(pdMS_TO_TICKS(10000));
-            continue;
+        if (gc->m_beaconRefresh.exchange(false)) {
+            len = build_beacon(payload, sizeof(payload), uuid, gc->m_config->getModel(), version,
+                               gc->m_config->getSerial(), socket6 >= 0);
+            if (len > 0) {
+                // (re)connected or new IP address: announce the dock quickly
+                ESP_LOGD(TAG_BEACON, "Beacon: %s", payload);
+                interval = CONFIG_UCD_GC_BEACON_INTERVAL_MIN * 1000;
+                nextBeacon = xTaskGetTickCount();
+            }
         }
 
-        char ip_buf[64];
-        snprintf(ip_buf, sizeof(ip_buf), IPSTR, IP2STR(&ipInfo.ip));
-
-        int len = snprintf(buffer, sizeof(buffer),
-                           "AMXB<-UUID=%s><-SDKClass=Utility><-Make=Unfolded "
-                           "Circle><-Model=%s><-Revision=%s><-Config-URL=http://%s><-PCB_PN=%s><-Status=Ready>",
-                           uuid, gc->m_config->getModel(), version, ip_buf, gc->m_config->getSerial());
-        int sent_data = sendto(socket_fd, buffer, len, 0, (struct sockaddr *)&ra, sizeof(ra));
-
-        ESP_LOGD(TAG_BEACON, "Sent %d bytes: %s", sent_data, buffer);
+        TickType_t now = xTaskGetTickCount();
+        if (len > 0 && static_cast<int32_t>(nextBeacon - now) <= 0) {
+            if (socket4 >= 0) {
+                int sent_data = sendto(socket4, payload, len, 0, (struct sockaddr *)&ra, sizeof(ra));
+                ESP_LOGD(TAG_BEACON, "Sent %d bytes over IPv4", sent_data);
+            }
+#if CONFIG_LWIP_IPV6
+            if (socket6 >= 0) {
+                // fails without an IPv6 address, e.g. before the link-local address is assigned
+                int sent_data = sendto(socket6, payload, len, 0, (struct sockaddr *)&ra6, sizeof(ra6));
+                ESP_LOGD(TAG_BEACON, "Sent %d bytes over IPv6", sent_data);
+            }
+#endif
+            gcBeacons.inc();
+            nextBeacon = now + pdMS_TO_TICKS(interval);
+            interval = std::min<uint32_t>(interval * 2, CONFIG_UCD_GC_BEACON_INTERVAL_MAX * 1000);
+        }
 
-        vTaskDelay(pdMS_TO_TICKS(BEACON_INTERVAL_SEC * 1000));
+        // wait for discovery probes until the next beacon is due. IP events are checked at least every second.
+        uint32_t waitMs = BEACON_REFRESH_CHECK_MS;
+        if (len > 0) {
+            waitMs = std::min<uint32_t>(waitMs, pdTICKS_TO_MS(nextBeacon - xTaskGetTickCount()));
+        }
+        struct timeval timeout;
+        timeout.tv_sec = waitMs / 1000;
+        timeout.tv_usec = (waitMs % 1000) * 1000;
+        fd_set readFds;
+        FD_ZERO(&readFds);
+        int maxFd = std::max(socket4, socket6);
+        if (socket4 >= 0) {
+            FD_SET(socket4, &readFds);
+        }
+        if (socket6 >= 0) {
+            FD_SET(socket6, &readFds);
+        }
+        if (select(maxFd + 1, &readFds, nullptr, nullptr, &timeout) <= 0) {
+            continue;
+        }
+        if (socket4 >= 0 && FD_ISSET(socket4, &readFds)) {
+            answer_probe(socket4, payload, len, &lastProbeAnswer);
+        }
+        if (socket6 >= 0 && FD_ISSET(socket6, &readFds)) {
+            answer_probe(socket6, payload, len, &lastProbeAnswer);
+        }
     }
-
-    close(socket_fd);
-    vTaskDelete(NULL);
 }
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "config.h"
+#include "esp_event.h"
 #include "service_ir.h"
 
 /// @brief Send string buffer to client socket.
@@ -30,7 +33,10 @@ class GlobalCacheServer {
     static void tcp_server_task(void *pvParameters);
     static void socket_task(void *pvParameters);
     static void beacon_task(void *param);
+    static void ip_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
 
     InfraredService *m_irService;
     Config          *m_config;
+    /// Set by IP events: the beacon task refreshes the payload and restarts the beacon burst.
+    std::atomic<bool> m_beaconRefresh{true};
 };
@@ -8,6 +8,8 @@
 
 #include <climits>
 
+#include "mem_tag.h"
+
 uint32_t parseUint32(const char *number, int *error, int base) {
     if (number == NULL) {
         if (error != NULL) {
@@ -62,36 +64,49 @@ uint64_t parseCommand(const char *input) {
     return command;
 }
 
-bool buildIRHexData(const std::string &message, IRHexData *data) {
-    // Format is: "<protocol>;<hex-ir-code>;<bits>;<repeat-count>" e.g. "4;0x640C;15;0"
-    int firstIndex = message.find_first_of(';');
-    if (firstIndex == std::string::npos) {
-        return false;
+/// @brief Copy a separated field into a buffer.
+/// @return pointer to the separator or string end after the field, NULL if the field doesn't fit into the buffer.
+static const char *copyField(const char *start, char separator, char *buffer, size_t size) {
+    size_t len = 0;
+    while (start[len] && start[len] != separator) {
+        if (len + 1 >= size) {
+            return NULL;
+        }
+        buffer[len] = start[len];
+        len++;
     }
-    int secondIndex = message.find_first_of(';', firstIndex + 1);
-    if (secondIndex == std::string::npos) {
+    buffer[len] = 0;
+    return start + len;
+}
+
+bool buildIRHexData(const char *message, IRHexData *data) {
+    // Format is: "<protocol>;<hex-ir-code>;<bits>;<repeat-count>" e.g. "4;0x640C;15;0"
+    // Parsed with a field buffer on the stack: this is called for every IR send request.
+    char        field[32];
+    const char *next = copyField(message, ';', field, sizeof(field));
+    if (next == NULL || *next != ';') {
         return false;
     }
-    const int thirdIndex = message.find_first_of(';', secondIndex + 1);
-    if (thirdIndex == std::string::npos) {
+    data->protocol = parseProtocol(field);
+    if (data->protocol <= 0) {
         return false;
     }
 
-    data->protocol = parseProtocol(message.substr(0, firstIndex).c_str());
-    if (data->protocol <= 0) {
+    next = copyField(next + 1, ';', field, sizeof(field));
+    if (next == NULL || *next != ';') {
         return false;
     }
-
-    firstIndex++;
-    data->command = parseCommand(message.substr(firstIndex, secondIndex - firstIndex).c_str());
+    data->command = parseCommand(field);
     if (data->command == 0) {
         return false;
     }
 
-    secondIndex++;
-    int         error;
-    std::string number = message.substr(secondIndex, thirdIndex - secondIndex);
-    uint32_t    value = parseUint32(number.c_str(), &error, 10);
+    next = copyField(next + 1, ';', field, sizeof(field));
+    if (next == NULL || *next != ';') {
+        return false;
+    }
+    int      error;
+    uint32_t value = parseUint32(field, &error, 10);
     if (error || value > 0xFFFF) {
         return false;
     }
@@ -100,8 +115,11 @@ bool buildIRHexData(const std::string &message, IRHexData *data) {
         return false;
     }
 
-    number = message.substr(thirdIndex + 1);
-    value = parseUint32(number.c_str(), &error, 10);
+    next = copyField(next + 1, ';', field, sizeof(field));
+    if (next == NULL || *next != 0) {
+        return false;
+    }
+    value = parseUint32(field, &error, 10);
     if (error || value > 0xFFFF || value > 20) {
         return false;
     }
@@ -110,6 +128,10 @@ bool buildIRHexData(const std::string &message, IRHexData *data) {
     return true;
 }
 
+bool buildIRHexData(const std::string &message, IRHexData *data) {
+    return buildIRHexData(message.c_str(), data);
+}
+
 uint16_t countValuesInCStr(const char *str, char sep) {
     if (str == NULL || *str == 0) {
         return 0;
@@ -128,70 +150,113 @@ uint16_t countValuesInCStr(const char *str, char sep) {
     return count + 1;  // for value after last separator
 }
 
-uint16_t *prontoBufferToArray(const char *msg, char separator, uint16_t *codeCount, int *memError) {
-    if (memError) {
-        *memError = 0;
+bool prontoSequences(const uint16_t *code, uint16_t count, ProntoSequences *sequences) {
+    // Only raw pronto codes are supported
+    if (code == NULL || count < 4 || code[0] != 0) {
+        return false;
     }
 
-    uint16_t count = countValuesInCStr(msg, separator);
-    // minimal length is 6:
-    // - preamble of 4 (raw, frequency, # code pairs sequence 1, # code pairs sequence 2)
-    // - 1 code pair
-    if (count < 6) {
-        return NULL;
+    sequences->introStart = 4;
+    sequences->introLength = code[2] * 2;
+    sequences->repeatStart = sequences->introStart + sequences->introLength;
+    sequences->repeatLength = code[3] * 2;
+
+    if (sequences->introLength > 0 && sequences->introStart + sequences->introLength > count) {
+        return false;
+    }
+    if (sequences->repeatLength > 0 && sequences->repeatStart + sequences->repeatLength > count) {
+        return false;
     }
+    return true;
+}
 
-    uint16_t *codeArray = reinterpret_cast<uint16_t *>(malloc(count * sizeof(uint16_t)));
-    if (codeArray == NULL) {  // malloc failed, so give up.
-        if (memError) {
-            *memError = 1;
-        }
-        return NULL;
+bool parseProntoCode(const char *msg, char separator, uint16_t *buffer, uint16_t capacity, ProntoCode *pronto) {
+    if (msg == NULL || buffer == NULL || pronto == NULL) {
+        return false;
+    }
+    if (separator == 0) {
+        // use space as default separator, fallback to old comma (dock version <= 0.6.0)
+        separator = strchr(msg, ' ') == NULL ? ',' : ' ';
     }
 
     int16_t  index = 0;
     uint16_t startFrom = 0;
-    count = 0;
+    uint16_t count = 0;
     while (msg[index] != 0) {
         if (msg[index] == separator) {
-            codeArray[count] = strtoul(msg + startFrom, NULL, 16);
+            if (count >= capacity) {
+                return false;
+            }
+            buffer[count] = strtoul(msg + startFrom, NULL, 16);
             startFrom = index + 1;
             count++;
         }
         index++;
     }
     if (index > startFrom) {
-        codeArray[count] = strtoul(msg + startFrom, NULL, 16);
+        if (count >= capacity) {
+            return false;
+        }
+        buffer[count] = strtoul(msg + startFrom, NULL, 16);
         count++;
     }
 
-    // Validate PRONTO code
-    // Only raw pronto codes are supported
-    if (codeArray[0] != 0) {
-        free(codeArray);
-        return NULL;
+    // minimal length is 6:
+    // - preamble of 4 (raw, frequency, # code pairs sequence 1, # code pairs sequence 2)
+    // - 1 code pair
+    if (count < 6 || !prontoSequences(buffer, count, &pronto->sequences)) {
+        return false;
+    }
+
+    pronto->code = buffer;
+    pronto->count = count;
+    pronto->frequency = prontoFrequency(buffer, count);
+    return true;
+}
+
+bool prontoCodeEqual(const ProntoCode *a, const ProntoCode *b) {
+    if (a == nullptr || b == nullptr) {
+        return false;
     }
+    return a->count == b->count && memcmp(a->code, b->code, a->count * sizeof(uint16_t)) == 0;
+}
 
-    uint16_t seq1Len = codeArray[2] * 2;
-    uint16_t seq2Len = codeArray[3] * 2;
-    uint16_t seq1Start = 4;
-    uint16_t seq2Start = seq1Start + seq1Len;
+uint16_t *prontoBufferToArray(const char *msg, char separator, uint16_t *codeCount, int *memError,
+                              uint32_t *frequency, ProntoSequences *sequences) {
+    if (memError) {
+        *memError = 0;
+    }
+
+    uint16_t count = countValuesInCStr(msg, separator);
+    if (count < 6) {
+        return NULL;
+    }
 
-    if (seq1Len > 0 && seq1Len + seq1Start > count) {
-        free(codeArray);
+    uint16_t *codeArray = reinterpret_cast<uint16_t *>(mem_tag_malloc(MEM_TAG_IR, count * sizeof(uint16_t)));
+    if (codeArray == NULL) {  // malloc failed, so give up.
+        if (memError) {
+            *memError = 1;
+        }
         return NULL;
     }
 
-    if (seq2Len > 0 && seq2Len + seq2Start > count) {
-        free(codeArray);
+    ProntoCode pronto;
+    if (!parseProntoCode(msg, separator, codeArray, count, &pronto)) {
+        mem_tag_free(MEM_TAG_IR, codeArray);
         return NULL;
     }
 
-    *codeCount = count;
+    if (frequency) {
+        *frequency = pronto.frequency;
+    }
+    if (sequences) {
+        *sequences = pronto.sequences;
+    }
+    *codeCount = pronto.count;
     return codeArray;
 }
 
-uint16_t *globalCacheBufferToArray(const char *msg, uint16_t *codeCount, int *memError) {
+uint16_t *globalCacheBufferToArray(const char *msg, uint16_t *codeCount, int *memError, uint32_t *frequency) {
     if (memError) {
         *memError = 0;
     }
@@ -210,7 +275,7 @@ uint16_t *globalCacheBufferToArray(const char *msg, uint16_t *codeCount, int *me
         return NULL;
     }
 
-    uint16_t *codeArray = reinterpret_cast<uint16_t *>(malloc(count * sizeof(uint16_t)));
+    uint16_t *codeArray = reinterpret_cast<uint16_t *>(mem_tag_malloc(MEM_TAG_IR, count * sizeof(uint16_t)));
     if (codeArray == NULL) {  // malloc failed, so give up.
         if (memError) {
             *memError = 1;
@@ -238,6 +303,195 @@ uint16_t *globalCacheBufferToArray(const char *msg, uint16_t *codeCount, int *me
         codeIndex++;
     }
 
+    if (frequency) {
+        *frequency = globalCacheFrequency(codeArray, codeIndex);
+    }
     *codeCount = codeIndex;
     return codeArray;
 }
+
+uint32_t prontoFrequency(const uint16_t *code, uint16_t count) {
+    if (code == NULL || count < 2 || code[1] == 0) {
+        return 0;
+    }
+    // frequency word: carrier period in units of 0.241246 us
+    return 1000000U / (code[1] * 0.241246);
+}
+
+uint32_t globalCacheFrequency(const uint16_t *code, uint16_t count) {
+    if (code == NULL || count < 1) {
+        return 0;
+    }
+    return code[0];
+}
+
+uint32_t protocolFrequency(decode_type_t protocol) {
+    // carrier frequencies of the IRsend protocol encoders which don't use 38 kHz
+    switch (protocol) {
+        case RC5:
+        case RC5X:
+        case RC6:
+        case RCMM:
+            return 36000;
+        case PANASONIC:
+            return 36700;
+        case SONY:
+            return 40000;
+        case MITSUBISHI:
+        case MITSUBISHI2:
+            return 33000;
+        case DISH:
+            return 57600;
+        default:
+            return 38000;
+    }
+}
+
+bool IrCalibrationCache::get(uint32_t frequency, int8_t *offset) const {
+    uint16_t k = key(frequency);
+    for (uint8_t i = 0; i < count_; i++) {
+        if (entries_[i].key == k) {
+            *offset = entries_[i].offset;
+            return true;
+        }
+    }
+    return false;
+}
+
+void IrCalibrationCache::put(uint32_t frequency, int8_t offset) {
+    uint16_t k = key(frequency);
+    for (uint8_t i = 0; i < count_; i++) {
+        if (entries_[i].key == k) {
+            entries_[i].offset = offset;
+            return;
+        }
+    }
+    entries_[next_] = {k, offset};
+    next_ = (next_ + 1) % CAPACITY;
+    if (count_ < CAPACITY) {
+        count_++;
+    }
+}
+
+// Same period calculation as IRsend::calcUSecPeriod without offset.
+static uint32_t periodUsec(uint32_t hz) {
+    if (hz == 0) {
+        hz = 1;
+    }
+    return (1000000UL + hz / 2) / hz;
+}
+
+bool allocTimings(IrTimings *timings, uint32_t frequency, uint32_t count) {
+    timings->frequency = frequency;
+    timings->count = 0;
+    timings->durations = NULL;
+    if (count == 0 || count > IR_TIMINGS_MAX_DURATIONS) {
+        return false;
+    }
+    timings->durations = reinterpret_cast<uint32_t *>(mem_tag_malloc(MEM_TAG_IR, count * sizeof(uint32_t)));
+    return timings->durations != NULL;
+}
+
+// Append a mark or space to a timing stream: consecutive marks or spaces are merged.
+static void appendTiming(IrTimings *timings, uint32_t usec, bool mark) {
+    // marks are at even indexes
+    if (timings->count == 0 && !mark) {
+        timings->durations[timings->count++] = 0;
+    } else if (timings->count > 0 && ((timings->count - 1) % 2 == 0) == mark) {
+        timings->durations[timings->count - 1] += usec;
+        return;
+    }
+    timings->durations[timings->count++] = usec;
+}
+
+// Append a PRONTO sequence with the same period calculation as IRsend::sendPronto.
+static void appendProntoSequence(IrTimings *timings, const uint16_t *code, uint16_t start, uint16_t length) {
+    uint32_t periodX10 = periodUsec(timings->frequency / 10);
+    for (uint16_t i = start; i < start + length; i++) {
+        timings->durations[timings->count++] = code[i] * periodX10 / 10;
+    }
+}
+
+bool prontoToTimings(const uint16_t *code, uint16_t count, uint16_t repeat, IrTimings *timings) {
+    ProntoSequences seq;
+    // validated in prontoBufferToArray
+    if (count < 6 || !prontoSequences(code, count, &seq) || code[1] == 0) {
+        return false;
+    }
+    if (seq.introLength == 0) {
+        // no intro sequence: repeat sequence is sent at least once
+        repeat++;
+    }
+
+    uint32_t total = seq.introLength + static_cast<uint32_t>(seq.repeatLength) * repeat;
+    if (!allocTimings(timings, prontoFrequency(code, count), total)) {
+        return false;
+    }
+
+    appendProntoSequence(timings, code, seq.introStart, seq.introLength);
+    for (uint16_t r = 0; r < repeat; r++) {
+        appendProntoSequence(timings, code, seq.repeatStart, seq.repeatLength);
+    }
+
+    return true;
+}
+
+bool prontoSequenceToTimings(const uint16_t *code, uint16_t count, bool repeatSequence, IrTimings *timings) {
+    ProntoSequences seq;
+    if (count < 6 || !prontoSequences(code, count, &seq) || code[1] == 0) {
+        return false;
+    }
+
+    uint16_t start = seq.introStart;
+    uint16_t length = seq.introLength;
+    if (repeatSequence || length == 0) {
+        start = seq.repeatStart;
+        length = seq.repeatLength;
+    }
+    if (!allocTimings(timings, prontoFrequency(code, count), length)) {
+        return false;
+    }
+
+    appendProntoSequence(timings, code, start, length);
+    return true;
+}
+
+bool globalCacheToTimings(const uint16_t *code, uint16_t count, IrTimings *timings) {
+    // GlobalCache code array: frequency, repeat, repeat offset, durations...
+    const uint16_t startIndex = 3;
+    // same limits as IRsend::sendGC
+    const uint16_t maxRepeat = 50;
+    const uint32_t minUsec = 80;
+
+    if (count <= startIndex || code[0] == 0) {
+        return false;
+    }
+    uint16_t emits = code[1] < maxRepeat ? code[1] : maxRepeat;
+    uint16_t repeatStart = code[2] + startIndex - 1;
+    if (code[2] == 0 || repeatStart >= count) {
+        return false;
+    }
+
+    // worst case: an additional leading mark
+    uint32_t total = (count - startIndex) + static_cast<uint32_t>(count - repeatStart) * (emits > 0 ? emits - 1 : 0);
+    if (!allocTimings(timings, code[0], emits > 0 ? total + 1 : 0)) {
+        return false;
+    }
+
+    uint32_t period = periodUsec(code[0]);
+    for (uint16_t r = 0; r < emits; r++) {
+        for (uint16_t i = r ? repeatStart : startIndex; i < count; i++) {
+            uint32_t usec = code[i] * period;
+            // GlobalCache marks are at odd indexes
+            appendTiming(timings, usec < minUsec ? minUsec : usec, i & 1);
+        }
+    }
+
+    return true;
+}
+
+void freeTimings(IrTimings *timings) {
+    mem_tag_free(MEM_TAG_IR, timings->durations);
+    timings->durations = NULL;
+    timings->count = 0;
+}
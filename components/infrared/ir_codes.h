@@ -14,12 +14,17 @@
 
 #include "IRremoteESP8266.h"
 #include "string.h"
+#include "util_types.h"
 
 enum class IRFormat {
     UNKNOWN = 0,
     UNFOLDED_CIRCLE = 1,
     PRONTO = 2,
     GLOBAL_CACHE = 3,
+    // Multiple PRONTO or GlobalCache IR codes for different outputs, see `IRSendMessage::parts`.
+    PARALLEL = 4,
+    // Compact canonical IR code, see ir_compact.h
+    COMPACT = 5,
 };
 
 struct GpioPinMask {
@@ -31,15 +36,73 @@ struct GpioPinMask {
     uint64_t w1tc;
 };
 
+/// Maximum number of different IR codes in a parallel IR send request.
+#define IR_PARALLEL_MAX_CODES 4
+/// Maximum number of IR outputs: internal side, internal top, external 1 & 2.
+#define IR_MAX_OUTPUTS 4
+
+/// IR output for sending an IR timing stream.
+struct IrOutput {
+    int8_t gpio;
+    bool   inverted;
+};
+
+/// IR code of a parallel IR send request.
+struct IrParallelPart {
+    IRFormat format;
+    // Offset of the NUL terminated IR code in the message buffer.
+    uint16_t offset;
+    uint8_t  outputCount;
+    IrOutput outputs[IR_MAX_OUTPUTS];
+};
+
+/// Location of the PRONTO burst sequences in a PRONTO code array.
+struct ProntoSequences {
+    /// Index of the intro sequence (sequence 1), sent once.
+    uint16_t introStart;
+    /// Number of intro sequence durations, 0 if the code doesn't have an intro sequence.
+    uint16_t introLength;
+    /// Index of the repeat sequence (sequence 2), sent while a button is held.
+    uint16_t repeatStart;
+    /// Number of repeat sequence durations, 0 if the code doesn't have a repeat sequence.
+    uint16_t repeatLength;
+};
+
+/// Parsed raw PRONTO code.
+struct ProntoCode {
+    /// Code array, stored in a caller provided buffer.
+    uint16_t       *code;
+    uint16_t        count;
+    /// Carrier frequency in Hz.
+    uint32_t        frequency;
+    ProntoSequences sequences;
+};
+
 struct IRSendMessage {
     int16_t     clientId;
     uint32_t    msgId;
     IRFormat    format;
-    std::string message;
+    // NUL terminated IR code. Points to the code buffer of the message pool slot.
+    // Not used with formats GLOBAL_CACHE and PRONTO: the code buffer contains the parsed code array of `gc` or
+    // `pronto`.
+    char       *message;
     uint16_t    repeat;
     GpioPinMask pin_mask;
     // TCP socket of message if received from the GlobalCache server, 0 otherwise.
     int gcSocket;
+    // Timestamp in microseconds since boot when the message was queued.
+    int64_t queuedAt;
+    // IR trace identifier, see ir_trace.h
+    uint32_t traceId;
+    // IR repeat hold handle if the repeat is kept alive with keep-alive messages, 0 otherwise.
+    uint16_t holdHandle;
+    // Number of IR codes for different outputs in `message` with format PARALLEL.
+    uint8_t        partCount;
+    IrParallelPart parts[IR_PARALLEL_MAX_CODES];
+    // Parsed IR code with format GLOBAL_CACHE, parsed once when the message is queued.
+    GCSendIr gc;
+    // Parsed IR code with format PRONTO, parsed once when the message is queued.
+    ProntoCode pronto;
 };
 
 struct IRHexData {
@@ -51,10 +114,122 @@ struct IRHexData {
 
 uint32_t parseUint32(const char *number, int *error = NULL, int base = 10);
 
+bool buildIRHexData(const char *message, IRHexData *data);
 bool buildIRHexData(const std::string &message, IRHexData *data);
 
 uint16_t countValuesInCStr(const char *str, char sep);
 
-uint16_t *prontoBufferToArray(const char *msg, char separator, uint16_t *codeCount, int *memError = NULL);
+/// @brief Get the intro and repeat sequences of a raw PRONTO code array.
+/// @return false if the code is not a raw PRONTO code or the sequences exceed the code array.
+bool prontoSequences(const uint16_t *code, uint16_t count, ProntoSequences *sequences);
+
+/// @brief Parse a raw PRONTO code into a caller provided code buffer.
+/// @param separator value separator, 0 to use space or the old comma separator (dock version <= 0.6.0).
+/// @param buffer code buffer, `pronto->code` points to it if successful.
+/// @param capacity number of values fitting into `buffer`.
+/// @return false if the code is invalid or doesn't fit into the buffer.
+bool parseProntoCode(const char *msg, char separator, uint16_t *buffer, uint16_t capacity, ProntoCode *pronto);
+
+/// @brief Compare two parsed PRONTO codes.
+bool prontoCodeEqual(const ProntoCode *a, const ProntoCode *b);
+
+/// @brief Convert a PRONTO code to an array of code values.
+/// @param frequency optional output parameter for the carrier frequency in Hz.
+/// @param sequences optional output parameter for the intro and repeat sequences.
+/// @return code array allocated with `MEM_TAG_IR`, must be freed with `mem_tag_free`. NULL if invalid.
+uint16_t *prontoBufferToArray(const char *msg, char separator, uint16_t *codeCount, int *memError = NULL,
+                              uint32_t *frequency = NULL, ProntoSequences *sequences = NULL);
+
+/// @brief Convert a GlobalCache sendir code to an array of code values.
+/// @param frequency optional output parameter for the carrier frequency in Hz.
+/// @return code array allocated with `MEM_TAG_IR`, must be freed with `mem_tag_free`. NULL if invalid.
+uint16_t *globalCacheBufferToArray(const char *msg, uint16_t *codeCount, int *memError = NULL,
+                                   uint32_t *frequency = NULL);
+
+/// @brief Get the carrier frequency of a PRONTO code array. Same calculation as in `IRsend::sendPronto`.
+/// @return frequency in Hz, 0 if invalid.
+uint32_t prontoFrequency(const uint16_t *code, uint16_t count);
+
+/// @brief Get the carrier frequency of a GlobalCache code array.
+/// @return frequency in Hz, 0 if invalid.
+uint32_t globalCacheFrequency(const uint16_t *code, uint16_t count);
+
+/// @brief Get the carrier frequency IRsend uses for an IR protocol.
+/// @return frequency in Hz, 38 kHz for protocols without a different carrier.
+uint32_t protocolFrequency(decode_type_t protocol);
+
+/// @brief Cache of IRsend period offset calibrations per carrier frequency.
+///
+/// Carrier frequencies are grouped in 1 kHz steps, e.g. PRONTO 38028 Hz and GlobalCache 38000 Hz share an entry.
+/// The oldest entry is replaced if the cache is full.
+class IrCalibrationCache {
+ public:
+    /// Maximum number of cached carrier frequencies.
+    enum { CAPACITY = 8 };
+
+    /// @brief Get the cache key of a carrier frequency.
+    static uint16_t key(uint32_t frequency) { return (frequency + 500) / 1000; }
+
+    /// @brief Get the cached period offset of a carrier frequency.
+    /// @return false if the carrier frequency has not been calibrated yet.
+    bool get(uint32_t frequency, int8_t *offset) const;
+
+    /// @brief Store the period offset of a carrier frequency.
+    void put(uint32_t frequency, int8_t offset);
+
+    uint8_t size() const { return count_; }
+
+ private:
+    struct Entry {
+        uint16_t key;
+        int8_t   offset;
+    };
+
+    Entry   entries_[CAPACITY] = {};
+    uint8_t count_ = 0;
+    uint8_t next_ = 0;
+};
+
+/// Maximum number of durations in an IR timing stream.
+#define IR_TIMINGS_MAX_DURATIONS 4096
+
+/// IR timing stream: alternating mark and space durations in µs, starting with a mark.
+struct IrTimings {
+    /// Carrier frequency in Hz.
+    uint32_t  frequency;
+    uint32_t *durations;
+    uint16_t  count;
+};
+
+/// @brief Expand a PRONTO code array to an IR timing stream. The stream is identical to `IRsend::sendPronto`: the
+/// intro sequence is sent once, followed by `repeat` times the repeat sequence.
+/// @param code PRONTO code array from `prontoBufferToArray`.
+/// @param count number of values in the code array.
+/// @param repeat number of repeats.
+/// @param timings durations are allocated with `MEM_TAG_IR` and must be freed with `freeTimings`.
+/// @return false if the code is invalid, too long or out of memory.
+bool prontoToTimings(const uint16_t *code, uint16_t count, uint16_t repeat, IrTimings *timings);
+
+/// @brief Expand a single PRONTO sequence to an IR timing stream.
+///
+/// The intro stream of a code without intro sequence is the repeat sequence, since it's implied that the repeat
+/// sequence has to be sent at least once.
+/// @param code PRONTO code array from `prontoBufferToArray`.
+/// @param count number of values in the code array.
+/// @param repeatSequence true for the repeat sequence, false for the intro sequence.
+/// @param timings durations are allocated with `MEM_TAG_IR` and must be freed with `freeTimings`.
+/// @return false if the code is invalid, the sequence is empty or out of memory.
+bool prontoSequenceToTimings(const uint16_t *code, uint16_t count, bool repeatSequence, IrTimings *timings);
+
+/// @brief Expand a GlobalCache code array to an IR timing stream. The stream is identical to `IRsend::sendGC`.
+/// @param code GlobalCache code array from `globalCacheBufferToArray`, including the repeat value.
+/// @param count number of values in the code array.
+/// @param timings durations are allocated with `MEM_TAG_IR` and must be freed with `freeTimings`.
+/// @return false if the code is invalid, too long or out of memory.
+bool globalCacheToTimings(const uint16_t *code, uint16_t count, IrTimings *timings);
+
+/// @brief Allocate an empty IR timing stream for up to `count` durations.
+/// @return false if count is 0, exceeds `IR_TIMINGS_MAX_DURATIONS` or out of memory.
+bool allocTimings(IrTimings *timings, uint32_t frequency, uint32_t count);
 
-uint16_t *globalCacheBufferToArray(const char *msg, uint16_t *codeCount, int *memError = NULL);
+void freeTimings(IrTimings *timings);
@@ -0,0 +1,424 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ir_compact.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mem_tag.h"
+
+// Units of small multiples used for the least squares unit refinement. Long gaps would dominate otherwise.
+#define IR_COMPACT_REFINE_MAX_UNITS 16
+// Maximum relative difference in percent of long durations to share a pair, e.g. slightly different frame gaps.
+#define IR_COMPACT_MERGE_TOLERANCE 10
+// Long durations in units which may be merged within IR_COMPACT_MERGE_TOLERANCE.
+#define IR_COMPACT_MERGE_MIN_UNITS 8
+// Minimum gap in µs between repeated frames.
+#define IR_COMPACT_MIN_FRAME_GAP 5000
+
+static uint32_t quantize(uint32_t duration, uint32_t unit) {
+    uint32_t units = (duration + unit / 2) / unit;
+    return units ? units : 1;
+}
+
+// Least squares fit of the unit for all durations with small multiples.
+static uint32_t refineUnit(const uint32_t *durations, uint16_t count, uint32_t unit) {
+    uint64_t sumDurations = 0;
+    uint64_t sumUnits = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        uint32_t units = quantize(durations[i], unit);
+        if (units <= IR_COMPACT_REFINE_MAX_UNITS) {
+            sumDurations += static_cast<uint64_t>(durations[i]) * units;
+            sumUnits += units * units;
+        }
+    }
+    return sumUnits ? (sumDurations + sumUnits / 2) / sumUnits : unit;
+}
+
+// Maximum relative quantization error in percent.
+static uint32_t maxError(const uint32_t *durations, uint16_t count, uint32_t unit) {
+    uint32_t maxErr = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        if (durations[i] == 0) {
+            continue;
+        }
+        uint32_t expected = quantize(durations[i], unit) * unit;
+        uint32_t diff = expected > durations[i] ? expected - durations[i] : durations[i] - expected;
+        uint32_t err = static_cast<uint64_t>(diff) * 100 / durations[i];
+        if (err > maxErr) {
+            maxErr = err;
+        }
+    }
+    return maxErr;
+}
+
+// The shortest durations are the base unit of most IR protocols. If the longer durations are not close to a multiple,
+// e.g. a 1:2.5 ratio, a fraction of it is used.
+static uint32_t findUnit(const uint32_t *durations, uint16_t count) {
+    uint32_t shortest = UINT32_MAX;
+    for (uint16_t i = 0; i < count; i++) {
+        if (durations[i] > 0 && durations[i] < shortest) {
+            shortest = durations[i];
+        }
+    }
+    if (shortest == UINT32_MAX) {
+        return 0;
+    }
+
+    uint64_t sum = 0;
+    uint32_t n = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        if (durations[i] > 0 && durations[i] <= shortest + shortest / 2) {
+            sum += durations[i];
+            n++;
+        }
+    }
+    uint32_t base = sum / n;
+
+    uint32_t bestUnit = 0;
+    uint32_t bestErr = UINT32_MAX;
+    for (uint32_t divider = 1; divider <= 4; divider++) {
+        if (base / divider < IR_COMPACT_MIN_UNIT) {
+            break;
+        }
+        uint32_t unit = base / divider;
+        uint32_t err = maxError(durations, count, unit);
+        if (err <= IR_COMPACT_TOLERANCE) {
+            return refineUnit(durations, count, unit);
+        }
+        if (err < bestErr) {
+            bestErr = err;
+            bestUnit = unit;
+        }
+    }
+    return refineUnit(durations, count, bestUnit);
+}
+
+static bool similar(uint16_t a, uint16_t b) {
+    if (a == b) {
+        return true;
+    }
+    uint16_t lo = a < b ? a : b;
+    uint16_t hi = a < b ? b : a;
+    return lo >= IR_COMPACT_MERGE_MIN_UNITS && (hi - lo) * 100U <= hi * IR_COMPACT_MERGE_TOLERANCE;
+}
+
+static int findOrAddPair(IrCompactCode *code, uint16_t mark, uint16_t space) {
+    for (uint8_t i = 0; i < code->pairCount; i++) {
+        if (similar(code->pairs[i].mark, mark) && similar(code->pairs[i].space, space)) {
+            return i;
+        }
+    }
+    if (code->pairCount >= IR_COMPACT_MAX_PAIRS) {
+        return -1;
+    }
+    code->pairs[code->pairCount] = {mark, space};
+    return code->pairCount++;
+}
+
+// The space of the last pair is the capture timeout and not a real gap: it matches any frame gap.
+static bool sameSymbol(const IrCompactCode *code, uint16_t count, uint16_t a, uint16_t b) {
+    if (code->symbols[a] == code->symbols[b]) {
+        return true;
+    }
+    if (a != count - 1 && b != count - 1) {
+        return false;
+    }
+    const IrCompactPair &pairA = code->pairs[code->symbols[a]];
+    const IrCompactPair &pairB = code->pairs[code->symbols[b]];
+    uint32_t             minGap = IR_COMPACT_MIN_FRAME_GAP / code->unit;
+    return pairA.mark == pairB.mark && pairA.space >= minGap && pairB.space >= minGap;
+}
+
+// Find the repeated frame at the end of the symbol sequence covering the most symbols.
+static void splitSequences(IrCompactCode *code, uint16_t count) {
+    uint16_t bestLength = 0;
+    uint16_t bestRepeats = 0;
+    for (uint16_t length = 1; length <= count / 2; length++) {
+        uint16_t repeats = 1;
+        while ((repeats + 1) * length <= count) {
+            uint16_t start = count - (repeats + 1) * length;
+            uint16_t i = 0;
+            while (i < length && sameSymbol(code, count, start + i, count - length + i)) {
+                i++;
+            }
+            if (i < length) {
+                break;
+            }
+            repeats++;
+        }
+        if (repeats >= 2 && repeats * length > bestRepeats * bestLength) {
+            bestLength = length;
+            bestRepeats = repeats;
+        }
+    }
+
+    if (bestRepeats == 0) {
+        code->introLength = count;
+        code->repeatLength = 0;
+        code->repeatCount = 0;
+        return;
+    }
+    // the first repeated frame has the real gap
+    code->introLength = count - bestRepeats * bestLength;
+    code->repeatLength = bestLength;
+    code->repeatCount = bestRepeats;
+}
+
+// Drop unused pairs, e.g. the last pair of a repeated frame, and number the pairs in order of appearance.
+static void compactPairs(IrCompactCode *code) {
+    int16_t       mapping[IR_COMPACT_MAX_PAIRS];
+    IrCompactPair pairs[IR_COMPACT_MAX_PAIRS];
+    uint8_t       pairCount = 0;
+
+    for (uint8_t i = 0; i < IR_COMPACT_MAX_PAIRS; i++) {
+        mapping[i] = -1;
+    }
+    for (uint16_t i = 0; i < code->introLength + code->repeatLength; i++) {
+        uint8_t symbol = code->symbols[i];
+        if (mapping[symbol] < 0) {
+            mapping[symbol] = pairCount;
+            pairs[pairCount++] = code->pairs[symbol];
+        }
+        code->symbols[i] = mapping[symbol];
+    }
+    for (uint8_t i = 0; i < pairCount; i++) {
+        code->pairs[i] = pairs[i];
+    }
+    code->pairCount = pairCount;
+}
+
+bool irCompactFromTimings(const uint32_t *durations, uint16_t count, uint32_t frequency, IrCompactCode *code) {
+    if (durations == NULL || count < 2 || count > IR_COMPACT_MAX_SYMBOLS * 2 || code == NULL) {
+        return false;
+    }
+
+    uint32_t unit = findUnit(durations, count);
+    if (unit < IR_COMPACT_MIN_UNIT || unit > UINT16_MAX) {
+        return false;
+    }
+
+    code->frequency = frequency;
+    code->unit = unit;
+    code->pairCount = 0;
+
+    uint16_t symbolCount = 0;
+    for (uint16_t i = 0; i < count; i += 2) {
+        uint32_t mark = quantize(durations[i], unit);
+        uint32_t space = quantize(i + 1 < count ? durations[i + 1] : IR_COMPACT_TRAILING_GAP, unit);
+        if (mark > UINT16_MAX || space > UINT16_MAX) {
+            return false;
+        }
+        int symbol = findOrAddPair(code, mark, space);
+        if (symbol < 0) {
+            return false;
+        }
+        code->symbols[symbolCount++] = symbol;
+    }
+
+    splitSequences(code, symbolCount);
+    compactPairs(code);
+    return true;
+}
+
+// Append a run-length encoded symbol sequence.
+static int formatSequence(const uint8_t *symbols, uint16_t length, char *buf, size_t size) {
+    size_t pos = 0;
+    for (uint16_t i = 0; i < length;) {
+        uint16_t run = 1;
+        while (i + run < length && symbols[i + run] == symbols[i]) {
+            run++;
+        }
+        int len = run > 1 ? snprintf(buf + pos, size - pos, "%c%u", 'A' + symbols[i], run)
+                          : snprintf(buf + pos, size - pos, "%c", 'A' + symbols[i]);
+        if (len < 0 || pos + len >= size) {
+            return -1;
+        }
+        pos += len;
+        i += run;
+    }
+    return pos;
+}
+
+int irCompactFormat(const IrCompactCode *code, char *buf, size_t size) {
+    if (code == NULL || buf == NULL || size == 0) {
+        return -1;
+    }
+
+    int    len = snprintf(buf, size, IR_COMPACT_PREFIX "%lu;%u;", static_cast<unsigned long>(code->frequency),
+                          code->unit);
+    size_t pos = len;
+    if (len < 0 || pos >= size) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < code->pairCount; i++) {
+        len = snprintf(buf + pos, size - pos, i ? ",%u.%u" : "%u.%u", code->pairs[i].mark, code->pairs[i].space);
+        if (len < 0 || pos + len >= size) {
+            return -1;
+        }
+        pos += len;
+    }
+
+    const uint8_t *sequences[] = {code->symbols, code->symbols + code->introLength};
+    uint16_t       lengths[] = {code->introLength, code->repeatLength};
+    for (int s = 0; s < 2; s++) {
+        if (pos + 1 >= size) {
+            return -1;
+        }
+        buf[pos++] = ';';
+        buf[pos] = '\0';
+        len = formatSequence(sequences[s], lengths[s], buf + pos, size - pos);
+        if (len < 0) {
+            return -1;
+        }
+        pos += len;
+    }
+    return pos;
+}
+
+static bool parseNumber(const char **str, uint32_t max, uint32_t *value) {
+    const char *p = *str;
+    uint32_t    result = 0;
+    if (*p < '0' || *p > '9') {
+        return false;
+    }
+    while (*p >= '0' && *p <= '9') {
+        result = result * 10 + (*p - '0');
+        if (result > max) {
+            return false;
+        }
+        p++;
+    }
+    *str = p;
+    *value = result;
+    return true;
+}
+
+static bool parseSequence(const char **str, IrCompactCode *code, uint16_t *length) {
+    const char *p = *str;
+    uint16_t    start = code->introLength + code->repeatLength;
+    *length = 0;
+    while (*p >= 'A' && *p <= 'Z') {
+        uint8_t  symbol = *p++ - 'A';
+        uint32_t run = 1;
+        if (symbol >= code->pairCount) {
+            return false;
+        }
+        if (*p >= '0' && *p <= '9' && (!parseNumber(&p, IR_COMPACT_MAX_SYMBOLS, &run) || run < 2)) {
+            return false;
+        }
+        if (start + *length + run > IR_COMPACT_MAX_SYMBOLS) {
+            return false;
+        }
+        for (uint32_t i = 0; i < run; i++) {
+            code->symbols[start + (*length)++] = symbol;
+        }
+    }
+    *str = p;
+    return true;
+}
+
+bool irCompactParse(const char *str, IrCompactCode *code) {
+    if (str == NULL || code == NULL || strncmp(str, IR_COMPACT_PREFIX, strlen(IR_COMPACT_PREFIX)) != 0) {
+        return false;
+    }
+    const char *p = str + strlen(IR_COMPACT_PREFIX);
+    uint32_t    value;
+
+    if (!parseNumber(&p, UINT32_MAX / 10, &value) || value == 0 || *p++ != ';') {
+        return false;
+    }
+    code->frequency = value;
+    if (!parseNumber(&p, UINT16_MAX, &value) || value < IR_COMPACT_MIN_UNIT || *p++ != ';') {
+        return false;
+    }
+    code->unit = value;
+
+    code->pairCount = 0;
+    while (true) {
+        uint32_t mark;
+        uint32_t space;
+        if (code->pairCount >= IR_COMPACT_MAX_PAIRS || !parseNumber(&p, UINT16_MAX, &mark) || mark == 0 ||
+            *p++ != '.' || !parseNumber(&p, UINT16_MAX, &space) || space == 0) {
+            return false;
+        }
+        code->pairs[code->pairCount++] = {static_cast<uint16_t>(mark), static_cast<uint16_t>(space)};
+        if (*p != ',') {
+            break;
+        }
+        p++;
+    }
+    if (*p++ != ';') {
+        return false;
+    }
+
+    code->introLength = 0;
+    code->repeatLength = 0;
+    code->repeatCount = 0;
+    uint16_t length;
+    if (!parseSequence(&p, code, &length) || *p++ != ';') {
+        return false;
+    }
+    code->introLength = length;
+    if (!parseSequence(&p, code, &length) || *p != '\0') {
+        return false;
+    }
+    code->repeatLength = length;
+
+    return code->introLength + code->repeatLength > 0;
+}
+
+static void appendSymbols(IrTimings *timings, const IrCompactCode *code, uint16_t start, uint16_t length) {
+    for (uint16_t i = start; i < start + length; i++) {
+        const IrCompactPair &pair = code->pairs[code->symbols[i]];
+        timings->durations[timings->count++] = static_cast<uint32_t>(pair.mark) * code->unit;
+        timings->durations[timings->count++] = static_cast<uint32_t>(pair.space) * code->unit;
+    }
+}
+
+// Location of the repeat frame: the intro sequence if there's no repeat sequence.
+static void repeatFrame(const IrCompactCode *code, uint16_t *start, uint16_t *length) {
+    if (code->repeatLength) {
+        *start = code->introLength;
+        *length = code->repeatLength;
+    } else {
+        *start = 0;
+        *length = code->introLength;
+    }
+}
+
+bool irCompactToTimings(const IrCompactCode *code, uint16_t repeat, IrTimings *timings) {
+    uint16_t repeatStart;
+    uint16_t repeatLength;
+    repeatFrame(code, &repeatStart, &repeatLength);
+    uint32_t repeats = repeat;
+    if (code->introLength == 0) {
+        // no intro sequence: repeat sequence is sent at least once
+        repeats++;
+    }
+
+    uint32_t total = 2 * (code->introLength + repeats * repeatLength);
+    if (!allocTimings(timings, code->frequency, total)) {
+        return false;
+    }
+    appendSymbols(timings, code, 0, code->introLength);
+    for (uint32_t r = 0; r < repeats; r++) {
+        appendSymbols(timings, code, repeatStart, repeatLength);
+    }
+    return true;
+}
+
+bool irCompactSequenceToTimings(const IrCompactCode *code, bool repeatSequence, IrTimings *timings) {
+    uint16_t start = 0;
+    uint16_t length = code->introLength;
+    if (repeatSequence || length == 0) {
+        repeatFrame(code, &start, &length);
+    }
+    if (!allocTimings(timings, code->frequency, 2 * length)) {
+        return false;
+    }
+    appendSymbols(timings, code, start, length);
+    return true;
+}
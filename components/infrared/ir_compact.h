@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Normalization of raw IR timings to a compact canonical IR code format.
+//
+// Raw timings are quantized to multiples of a common time unit, mark / space pairs are replaced by symbols of a small
+// pair table and repeated frames are split into an intro and a repeat sequence:
+//
+//     UCC1;<carrier Hz>;<unit µs>;<mark>.<space>,...;<intro>;<repeat>
+//
+// Pair durations are multiples of the unit. Intro and repeat are run-length encoded symbol sequences: `A` is the first
+// pair of the table, an optional decimal count repeats the symbol, e.g. `AB3C` = `ABBBC`.
+// Same semantics as PRONTO: the intro sequence is sent once, followed by the repeat sequence. If there's no intro
+// sequence, the repeat sequence is sent at least once.
+// Make sure this file also compiles natively and all functions are covered by unit tests.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ir_codes.h"
+
+/// Format identifier and version prefix of a compact IR code.
+#define IR_COMPACT_PREFIX "UCC1;"
+/// Maximum number of distinct mark / space pairs: symbols `A` to `Z`.
+#define IR_COMPACT_MAX_PAIRS 26
+/// Maximum number of symbols in the intro and repeat sequences.
+#define IR_COMPACT_MAX_SYMBOLS 512
+/// Maximum relative quantization error of a duration in percent.
+#define IR_COMPACT_TOLERANCE 15
+/// Smallest time unit in µs.
+#define IR_COMPACT_MIN_UNIT 50
+/// Gap in µs appended to raw timings ending with a mark, e.g. captured timings without the final gap.
+#define IR_COMPACT_TRAILING_GAP 40000
+
+/// Mark / space durations in time units.
+struct IrCompactPair {
+    uint16_t mark;
+    uint16_t space;
+};
+
+/// IR code in compact canonical form.
+struct IrCompactCode {
+    /// Carrier frequency in Hz.
+    uint32_t frequency;
+    /// Time unit in µs.
+    uint16_t      unit;
+    uint8_t       pairCount;
+    IrCompactPair pairs[IR_COMPACT_MAX_PAIRS];
+    /// Number of intro sequence symbols at the start of `symbols`.
+    uint16_t introLength;
+    /// Number of repeat sequence symbols following the intro sequence.
+    uint16_t repeatLength;
+    /// Pair table indexes.
+    uint8_t symbols[IR_COMPACT_MAX_SYMBOLS];
+    /// Number of repeat sequences found in the raw timings. Not part of the canonical form.
+    uint16_t repeatCount;
+};
+
+/// @brief Normalize raw IR timings to a compact IR code.
+/// @param durations alternating mark and space durations in µs, starting with a mark.
+/// @param count number of durations.
+/// @param frequency carrier frequency in Hz.
+/// @param code output code.
+/// @return false if the timings can't be quantized or use too many distinct mark / space pairs.
+bool irCompactFromTimings(const uint32_t *durations, uint16_t count, uint32_t frequency, IrCompactCode *code);
+
+/// @brief Format a compact IR code in its canonical string form.
+/// @return length of the string, -1 if the buffer is too small.
+int irCompactFormat(const IrCompactCode *code, char *buf, size_t size);
+
+/// @brief Parse a compact IR code string.
+/// @return false if the string is not a valid compact IR code.
+bool irCompactParse(const char *str, IrCompactCode *code);
+
+/// @brief Expand a compact IR code to an IR timing stream: intro sequence followed by `repeat` repeat sequences.
+/// @param timings durations are allocated with `MEM_TAG_IR` and must be freed with `freeTimings`.
+/// @return false if the code is too long or out of memory.
+bool irCompactToTimings(const IrCompactCode *code, uint16_t repeat, IrTimings *timings);
+
+/// @brief Expand a single sequence of a compact IR code to an IR timing stream.
+///
+/// The intro stream of a code without intro sequence is the repeat sequence, the repeat stream of a code without repeat
+/// sequence is the intro sequence.
+/// @param repeatSequence true for the repeat sequence, false for the intro sequence.
+/// @param timings durations are allocated with `MEM_TAG_IR` and must be freed with `freeTimings`.
+/// @return false if the code is empty or out of memory.
+bool irCompactSequenceToTimings(const IrCompactCode *code, bool repeatSequence, IrTimings *timings);
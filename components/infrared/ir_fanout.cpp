@@ -0,0 +1,606 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ir_fanout.h"
+
+#include <fcntl.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <lwip/netdb.h>
+#include <lwip/sockets.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "cJSON.h"
+#include "ir_peer_protocol.h"
+#include "mdns.h"
+#include "metrics.h"
+#include "sdkconfig.h"
+#include "socket_util.h"
+
+#define MAX_PEER_CLIENT_COUNT 4
+#define CONNECT_TIMEOUT_MS 1000
+#define KEEPALIVE_IDLE 5
+#define KEEPALIVE_INTERVAL 5
+#define KEEPALIVE_COUNT 3
+#define MDNS_QUERY_TIMEOUT_MS 3000
+
+static const char *const TAG = "FANOUT";
+
+static Counter fanoutSends("ucd_ir_fanout_sends_total", "Number of IR send requests forwarded to a dock group");
+static Counter fanoutPeerErrors("ucd_ir_fanout_peer_errors_total",
+                                "Number of failed IR send requests forwarded to a peer dock");
+static Gauge   fanoutPeers("ucd_ir_fanout_peers", "Number of discovered peer docks");
+
+/// Parameters for the peer connection task `connection_task`
+struct PeerClient {
+    int               socket;
+    SemaphoreHandle_t semaphore;
+    InfraredService  *irService;
+    Config           *config;
+    /// dock group of this dock
+    const char *group;
+};
+
+/// @brief Get the API access token, which is the authentication key of IR send frames.
+/// @param token cached token, reloaded if the configuration changed.
+/// @param generation configuration generation of the cached token.
+static const char *cached_token(Config *config, std::string *token, uint32_t *generation) {
+    uint32_t current = config->getGeneration();
+    if (token->empty() || current != *generation) {
+        *generation = current;
+        *token = config->getToken();
+    }
+    return token->c_str();
+}
+
+static void set_keepalive(int sock) {
+    int keepAlive = 1;
+    int keepIdle = KEEPALIVE_IDLE;
+    int keepInterval = KEEPALIVE_INTERVAL;
+    int keepCount = KEEPALIVE_COUNT;
+    int noDelay = 1;
+    setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(int));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &keepIdle, sizeof(int));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &keepInterval, sizeof(int));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &keepCount, sizeof(int));
+    // small request and result frames
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(int));
+}
+
+static bool send_all(int sock, const uint8_t *buf, size_t length) {
+    while (length > 0) {
+        int written = send(sock, buf, length, 0);
+        if (written < 0) {
+            ESP_LOGW(TAG, "[%d] Error occurred during sending: errno %d", sock, errno);
+            return false;
+        }
+        buf += written;
+        length -= written;
+    }
+    return true;
+}
+
+static bool recv_all(int sock, uint8_t *buf, size_t length) {
+    while (length > 0) {
+        int len = recv(sock, buf, length, 0);
+        if (len <= 0) {
+            return false;
+        }
+        buf += len;
+        length -= len;
+    }
+    return true;
+}
+
+/// @brief Connect to a peer dock with a connection timeout.
+/// @return socket, -1 if the connection failed.
+static int connect_peer(uint32_t ip, uint16_t port) {
+    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+        return -1;
+    }
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ip;
+    addr.sin_port = htons(port);
+
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+    int err = connect(sock, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+    if (err != 0 && errno == EINPROGRESS) {
+        fd_set writeFds;
+        FD_ZERO(&writeFds);
+        FD_SET(sock, &writeFds);
+        struct timeval timeout = {.tv_sec = 0, .tv_usec = CONNECT_TIMEOUT_MS * 1000};
+        socklen_t      len = sizeof(err);
+        if (select(sock + 1, nullptr, &writeFds, nullptr, &timeout) == 1 &&
+            getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len) == 0) {
+            // err: pending socket error, 0 if connected
+        } else {
+            err = -1;
+        }
+    }
+    if (err != 0) {
+        ESP_LOGW(TAG, "Failed to connect to %s:%u", inet_ntoa(addr.sin_addr), port);
+        close(sock);
+        return -1;
+    }
+
+    fcntl(sock, F_SETFL, flags);
+    set_keepalive(sock);
+    return sock;
+}
+
+static void close_peer_socket(int *sock) {
+    if (*sock >= 0) {
+        shutdown(*sock, SHUT_RDWR);
+        close(*sock);
+        *sock = -1;
+    }
+}
+
+bool send_peer_result(int socket, uint16_t sequence, uint16_t status) {
+    uint8_t frame[IR_PEER_HEADER_SIZE + 2];
+    int     length = irPeerEncodeResult(sequence, status, frame, sizeof(frame));
+    return length > 0 && send_all(socket, frame, length);
+}
+
+IrFanout &IrFanout::getInstance() {
+    static IrFanout instance;
+    return instance;
+}
+
+void IrFanout::init(InfraredService *irService, Config *config, IrFanoutResponseCallback responseCallback) {
+    if (m_queue) {
+        ESP_LOGE(TAG, "Already initialized");
+        return;
+    }
+    std::string group = config->getDockGroup();
+    if (group.empty()) {
+        ESP_LOGI(TAG, "No dock group configured");
+        return;
+    }
+
+    m_irService = irService;
+    m_config = config;
+    m_responseCallback = responseCallback;
+
+    // the frame is only encoded and sent: prefer PSRAM
+    m_frameSize = IR_PEER_HEADER_SIZE + IR_PEER_SEND_OVERHEAD + CONFIG_UCD_IR_CODE_MAX_LENGTH;
+    m_frame = static_cast<uint8_t *>(heap_caps_malloc_prefer(m_frameSize, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+                                                             MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    if (m_frame == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate frame buffer");
+        return;
+    }
+
+    // this dock is always the first peer
+    Peer &self = m_peers[0];
+    strlcpy(self.name, config->getHostName(), sizeof(self.name));
+    strlcpy(self.group, group.c_str(), sizeof(self.group));
+    self.ip = htonl(INADDR_LOOPBACK);
+    self.port = CONFIG_UCD_IR_FANOUT_PORT;
+    self.socket = -1;
+    self.active = true;
+    m_peerCount = 1;
+
+    m_queue = xQueueCreate(1, sizeof(Job));
+    if (m_queue == nullptr) {
+        ESP_LOGE(TAG, "xQueueCreate failed");
+        return;
+    }
+
+    xTaskCreatePinnedToCore(server_task,     // task function
+                            "Peer server",   // task name
+                            3072,            // stack size
+                            this,            // task parameter
+                            3,               // task priority
+                            NULL,            // Task handle to keep track of created task
+                            0);              // core
+    xTaskCreatePinnedToCore(fanout_task,     // task function
+                            "IR fanout",     // task name
+                            4096,            // stack size
+                            this,            // task parameter
+                            4,               // task priority
+                            NULL,            // Task handle to keep track of created task
+                            0);              // core
+
+    ESP_LOGI(TAG, "Initialized: group=%s, port=%d", group.c_str(), CONFIG_UCD_IR_FANOUT_PORT);
+}
+
+uint16_t IrFanout::send(int16_t clientId, uint32_t msgId, const char *group, const char *code, const char *format,
+                        uint16_t repeat, uint8_t outputs) {
+    if (!m_queue) {
+        return 503;  // service unavailable
+    }
+    if (!group || group[0] == '\0' || strlen(group) > IR_FANOUT_GROUP_MAX_LENGTH || !code || !format ||
+        strlen(code) >= CONFIG_UCD_IR_CODE_MAX_LENGTH) {
+        return 400;
+    }
+
+    bool expected = false;
+    if (!m_busy.compare_exchange_strong(expected, true)) {
+        return 429;  // too many requests
+    }
+
+    Job job = {};
+    job.clientId = clientId;
+    job.msgId = msgId;
+    strlcpy(job.group, group, sizeof(job.group));
+    job.sequence = ++m_sequence;
+    // encoded once and sent to all peers: the frame buffer is owned by the active job
+    int length = irPeerEncodeSend(job.sequence, group, code, format, repeat, outputs,
+                                  cached_token(m_config, &m_token, &m_tokenGeneration), m_frame, m_frameSize);
+    if (length < 0) {
+        m_busy = false;
+        return 400;
+    }
+    job.frameLength = length;
+
+    if (xQueueSendToBack(m_queue, &job, 0) != pdTRUE) {
+        m_busy = false;
+        return 429;
+    }
+    fanoutSends.inc();
+    return 0;
+}
+
+bool IrFanout::sendFrame(Peer *peer, const uint8_t *frame, size_t length) {
+    // persistent connections: reconnect once if the peer closed the connection
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (peer->socket < 0) {
+            peer->socket = connect_peer(peer->ip, peer->port);
+            if (peer->socket < 0) {
+                return false;
+            }
+        }
+        if (send_all(peer->socket, frame, length)) {
+            return true;
+        }
+        close_peer_socket(&peer->socket);
+    }
+    return false;
+}
+
+void IrFanout::dispatch(const Job &job) {
+    uint8_t  targets[IR_FANOUT_MAX_PEERS + 1];
+    uint16_t status[IR_FANOUT_MAX_PEERS + 1];
+    bool     pending[IR_FANOUT_MAX_PEERS + 1] = {};
+    uint8_t  targetCount = 0;
+
+    for (uint8_t i = 0; i < m_peerCount; i++) {
+        if (m_peers[i].active && strcmp(m_peers[i].group, job.group) == 0) {
+            targets[targetCount++] = i;
+        }
+    }
+
+    IrPeerAggregate aggregate(targetCount);
+    // parallel dispatch: send the request to all docks before waiting for the first result
+    for (uint8_t t = 0; t < targetCount; t++) {
+        if (sendFrame(&m_peers[targets[t]], m_frame, job.frameLength)) {
+            pending[t] = true;
+        } else {
+            status[t] = 503;
+            aggregate.complete(503);
+        }
+    }
+
+    int64_t deadline = esp_timer_get_time() + CONFIG_UCD_IR_FANOUT_TIMEOUT * 1000LL;
+    while (!aggregate.isDone()) {
+        int64_t remaining = deadline - esp_timer_get_time();
+        if (remaining <= 0) {
+            break;
+        }
+
+        fd_set readFds;
+        int    maxFd = -1;
+        FD_ZERO(&readFds);
+        for (uint8_t t = 0; t < targetCount; t++) {
+            if (pending[t]) {
+                FD_SET(m_peers[targets[t]].socket, &readFds);
+                maxFd = std::max(maxFd, m_peers[targets[t]].socket);
+            }
+        }
+        struct timeval timeout = {.tv_sec = static_cast<time_t>(remaining / 1000000),
+                                  .tv_usec = static_cast<suseconds_t>(remaining % 1000000)};
+        int            ready = select(maxFd + 1, &readFds, nullptr, nullptr, &timeout);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            break;
+        }
+
+        for (uint8_t t = 0; t < targetCount; t++) {
+            Peer &peer = m_peers[targets[t]];
+            if (!pending[t] || !FD_ISSET(peer.socket, &readFds)) {
+                continue;
+            }
+            uint8_t      buf[IR_PEER_HEADER_SIZE + 2];
+            IrPeerHeader header;
+            uint16_t     result;
+            if (!recv_all(peer.socket, buf, IR_PEER_HEADER_SIZE) || !irPeerParseHeader(buf, &header) ||
+                header.type != IrPeerFrameType::RESULT || header.length != 2 ||
+                !recv_all(peer.socket, buf + IR_PEER_HEADER_SIZE, 2) ||
+                !irPeerDecodeResult(buf + IR_PEER_HEADER_SIZE, 2, &result)) {
+                ESP_LOGW(TAG, "Invalid response from %s", peer.name);
+                close_peer_socket(&peer.socket);
+                pending[t] = false;
+                status[t] = 502;
+                aggregate.complete(502);
+                continue;
+            }
+            if (header.sequence != job.sequence) {
+                // late result of a timed out request
+                continue;
+            }
+            pending[t] = false;
+            status[t] = result;
+            aggregate.complete(result);
+        }
+    }
+
+    // timed out peers: drop the connection to discard late results
+    for (uint8_t t = 0; t < targetCount; t++) {
+        if (pending[t]) {
+            close_peer_socket(&m_peers[targets[t]].socket);
+            status[t] = 504;
+            aggregate.complete(504);
+        }
+    }
+
+    cJSON *responseDoc = cJSON_CreateObject();
+    cJSON_AddStringToObject(responseDoc, "type", "dock");
+    cJSON_AddNumberToObject(responseDoc, "req_id", job.msgId);
+    cJSON_AddStringToObject(responseDoc, "msg", "ir_send");
+    cJSON_AddNumberToObject(responseDoc, "code", targetCount > 0 ? aggregate.status() : 404);
+    cJSON *docks = cJSON_AddArrayToObject(responseDoc, "docks");
+    for (uint8_t t = 0; t < targetCount; t++) {
+        if (status[t] != 200) {
+            fanoutPeerErrors.inc();
+        }
+        cJSON *dock = cJSON_CreateObject();
+        cJSON_AddStringToObject(dock, "name", m_peers[targets[t]].name);
+        cJSON_AddNumberToObject(dock, "code", status[t]);
+        cJSON_AddItemToArray(docks, dock);
+    }
+
+    ESP_LOGI(TAG, "Sent to %d dock(s) of group %s: %d", targetCount, job.group, aggregate.status());
+    char *response = cJSON_PrintUnformatted(responseDoc);
+    if (response && job.clientId >= 0 && m_responseCallback) {
+        m_responseCallback(job.clientId, response);
+    }
+    cJSON_free(response);
+    cJSON_Delete(responseDoc);
+}
+
+void IrFanout::discoverPeers() {
+    mdns_result_t *results = nullptr;
+    esp_err_t      err = mdns_query_ptr("_uc-dock", "_tcp", MDNS_QUERY_TIMEOUT_MS, IR_FANOUT_MAX_PEERS * 2, &results);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "mDNS query failed: %s", esp_err_to_name(err));
+        return;
+    }
+
+    for (uint8_t i = 1; i < m_peerCount; i++) {
+        m_peers[i].active = false;
+    }
+
+    for (mdns_result_t *r = results; r; r = r->next) {
+        if (!r->hostname || strcmp(r->hostname, m_config->getHostName()) == 0) {
+            continue;
+        }
+        const char *group = nullptr;
+        uint16_t    port = 0;
+        for (size_t i = 0; i < r->txt_count; i++) {
+            if (strcmp(r->txt[i].key, "group") == 0) {
+                group = r->txt[i].value;
+            } else if (strcmp(r->txt[i].key, "peer_port") == 0 && r->txt[i].value) {
+                port = atoi(r->txt[i].value);
+            }
+        }
+        uint32_t ip = 0;
+        for (mdns_ip_addr_t *a = r->addr; a; a = a->next) {
+            if (a->addr.type == ESP_IPADDR_TYPE_V4) {
+                ip = a->addr.u_addr.ip4.addr;
+                break;
+            }
+        }
+        if (!group || group[0] == '\0' || port == 0 || ip == 0) {
+            // dock without IR fan-out
+            continue;
+        }
+
+        Peer *peer = nullptr;
+        for (uint8_t i = 1; i < m_peerCount; i++) {
+            if (strcmp(m_peers[i].name, r->hostname) == 0) {
+                peer = &m_peers[i];
+                break;
+            }
+        }
+        if (!peer) {
+            // reuse the slot of a vanished peer
+            for (uint8_t i = 1; i < m_peerCount && !peer; i++) {
+                if (!m_peers[i].active && m_peers[i].socket < 0) {
+                    peer = &m_peers[i];
+                }
+            }
+            if (!peer && m_peerCount <= IR_FANOUT_MAX_PEERS) {
+                peer = &m_peers[m_peerCount++];
+                peer->socket = -1;
+            }
+            if (!peer) {
+                ESP_LOGW(TAG, "Too many peer docks, ignoring %s", r->hostname);
+                continue;
+            }
+            strlcpy(peer->name, r->hostname, sizeof(peer->name));
+            ESP_LOGI(TAG, "Discovered %s: group=%s", peer->name, group);
+        }
+        if (peer->ip != ip || peer->port != port) {
+            close_peer_socket(&peer->socket);
+        }
+        strlcpy(peer->group, group, sizeof(peer->group));
+        peer->ip = ip;
+        peer->port = port;
+        peer->active = true;
+    }
+    mdns_query_results_free(results);
+
+    int32_t active = 0;
+    for (uint8_t i = 1; i < m_peerCount; i++) {
+        if (m_peers[i].active) {
+            active++;
+        } else {
+            close_peer_socket(&m_peers[i].socket);
+        }
+    }
+    fanoutPeers.set(active);
+}
+
+void IrFanout::fanout_task(void *param) {
+    IrFanout *fanout = reinterpret_cast<IrFanout *>(param);
+
+    const TickType_t interval = pdMS_TO_TICKS(CONFIG_UCD_IR_FANOUT_DISCOVERY_INTERVAL * 1000);
+    TickType_t       lastDiscovery = xTaskGetTickCount();
+    fanout->discoverPeers();
+
+    Job job;
+    while (true) {
+        TickType_t elapsed = xTaskGetTickCount() - lastDiscovery;
+        if (xQueueReceive(fanout->m_queue, &job, elapsed >= interval ? 0 : interval - elapsed) == pdTRUE) {
+            fanout->dispatch(job);
+            fanout->m_busy = false;
+            continue;
+        }
+        fanout->discoverPeers();
+        lastDiscovery = xTaskGetTickCount();
+    }
+}
+
+/// @brief TCP server task accepting connections from peer docks.
+/// @param param pointer to IrFanout instance
+void IrFanout::server_task(void *param) {
+    IrFanout *fanout = reinterpret_cast<IrFanout *>(param);
+
+    SemaphoreHandle_t clientCountSemaphore = xSemaphoreCreateCounting(MAX_PEER_CLIENT_COUNT, MAX_PEER_CLIENT_COUNT);
+    if (clientCountSemaphore == NULL) {
+        ESP_LOGE(TAG, "Error starting server: unable to create client semaphore");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    int listen_sock = socket_tcp_listen(CONFIG_UCD_IR_FANOUT_PORT, 2, TAG);
+    if (listen_sock < 0) {
+        vTaskDelete(NULL);
+        return;
+    }
+
+    while (true) {
+        // limit number of clients, wait until a client slot is available
+        if (xSemaphoreTake(clientCountSemaphore, portMAX_DELAY) == pdFALSE) {
+            continue;
+        }
+
+        struct sockaddr_storage source_addr;
+        socklen_t               addr_len = sizeof(source_addr);
+        int sock = accept(listen_sock, reinterpret_cast<struct sockaddr *>(&source_addr), &addr_len);
+        if (sock < 0) {
+            ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
+            xSemaphoreGive(clientCountSemaphore);
+            continue;
+        }
+        set_keepalive(sock);
+        char addr_str[SOCKET_ADDR_STR_LEN];
+        ESP_LOGI(TAG, "[%d] Peer connected: %s", sock, socket_addr_str(&source_addr, addr_str, sizeof(addr_str)));
+
+        PeerClient *client = new PeerClient();
+        client->socket = sock;
+        client->semaphore = clientCountSemaphore;
+        client->irService = fanout->m_irService;
+        client->config = fanout->m_config;
+        client->group = fanout->m_peers[0].group;
+        xTaskCreatePinnedToCore(connection_task,  // task function
+                                "Peer client",    // task name
+                                4000,             // stack size
+                                client,           // task parameter
+                                5,                // task priority
+                                NULL,             // Task handle to keep track of created task
+                                1);               // core
+    }
+}
+
+/// @brief Peer connection task to process forwarded IR send requests.
+/// @param param pointer to PeerClient struct. The task is responsible to delete the struct when terminating.
+void IrFanout::connection_task(void *param) {
+    PeerClient *client = reinterpret_cast<PeerClient *>(param);
+
+    const size_t payloadSize = IR_PEER_SEND_OVERHEAD + CONFIG_UCD_IR_CODE_MAX_LENGTH;
+    uint8_t     *frame = static_cast<uint8_t *>(heap_caps_malloc_prefer(IR_PEER_HEADER_SIZE + payloadSize, 2,
+                                                                         MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+                                                                         MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    char        *code = static_cast<char *>(heap_caps_malloc_prefer(
+        CONFIG_UCD_IR_CODE_MAX_LENGTH, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    std::string  token;
+    uint32_t     tokenGeneration = 0;
+
+    while (frame && code) {
+        IrPeerHeader header;
+        if (!recv_all(client->socket, frame, IR_PEER_HEADER_SIZE)) {
+            break;
+        }
+        if (!irPeerParseHeader(frame, &header) || header.type != IrPeerFrameType::SEND || header.length > payloadSize) {
+            ESP_LOGW(TAG, "[%d] Invalid frame", client->socket);
+            break;
+        }
+        uint8_t *payload = frame + IR_PEER_HEADER_SIZE;
+        if (!recv_all(client->socket, payload, header.length)) {
+            break;
+        }
+
+        // only accept IR send requests from docks knowing the API access token
+        if (!irPeerVerifySend(frame, header, cached_token(client->config, &token, &tokenGeneration))) {
+            ESP_LOGW(TAG, "[%d] Frame authentication failed", client->socket);
+            send_peer_result(client->socket, header.sequence, 401);
+            break;
+        }
+
+        IrPeerSend request;
+        uint16_t   status = 400;
+        if (irPeerDecodeSend(payload, header.length, &request, code, CONFIG_UCD_IR_CODE_MAX_LENGTH)) {
+            if (strcmp(request.group, client->group) != 0) {
+                ESP_LOGW(TAG, "[%d] Rejected IR send for group %s", client->socket, request.group);
+                status = 403;
+            } else {
+                status = client->irService->send(
+                    IR_CLIENT_PEER, header.sequence, code, request.format, request.repeat,
+                    request.outputs & IR_PEER_OUTPUT_INT_SIDE, request.outputs & IR_PEER_OUTPUT_INT_TOP,
+                    request.outputs & IR_PEER_OUTPUT_EXT1, request.outputs & IR_PEER_OUTPUT_EXT2, client->socket);
+            }
+        }
+        // 0: the result is sent by the IR send task. 202: accepted IR repeat of the active code
+        if (status != 0 && !send_peer_result(client->socket, header.sequence, status == 202 ? 200 : status)) {
+            break;
+        }
+    }
+
+    ESP_LOGI(TAG, "[%d] Connection closed", client->socket);
+    free(code);
+    free(frame);
+    shutdown(client->socket, 0);
+    close(client->socket);
+    // release client slot
+    xSemaphoreGive(client->semaphore);
+
+    delete client;
+    vTaskDelete(NULL);
+}
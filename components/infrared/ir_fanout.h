@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Multi-dock IR fan-out: forward an IR send request to all docks of a dock group.
+//
+// Docks with a configured dock group advertise the group and the peer port in the `_uc-dock._tcp` mDNS record and
+// accept forwarded IR send requests on the peer port (see `ir_peer_protocol.h`). The dock receiving the request
+// dispatches it to all group members over persistent TCP connections in parallel and replies with the aggregated
+// result once all docks have sent the IR code.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#include "config.h"
+#include "ir_peer_protocol.h"
+#include "service_ir.h"
+
+/// Maximum number of discovered peer docks.
+#define IR_FANOUT_MAX_PEERS 8
+/// Maximum length of a dock group name.
+#define IR_FANOUT_GROUP_MAX_LENGTH IR_PEER_GROUP_MAX_LENGTH
+
+typedef std::function<void(int16_t clientId, const char *message)> IrFanoutResponseCallback;
+
+/// @brief Send the result of a forwarded IR send request to the requesting dock.
+/// @param socket peer connection socket.
+/// @param sequence sequence number of the request.
+/// @param status response code of `InfraredService::send`.
+/// @return true if successful, false if send failed.
+bool send_peer_result(int socket, uint16_t sequence, uint16_t status);
+
+class IrFanout {
+ public:
+    static IrFanout &getInstance();
+
+    /**
+     * Start the peer server, peer discovery and the fan-out task.
+     *
+     * Does nothing if no dock group is configured.
+     * @param responseCallback sends the aggregated IR send response to a WebSocket client.
+     */
+    void init(InfraredService *irService, Config *config, IrFanoutResponseCallback responseCallback);
+
+    bool isEnabled() const { return m_queue != nullptr; }
+
+    /**
+     * Asynchronously send an IR code on all docks of a dock group.
+     *
+     * This dock is included if it is a member of the group. The IR send response contains the aggregated result and
+     * the result of every dock.
+     *
+     * @param clientId the WebSocket client identifier to associate the response message.
+     * @param msgId the client send request message identifier to associate the response message with.
+     * @param group dock group name.
+     * @param code IR code, any format of `InfraredService::send`.
+     * @param format IR code format.
+     * @param repeat IR repeat count.
+     * @param outputs IR outputs: IR_PEER_OUTPUT_* flags.
+     * @return 0 if dispatched, 400 if the request is invalid, 429 if a fan-out is in progress, 503 if the fan-out is
+     *         not enabled.
+     */
+    uint16_t send(int16_t clientId, uint32_t msgId, const char *group, const char *code, const char *format,
+                  uint16_t repeat, uint8_t outputs);
+
+ private:
+    IrFanout() = default;
+
+    IrFanout(const IrFanout &) = delete;  // no copying
+    IrFanout &operator=(const IrFanout &) = delete;
+
+    struct Peer {
+        char     name[32];
+        char     group[IR_FANOUT_GROUP_MAX_LENGTH + 1];
+        uint32_t ip;
+        uint16_t port;
+        /// persistent connection, -1 if not connected
+        int socket;
+        /// seen in the last discovery
+        bool active;
+    };
+
+    struct Job {
+        int16_t  clientId;
+        uint32_t msgId;
+        char     group[IR_FANOUT_GROUP_MAX_LENGTH + 1];
+        uint16_t sequence;
+        /// length of the encoded IR send frame in `m_frame`
+        size_t frameLength;
+    };
+
+    static void server_task(void *param);
+    static void connection_task(void *param);
+    static void fanout_task(void *param);
+
+    void discoverPeers();
+    void dispatch(const Job &job);
+    bool sendFrame(Peer *peer, const uint8_t *frame, size_t length);
+
+    InfraredService         *m_irService = nullptr;
+    Config                  *m_config = nullptr;
+    IrFanoutResponseCallback m_responseCallback;
+
+    QueueHandle_t     m_queue = nullptr;
+    std::atomic<bool> m_busy{false};
+    // encoded IR send frame of the active job
+    uint8_t *m_frame = nullptr;
+    size_t   m_frameSize = 0;
+    uint16_t m_sequence = 0;
+    // authentication key of the encoded frames, see `cached_token`
+    std::string m_token;
+    uint32_t    m_tokenGeneration = 0;
+
+    // only accessed in the fan-out task. The first peer is this dock, connected over the loopback interface.
+    Peer    m_peers[IR_FANOUT_MAX_PEERS + 1] = {};
+    uint8_t m_peerCount = 0;
+};
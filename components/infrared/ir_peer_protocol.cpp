@@ -0,0 +1,229 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ir_peer_protocol.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void putU16(uint8_t *buf, uint16_t value) {
+    buf[0] = value >> 8;
+    buf[1] = value & 0xFF;
+}
+
+static uint16_t getU16(const uint8_t *buf) {
+    return (buf[0] << 8) | buf[1];
+}
+
+static void putHeader(uint8_t *buf, IrPeerFrameType type, uint16_t sequence, uint16_t length) {
+    buf[0] = 'U';
+    buf[1] = 'P';
+    buf[2] = IR_PEER_VERSION;
+    buf[3] = static_cast<uint8_t>(type);
+    putU16(buf + 4, sequence);
+    putU16(buf + 6, length);
+}
+
+static bool formatFromName(const char *name, IrPeerFormat *format) {
+    if (!name) {
+        return false;
+    }
+    if (strcmp(name, "hex") == 0) {
+        *format = IrPeerFormat::HEX;
+    } else if (strcmp(name, "pronto") == 0) {
+        *format = IrPeerFormat::PRONTO;
+    } else if (strcmp(name, "gc") == 0) {
+        *format = IrPeerFormat::GC;
+    } else if (strcmp(name, "compact") == 0) {
+        *format = IrPeerFormat::COMPACT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/// @brief Pack a PRONTO code as binary words.
+/// @return number of bytes, -1 if the code is invalid or the buffer is too small.
+static int packPronto(const char *code, uint8_t *buf, size_t size) {
+    size_t      length = 0;
+    const char *pos = code;
+    while (*pos) {
+        if (isspace(static_cast<unsigned char>(*pos))) {
+            pos++;
+            continue;
+        }
+        char         *end;
+        unsigned long word = strtoul(pos, &end, 16);
+        if (end == pos || end - pos > 4 || (*end && !isspace(static_cast<unsigned char>(*end)))) {
+            return -1;
+        }
+        if (length + 2 > size) {
+            return -1;
+        }
+        putU16(buf + length, static_cast<uint16_t>(word));
+        length += 2;
+        pos = end;
+    }
+    return length > 0 ? static_cast<int>(length) : -1;
+}
+
+/// @brief Calculate the authentication tag of a frame.
+/// @param length length of the header and the payload before the tag.
+static void frameTag(const uint8_t *frame, size_t length, const char *key, uint8_t tag[IR_PEER_TAG_SIZE]) {
+    hmacSha256(reinterpret_cast<const uint8_t *>(key), strlen(key), frame, length, tag);
+}
+
+int irPeerEncodeSend(uint16_t sequence, const char *group, const char *code, const char *format, uint16_t repeat,
+                     uint8_t outputs, const char *key, uint8_t *buf, size_t size) {
+    IrPeerFormat peerFormat;
+    if (!group || !code || !key || !buf || !formatFromName(format, &peerFormat)) {
+        return -1;
+    }
+    size_t groupLength = strlen(group);
+    if (groupLength == 0 || groupLength > IR_PEER_GROUP_MAX_LENGTH ||
+        size < IR_PEER_HEADER_SIZE + IR_PEER_SEND_SIZE + groupLength + IR_PEER_TAG_SIZE) {
+        return -1;
+    }
+
+    uint8_t *payload = buf + IR_PEER_HEADER_SIZE;
+    size_t   fixedSize = IR_PEER_SEND_SIZE + groupLength;
+    size_t   available = size - IR_PEER_HEADER_SIZE - fixedSize - IR_PEER_TAG_SIZE;
+    if (available > UINT16_MAX - fixedSize - IR_PEER_TAG_SIZE) {
+        available = UINT16_MAX - fixedSize - IR_PEER_TAG_SIZE;
+    }
+    int codeLength;
+    if (peerFormat == IrPeerFormat::PRONTO) {
+        codeLength = packPronto(code, payload + fixedSize, available);
+    } else {
+        size_t length = strlen(code);
+        codeLength = length > 0 && length <= available ? static_cast<int>(length) : -1;
+        if (codeLength > 0) {
+            memcpy(payload + fixedSize, code, length);
+        }
+    }
+    if (codeLength < 0) {
+        return -1;
+    }
+
+    payload[0] = groupLength;
+    memcpy(payload + 1, group, groupLength);
+    payload[1 + groupLength] = static_cast<uint8_t>(peerFormat);
+    payload[2 + groupLength] = outputs;
+    putU16(payload + 3 + groupLength, repeat);
+
+    size_t tagOffset = IR_PEER_HEADER_SIZE + fixedSize + codeLength;
+    putHeader(buf, IrPeerFrameType::SEND, sequence, fixedSize + codeLength + IR_PEER_TAG_SIZE);
+    frameTag(buf, tagOffset, key, buf + tagOffset);
+    return tagOffset + IR_PEER_TAG_SIZE;
+}
+
+int irPeerEncodeResult(uint16_t sequence, uint16_t status, uint8_t *buf, size_t size) {
+    if (!buf || size < IR_PEER_HEADER_SIZE + 2) {
+        return -1;
+    }
+    putHeader(buf, IrPeerFrameType::RESULT, sequence, 2);
+    putU16(buf + IR_PEER_HEADER_SIZE, status);
+    return IR_PEER_HEADER_SIZE + 2;
+}
+
+bool irPeerParseHeader(const uint8_t *buf, IrPeerHeader *header) {
+    if (!buf || !header || buf[0] != 'U' || buf[1] != 'P' || buf[2] != IR_PEER_VERSION) {
+        return false;
+    }
+    if (buf[3] != static_cast<uint8_t>(IrPeerFrameType::SEND) &&
+        buf[3] != static_cast<uint8_t>(IrPeerFrameType::RESULT)) {
+        return false;
+    }
+    header->type = static_cast<IrPeerFrameType>(buf[3]);
+    header->sequence = getU16(buf + 4);
+    header->length = getU16(buf + 6);
+    return true;
+}
+
+bool irPeerVerifySend(const uint8_t *frame, const IrPeerHeader &header, const char *key) {
+    if (!frame || !key || header.type != IrPeerFrameType::SEND || header.length < IR_PEER_SEND_SIZE + IR_PEER_TAG_SIZE) {
+        return false;
+    }
+    size_t  tagOffset = IR_PEER_HEADER_SIZE + header.length - IR_PEER_TAG_SIZE;
+    uint8_t tag[IR_PEER_TAG_SIZE];
+    frameTag(frame, tagOffset, key, tag);
+    return constantTimeEqual(tag, frame + tagOffset, IR_PEER_TAG_SIZE);
+}
+
+bool irPeerDecodeSend(const uint8_t *payload, uint16_t length, IrPeerSend *send, char *code, size_t codeSize) {
+    if (!payload || !send || !code || length <= IR_PEER_SEND_SIZE + IR_PEER_TAG_SIZE || codeSize == 0) {
+        return false;
+    }
+
+    size_t groupLength = payload[0];
+    if (groupLength == 0 || groupLength > IR_PEER_GROUP_MAX_LENGTH ||
+        length <= IR_PEER_SEND_SIZE + groupLength + IR_PEER_TAG_SIZE || memchr(payload + 1, 0, groupLength) != nullptr) {
+        return false;
+    }
+    memcpy(send->group, payload + 1, groupLength);
+    send->group[groupLength] = '\0';
+
+    // format, outputs and repeat after the group
+    const uint8_t *fields = payload + 1 + groupLength;
+    const uint8_t *data = payload + IR_PEER_SEND_SIZE + groupLength;
+    size_t         dataLength = length - IR_PEER_SEND_SIZE - groupLength - IR_PEER_TAG_SIZE;
+    switch (static_cast<IrPeerFormat>(fields[0])) {
+        case IrPeerFormat::HEX:
+            send->format = "hex";
+            break;
+        case IrPeerFormat::PRONTO:
+            send->format = "pronto";
+            break;
+        case IrPeerFormat::GC:
+            send->format = "gc";
+            break;
+        case IrPeerFormat::COMPACT:
+            send->format = "compact";
+            break;
+        default:
+            return false;
+    }
+    send->outputs = fields[1];
+    send->repeat = getU16(fields + 2);
+
+    if (static_cast<IrPeerFormat>(fields[0]) != IrPeerFormat::PRONTO) {
+        if (dataLength >= codeSize || memchr(data, 0, dataLength) != nullptr) {
+            return false;
+        }
+        memcpy(code, data, dataLength);
+        code[dataLength] = '\0';
+        return true;
+    }
+
+    // 4 hex digits per word, separated by a space
+    if (dataLength % 2 || dataLength / 2 * 5 > codeSize) {
+        return false;
+    }
+    char *pos = code;
+    for (size_t i = 0; i < dataLength; i += 2) {
+        snprintf(pos, 6, i == 0 ? "%04X" : " %04X", getU16(data + i));
+        pos += i == 0 ? 4 : 5;
+    }
+    return true;
+}
+
+bool irPeerDecodeResult(const uint8_t *payload, uint16_t length, uint16_t *status) {
+    if (!payload || !status || length != 2) {
+        return false;
+    }
+    *status = getU16(payload);
+    return true;
+}
+
+bool IrPeerAggregate::complete(uint16_t status) {
+    if (m_pending == 0) {
+        return true;
+    }
+    if (status != 200 && m_status == 200) {
+        m_status = status;
+    }
+    return --m_pending == 0;
+}
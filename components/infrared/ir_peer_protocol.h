@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Binary protocol to forward IR send requests between docks of a dock group.
+//
+// Frame: 8 byte header followed by the payload. Multi-byte values are in network byte order.
+//
+//     0  'U' 'P'          magic
+//     2  version          IR_PEER_VERSION
+//     3  type             IrPeerFrameType
+//     4  sequence         uint16: result frames use the sequence number of the request
+//     6  payload length   uint16
+//
+// IR send payload: group length (uint8), dock group, format (IrPeerFormat), output flags (IR_PEER_OUTPUT_*),
+// repeat (uint16), IR code, authentication tag.
+// PRONTO codes are transferred as binary words, the other formats as text without NUL terminator.
+// The authentication tag is the HMAC-SHA256 of the header and the payload before the tag, keyed with the API access
+// token. All docks of a dock group must use the same token.
+// IR send result payload: status (uint16), the response code of `InfraredService::send`.
+// Make sure this file also compiles natively and all functions are covered by unit tests.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hmac_sha256.h"
+
+#define IR_PEER_VERSION 2
+#define IR_PEER_HEADER_SIZE 8
+/// Size of the fixed fields of an IR send payload.
+#define IR_PEER_SEND_SIZE 5
+/// Maximum length of a dock group name.
+#define IR_PEER_GROUP_MAX_LENGTH 32
+/// Size of the authentication tag of an IR send payload.
+#define IR_PEER_TAG_SIZE SHA256_DIGEST_SIZE
+/// Maximum size of an IR send payload without the IR code.
+#define IR_PEER_SEND_OVERHEAD (IR_PEER_SEND_SIZE + IR_PEER_GROUP_MAX_LENGTH + IR_PEER_TAG_SIZE)
+
+#define IR_PEER_OUTPUT_INT_SIDE 0x01
+#define IR_PEER_OUTPUT_INT_TOP 0x02
+#define IR_PEER_OUTPUT_EXT1 0x04
+#define IR_PEER_OUTPUT_EXT2 0x08
+
+enum class IrPeerFrameType : uint8_t {
+    SEND = 1,
+    RESULT = 2,
+};
+
+enum class IrPeerFormat : uint8_t {
+    HEX = 0,
+    PRONTO = 1,
+    GC = 2,
+    COMPACT = 3,
+};
+
+struct IrPeerHeader {
+    IrPeerFrameType type;
+    uint16_t        sequence;
+    uint16_t        length;
+};
+
+/// Decoded IR send request.
+struct IrPeerSend {
+    /// NUL terminated dock group name.
+    char        group[IR_PEER_GROUP_MAX_LENGTH + 1];
+    /// IR code format name for `InfraredService::send`.
+    const char *format;
+    uint8_t     outputs;
+    uint16_t    repeat;
+};
+
+/// @brief Encode an IR send request frame.
+/// @param group dock group name.
+/// @param format IR code format name: "hex", "pronto", "gc" or "compact".
+/// @param key authentication key: the API access token.
+/// @return frame length, -1 if the group, format or PRONTO code is invalid or the buffer is too small.
+int irPeerEncodeSend(uint16_t sequence, const char *group, const char *code, const char *format, uint16_t repeat,
+                     uint8_t outputs, const char *key, uint8_t *buf, size_t size);
+
+/// @brief Encode an IR send result frame.
+/// @return frame length, -1 if the buffer is too small.
+int irPeerEncodeResult(uint16_t sequence, uint16_t status, uint8_t *buf, size_t size);
+
+/// @brief Parse a frame header.
+/// @param buf at least IR_PEER_HEADER_SIZE bytes.
+/// @return false if the magic, version or frame type is invalid.
+bool irPeerParseHeader(const uint8_t *buf, IrPeerHeader *header);
+
+/// @brief Verify the authentication tag of an IR send request frame.
+/// @param frame header and payload of the frame.
+/// @param key authentication key: the API access token.
+/// @return false if the frame is too short or the tag doesn't match.
+bool irPeerVerifySend(const uint8_t *frame, const IrPeerHeader &header, const char *key);
+
+/// @brief Decode the payload of an IR send request frame. The frame must be verified with `irPeerVerifySend`.
+/// @param length payload length including the authentication tag.
+/// @param code output buffer for the NUL terminated IR code in the text format of `InfraredService::send`.
+/// @return false if the payload is invalid or the code doesn't fit into `code`.
+bool irPeerDecodeSend(const uint8_t *payload, uint16_t length, IrPeerSend *send, char *code, size_t codeSize);
+
+/// @brief Decode the payload of an IR send result frame.
+bool irPeerDecodeResult(const uint8_t *payload, uint16_t length, uint16_t *status);
+
+/// Aggregated completion of an IR send forwarded to multiple docks.
+class IrPeerAggregate {
+ public:
+    /// @param pending number of expected results.
+    explicit IrPeerAggregate(uint8_t pending) : m_pending(pending), m_status(200) {}
+
+    /// @brief Record a result.
+    /// @return true if all results are available.
+    bool complete(uint16_t status);
+
+    bool isDone() const { return m_pending == 0; }
+    /// 200 if all docks sent the IR code, otherwise the first failed status.
+    uint16_t status() const { return m_status; }
+
+ private:
+    uint8_t  m_pending;
+    uint16_t m_status;
+};
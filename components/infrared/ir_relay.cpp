@@ -0,0 +1,234 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ir_relay.h"
+
+#include <atomic>
+
+#include "driver/ledc.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_rom_gpio.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_sig_map.h"
+#include "soc/gpio_struct.h"
+
+static const char *const TAG = "IRRELAY";
+
+#define IR_RELAY_LEDC_MODE LEDC_LOW_SPEED_MODE
+#define IR_RELAY_LEDC_TIMER LEDC_TIMER_3
+#define IR_RELAY_LEDC_CHANNEL LEDC_CHANNEL_7
+// 6 bit resolution supports carrier frequencies up to 1.25 MHz
+#define IR_RELAY_LEDC_RESOLUTION LEDC_TIMER_6_BIT
+// ~33% duty cycle
+#define IR_RELAY_LEDC_DUTY 21
+
+// captured edges: 1 KB, drained by the frame reader while relaying
+#define IR_RELAY_QUEUE_LENGTH 256
+// queue item: duration in µs of the level ending with the edge, MSB set for a mark
+#define IR_RELAY_MARK 0x80000000
+#define IR_RELAY_DURATION_MASK 0x7FFFFFFF
+
+struct IrRelayState {
+    gpio_num_t    input;
+    IrOutput      outputs[IR_MAX_OUTPUTS];
+    bool          openDrain[IR_MAX_OUTPUTS];
+    uint8_t       outputCount;
+    uint32_t      signal;
+    QueueHandle_t queue;
+    bool          running;
+    // only accessed in the ISR while running
+    bool    mark;
+    int64_t lastEdge;
+
+    std::atomic<uint32_t> maxLatency;
+    std::atomic<uint32_t> dropped;
+};
+
+static IrRelayState s_relay = {};
+
+static void IRAM_ATTR relay_isr(void *arg) {
+    int64_t now = esp_timer_get_time();
+    // receiver output is active low
+    bool mark = gpio_ll_get_level(&GPIO, s_relay.input) == 0;
+
+    // latency critical: switch the outputs first
+    for (uint8_t i = 0; i < s_relay.outputCount; i++) {
+        const IrOutput &output = s_relay.outputs[i];
+        esp_rom_gpio_connect_out_signal(output.gpio, mark ? s_relay.signal : SIG_GPIO_OUT_IDX, mark && output.inverted,
+                                        false);
+    }
+
+    uint32_t latency = static_cast<uint32_t>(esp_timer_get_time() - now);
+    if (latency > s_relay.maxLatency.load(std::memory_order_relaxed)) {
+        s_relay.maxLatency.store(latency, std::memory_order_relaxed);
+    }
+
+    if (mark == s_relay.mark) {
+        // glitch shorter than the interrupt latency: level didn't change
+        return;
+    }
+
+    int64_t  elapsed = now - s_relay.lastEdge;
+    uint32_t item = elapsed > IR_RELAY_DURATION_MASK ? IR_RELAY_DURATION_MASK : static_cast<uint32_t>(elapsed);
+    if (s_relay.mark) {
+        item |= IR_RELAY_MARK;
+    }
+    s_relay.mark = mark;
+    s_relay.lastEdge = now;
+
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(s_relay.queue, &item, &woken) != pdTRUE) {
+        s_relay.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/// @brief Route the output GPIOs back to the GPIO output register used by `IRsend` and set the idle level.
+static void restore_outputs() {
+    for (uint8_t i = 0; i < s_relay.outputCount; i++) {
+        gpio_num_t gpio = static_cast<gpio_num_t>(s_relay.outputs[i].gpio);
+        gpio_set_level(gpio, s_relay.outputs[i].inverted ? 1 : 0);
+        gpio_set_direction(gpio, s_relay.openDrain[i] ? GPIO_MODE_OUTPUT_OD : GPIO_MODE_OUTPUT);
+    }
+}
+
+static esp_err_t start_carrier(uint32_t frequency) {
+    ledc_timer_config_t timer = {};
+    timer.speed_mode = IR_RELAY_LEDC_MODE;
+    timer.duty_resolution = IR_RELAY_LEDC_RESOLUTION;
+    timer.timer_num = IR_RELAY_LEDC_TIMER;
+    timer.freq_hz = frequency;
+    timer.clk_cfg = LEDC_AUTO_CLK;
+    ESP_RETURN_ON_ERROR(ledc_timer_config(&timer), TAG, "Carrier timer failed");
+
+    // the channel requires an output: it is routed back to the GPIO output register by the caller
+    ledc_channel_config_t channel = {};
+    channel.gpio_num = s_relay.outputs[0].gpio;
+    channel.speed_mode = IR_RELAY_LEDC_MODE;
+    channel.channel = IR_RELAY_LEDC_CHANNEL;
+    channel.intr_type = LEDC_INTR_DISABLE;
+    channel.timer_sel = IR_RELAY_LEDC_TIMER;
+    channel.duty = IR_RELAY_LEDC_DUTY;
+    channel.hpoint = 0;
+    ESP_RETURN_ON_ERROR(ledc_channel_config(&channel), TAG, "Carrier channel failed");
+
+    s_relay.signal = LEDC_LS_SIG_OUT0_IDX + IR_RELAY_LEDC_CHANNEL;
+    return ESP_OK;
+}
+
+esp_err_t ir_relay_start(const IrRelayConfig *config) {
+    ESP_RETURN_ON_FALSE(config && config->outputCount > 0 && config->outputCount <= IR_MAX_OUTPUTS,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid outputs");
+    ESP_RETURN_ON_FALSE(!s_relay.running, ESP_ERR_INVALID_STATE, TAG, "Already running");
+
+    if (s_relay.queue == nullptr) {
+        s_relay.queue = xQueueCreate(IR_RELAY_QUEUE_LENGTH, sizeof(uint32_t));
+        ESP_RETURN_ON_FALSE(s_relay.queue, ESP_ERR_NO_MEM, TAG, "Failed to create edge queue");
+    } else {
+        xQueueReset(s_relay.queue);
+    }
+
+    esp_err_t ret = ESP_OK;
+    s_relay.input = config->input;
+    s_relay.outputCount = config->outputCount;
+    for (uint8_t i = 0; i < config->outputCount; i++) {
+        s_relay.outputs[i] = config->outputs[i];
+        // keep the output driver configuration of the GPIO
+        s_relay.openDrain[i] = GPIO.pin[config->outputs[i].gpio].pad_driver;
+    }
+
+    ESP_GOTO_ON_ERROR(start_carrier(config->frequency), cleanup, TAG, "Failed to start %lu Hz carrier",
+                      config->frequency);
+    restore_outputs();
+
+    s_relay.mark = gpio_get_level(config->input) == 0;
+    s_relay.lastEdge = esp_timer_get_time();
+    s_relay.maxLatency = 0;
+    s_relay.dropped = 0;
+
+    // the ISR service may already be installed by other components
+    ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK || ret == ESP_ERR_INVALID_STATE, ret, cleanup, TAG,
+                      "Failed to install ISR service");
+    ESP_GOTO_ON_ERROR(gpio_set_intr_type(config->input, GPIO_INTR_ANYEDGE), cleanup, TAG, "Failed to set interrupt");
+    ESP_GOTO_ON_ERROR(gpio_isr_handler_add(config->input, relay_isr, nullptr), cleanup, TAG, "Failed to add ISR");
+    ESP_GOTO_ON_ERROR(gpio_intr_enable(config->input), cleanup, TAG, "Failed to enable interrupt");
+
+    s_relay.running = true;
+    ESP_LOGI(TAG, "Relaying GPIO %d to %d output(s) with %lu Hz carrier", config->input, config->outputCount,
+             config->frequency);
+    return ESP_OK;
+
+cleanup:
+    gpio_isr_handler_remove(config->input);
+    gpio_set_intr_type(config->input, GPIO_INTR_DISABLE);
+    ledc_stop(IR_RELAY_LEDC_MODE, IR_RELAY_LEDC_CHANNEL, 0);
+    restore_outputs();
+    return ret;
+}
+
+void ir_relay_stop() {
+    if (!s_relay.running) {
+        return;
+    }
+
+    gpio_intr_disable(s_relay.input);
+    gpio_isr_handler_remove(s_relay.input);
+    gpio_set_intr_type(s_relay.input, GPIO_INTR_DISABLE);
+    ledc_stop(IR_RELAY_LEDC_MODE, IR_RELAY_LEDC_CHANNEL, 0);
+    restore_outputs();
+    s_relay.running = false;
+
+    ESP_LOGI(TAG, "Stopped, dropped edges: %lu", s_relay.dropped.load());
+}
+
+bool ir_relay_read_frame(uint32_t *durations, uint16_t size, uint32_t gap, TickType_t timeout, IrRelayFrame *frame) {
+    if (!s_relay.running || !durations || size == 0 || !frame) {
+        return false;
+    }
+
+    frame->count = 0;
+    frame->overflow = false;
+
+    uint32_t item;
+    while (xQueueReceive(s_relay.queue, &item, frame->count == 0 ? timeout : pdMS_TO_TICKS(gap)) == pdTRUE) {
+        bool mark = item & IR_RELAY_MARK;
+        if (frame->count == 0 && !mark) {
+            // idle time before the frame
+            continue;
+        }
+        if (mark != (frame->count % 2 == 0)) {
+            // lost an edge: start over with the next mark
+            frame->count = 0;
+            frame->overflow = false;
+            if (!mark) {
+                continue;
+            }
+        }
+        if (frame->count < size) {
+            durations[frame->count++] = item & IR_RELAY_DURATION_MASK;
+        } else {
+            frame->overflow = true;
+        }
+    }
+
+    if (frame->count == 0) {
+        return false;
+    }
+    // a frame ends with a mark
+    if (frame->count % 2 == 0) {
+        frame->count--;
+    }
+    frame->maxLatency = s_relay.maxLatency.exchange(0);
+    return true;
+}
+
+uint32_t ir_relay_dropped_edges() {
+    return s_relay.dropped.load(std::memory_order_relaxed);
+}
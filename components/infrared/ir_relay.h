@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Low latency IR relay: the demodulated signal of the IR receiver is modulated again and mirrored on IR outputs.
+//
+// Every edge of the receiver output triggers a GPIO interrupt, which switches the output GPIOs between the carrier of
+// an LEDC channel (mark) and the idle GPIO output level (space) with the GPIO matrix. Marks and spaces are forwarded as
+// they arrive, the relay latency is the interrupt latency. The captured durations are collected in frames for
+// reporting.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#include "ir_codes.h"
+
+/// IR relay configuration.
+struct IrRelayConfig {
+    /// IR receiver GPIO. The receiver output is active low.
+    gpio_num_t input;
+    IrOutput   outputs[IR_MAX_OUTPUTS];
+    uint8_t    outputCount;
+    /// Carrier frequency in Hz.
+    uint32_t frequency;
+};
+
+/// Relayed IR frame.
+struct IrRelayFrame {
+    /// Number of captured durations: alternating mark and space durations in µs, starting and ending with a mark.
+    uint16_t count;
+    /// Frame has more durations than the capture buffer, the durations are truncated.
+    bool overflow;
+    /// Longest time in µs from entering the interrupt handler until all outputs were switched.
+    uint32_t maxLatency;
+};
+
+/// @brief Start relaying the IR receiver signal to the IR outputs.
+///
+/// Uses LEDC timer `LEDC_TIMER_3` and channel `LEDC_CHANNEL_7` for the carrier. The output GPIOs must not be used for
+/// sending IR while relaying.
+/// @return ESP_ERR_INVALID_STATE if the relay is already running.
+esp_err_t ir_relay_start(const IrRelayConfig *config);
+
+/// @brief Stop relaying and restore the IR outputs as regular GPIO outputs for `IRsend`.
+void ir_relay_stop();
+
+/// @brief Wait for the next relayed IR frame.
+///
+/// A frame ends if the receiver is idle for `gap` milliseconds after the last mark.
+/// @param durations capture buffer.
+/// @param size capacity of the capture buffer.
+/// @param gap frame gap in milliseconds.
+/// @param timeout maximum time to wait for the start of a frame.
+/// @param frame output frame information.
+/// @return false if no frame was received within `timeout`.
+bool ir_relay_read_frame(uint32_t *durations, uint16_t size, uint32_t gap, TickType_t timeout, IrRelayFrame *frame);
+
+/// @brief Number of edges dropped since the relay was started because the edge queue was full.
+///
+/// Dropped edges are still relayed, only the captured frame is discarded.
+uint32_t ir_relay_dropped_edges();
@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ir_rmt.h"
+
+#include "driver/gpio.h"
+#include "driver/rmt_tx.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "soc/gpio_struct.h"
+#include "soc/soc_caps.h"
+
+#include "mem_tag.h"
+
+static const char *const TAG = "IRRMT";
+
+// 1 tick = 1us
+#define IR_RMT_RESOLUTION_HZ 1000000
+// maximum duration of a symbol half: 15 bits
+#define IR_RMT_MAX_DURATION 0x7FFF
+#define IR_RMT_DUTY_CYCLE 0.33f
+
+struct IrRmtChannel {
+    rmt_channel_handle_t channel;
+    rmt_encoder_handle_t encoder;
+    rmt_symbol_word_t   *symbols;
+    size_t               symbolCount;
+    bool                 openDrain;
+};
+
+/// @brief Number of symbol halves: durations longer than a symbol half are split, zero durations are skipped.
+static size_t count_halves(const IrTimings *timings) {
+    size_t halves = 0;
+    for (uint16_t i = 0; i < timings->count; i++) {
+        halves += (timings->durations[i] + IR_RMT_MAX_DURATION - 1) / IR_RMT_MAX_DURATION;
+    }
+    return halves;
+}
+
+static void encode_symbols(const IrTimings *timings, rmt_symbol_word_t *symbols, size_t symbolCount) {
+    size_t half = 0;
+    for (uint16_t i = 0; i < timings->count; i++) {
+        // marks are at even indexes
+        uint32_t level = i % 2 == 0 ? 1 : 0;
+        uint32_t remaining = timings->durations[i];
+        while (remaining > 0) {
+            uint32_t duration = remaining > IR_RMT_MAX_DURATION ? IR_RMT_MAX_DURATION : remaining;
+            remaining -= duration;
+            rmt_symbol_word_t *symbol = &symbols[half / 2];
+            if (half % 2 == 0) {
+                symbol->duration0 = duration;
+                symbol->level0 = level;
+            } else {
+                symbol->duration1 = duration;
+                symbol->level1 = level;
+            }
+            half++;
+        }
+    }
+    if (half % 2) {
+        // a zero duration would be an end marker
+        symbols[symbolCount - 1].duration1 = 1;
+        symbols[symbolCount - 1].level1 = 0;
+    }
+}
+
+static esp_err_t create_channel(const IrRmtStream *stream, IrRmtChannel *ch) {
+    gpio_num_t gpio = static_cast<gpio_num_t>(stream->output.gpio);
+    size_t     halves = count_halves(stream->timings);
+    if (halves == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ch->symbolCount = (halves + 1) / 2;
+    // read by the RMT ISR: must be in internal RAM
+    ch->symbols =
+        static_cast<rmt_symbol_word_t *>(mem_tag_malloc(MEM_TAG_IR, ch->symbolCount * sizeof(rmt_symbol_word_t)));
+    if (!ch->symbols) {
+        return ESP_ERR_NO_MEM;
+    }
+    encode_symbols(stream->timings, ch->symbols, ch->symbolCount);
+
+    // keep the output driver configuration of the GPIO
+    ch->openDrain = GPIO.pin[gpio].pad_driver;
+
+    rmt_tx_channel_config_t config = {};
+    config.gpio_num = gpio;
+    config.clk_src = RMT_CLK_SRC_DEFAULT;
+    config.resolution_hz = IR_RMT_RESOLUTION_HZ;
+    config.mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL;
+    config.trans_queue_depth = 1;
+    config.flags.invert_out = stream->output.inverted;
+    config.flags.io_od_mode = ch->openDrain;
+    ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&config, &ch->channel), TAG, "Failed to create channel for GPIO %d", gpio);
+
+    rmt_carrier_config_t carrier = {};
+    carrier.frequency_hz = stream->timings->frequency;
+    carrier.duty_cycle = IR_RMT_DUTY_CYCLE;
+    ESP_RETURN_ON_ERROR(rmt_apply_carrier(ch->channel, &carrier), TAG, "Failed to set carrier");
+
+    rmt_copy_encoder_config_t encoderConfig = {};
+    ESP_RETURN_ON_ERROR(rmt_new_copy_encoder(&encoderConfig, &ch->encoder), TAG, "Failed to create encoder");
+
+    return rmt_enable(ch->channel);
+}
+
+static void delete_channel(const IrRmtStream *stream, IrRmtChannel *ch) {
+    if (ch->channel) {
+        rmt_disable(ch->channel);
+        rmt_del_channel(ch->channel);
+
+        // route the GPIO back to the GPIO output register used by IRsend
+        gpio_num_t gpio = static_cast<gpio_num_t>(stream->output.gpio);
+        gpio_set_direction(gpio, ch->openDrain ? GPIO_MODE_OUTPUT_OD : GPIO_MODE_OUTPUT);
+        gpio_set_level(gpio, stream->output.inverted ? 1 : 0);
+    }
+    if (ch->encoder) {
+        rmt_del_encoder(ch->encoder);
+    }
+    mem_tag_free(MEM_TAG_IR, ch->symbols);
+}
+
+esp_err_t ir_rmt_send(const IrRmtStream *streams, size_t count) {
+    if (count == 0 || count > IR_MAX_OUTPUTS || count > SOC_RMT_TX_CANDIDATES_PER_GROUP) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t                 ret = ESP_OK;
+    IrRmtChannel              channels[IR_MAX_OUTPUTS] = {};
+    rmt_channel_handle_t      handles[IR_MAX_OUTPUTS] = {};
+    rmt_sync_manager_handle_t sync = nullptr;
+    uint32_t                  maxDurationMs = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        ESP_GOTO_ON_ERROR(create_channel(&streams[i], &channels[i]), cleanup, TAG, "Failed to set up output %d",
+                          streams[i].output.gpio);
+        handles[i] = channels[i].channel;
+
+        uint64_t duration = 0;
+        for (uint16_t j = 0; j < streams[i].timings->count; j++) {
+            duration += streams[i].timings->durations[j];
+        }
+        if (duration / 1000 > maxDurationMs) {
+            maxDurationMs = duration / 1000;
+        }
+    }
+
+#if SOC_RMT_SUPPORT_TX_SYNCHRO
+    if (count > 1) {
+        rmt_sync_manager_config_t syncConfig = {};
+        syncConfig.tx_channel_array = handles;
+        syncConfig.array_size = count;
+        ESP_GOTO_ON_ERROR(rmt_new_sync_manager(&syncConfig, &sync), cleanup, TAG, "Failed to create sync manager");
+    }
+#endif
+
+    {
+        rmt_transmit_config_t txConfig = {};
+        txConfig.loop_count = 0;
+        txConfig.flags.eot_level = 0;
+        // with the sync manager, transmission starts when the last channel is started
+        for (size_t i = 0; i < count; i++) {
+            ESP_GOTO_ON_ERROR(rmt_transmit(channels[i].channel, channels[i].encoder, channels[i].symbols,
+                                           channels[i].symbolCount * sizeof(rmt_symbol_word_t), &txConfig),
+                              cleanup, TAG, "Failed to transmit");
+        }
+        for (size_t i = 0; i < count; i++) {
+            ESP_GOTO_ON_ERROR(rmt_tx_wait_all_done(channels[i].channel, maxDurationMs + 100), cleanup, TAG,
+                              "Failed to wait for transmission");
+        }
+    }
+
+cleanup:
+    if (sync) {
+        rmt_del_sync_manager(sync);
+    }
+    for (size_t i = 0; i < count; i++) {
+        delete_channel(&streams[i], &channels[i]);
+    }
+    return ret;
+}
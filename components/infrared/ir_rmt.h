@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Parallel IR sending of different IR timing streams with independent RMT TX channels.
+
+#pragma once
+
+#include <stddef.h>
+
+#include "esp_err.h"
+
+#include "ir_codes.h"
+
+/// IR timing stream to send on an IR output.
+struct IrRmtStream {
+    IrOutput         output;
+    const IrTimings *timings;
+};
+
+/// @brief Send IR timing streams simultaneously on different outputs.
+///
+/// An RMT TX channel with carrier modulation is created for every output, all channels start transmitting at the same
+/// time. The channels are released after sending and the GPIOs are restored as regular outputs for `IRsend`.
+/// This function blocks until all streams are sent.
+/// @param streams IR timing streams. Every stream must use a different output.
+/// @param count number of streams, at most `IR_MAX_OUTPUTS`.
+/// @return ESP_OK if all streams were sent.
+esp_err_t ir_rmt_send(const IrRmtStream *streams, size_t count);
@@ -9,7 +9,9 @@
 #include <IRutils.h>
 
 #include "esp_event.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/idf_additions.h"
 
 #include "IRrecv.h"
@@ -19,6 +21,15 @@
 #include "globalcache.h"
 #include "globalcache_server.h"
 #include "ir_codes.h"
+#include "ir_compact.h"
+#include "ir_fanout.h"
+#include "ir_relay.h"
+#include "ir_rmt.h"
+#include "ir_trace.h"
+#include "mem_tag.h"
+#include "metrics.h"
+#include "object_pool.h"
+#include "response_template.h"
 #include "sdkconfig.h"
 #include "uc_events.h"
 #include "util_types.h"
@@ -30,6 +41,7 @@ const char *irLogLearn = "IRLEARN";
 const int IR_LEARNING_BIT = BIT0;
 const int IR_REPEAT_BIT = BIT1;
 const int IR_REPEAT_STOP_BIT = BIT2;
+const int IR_RELAY_BIT = BIT3;
 
 // good explanation of IRrecv parameters:
 // https://github.com/crankyoldgit/IRremoteESP8266/blob/master/examples/IRrecvDumpV3/IRrecvDumpV3.ino
@@ -40,6 +52,254 @@ const uint16_t kFrequency = 38000;  // in Hz. e.g. 38kHz.
 // Set the smallest sized "UNKNOWN" message packets we actually care about.
 const uint16_t kMinUnknownSize = 12;
 
+static Counter irSendsHex("ucd_ir_sends_total", "Number of queued IR send requests", "format=\"hex\"");
+static Counter irSendsPronto("ucd_ir_sends_total", "Number of queued IR send requests", "format=\"pronto\"");
+static Counter irSendsGc("ucd_ir_sends_total", "Number of queued IR send requests", "format=\"gc\"");
+static Counter irSendsCompact("ucd_ir_sends_total", "Number of queued IR send requests", "format=\"compact\"");
+static Counter irSendsParallel("ucd_ir_sends_total", "Number of queued IR send requests", "format=\"parallel\"");
+static Counter irRepeats("ucd_ir_repeats_total", "Number of IR repeat requests for the active IR code");
+static Counter irBusy("ucd_ir_busy_total", "Number of rejected IR send requests while sending");
+static Counter irSendErrors("ucd_ir_send_errors_total", "Number of failed IR send operations");
+static Counter irHoldTimeouts("ucd_ir_hold_timeouts_total", "Number of IR repeat holds stopped without keep-alive");
+static Counter irCalibrations("ucd_ir_calibrations_total", "Number of IR carrier calibrations");
+static Counter irRelayStream("ucd_ir_relay_frames_total", "Number of relayed IR frames", "mode=\"stream\"");
+static Counter irRelayReencode("ucd_ir_relay_frames_total", "Number of relayed IR frames", "mode=\"reencode\"");
+static Counter irRelayDropped("ucd_ir_relay_dropped_total", "Number of received IR codes which couldn't be relayed");
+
+// bucket upper bounds in milliseconds
+static const uint32_t irQueueWaitBounds[] = {1, 2, 5, 10, 25, 50, 100};
+static const uint32_t irSendDurationBounds[] = {25, 50, 100, 250, 500, 1000, 2500, 5000};
+static HistogramN<7> irQueueWait("ucd_ir_queue_wait_ms", "Time from queuing an IR code until sending starts", nullptr,
+                                 irQueueWaitBounds);
+static HistogramN<8> irSendDuration("ucd_ir_send_duration_ms", "IR send duration including repeats", nullptr,
+                                    irSendDurationBounds);
+// bucket upper bounds in microseconds
+static const uint32_t irRelayLatencyBounds[] = {2, 5, 10, 20, 50, 100};
+static HistogramN<6>  irRelayLatency("ucd_ir_relay_latency_us", "Longest output switching time of a relayed IR frame",
+                                     nullptr, irRelayLatencyBounds);
+
+// Send message pool: one message in the send queue, one more for concurrent send requests from the web server and
+// the GC server task. The IR code of a message is stored in the code slab at the message's pool index.
+#define IR_SEND_POOL_SIZE 2
+static ObjectPool<IRSendMessage, IR_SEND_POOL_SIZE>             irSendPool;
+static ObjectPool<IrResponse, CONFIG_UCD_IR_RESPONSE_POOL_SIZE> irResponsePool;
+// GlobalCache codes are parsed into uint16_t arrays in the code buffers
+static_assert(CONFIG_UCD_IR_CODE_MAX_LENGTH % 2 == 0, "CONFIG_UCD_IR_CODE_MAX_LENGTH must be even");
+
+// IR receivers demodulate the signal: the carrier frequency of learned IR codes is unknown
+#define IR_LEARN_FREQUENCY 38000
+
+// IRsend can't generate higher carrier frequencies accurately, e.g. 455 kHz Bang & Olufsen codes. These IR codes are
+// sent with RMT.
+#define IR_BITBANG_MAX_CARRIER 100000
+
+/// @brief IRsend with a settable carrier period offset. IRsend only sets the offset in `calibrate`.
+class CalibratedIRsend : public IRsend {
+ public:
+    using IRsend::IRsend;
+
+    /// Set the period offset of a previous calibration. Applied with the next `enableIROut`.
+    void setPeriodOffset(int8_t offset) { periodOffset = offset; }
+};
+
+// IRsend calibrations per carrier frequency, only used in the IR send task.
+static IrCalibrationCache irCalibrationCache;
+// carrier frequency group of the active IRsend period offset
+static uint16_t irCalibratedKey = 0;
+
+/// @brief Set the IRsend period offset for the carrier frequency of the next IR code.
+///
+/// The period offset is calibrated once per carrier frequency group and then restored from the calibration cache.
+static void calibrateCarrier(CalibratedIRsend &irsend, uint32_t frequency, const GpioPinMask &pinMask) {
+    uint16_t key = IrCalibrationCache::key(frequency);
+    if (frequency == 0 || frequency > UINT16_MAX || key == irCalibratedKey) {
+        return;
+    }
+
+    int8_t offset;
+    if (irCalibrationCache.get(frequency, &offset)) {
+        irsend.setPeriodOffset(offset);
+        irCalibratedKey = key;
+        return;
+    }
+
+    // calibration generates a 65ms carrier signal: disable all outputs
+    if (!irsend.setPinMask(0, 0)) {
+        ESP_LOGW(irLogSend, "Failed to disable outputs for calibration");
+        return;
+    }
+    offset = irsend.calibrate(frequency);
+    irsend.setPinMask(pinMask.w1ts, pinMask.w1tc);
+
+    irCalibrationCache.put(frequency, offset);
+    irCalibratedKey = key;
+    irCalibrations.inc();
+    ESP_LOGI(irLogSend, "IR calibration for %luHz, calculated period offset: %dus", frequency, offset);
+}
+
+/// @brief Send an IR timing stream on all outputs of the pin mask with RMT.
+static bool sendWithRmt(const GpioPinMask &pinMask, const IrTimings *timings) {
+    IrRmtStream streams[IR_MAX_OUTPUTS];
+    size_t      count = 0;
+    for (int8_t gpio = 0; gpio < 64 && count < IR_MAX_OUTPUTS; gpio++) {
+        uint64_t bit = 1ULL << gpio;
+        if ((pinMask.w1ts | pinMask.w1tc) & bit) {
+            // inverted outputs are switched on by clearing the GPIO
+            streams[count].output = {gpio, (pinMask.w1tc & bit) != 0};
+            streams[count].timings = timings;
+            count++;
+        }
+    }
+
+    esp_err_t err = ir_rmt_send(streams, count);
+    if (err != ESP_OK) {
+        ESP_LOGE(irLogSend, "failed to send IR code with RMT: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+/// @brief Send an IR timing stream with IRsend.
+static void sendTimings(IRsend &irsend, const IrTimings *timings) {
+    for (uint16_t i = 0; i < timings->count; i++) {
+        if (i % 2 == 0) {
+            irsend.mark(timings->durations[i]);
+        } else {
+            irsend.space(timings->durations[i]);
+        }
+    }
+}
+
+/// @brief Send an intro sequence once, followed by the repeat sequence for as long as the repeat callback requests
+/// it, e.g. while a button is held.
+/// @param repeatCallback IR repeat callback, nullptr if the IR repeat is not active.
+static void sendIntroRepeat(IRsend &irsend, const IrTimings *intro, const IrTimings *repeat,
+                            const std::function<bool()> *repeatCallback) {
+    irsend.enableIROut(intro->frequency);
+    sendTimings(irsend, intro);
+    while (repeatCallback && (*repeatCallback)()) {
+        sendTimings(irsend, repeat);
+    }
+}
+
+/// @brief Send the intro sequence of a PRONTO code once, followed by the repeat sequence while the IR repeat is active.
+static bool sendProntoRepeat(IRsend &irsend, const uint16_t *code, uint16_t count,
+                             const std::function<bool()> &repeatCallback) {
+    IrTimings intro = {};
+    IrTimings repeat = {};
+    bool      success = prontoSequenceToTimings(code, count, false, &intro) &&
+                        prontoSequenceToTimings(code, count, true, &repeat);
+    if (success) {
+        sendIntroRepeat(irsend, &intro, &repeat, &repeatCallback);
+    }
+    freeTimings(&intro);
+    freeTimings(&repeat);
+    return success;
+}
+
+/// @brief Send a compact IR code: the intro sequence once, followed by the repeat sequence while the IR repeat is
+/// active.
+static bool sendCompact(CalibratedIRsend &irsend, const IRSendMessage *message, const std::function<bool()> *repeatCallback) {
+    IrCompactCode *code = static_cast<IrCompactCode *>(mem_tag_malloc(MEM_TAG_IR, sizeof(IrCompactCode)));
+    if (code == nullptr) {
+        ESP_LOGE(irLogSend, "failed to allocate compact code");
+        return false;
+    }
+    if (!irCompactParse(message->message, code)) {
+        ESP_LOGW(irLogSend, "failed to parse compact code");
+        mem_tag_free(MEM_TAG_IR, code);
+        return false;
+    }
+
+    IrTimings intro = {};
+    IrTimings repeat = {};
+    bool      success;
+    if (code->frequency > IR_BITBANG_MAX_CARRIER) {
+        ir_trace_point(message->traceId, IrTracePoint::FIRST_MARK);
+        success = irCompactToTimings(code, message->repeat, &intro) && sendWithRmt(message->pin_mask, &intro);
+    } else {
+        success =
+            irCompactSequenceToTimings(code, false, &intro) && irCompactSequenceToTimings(code, true, &repeat);
+        if (success) {
+            calibrateCarrier(irsend, code->frequency, message->pin_mask);
+            ir_trace_point(message->traceId, IrTracePoint::FIRST_MARK);
+            sendIntroRepeat(irsend, &intro, &repeat, repeatCallback);
+        }
+    }
+
+    freeTimings(&intro);
+    freeTimings(&repeat);
+    mem_tag_free(MEM_TAG_IR, code);
+    return success;
+}
+
+/// @brief Normalize the raw timings of an unknown learned IR code to the compact IR code format.
+/// @return false if the timings can't be normalized or the code can't be sent, i.e. it's not shorter than
+///         CONFIG_UCD_IR_CODE_MAX_LENGTH.
+static bool learnCompactCode(const decode_results *results, std::string *compactCode) {
+    uint16_t       length = getCorrectedRawLength(results);
+    uint32_t      *durations = static_cast<uint32_t *>(mem_tag_malloc(MEM_TAG_IR, length * sizeof(uint32_t)));
+    IrCompactCode *code = static_cast<IrCompactCode *>(mem_tag_malloc(MEM_TAG_IR, sizeof(IrCompactCode)));
+    char          *buf = static_cast<char *>(mem_tag_malloc(MEM_TAG_IR, CONFIG_UCD_IR_CODE_MAX_LENGTH));
+    bool           success = false;
+
+    if (durations && code && buf) {
+        uint16_t *raw = resultToRawArray(results);
+        for (uint16_t i = 0; i < length; i++) {
+            durations[i] = raw[i];
+        }
+        delete[] raw;
+        success = irCompactFromTimings(durations, length, IR_LEARN_FREQUENCY, code) &&
+                  irCompactFormat(code, buf, CONFIG_UCD_IR_CODE_MAX_LENGTH) > 0;
+        if (success) {
+            *compactCode = buf;
+        }
+    }
+
+    mem_tag_free(MEM_TAG_IR, buf);
+    mem_tag_free(MEM_TAG_IR, code);
+    mem_tag_free(MEM_TAG_IR, durations);
+    return success;
+}
+
+/// @brief Send the raw timings of a learned IR code in sendir format to a GlobalCache client.
+static void sendGcLearnedCode(int socket, const decode_results *results) {
+    uint16_t length = getCorrectedRawLength(results);
+    // sendir prefix and header, at most 6 characters per carrier cycle count and the trailing gap
+    size_t size = 40 + (length + 1) * 6;
+    char  *buf = static_cast<char *>(mem_tag_malloc(MEM_TAG_IR, size));
+    if (buf == nullptr) {
+        ESP_LOGE(irLogLearn, "Not enough memory for learned GC code");
+        return;
+    }
+
+    uint16_t *raw = resultToRawArray(results);
+    int       len = formatGcSendIr(raw, length, IR_LEARN_FREQUENCY, buf, size - 1);
+    delete[] raw;
+    if (len > 0) {
+        buf[len] = '\r';
+        buf[len + 1] = 0;
+        if (!send_string_to_socket(socket, buf)) {
+            ESP_LOGW(irLogLearn, "[%d] Failed to send learned GC code", socket);
+        }
+    } else {
+        ESP_LOGW(irLogLearn, "Learned code can't be converted to GC format: %u timings", length);
+    }
+    mem_tag_free(MEM_TAG_IR, buf);
+}
+
+static void write_pool_metrics(std::string &out) {
+    metrics_write_header(out, "ucd_pool_size", "Number of objects in a fixed size pool", MetricType::GAUGE);
+    metrics_write_sample(out, "ucd_pool_size", "pool=\"ir_send\"", irSendPool.capacity());
+    metrics_write_sample(out, "ucd_pool_size", "pool=\"ir_response\"", irResponsePool.capacity());
+    metrics_write_header(out, "ucd_pool_used", "Number of used objects in a fixed size pool", MetricType::GAUGE);
+    metrics_write_sample(out, "ucd_pool_used", "pool=\"ir_send\"", irSendPool.used());
+    metrics_write_sample(out, "ucd_pool_used", "pool=\"ir_response\"", irResponsePool.used());
+    metrics_write_header(out, "ucd_pool_exhausted_total", "Number of failed pool allocations", MetricType::COUNTER);
+    metrics_write_sample(out, "ucd_pool_exhausted_total", "pool=\"ir_send\"", irSendPool.exhausted());
+    metrics_write_sample(out, "ucd_pool_exhausted_total", "pool=\"ir_response\"", irResponsePool.exhausted());
+}
+
 void InfraredService::init(port_map_t ports, uint16_t sendCore, uint16_t sendPriority, uint16_t learnCore,
                            uint16_t learnPriority, IrResponseCallback responseCallback) {
     if (m_eventgroup) {
@@ -50,6 +310,15 @@ void InfraredService::init(port_map_t ports, uint16_t sendCore, uint16_t sendPri
     ports_ = ports;
     m_responseCallback = responseCallback;
 
+    // IR codes are only parsed, not read in the timing critical send loop: prefer PSRAM
+    m_codeSlab = static_cast<char *>(heap_caps_malloc_prefer(
+        IR_SEND_POOL_SIZE * CONFIG_UCD_IR_CODE_MAX_LENGTH, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+        MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    if (m_codeSlab == nullptr) {
+        ESP_LOGE(irLog, "Failed to allocate IR code buffers");
+        return;
+    }
+
     m_queue = xQueueCreate(1, sizeof(struct IRSendMessage *));
     if (m_queue == nullptr) {
         ESP_LOGE(irLog, "xQueueCreate failed");
@@ -60,6 +329,9 @@ void InfraredService::init(port_map_t ports, uint16_t sendCore, uint16_t sendPri
         ESP_LOGE(irLog, "xEventGroupCreate failed");
         return;
     }
+    if (!MetricsRegistry::instance().addCollector(write_pool_metrics)) {
+        ESP_LOGW(irLog, "Failed to register pool metrics");
+    }
     if (sendCore > 1) {
         sendCore = 1;
     }
@@ -105,20 +377,33 @@ void InfraredService::setIrLearnPriority(uint16_t priority) {
     }
 }
 
-void InfraredService::startIrLearn() {
+void InfraredService::startIrLearn(int gcSocket) {
     // Note: UC_EVENT_IR_LEARNING_START event is sent when the learning loop starts
     if (m_eventgroup) {
+        if (gcSocket > 0) {
+            // only one iTach client receives the learned codes, the last one enabling the IR learner
+            m_gcLearnSocket.store(gcSocket);
+        }
+        // the IR receiver is either used for learning or relaying
+        xEventGroupClearBits(m_eventgroup, IR_RELAY_BIT);
         xEventGroupSetBits(m_eventgroup, IR_LEARNING_BIT);
     }
 }
 
 void InfraredService::stopIrLearn() {
     // Note: UC_EVENT_IR_LEARNING_STOP event is sent after the learning loop stops
+    m_gcLearnSocket.store(0);
     if (m_eventgroup) {
         xEventGroupClearBits(m_eventgroup, IR_LEARNING_BIT);
     }
 }
 
+void InfraredService::stopGcIrLearn(int gcSocket) {
+    if (gcSocket > 0 && m_gcLearnSocket.compare_exchange_strong(gcSocket, 0)) {
+        stopIrLearn();
+    }
+}
+
 bool InfraredService::isIrLearning() {
     if (!m_eventgroup) {
         return false;
@@ -126,52 +411,85 @@ bool InfraredService::isIrLearning() {
     return xEventGroupGetBits(m_eventgroup) & IR_LEARNING_BIT;
 }
 
-uint16_t InfraredService::sendGlobalCache(int16_t clientId, uint32_t msgId, const char *sendir, int socket) {
-    // module is always 1 (emulating an iTach device)
-    if (strncmp(sendir, "sendir,1:", 9) != 0) {
-        return 2;  // invalid module address
+uint16_t InfraredService::startIrRelay(const IrRelaySettings &settings) {
+    if (!m_eventgroup) {
+        return 500;
+    }
+    if (isIrLearning() || isIrRelaying()) {
+        return 503;  // service unavailable
     }
 
-    // ID
-    char *next = strchr(sendir + 9, ',');
-    if (next == NULL) {
-        return 4;  // invalid ID
+    IrOutput outputs[IR_MAX_OUTPUTS];
+    if (getIrOutputs(settings.internal_side, settings.internal_top, settings.external1, settings.external2, outputs) ==
+        0) {
+        ESP_LOGW(irLog, "No relay output specified");
+        return 400;
     }
-    auto port = atoi(sendir + 9);
-    if (port < 1 || port > 15) {
-        return 3;  // invalid port address
+    if (settings.mode == IrRelayMode::STREAM && (settings.frequency < 15000 || settings.frequency > 500000)) {
+        ESP_LOGW(irLog, "Invalid relay carrier frequency: %lu", settings.frequency);
+        return 400;
     }
 
-    // frequency
-    next = strchr(next + 1, ',');
-    if (next == NULL) {
-        return 5;  // invalid frequency
+    // the relay loop reads the settings after the relay bit is set
+    m_relay = settings;
+    xEventGroupSetBits(m_eventgroup, IR_RELAY_BIT);
+    return 200;
+}
+
+void InfraredService::stopIrRelay() {
+    if (m_eventgroup) {
+        xEventGroupClearBits(m_eventgroup, IR_RELAY_BIT);
     }
-    // repeat
-    next = strchr(next + 1, ',');
-    if (next == NULL) {
-        return 6;  // invalid repeat
+}
+
+bool InfraredService::isIrRelaying() {
+    if (!m_eventgroup) {
+        return false;
+    }
+    return xEventGroupGetBits(m_eventgroup) & IR_RELAY_BIT;
+}
+
+bool InfraredService::isRelayStreaming() {
+    return isIrRelaying() && m_relay.mode == IrRelayMode::STREAM;
+}
+
+uint16_t InfraredService::sendGlobalCache(int16_t clientId, uint32_t msgId, const char *sendir, int socket) {
+    if (!m_queue || !m_eventgroup || !m_codeSlab) {
+        return 500;
+    }
+
+    if (isIrLearning() || isRelayStreaming()) {
+        return 503;  // service unavailable
+    }
+
+    // module is always 1 (emulating an iTach device)
+    if (strncmp(sendir, "sendir,", 7) != 0) {
+        return 2;  // invalid module address
     }
 
-    int16_t repeat = atoi(next + 1);
-    if (repeat < 1 || repeat > 50) {
-        return 6;  // invalid repeat
+    IRSendMessage *pxMessage = nullptr;
+    uint16_t       ret = acquireGcMessage(sendir, &pxMessage);
+    if (ret != 0) {
+        return ret;
     }
 
-    std::string code = sendir;
-    std::string format = "gc";
+    uint8_t     port = pxMessage->gc.port;
+    GpioPinMask pin_mask = createIrPinMask(port & 1, port & 8, port & 2, port & 4);
+    pxMessage->clientId = clientId;
+    pxMessage->msgId = msgId;
+    pxMessage->gcSocket = socket;
 
-    return send(clientId, msgId, code, format, repeat, port & 1, port & 8, port & 2, port & 4, socket);
+    return queueParsedMessage(pxMessage, pxMessage->gc.repeat, pin_mask, nullptr);
 }
 
-uint16_t InfraredService::send(int16_t clientId, uint32_t msgId, const std::string &code, const std::string &format,
-                               uint16_t repeat, bool internal_side, bool internal_top, bool external1, bool external2,
-                               int gcSocket) {
-    if (!m_queue || !m_eventgroup) {
+uint16_t InfraredService::send(int16_t clientId, uint32_t msgId, const char *code, const char *format, uint16_t repeat,
+                               bool internal_side, bool internal_top, bool external1, bool external2, int gcSocket,
+                               uint16_t *holdHandle) {
+    if (!m_queue || !m_eventgroup || !m_codeSlab) {
         return 500;
     }
 
-    if (isIrLearning()) {
+    if (isIrLearning() || isRelayStreaming()) {
         return 503;  // service unavailable
     }
 
@@ -182,58 +500,361 @@ uint16_t InfraredService::send(int16_t clientId, uint32_t msgId, const std::stri
     }
 
     IRFormat irFormat;
-    if (format == "hex") {
+    if (strcmp(format, "hex") == 0) {
         irFormat = IRFormat::UNFOLDED_CIRCLE;
-    } else if (format == "pronto") {
+    } else if (strcmp(format, "pronto") == 0) {
         irFormat = IRFormat::PRONTO;
-    } else if (format == "gc") {
+    } else if (strcmp(format, "gc") == 0) {
         irFormat = IRFormat::GLOBAL_CACHE;
+    } else if (strcmp(format, "compact") == 0) {
+        irFormat = IRFormat::COMPACT;
     } else {
-        ESP_LOGW(irLog, "Invalid format: '%s'", format.c_str());
+        ESP_LOGW(irLog, "Invalid format: '%s'", format);
         return 400;
     }
 
-    bool sending = uxQueueMessagesWaiting(m_queue) > 0;
+    size_t codeLength = strlen(code);
+    if (codeLength >= CONFIG_UCD_IR_CODE_MAX_LENGTH) {
+        ESP_LOGW(irLog, "IR code too long: %zu", codeLength);
+        return 400;
+    }
 
-    // #30 handle IR repeat if it's the same command. This is a very simple, initial implementation (ignore repeat val)
-    if (sending && repeat > 0 && m_currentSendCode == code) {
-        ESP_LOGI(irLog, "detected IR repeat for last IR send command (%d)", repeat);
-        xEventGroupSetBits(m_eventgroup, IR_REPEAT_BIT);
+    if (irFormat == IRFormat::GLOBAL_CACHE) {
+        IRSendMessage *pxMessage = nullptr;
+        uint16_t       ret = acquireGcMessage(code, &pxMessage);
+        if (ret != 0) {
+            if (ret < 100) {
+                ESP_LOGW(irLog, "Invalid GC code: error %u", ret);
+                ret = 400;
+            }
+            return ret;
+        }
+        pxMessage->clientId = clientId;
+        pxMessage->msgId = msgId;
+        pxMessage->gcSocket = gcSocket;
+        return queueParsedMessage(pxMessage, repeat, pin_mask, holdHandle);
+    }
+    if (irFormat == IRFormat::PRONTO) {
+        IRSendMessage *pxMessage = nullptr;
+        uint16_t       ret = acquireProntoMessage(code, &pxMessage);
+        if (ret != 0) {
+            return ret;
+        }
+        pxMessage->clientId = clientId;
+        pxMessage->msgId = msgId;
+        pxMessage->gcSocket = gcSocket;
+        return queueParsedMessage(pxMessage, repeat, pin_mask, holdHandle);
+    }
+
+    // The active message stays in the queue until sending is finished.
+    // Note: the message might be released by the IR send task right after peeking. The code buffer remains valid, the
+    // worst case is a missed repeat, which is then rejected with 429.
+    IRSendMessage *current = nullptr;
+    bool           sending = xQueuePeek(m_queue, &current, 0) == pdTRUE;
 
-        return 202;  // accepted IR repeat
+    // #30 handle IR repeat if it's the same command. This is a very simple, initial implementation (ignore repeat val)
+    if (sending && repeat > 0 && current->format == irFormat && strcmp(current->message, code) == 0) {
+        return acceptRepeat(current, repeat, holdHandle);
     }
 
     // try to save an allocation if still sending an IR code
     if (sending) {
+        irBusy.inc();
         return 429;  // too many requests
     }
 
     // new code, clear repeat flags
     xEventGroupClearBits(m_eventgroup, IR_REPEAT_BIT | IR_REPEAT_STOP_BIT);
 
-    struct IRSendMessage *pxMessage = new IRSendMessage();
+    struct IRSendMessage *pxMessage = irSendPool.acquire();
+    if (pxMessage == nullptr) {
+        // concurrent send request
+        irBusy.inc();
+        return 429;
+    }
     pxMessage->clientId = clientId;
     pxMessage->msgId = msgId;
     pxMessage->format = irFormat;
-    pxMessage->message = code;
+    pxMessage->message = m_codeSlab + irSendPool.index(pxMessage) * CONFIG_UCD_IR_CODE_MAX_LENGTH;
+    memcpy(pxMessage->message, code, codeLength + 1);
     pxMessage->repeat = repeat;
     pxMessage->pin_mask = pin_mask;
     pxMessage->gcSocket = gcSocket;
 
-    if (xQueueSendToBack(m_queue, reinterpret_cast<void *>(&pxMessage), 0) == errQUEUE_FULL) {
-        // This should never happen with the pre-check!
-        delete pxMessage;
+    return queueHoldMessage(pxMessage, holdHandle);
+}
+
+uint16_t InfraredService::acquireGcMessage(const char *code, IRSendMessage **message) {
+    IRSendMessage *pxMessage = irSendPool.acquire();
+    if (pxMessage == nullptr) {
+        // concurrent send request
+        irBusy.inc();
+        return 429;
+    }
+
+    // Parse the code directly into the code buffer of the pool slot: the code array always fits, N values require at
+    // least 2N-1 characters.
+    char    *buffer = m_codeSlab + irSendPool.index(pxMessage) * CONFIG_UCD_IR_CODE_MAX_LENGTH;
+    uint8_t  ret = parseGcSendIr(code, &pxMessage->gc, reinterpret_cast<uint16_t *>(buffer),
+                                 CONFIG_UCD_IR_CODE_MAX_LENGTH / sizeof(uint16_t));
+    if (ret != 0) {
+        irSendPool.release(pxMessage);
+        return ret;
+    }
+
+    pxMessage->format = IRFormat::GLOBAL_CACHE;
+    pxMessage->message = buffer;
+    *message = pxMessage;
+    return 0;
+}
+
+uint16_t InfraredService::acquireProntoMessage(const char *code, IRSendMessage **message) {
+    IRSendMessage *pxMessage = irSendPool.acquire();
+    if (pxMessage == nullptr) {
+        // concurrent send request
+        irBusy.inc();
+        return 429;
+    }
+
+    // Same as GlobalCache codes: N values require at least 2N-1 characters.
+    char *buffer = m_codeSlab + irSendPool.index(pxMessage) * CONFIG_UCD_IR_CODE_MAX_LENGTH;
+    if (!parseProntoCode(code, 0, reinterpret_cast<uint16_t *>(buffer),
+                         CONFIG_UCD_IR_CODE_MAX_LENGTH / sizeof(uint16_t), &pxMessage->pronto)) {
+        irSendPool.release(pxMessage);
+        ESP_LOGW(irLog, "Invalid PRONTO code");
+        return 400;
+    }
+
+    pxMessage->format = IRFormat::PRONTO;
+    pxMessage->message = buffer;
+    *message = pxMessage;
+    return 0;
+}
+
+uint16_t InfraredService::queueParsedMessage(IRSendMessage *message, uint16_t repeat, GpioPinMask pin_mask,
+                                         uint16_t *holdHandle) {
+    // same IR repeat handling as in `send`, but comparing the parsed codes
+    IRSendMessage *current = nullptr;
+    bool           sending = xQueuePeek(m_queue, &current, 0) == pdTRUE;
+
+    if (sending && repeat > 0 && current->format == message->format &&
+        (message->format == IRFormat::GLOBAL_CACHE ? gcSendIrEqual(&current->gc, &message->gc)
+                                                   : prontoCodeEqual(&current->pronto, &message->pronto))) {
+        irSendPool.release(message);
+        return acceptRepeat(current, repeat, holdHandle);
+    }
+
+    if (sending) {
+        irSendPool.release(message);
+        irBusy.inc();
+        return 429;  // too many requests
+    }
+
+    // new code, clear repeat flags
+    xEventGroupClearBits(m_eventgroup, IR_REPEAT_BIT | IR_REPEAT_STOP_BIT);
+
+    message->repeat = repeat;
+    message->pin_mask = pin_mask;
+    return queueHoldMessage(message, holdHandle);
+}
+
+uint16_t InfraredService::acceptRepeat(const IRSendMessage *current, uint16_t repeat, uint16_t *holdHandle) {
+    if (holdHandle) {
+        // the client keeps the repeat alive with the handle of the active hold. It's published by the IR send task when
+        // the message is dequeued, until then it's only set in the queued message.
+        *holdHandle = m_holdHandle.load();
+        if (*holdHandle == 0) {
+            *holdHandle = current->holdHandle;
+        }
+        if (*holdHandle == 0) {
+            ESP_LOGW(irLog, "Cannot hold active IR code: not sent with hold");
+            return 409;  // conflict
+        }
+    }
+    ESP_LOGI(irLog, "detected IR repeat for last IR send command (%d)", repeat);
+    m_holdKeepAlive.store(xTaskGetTickCount());
+    xEventGroupSetBits(m_eventgroup, IR_REPEAT_BIT);
+    irRepeats.inc();
+
+    return 202;  // accepted IR repeat
+}
+
+uint16_t InfraredService::queueHoldMessage(IRSendMessage *message, uint16_t *holdHandle) {
+    message->holdHandle = 0;
+
+    if (holdHandle) {
+        uint16_t handle = m_nextHoldHandle.fetch_add(1);
+        if (handle == 0) {
+            handle = m_nextHoldHandle.fetch_add(1);
+        }
+        // published by the IR send task when the message is dequeued, together with starting the keep-alive timeout
+        message->holdHandle = handle;
+        *holdHandle = handle;
+    }
+
+    return queueMessage(message);
+}
+
+uint16_t InfraredService::sendParallel(int16_t clientId, uint32_t msgId, const IrParallelCode *codes, size_t count,
+                                       uint16_t repeat) {
+    if (!m_queue || !m_eventgroup || !m_codeSlab) {
+        return 500;
+    }
+    if (count == 0 || count > IR_PARALLEL_MAX_CODES) {
+        ESP_LOGW(irLog, "Invalid number of parallel IR codes: %zu", count);
+        return 400;
+    }
+    if (isIrLearning() || isRelayStreaming()) {
+        return 503;  // service unavailable
+    }
+
+    IrParallelPart parts[IR_PARALLEL_MAX_CODES];
+    uint8_t        usedOutputs = 0;
+    size_t         length = 0;
+    for (size_t i = 0; i < count; i++) {
+        const IrParallelCode &code = codes[i];
+        IrParallelPart       &part = parts[i];
+        // only timing based formats, IR protocols are encoded in IRsend
+        if (strcmp(code.format, "pronto") == 0) {
+            part.format = IRFormat::PRONTO;
+        } else if (strcmp(code.format, "gc") == 0) {
+            part.format = IRFormat::GLOBAL_CACHE;
+        } else {
+            ESP_LOGW(irLog, "Invalid format for parallel sending: '%s'", code.format);
+            return 400;
+        }
+
+        // outputs must not be shared between IR codes
+        uint8_t outputs = (code.internal_side ? 1 : 0) | (code.internal_top ? 2 : 0) | (code.external1 ? 4 : 0) |
+                          (code.external2 ? 8 : 0);
+        if (outputs & usedOutputs) {
+            ESP_LOGW(irLog, "IR output used by multiple IR codes");
+            return 400;
+        }
+        usedOutputs |= outputs;
+
+        part.outputCount =
+            getIrOutputs(code.internal_side, code.internal_top, code.external1, code.external2, part.outputs);
+        if (part.outputCount == 0) {
+            ESP_LOGW(irLog, "No output available for parallel IR code %zu", i);
+            return 400;
+        }
+
+        part.offset = length;
+        length += strlen(code.code) + 1;
+        if (length > CONFIG_UCD_IR_CODE_MAX_LENGTH) {
+            ESP_LOGW(irLog, "IR codes too long");
+            return 400;
+        }
+    }
+
+    if (uxQueueMessagesWaiting(m_queue) > 0) {
+        irBusy.inc();
+        return 429;  // too many requests
+    }
+
+    struct IRSendMessage *pxMessage = irSendPool.acquire();
+    if (pxMessage == nullptr) {
+        irBusy.inc();
+        return 429;
+    }
+    pxMessage->clientId = clientId;
+    pxMessage->msgId = msgId;
+    pxMessage->format = IRFormat::PARALLEL;
+    pxMessage->message = m_codeSlab + irSendPool.index(pxMessage) * CONFIG_UCD_IR_CODE_MAX_LENGTH;
+    pxMessage->repeat = repeat;
+    pxMessage->holdHandle = 0;
+    pxMessage->partCount = count;
+    for (size_t i = 0; i < count; i++) {
+        pxMessage->parts[i] = parts[i];
+        strcpy(pxMessage->message + parts[i].offset, codes[i].code);
+    }
+
+    return queueMessage(pxMessage);
+}
+
+uint16_t InfraredService::queueMessage(IRSendMessage *message) {
+    message->queuedAt = esp_timer_get_time();
+    message->traceId = ir_trace_begin();
+    // recorded before queuing: the IR send task on the other core might dequeue the message immediately
+    ir_trace_point(message->traceId, IrTracePoint::ENQUEUED);
+
+    if (xQueueSendToBack(m_queue, reinterpret_cast<void *>(&message), 0) == errQUEUE_FULL) {
+        // concurrent send request
+        irSendPool.release(message);
+        irBusy.inc();
         return 429;
     }
 
     ESP_LOGD(irLog, "queued IRSendMessage");
 
-    m_currentSendCode = code;
+    switch (message->format) {
+        case IRFormat::UNFOLDED_CIRCLE:
+            irSendsHex.inc();
+            break;
+        case IRFormat::PRONTO:
+            irSendsPronto.inc();
+            break;
+        case IRFormat::GLOBAL_CACHE:
+            irSendsGc.inc();
+            break;
+        case IRFormat::PARALLEL:
+            irSendsParallel.inc();
+            break;
+        case IRFormat::COMPACT:
+            irSendsCompact.inc();
+            break;
+        default:
+            break;
+    }
 
     // 0 = asynchronous reply from the the IR send task
     return 0;
 }
 
+void InfraredService::releaseResponse(IrResponse *response) {
+    if (response && response->message != response->buffer) {
+        cJSON_free(response->message);
+    }
+    irResponsePool.release(response);
+}
+
+IrResponse *InfraredService::acquireResponse(int16_t clientId) {
+    IrResponse *response = irResponsePool.acquire();
+    if (response == nullptr) {
+        ESP_LOGW(irLog, "Response pool exhausted, dropping message for client %d", clientId);
+        return nullptr;
+    }
+    response->clientId = clientId;
+    return response;
+}
+
+bool InfraredService::printResponse(IrResponse *response, const cJSON *json) {
+    char *message = cJSON_PrintUnformatted(json);
+    if (message == nullptr) {
+        ESP_LOGE(irLog, "Not enough memory for IR response");
+        return false;
+    }
+    size_t length = strlen(message);
+    if (length < sizeof(response->buffer)) {
+        memcpy(response->buffer, message, length + 1);
+        cJSON_free(message);
+    } else {
+        // long IR code: the message is released with the response
+        response->message = message;
+    }
+    return true;
+}
+
+uint16_t InfraredService::holdRepeat(uint16_t handle) {
+    if (handle == 0 || handle != m_holdHandle.load()) {
+        return 404;
+    }
+    m_holdKeepAlive.store(xTaskGetTickCount());
+    irRepeats.inc();
+    return 200;
+}
+
 void InfraredService::stopSend() {
     if (!m_eventgroup) {
         return;
@@ -324,6 +945,36 @@ GpioPinMask InfraredService::createIrPinMask(bool internal_side, bool internal_t
     return mask;
 }
 
+uint8_t InfraredService::getIrOutputs(bool internal_side, bool internal_top, bool external1, bool external2,
+                                      IrOutput *outputs) {
+    uint8_t count = 0;
+
+    if (internal_side) {
+        outputs[count++] = {static_cast<int8_t>(IR_SEND_PIN_INT_SIDE), IR_SEND_PIN_INT_SIDE_INVERTED != 0};
+    }
+#ifdef IR_SEND_PIN_INT_TOP
+    if (internal_top) {
+        outputs[count++] = {static_cast<int8_t>(IR_SEND_PIN_INT_TOP), IR_SEND_PIN_INT_TOP_INVERTED != 0};
+    }
+#endif
+    if (external1) {
+        auto ext_port = ports_.at(1);
+        if (ext_port && ext_port->getIrGpio() != GPIO_NUM_NC) {
+            outputs[count++] = {static_cast<int8_t>(ext_port->getIrGpio()), ext_port->isIrGpioInverted()};
+        }
+    }
+#ifdef SWITCH_EXT_2
+    if (external2) {
+        auto ext_port = ports_.at(2);
+        if (ext_port && ext_port->getIrGpio() != GPIO_NUM_NC) {
+            outputs[count++] = {static_cast<int8_t>(ext_port->getIrGpio()), ext_port->isIrGpioInverted()};
+        }
+    }
+#endif
+
+    return count;
+}
+
 void InfraredService::rebootIfMemError(int memError) {
     // Check we malloc'ed successfully.
     if (memError == 1) {  // malloc failed, so give up.
@@ -349,10 +1000,12 @@ void InfraredService::send_ir_f(void *param) {
     bool modulation = true;
     // used default output to initialize, active outputs are set with `setPinMask` before calling send
     uint64_t w1ts_mask = 1ULL << IR_SEND_PIN_INT_SIDE;
-    IRsend   irsend = IRsend(modulation, w1ts_mask, 0);
+    CalibratedIRsend irsend(modulation, w1ts_mask, 0);
 
     int8_t value = irsend.calibrate(38000);
     ESP_LOGI(irLogSend, "IR Calibration, calculated period offset: %dus", value);
+    irCalibrationCache.put(38000, value);
+    irCalibratedKey = IrCalibrationCache::key(38000);
 
     irsend.begin();
 
@@ -362,10 +1015,12 @@ void InfraredService::send_ir_f(void *param) {
     uint16_t              repeatLimit;
     int                   repeat;
     int                   repeatCount;
+    bool                  hold;
     EventGroupHandle_t    eventgroup = ir->m_eventgroup;
 
     // reference required to persist values during callbacks (also initialization is further down!)
-    auto repeatCallback = [&repeatLimit, &repeat, &repeatCount, eventgroup]() -> bool {
+    std::function<bool()> repeatCallback = [&repeatLimit, &repeat, &repeatCount, &hold, eventgroup,
+                                            ir]() -> bool {
         // commented out log statements: depending on IR format this is very time critical!
         // ESP_LOGI(irLogSend, "in callback!");
 
@@ -374,6 +1029,7 @@ void InfraredService::send_ir_f(void *param) {
         if (bits & IR_REPEAT_STOP_BIT) {
             // abort immediately
             repeat = 0;
+            hold = false;
             ESP_LOGI(irLogSend, "stopping repeat");
         } else if (bits & IR_REPEAT_BIT) {
             // reset repeat count and start counting down again
@@ -381,6 +1037,12 @@ void InfraredService::send_ir_f(void *param) {
             repeat = repeatLimit;
             xEventGroupClearBits(eventgroup, IR_REPEAT_BIT);
         }
+        if (hold && xTaskGetTickCount() - ir->m_holdKeepAlive.load() >
+                        pdMS_TO_TICKS(CONFIG_UCD_IR_REPEAT_HOLD_TIMEOUT)) {
+            // client stopped sending keep-alive messages
+            hold = false;
+            irHoldTimeouts.inc();
+        }
         if (repeat > 0) {
             // repeat still active: count down
             // ESP_LOGI(irLogSend, "repeat callback #%d, remaining repeats: %d",
@@ -388,7 +1050,8 @@ void InfraredService::send_ir_f(void *param) {
             repeat--;
             return true;
         }
-        return false;
+        // repeat count is the minimum number of repeats while holding
+        return hold;
     };
 
     // start the IR sending task
@@ -405,12 +1068,21 @@ void InfraredService::send_ir_f(void *param) {
                  pIrMsg->msgId, (uint8_t)pIrMsg->format, pIrMsg->repeat, pIrMsg->pin_mask.w1ts_enable,
                  pIrMsg->pin_mask.w1ts, pIrMsg->pin_mask.w1tc);
 
-        // Activate continuous IR repeat
-        if (pIrMsg->repeat > 0) {
+        ir_trace_point(pIrMsg->traceId, IrTracePoint::DEQUEUED);
+        int64_t sendStart = esp_timer_get_time();
+        irQueueWait.observe(static_cast<uint32_t>((sendStart - pIrMsg->queuedAt) / 1000));
+
+        // Activate continuous IR repeat. Not supported for parallel IR codes: they are not sent with IRsend.
+        if ((pIrMsg->repeat > 0 || pIrMsg->holdHandle) && pIrMsg->format != IRFormat::PARALLEL) {
             // set lambda reference variables
             repeatLimit = pIrMsg->repeat;
             repeat = pIrMsg->repeat;
             repeatCount = 0;
+            hold = pIrMsg->holdHandle != 0;
+            if (hold) {
+                ir->m_holdKeepAlive.store(xTaskGetTickCount());
+                ir->m_holdHandle.store(pIrMsg->holdHandle);
+            }
             irsend.setRepeatCallback(repeatCallback);
         } else {
             irsend.setRepeatCallback(nullptr);
@@ -423,9 +1095,11 @@ void InfraredService::send_ir_f(void *param) {
             usleep(20);
         }
 
-        // set active outputs for parallel IR sending
-        if (!irsend.setPinMask(pIrMsg->pin_mask.w1ts, pIrMsg->pin_mask.w1tc)) {
-            ESP_LOGE(irLogSend, "failed to set PinMask");
+        // set active outputs for parallel IR sending of the same IR code
+        if (pIrMsg->format != IRFormat::PARALLEL) {
+            if (!irsend.setPinMask(pIrMsg->pin_mask.w1ts, pIrMsg->pin_mask.w1tc)) {
+                ESP_LOGE(irLogSend, "failed to set PinMask");
+            }
         }
 
         bool success = false;
@@ -439,6 +1113,8 @@ void InfraredService::send_ir_f(void *param) {
                     if (pIrMsg->repeat > 0) {
                         data.repeat = pIrMsg->repeat;
                     }
+                    calibrateCarrier(irsend, protocolFrequency(data.protocol), pIrMsg->pin_mask);
+                    ir_trace_point(pIrMsg->traceId, IrTracePoint::FIRST_MARK);
                     success = irsend.send(data.protocol, data.command, data.bits, data.repeat);
                 } else {
                     ESP_LOGW(irLogSend, "failed to parse UC code");
@@ -446,85 +1122,97 @@ void InfraredService::send_ir_f(void *param) {
                 break;
             }
             case IRFormat::PRONTO: {
-                // use space as default separator
-                char separator = ' ';
-                if (pIrMsg->message.find_first_of(separator) == std::string::npos) {
-                    // fallback to old comma (dock version <= 0.6.0)
-                    separator = ',';
-                }
-
-                // operate directly on the underlaying message buffer: avoid std::string allocations from using
-                // "message.substring"!
-                auto      msg = pIrMsg->message.c_str();
-                uint16_t  count;
-                int       memError;
-                uint16_t *code_array = prontoBufferToArray(msg, separator, &count, &memError);
-                if (!(code_array == NULL || count == 0)) {
-                    // Attention: PRONTO codes don't have an embedded repeat count field, some codes might required
-                    // to be sent twice to be recognized correctly! One could argue it's an invalid code...
-                    // We ignore that here and treat every code the same in regards to the repeat field!
-                    success = irsend.sendPronto(code_array, count, pIrMsg->repeat);
-                    free(code_array);
+                // parsed when queued, the code array is stored in the code buffer of the message
+                const ProntoCode &pronto = pIrMsg->pronto;
+                // Attention: PRONTO codes don't have an embedded repeat count field, some codes might required
+                // to be sent twice to be recognized correctly! One could argue it's an invalid code...
+                // The repeat field is the number of repeat sequences after the intro sequence.
+                if (pronto.frequency > IR_BITBANG_MAX_CARRIER) {
+                    IrTimings timings = {};
+                    ir_trace_point(pIrMsg->traceId, IrTracePoint::FIRST_MARK);
+                    success = prontoToTimings(pronto.code, pronto.count, pIrMsg->repeat, &timings) &&
+                              sendWithRmt(pIrMsg->pin_mask, &timings);
+                    freeTimings(&timings);
                 } else {
-                    ESP_LOGW(irLogSend, "failed to parse PRONTO code");
-                    rebootIfMemError(memError);
+                    calibrateCarrier(irsend, pronto.frequency, pIrMsg->pin_mask);
+                    ir_trace_point(pIrMsg->traceId, IrTracePoint::FIRST_MARK);
+                    if ((pIrMsg->repeat > 0 || pIrMsg->holdHandle) && pronto.sequences.repeatLength > 0) {
+                        // intro sequence once, then only the repeat sequence while the IR repeat is active
+                        success = sendProntoRepeat(irsend, pronto.code, pronto.count, repeatCallback);
+                    } else {
+                        success = irsend.sendPronto(pronto.code, pronto.count, pIrMsg->repeat);
+                    }
                 }
                 break;
             }
             case IRFormat::GLOBAL_CACHE: {
-                uint16_t  count;
-                int       memError;
-                uint16_t *code_array = globalCacheBufferToArray(pIrMsg->message.c_str(), &count, &memError);
-                if (!(code_array == NULL || count == 0)) {
-                    // Override repeat in code
-                    if (pIrMsg->repeat > 0) {
-                        code_array[1] = pIrMsg->repeat;
-                    }
+                // parsed when queued, the code array is stored in the code buffer of the message
+                uint16_t *code_array = pIrMsg->gc.code;
+                uint16_t  count = pIrMsg->gc.count;
+                // Override repeat in code
+                if (pIrMsg->repeat > 0) {
+                    code_array[1] = pIrMsg->repeat;
+                }
+                if (pIrMsg->gc.frequency > IR_BITBANG_MAX_CARRIER) {
+                    IrTimings timings = {};
+                    ir_trace_point(pIrMsg->traceId, IrTracePoint::FIRST_MARK);
+                    success =
+                        globalCacheToTimings(code_array, count, &timings) && sendWithRmt(pIrMsg->pin_mask, &timings);
+                    freeTimings(&timings);
+                } else {
+                    calibrateCarrier(irsend, pIrMsg->gc.frequency, pIrMsg->pin_mask);
+                    ir_trace_point(pIrMsg->traceId, IrTracePoint::FIRST_MARK);
                     irsend.sendGC(code_array, count);
                     success = true;
-                    free(code_array);
-                } else {
-                    ESP_LOGW(irLogSend, "failed to parse GC code");
-                    rebootIfMemError(memError);
                 }
                 break;
             }
+            case IRFormat::PARALLEL:
+                ir_trace_point(pIrMsg->traceId, IrTracePoint::FIRST_MARK);
+                success = sendParallelParts(pIrMsg);
+                break;
+            case IRFormat::COMPACT: {
+                bool repeating = pIrMsg->repeat > 0 || pIrMsg->holdHandle;
+                success = sendCompact(irsend, pIrMsg, repeating ? &repeatCallback : nullptr);
+                break;
+            }
             default:
                 ESP_LOGE(irLogSend, "Invalid IR format");
         }
 
         irsend.setRepeatCallback(nullptr);
+        if (success) {
+            ir_trace_point(pIrMsg->traceId, IrTracePoint::LAST_SPACE);
+        }
+
+        irSendDuration.observe(static_cast<uint32_t>((esp_timer_get_time() - sendStart) / 1000));
+        if (!success) {
+            irSendErrors.inc();
+        }
 
         // #70 quick & dirty hack from UCD2 (rewrite with callback function or a dedicated queue)
         if (pIrMsg->clientId == IR_CLIENT_GC && pIrMsg->gcSocket > 0) {
             char    response[24];
-            uint8_t module = 1;
-            uint8_t port = 1;
-            GCMsg   req;
-            if (parseGcRequest(pIrMsg->message.c_str(), &req) == 0) {
-                module = req.module;
-                port = req.port;
-            }
+            uint8_t module = pIrMsg->gc.module ? pIrMsg->gc.module : 1;
+            uint8_t port = pIrMsg->gc.port ? pIrMsg->gc.port : 1;
             snprintf(response, sizeof(response), "completeir,%u:%u,%lu\r", module, port, pIrMsg->msgId);
             send_string_to_socket(pIrMsg->gcSocket, response);
-        } else {
-            cJSON *responseDoc = cJSON_CreateObject();
-            cJSON_AddStringToObject(responseDoc, "type", "dock");
-            cJSON_AddStringToObject(responseDoc, "msg", "ir_send");
-            cJSON_AddNumberToObject(responseDoc, "req_id", pIrMsg->msgId);
-            cJSON_AddNumberToObject(responseDoc, "code", success ? 200 : 400);
-
-            struct IrResponse *response = new IrResponse();
-            response->clientId = pIrMsg->clientId;
-            char *resp = cJSON_PrintUnformatted(responseDoc);
-            response->message = resp;
-            delete (resp);
-            cJSON_Delete(responseDoc);
-
-            if (ir->m_responseCallback) {
-                ir->m_responseCallback(response);
-            } else {
-                delete response;
+            ir_trace_point(pIrMsg->traceId, IrTracePoint::RESPONSE_SENT);
+        } else if (pIrMsg->clientId == IR_CLIENT_PEER && pIrMsg->gcSocket > 0) {
+            send_peer_result(pIrMsg->gcSocket, pIrMsg->msgId, success ? 200 : 400);
+            ir_trace_point(pIrMsg->traceId, IrTracePoint::RESPONSE_SENT);
+        } else if (pIrMsg->clientId != IR_CLIENT_NONE) {
+            struct IrResponse *response = acquireResponse(pIrMsg->clientId);
+            if (response) {
+                response->traceId = pIrMsg->traceId;
+                response_format_ir_send(response->buffer, sizeof(response->buffer), pIrMsg->msgId,
+                                        success ? 200 : 400);
+
+                if (ir->m_responseCallback) {
+                    ir->m_responseCallback(response);
+                } else {
+                    ir->releaseResponse(response);
+                }
             }
         }
 
@@ -534,12 +1222,67 @@ void InfraredService::send_ir_f(void *param) {
             GPIO.out1_w1tc.val = static_cast<int32_t>(pIrMsg->pin_mask.w1ts_enable >> 32);
         }
 
-        // all done, release queue (reset works because of queue length 1)
-        delete pIrMsg;
+        // all done, invalidate the repeat hold handle and release queue (reset works because of queue length 1)
+        if (pIrMsg->holdHandle) {
+            ir->m_holdHandle.store(0);
+        }
         xQueueReset(ir->m_queue);
+        irSendPool.release(pIrMsg);
     }
 }
 
+bool InfraredService::sendParallelParts(const IRSendMessage *message) {
+    IrTimings   timings[IR_PARALLEL_MAX_CODES] = {};
+    IrRmtStream streams[IR_MAX_OUTPUTS];
+    size_t      streamCount = 0;
+    bool        success = true;
+
+    for (uint8_t i = 0; i < message->partCount && success; i++) {
+        const IrParallelPart &part = message->parts[i];
+        const char           *code = message->message + part.offset;
+        uint16_t              count;
+        int                   memError;
+        uint16_t             *code_array;
+
+        if (part.format == IRFormat::PRONTO) {
+            char separator = strchr(code, ' ') ? ' ' : ',';
+            code_array = prontoBufferToArray(code, separator, &count, &memError);
+            success = code_array && count > 0 && prontoToTimings(code_array, count, message->repeat, &timings[i]);
+        } else {
+            code_array = globalCacheBufferToArray(code, &count, &memError);
+            if (code_array && count > 1 && message->repeat > 0) {
+                code_array[1] = message->repeat;
+            }
+            success = code_array && count > 0 && globalCacheToTimings(code_array, count, &timings[i]);
+        }
+        mem_tag_free(MEM_TAG_IR, code_array);
+        if (!success) {
+            ESP_LOGW(irLogSend, "failed to convert parallel IR code %u", i);
+            rebootIfMemError(memError);
+            break;
+        }
+
+        for (uint8_t j = 0; j < part.outputCount; j++) {
+            streams[streamCount].output = part.outputs[j];
+            streams[streamCount].timings = &timings[i];
+            streamCount++;
+        }
+    }
+
+    if (success) {
+        esp_err_t err = ir_rmt_send(streams, streamCount);
+        if (err != ESP_OK) {
+            ESP_LOGE(irLogSend, "failed to send parallel IR codes: %s", esp_err_to_name(err));
+            success = false;
+        }
+    }
+
+    for (auto &t : timings) {
+        freeTimings(&t);
+    }
+    return success;
+}
+
 void InfraredService::learn_ir_f(void *param) {
     if (param == nullptr) {
         ESP_LOGE(irLogLearn, "BUG: missing learn_ir_f param");
@@ -564,16 +1307,29 @@ void InfraredService::learn_ir_f(void *param) {
     decode_results results;
     // start the IR learning task
     while (true) {
-        // wait until learning is requested
-        bits = xEventGroupWaitBits(ir->m_eventgroup, IR_LEARNING_BIT, pdFALSE, pdFALSE, portMAX_DELAY);
+        // wait until learning or relaying is requested
+        bits = xEventGroupWaitBits(ir->m_eventgroup, IR_LEARNING_BIT | IR_RELAY_BIT, pdFALSE, pdFALSE, portMAX_DELAY);
         if ((bits & portMAX_DELAY) == 0) {
             // timeout
             continue;
         }
 
-        ESP_LOGI(irLogLearn, "ir_learn task starting");
-        ESP_ERROR_CHECK_WITHOUT_ABORT(
-            esp_event_post(UC_DOCK_EVENTS, UC_EVENT_IR_LEARNING_START, NULL, 0, pdMS_TO_TICKS(500)));
+        if ((bits & IR_RELAY_BIT) && ir->m_relay.mode == IrRelayMode::STREAM) {
+            relayStream(ir);
+            continue;
+        }
+
+        // decoding loop for IR learning and the re-encoding relay
+        const bool        relay = bits & IR_RELAY_BIT;
+        const EventBits_t activeBit = relay ? IR_RELAY_BIT : IR_LEARNING_BIT;
+
+        if (relay) {
+            ESP_LOGI(irLogLearn, "ir_relay starting: reencode");
+        } else {
+            ESP_LOGI(irLogLearn, "ir_learn task starting");
+            ESP_ERROR_CHECK_WITHOUT_ABORT(
+                esp_event_post(UC_DOCK_EVENTS, UC_EVENT_IR_LEARNING_START, NULL, 0, pdMS_TO_TICKS(500)));
+        }
 
         // enable IR learning
         irrecv.enableIRIn();
@@ -583,7 +1339,7 @@ void InfraredService::learn_ir_f(void *param) {
         irrecv.decode(&results);
 
         // start learning loop
-        while (xEventGroupGetBits(ir->m_eventgroup) & IR_LEARNING_BIT) {
+        while (xEventGroupGetBits(ir->m_eventgroup) & activeBit) {
             // Delay value by experimentation with Sony, Denon, LG, RC6 remotes.
             // If too high, there are more "double learned" code failures with Denon, if too low a core gets hogged.
             vTaskDelay(pdMS_TO_TICKS(20));
@@ -592,7 +1348,15 @@ void InfraredService::learn_ir_f(void *param) {
                 continue;
             }
 
+            // iTach IR learner: raw timings of every complete capture, also if the protocol isn't known
+            int gcSocket = relay ? 0 : ir->m_gcLearnSocket.load();
+            if (gcSocket > 0 && !results.overflow) {
+                sendGcLearnedCode(gcSocket, &results);
+            }
+
             bool          failed = false;
+            bool          compact = false;
+            std::string   code;
             uc_event_ir_t event_ir;
             memset(&event_ir, 0, sizeof(event_ir));
             // make sure to only report successfully decoded IR codes
@@ -601,30 +1365,39 @@ void InfraredService::learn_ir_f(void *param) {
                 failed = true;
                 event_ir.error = UC_ERROR_IR_LEARN_OVERFLOW;
             } else if (results.decode_type == decode_type_t::UNKNOWN) {
-                ESP_LOGW(irLogLearn, "Learning failed: unknown code");
-                failed = true;
-                event_ir.error = UC_ERROR_IR_LEARN_UNKNOWN;
+                // unknown protocol: report the normalized raw timings
+                compact = learnCompactCode(&results, &code);
+                if (!compact) {
+                    ESP_LOGW(irLogLearn, "Learning failed: unknown code");
+                    failed = true;
+                    event_ir.error = UC_ERROR_IR_LEARN_UNKNOWN;
+                }
             } else if (results.value == 0 || results.value == UINT64_MAX) {
                 ESP_LOGW(irLogLearn, "Learning failed: invalid value");
                 failed = true;
                 event_ir.error = UC_ERROR_IR_LEARN_INVALID;
             }
 
+            if (failed && relay) {
+                irRelayDropped.inc();
+                continue;
+            }
             if (failed) {
                 ESP_ERROR_CHECK_WITHOUT_ABORT(esp_event_post(UC_DOCK_EVENTS, UC_EVENT_IR_LEARNING_FAIL, &event_ir,
                                                              sizeof(event_ir), pdMS_TO_TICKS(500)));
                 continue;
             }
 
-            std::string code;
-            code += std::to_string(results.decode_type);
-            code += ";";
-            code += resultToHexidecimal(&results);
-            code += ";";
-            code += std::to_string(results.bits);
-            code += ";";
-            // TODO(#30) adjust repeat count for known protocols, e.g. set Sony to 2?
-            code += std::to_string(results.repeat);
+            if (!compact) {
+                code += std::to_string(results.decode_type);
+                code += ";";
+                code += resultToHexidecimal(&results);
+                code += ";";
+                code += std::to_string(results.bits);
+                code += ";";
+                // TODO(#30) adjust repeat count for known protocols, e.g. set Sony to 2?
+                code += std::to_string(results.repeat);
+            }
 
             // code += ";";
             // code += std::to_string(results.address);
@@ -634,6 +1407,21 @@ void InfraredService::learn_ir_f(void *param) {
             // TODO(#32) here we could add "protocol specific quirk handling":
             //           e.g. filter out double Denon codes (within 200ms) and report repeat count 2 instead
 
+            if (relay) {
+                const IrRelaySettings &relaySettings = ir->m_relay;
+                uint16_t status = ir->send(IR_CLIENT_NONE, 0, code.c_str(), compact ? "compact" : "hex", 0,
+                                           relaySettings.internal_side, relaySettings.internal_top,
+                                           relaySettings.external1, relaySettings.external2);
+                if (status == 0) {
+                    irRelayReencode.inc();
+                } else {
+                    ESP_LOGW(irLogLearn, "Relaying failed (%d): %s", status, code.c_str());
+                    irRelayDropped.inc();
+                }
+                publishRelayEvent(ir, code.c_str(), compact ? "compact" : "hex");
+                continue;
+            }
+
             ESP_LOGI(irLogLearn, "Learned: %s", code.c_str());
             event_ir.decode_type = results.decode_type;
             event_ir.value = results.value;
@@ -642,34 +1430,127 @@ void InfraredService::learn_ir_f(void *param) {
             ESP_ERROR_CHECK_WITHOUT_ABORT(esp_event_post(UC_DOCK_EVENTS, UC_EVENT_IR_LEARNING_OK, &event_ir,
                                                          sizeof(event_ir), pdMS_TO_TICKS(500)));
 
+            struct IrResponse *response = acquireResponse(-1);  // broadcast
+            if (response == nullptr) {
+                continue;
+            }
             cJSON *responseDoc = cJSON_CreateObject();
             cJSON_AddStringToObject(responseDoc, "type", "event");
             cJSON_AddStringToObject(responseDoc, "msg", "ir_receive");
             cJSON_AddStringToObject(responseDoc, "ir_code", code.c_str());
+            cJSON_AddStringToObject(responseDoc, "format", compact ? "compact" : "hex");
 
-            struct IrResponse *response = new IrResponse();
-            response->clientId = -1;  // broadcast
-            char *resp = cJSON_PrintUnformatted(responseDoc);
-            response->message = resp;
-            delete (resp);
+            bool printed = printResponse(response, responseDoc);
             cJSON_Delete(responseDoc);
+            if (!printed) {
+                ir->releaseResponse(response);
+                continue;
+            }
 
             if (ir->m_responseCallback) {
                 ir->m_responseCallback(response);
             } else {
-                delete response;
+                ir->releaseResponse(response);
             }
         }
 
-        ESP_LOGI(irLogLearn, "ir_learn task stopping");
-        ESP_ERROR_CHECK_WITHOUT_ABORT(
-            esp_event_post(UC_DOCK_EVENTS, UC_EVENT_IR_LEARNING_STOP, NULL, 0, pdMS_TO_TICKS(500)));
+        if (relay) {
+            ESP_LOGI(irLogLearn, "ir_relay stopping");
+        } else {
+            ESP_LOGI(irLogLearn, "ir_learn task stopping");
+            ESP_ERROR_CHECK_WITHOUT_ABORT(
+                esp_event_post(UC_DOCK_EVENTS, UC_EVENT_IR_LEARNING_STOP, NULL, 0, pdMS_TO_TICKS(500)));
+        }
 
         // learning turned off: disable processing
         irrecv.disableIRIn();
     }
 }
 
+void InfraredService::relayStream(InfraredService *ir) {
+    ESP_LOGI(irLogLearn, "ir_relay starting: stream");
+
+    const IrRelaySettings &settings = ir->m_relay;
+    IrRelayConfig          config = {};
+    config.input = IR_RECEIVE_PIN;
+    config.frequency = settings.frequency;
+    config.outputCount = ir->getIrOutputs(settings.internal_side, settings.internal_top, settings.external1,
+                                          settings.external2, config.outputs);
+    GpioPinMask pinMask =
+        ir->createIrPinMask(settings.internal_side, settings.internal_top, settings.external1, settings.external2);
+
+    uint32_t *durations = static_cast<uint32_t *>(mem_tag_malloc(MEM_TAG_IR, kCaptureBufferSize * sizeof(uint32_t)));
+    IrCompactCode *code = static_cast<IrCompactCode *>(mem_tag_malloc(MEM_TAG_IR, sizeof(IrCompactCode)));
+    // same limit as for learned compact codes
+    char *compactCode = static_cast<char *>(mem_tag_malloc(MEM_TAG_IR, CONFIG_UCD_IR_CODE_MAX_LENGTH));
+
+    if (durations && code && compactCode && ir_relay_start(&config) == ESP_OK) {
+        // enable external ports for the whole relay session
+        if (pinMask.w1ts_enable) {
+            GPIO.out_w1ts = static_cast<int32_t>(pinMask.w1ts_enable);
+            GPIO.out1_w1ts.val = static_cast<int32_t>(pinMask.w1ts_enable >> 32);
+        }
+
+        IrRelayFrame frame;
+        while (xEventGroupGetBits(ir->m_eventgroup) & IR_RELAY_BIT) {
+            // the frames are already relayed: only for reporting
+            if (!ir_relay_read_frame(durations, kCaptureBufferSize, kTimeout, pdMS_TO_TICKS(100), &frame)) {
+                continue;
+            }
+            irRelayStream.inc();
+            irRelayLatency.observe(frame.maxLatency);
+
+            if (frame.overflow || frame.count < kMinUnknownSize) {
+                continue;
+            }
+            if (irCompactFromTimings(durations, frame.count, config.frequency, code) &&
+                irCompactFormat(code, compactCode, CONFIG_UCD_IR_CODE_MAX_LENGTH) > 0) {
+                publishRelayEvent(ir, compactCode, "compact");
+            }
+        }
+
+        ir_relay_stop();
+        if (pinMask.w1ts_enable) {
+            GPIO.out_w1tc = static_cast<int32_t>(pinMask.w1ts_enable);
+            GPIO.out1_w1tc.val = static_cast<int32_t>(pinMask.w1ts_enable >> 32);
+        }
+    } else {
+        ESP_LOGE(irLogLearn, "Failed to start IR relay");
+        xEventGroupClearBits(ir->m_eventgroup, IR_RELAY_BIT);
+    }
+
+    mem_tag_free(MEM_TAG_IR, compactCode);
+    mem_tag_free(MEM_TAG_IR, code);
+    mem_tag_free(MEM_TAG_IR, durations);
+    ESP_LOGI(irLogLearn, "ir_relay stopping");
+}
+
+void InfraredService::publishRelayEvent(InfraredService *ir, const char *code, const char *format) {
+    struct IrResponse *response = acquireResponse(IR_CLIENT_RELAY);
+    if (response == nullptr) {
+        return;
+    }
+    cJSON *responseDoc = cJSON_CreateObject();
+    cJSON_AddStringToObject(responseDoc, "type", "event");
+    cJSON_AddStringToObject(responseDoc, "msg", "ir_relay");
+    cJSON_AddStringToObject(responseDoc, "ir_code", code);
+    cJSON_AddStringToObject(responseDoc, "format", format);
+    cJSON_AddStringToObject(responseDoc, "mode", ir->m_relay.mode == IrRelayMode::STREAM ? "stream" : "reencode");
+
+    bool printed = printResponse(response, responseDoc);
+    cJSON_Delete(responseDoc);
+    if (!printed) {
+        ir->releaseResponse(response);
+        return;
+    }
+
+    if (ir->m_responseCallback) {
+        ir->m_responseCallback(response);
+    } else {
+        ir->releaseResponse(response);
+    }
+}
+
 InfraredService &InfraredService::getInstance() {
     static InfraredService instance;
     return instance;
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <string>
 
@@ -12,18 +13,65 @@
 #include "freertos/queue.h"
 
 #include "board.h"
+#include "cJSON.h"
 #include "external_port.h"
 #include "ir_codes.h"
 
 #define IR_CLIENT_GC -2
+/// Client without asynchronous response, e.g. REST API requests.
+#define IR_CLIENT_NONE -3
+/// Broadcast to WebSocket clients subscribed to IR relay events.
+#define IR_CLIENT_RELAY -4
+/// IR send request forwarded by a peer dock, the result is sent to the peer connection socket.
+#define IR_CLIENT_PEER -5
 
+/// Length of the preallocated IR response message buffer including NUL terminator.
+#define IR_RESPONSE_MAX_LENGTH 256
+
+/// IR response message. Allocated from a fixed size pool, must be released with `InfraredService::releaseResponse`.
 struct IrResponse {
-    int16_t     clientId;
-    std::string message;
+    int16_t clientId;
+    /// NUL terminated JSON message: either `buffer`, or allocated on the heap for events with long IR codes.
+    char *message = buffer;
+    /// Preallocated message buffer.
+    char buffer[IR_RESPONSE_MAX_LENGTH];
+    /// IR trace identifier to record when the response has been sent, 0 if not traced.
+    uint32_t traceId = 0;
 };
 
 typedef std::function<esp_err_t(IrResponse *response)> IrResponseCallback;
 
+/// IR code for a parallel IR send request.
+struct IrParallelCode {
+    /// IR code in PRONTO or GlobalCache format.
+    const char *code;
+    /// IR code format: "pronto" or "gc".
+    const char *format;
+    bool        internal_side;
+    bool        internal_top;
+    bool        external1;
+    bool        external2;
+};
+
+/// IR relay modes, see `InfraredService::startIrRelay`.
+enum class IrRelayMode : uint8_t {
+    /// Forward marks and spaces of the IR receiver as they arrive.
+    STREAM,
+    /// Decode received IR codes and send them again. Unknown IR codes are sent in the compact IR code format.
+    REENCODE,
+};
+
+/// IR relay settings.
+struct IrRelaySettings {
+    IrRelayMode mode;
+    /// Carrier frequency in Hz of relayed IR codes in STREAM mode.
+    uint32_t frequency;
+    bool     internal_side;
+    bool     internal_top;
+    bool     external1;
+    bool     external2;
+};
+
 class InfraredService {
  public:
     static InfraredService &getInstance();
@@ -45,26 +93,79 @@ class InfraredService {
      * Asynchronously send an IR code on the 2nd core.
      *
      * If there's still an IR code being sent, error 429 (too many requests) is returned.
+     * The IR send request is allocated from a fixed size pool, error 429 is also returned if the pool is exhausted.
      *
      * @param clientId the WebSocket client identifier to associate the response message.
      * @param msgId the client send request message identifier to associate the response message with.
-     * @param code  IR code to send, either PRONTO or HEX (UnfoldedCircle) format.
-     * @param format IR code format: "pronto" or "hex".
+     * @param code  IR code to send, either PRONTO or HEX (UnfoldedCircle) format. Error 400 is returned if the code
+     *              is longer than CONFIG_UCD_IR_CODE_MAX_LENGTH.
+     * @param format IR code format: "pronto", "hex" or "gc".
      * @param repeat IR repeat count.
      * @param internal_side Send IR signal on internal LEDs.
      * @param internal_top Send IR signal on internal top LED.
      * @param external1 Send IR signal on external 1 emitter port.
      * @param external2 Send IR signal on external 2 emitter port.
-     * @param gcSocket Optional TCP socket if message was received from the GlobalCache TCP server.
+     * @param gcSocket Optional TCP socket if message was received from the GlobalCache TCP server or a peer dock.
+     * @param holdHandle Optional output parameter to keep the IR repeat alive with `holdRepeat` instead of sending
+     *                   the same code again. If set, the IR code is repeated until the keep-alive messages stop for
+     *                   CONFIG_UCD_IR_REPEAT_HOLD_TIMEOUT milliseconds or `stopSend` is called. An IR repeat of
+     *                   the active held IR code returns 202 with the active handle, 409 if it isn't held.
+     */
+    uint16_t send(int16_t clientId, uint32_t msgId, const char *code, const char *format, uint16_t repeat,
+                  bool internal_side, bool internal_top, bool external1, bool external2, int gcSocket = 0,
+                  uint16_t *holdHandle = nullptr);
+
+    /**
+     * Asynchronously send different IR codes simultaneously on different outputs.
+     *
+     * Each IR code is sent with an independent RMT channel. Only timing based formats are supported: PRONTO and
+     * GlobalCache. The IR codes must use different outputs. IR repeat and stopSend are not supported.
+     * Error handling and the asynchronous response are the same as in `send`.
+     *
+     * @param clientId the WebSocket client identifier to associate the response message.
+     * @param msgId the client send request message identifier to associate the response message with.
+     * @param codes IR codes with their outputs.
+     * @param count number of IR codes, at most IR_PARALLEL_MAX_CODES.
+     * @param repeat IR repeat count for all IR codes.
+     */
+    uint16_t sendParallel(int16_t clientId, uint32_t msgId, const IrParallelCode *codes, size_t count,
+                          uint16_t repeat);
+
+    /// Release a response message passed to the response callback.
+    void releaseResponse(IrResponse *response);
+
+    /**
+     * Keep the IR repeat of the active IR code alive.
+     *
+     * @param handle IR repeat hold handle returned from `send`.
+     * @return 200 if the repeat was extended, 404 if the handle doesn't belong to the active IR code.
      */
-    uint16_t send(int16_t clientId, uint32_t msgId, const std::string &code, const std::string &format, uint16_t repeat,
-                  bool internal_side, bool internal_top, bool external1, bool external2, int gcSocket = 0);
+    uint16_t holdRepeat(uint16_t handle);
 
     void stopSend();
 
-    void startIrLearn();
+    /// Start IR learning. An active IR relay is stopped.
+    /// @param gcSocket Optional GlobalCache client socket: learned IR codes are also sent to the client in sendir
+    ///                 format, like the IR learner of an iTach device.
+    void startIrLearn(int gcSocket = 0);
     void stopIrLearn();
     bool isIrLearning();
+    /// Stop sending learned IR codes to a GlobalCache client socket. IR learning is stopped if the client enabled it.
+    void stopGcIrLearn(int gcSocket);
+
+    /**
+     * Relay IR codes received by the IR receiver to the selected outputs.
+     *
+     * The IR receiver is either used for learning or relaying. In STREAM mode the outputs are exclusively used by the
+     * relay and IR sending is rejected with 503. Received IR codes are published as `ir_relay` events.
+     *
+     * @param settings relay mode and outputs.
+     * @return 200 if the relay is started, 400 if no output is available or the carrier frequency is invalid, 503 if
+     *         IR learning or the relay is already active.
+     */
+    uint16_t startIrRelay(const IrRelaySettings &settings);
+    void     stopIrRelay();
+    bool     isIrRelaying();
 
  private:
     InfraredService() = default;
@@ -74,6 +175,42 @@ class InfraredService {
 
     GpioPinMask createIrPinMask(bool internal_side, bool internal_top, bool external1, bool external2);
 
+    /// Get the GPIOs of the selected outputs. Unlike `createIrPinMask` there's no default output.
+    uint8_t getIrOutputs(bool internal_side, bool internal_top, bool external1, bool external2, IrOutput *outputs);
+
+    /// Queue an IR send message acquired from the message pool. The message is released if it can't be queued.
+    uint16_t queueMessage(IRSendMessage *message);
+
+    /// Acquire an IR send message from the message pool and parse the GlobalCache code into its code buffer.
+    /// @return 0 if successful, 429 if the pool is exhausted or the iTach error code of an invalid code.
+    uint16_t acquireGcMessage(const char *code, IRSendMessage **message);
+
+    /// Acquire an IR send message from the message pool and parse the PRONTO code into its code buffer.
+    /// @return 0 if successful, 429 if the pool is exhausted or 400 if the code is invalid.
+    uint16_t acquireProntoMessage(const char *code, IRSendMessage **message);
+
+    /// Queue a message from `acquireGcMessage` or `acquireProntoMessage`, or accept it as IR repeat of the active code.
+    /// The message is released if it isn't queued.
+    uint16_t queueParsedMessage(IRSendMessage *message, uint16_t repeat, GpioPinMask pin_mask, uint16_t *holdHandle);
+
+    /// Keep repeating the active IR code.
+    /// @param current active IR send message in the queue.
+    /// @param holdHandle Optional output parameter for the hold handle of the active IR code.
+    /// @return 202 if the repeat is accepted, 409 if a hold is requested but the active IR code isn't held.
+    uint16_t acceptRepeat(const IRSendMessage *current, uint16_t repeat, uint16_t *holdHandle);
+
+    /// Assign an optional IR repeat hold handle and queue the message.
+    uint16_t queueHoldMessage(IRSendMessage *message, uint16_t *holdHandle);
+
+    static bool sendParallelParts(const IRSendMessage *message);
+
+    /// Acquire a response message from the response pool, nullptr if exhausted.
+    static IrResponse *acquireResponse(int16_t clientId);
+
+    /// Print a JSON message into a response. Messages which don't fit into the response buffer are kept on the heap.
+    /// @return false if out of memory.
+    static bool printResponse(IrResponse *response, const cJSON *json);
+
     static void rebootIfMemError(int memError);
 
     // IR sending task
@@ -82,6 +219,14 @@ class InfraredService {
     // IR learning task
     static void learn_ir_f(void *param);
 
+    /// IR relay loop in STREAM mode, running in the IR learning task.
+    static void relayStream(InfraredService *ir);
+
+    /// Publish a received IR code to the IR relay event subscribers.
+    static void publishRelayEvent(InfraredService *ir, const char *code, const char *format);
+
+    bool isRelayStreaming();
+
     // Used to start and stop IR learning
     EventGroupHandle_t m_eventgroup = nullptr;
     // IR sending task handle for `send_ir_f`
@@ -91,8 +236,20 @@ class InfraredService {
     // IR send input queue
     QueueHandle_t m_queue = nullptr;
 
-    // Current IR code which is being sent. Used to check for IR repeat commands.
-    std::string m_currentSendCode;
+    // Code buffers of the IR send message pool, allocated once in `init`.
+    char *m_codeSlab = nullptr;
+
+    // IR repeat hold handle of the active IR code, 0 if none. Only set by the IR send task.
+    std::atomic<uint16_t> m_holdHandle{0};
+    std::atomic<uint16_t> m_nextHoldHandle{1};
+    // Tick count of the last IR repeat hold keep-alive.
+    std::atomic<TickType_t> m_holdKeepAlive{0};
+
+    // GlobalCache client socket receiving learned IR codes, 0 if none.
+    std::atomic<int> m_gcLearnSocket{0};
+
+    // Active IR relay settings, only changed while the relay is stopped.
+    IrRelaySettings m_relay = {};
 
     port_map_t ports_;
 
@@ -17,3 +17,24 @@ struct GCMsg {
     // optional parameter(s). Points to first parameter or NULL if not present.
     const char *param;
 };
+
+/// Parsed GlobalCache sendir request
+struct GCSendIr {
+    // module, 0 if the request didn't include the `sendir,<module>:<port>,<ID>,` prefix
+    uint8_t module;
+    // port, 0 if not present
+    uint8_t port;
+    // request ID, 0 if not present
+    uint32_t id;
+    // carrier frequency in Hz
+    uint16_t frequency;
+    // number of times the IR code is sent
+    uint16_t repeat;
+    // repeat offset: index of the first on-duration of the repeated part, 1 = entire code
+    uint16_t offset;
+    // number of values in `code`
+    uint16_t count;
+    // GlobalCache code array: <freq>,<repeat>,<offset>,<on1>,<off1>,...,<onN>,<offN>.
+    // Same layout as returned by `globalCacheBufferToArray` for `IRsend::sendGC` and `globalCacheToTimings`.
+    uint16_t *code;
+};
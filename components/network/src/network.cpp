@@ -283,6 +283,10 @@ void eth_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id,
             ESP_LOGI(TAG, "Ethernet Link Up, HW Addr %02x:%02x:%02x:%02x:%02x:%02x", mac_addr[0], mac_addr[1],
                      mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5]);
             wifi_disconnect();
+#if CONFIG_LWIP_IPV6
+            // IPv6 link-local address for the iTach server and beacon, global addresses follow with SLAAC
+            esp_netif_create_ip6_linklocal(esp_netif_get_handle_from_ifkey("ETH_DEF"));
+#endif
             set_eth_led_brightness(Config::instance().getEthLedBrightness());
             if (eth_event_group) {
                 xEventGroupSetBits(eth_event_group, ETH_LINK_UP_BIT);
@@ -347,9 +351,14 @@ void network_ip_event_handler(void *arg, esp_event_base_t event_base, int32_t ev
         case IP_EVENT_AP_STAIPASSIGNED:
             ESP_LOGI(TAG, "IP_EVENT_AP_STAIPASSIGNED");
             break;
-        case IP_EVENT_GOT_IP6:
-            ESP_LOGI(TAG, "IP_EVENT_GOT_IP6");
+        case IP_EVENT_GOT_IP6: {
+            ip_event_got_ip6_t *event = (ip_event_got_ip6_t *)event_data;
+            ESP_LOGI(TAG, "Got an IPv6 address from interface %s: " IPV6STR " (%s)",
+                     esp_netif_get_desc(event->esp_netif), IPV62STR(event->ip6_info.ip),
+                     esp_netif_ip6_get_addr_type(&event->ip6_info.ip) == ESP_IP6_ADDR_IS_LINK_LOCAL ? "link-local"
+                                                                                                    : "global");
             break;
+        }
         default:
             break;
     }
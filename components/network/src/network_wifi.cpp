@@ -20,9 +20,13 @@
 #include "freertos/task.h"
 
 #include "config.h"
+#include "metrics.h"
 #include "network_priv.h"
 
 static const char*  TAG = "WIFI";
+
+static Counter wifiConnects("ucd_wifi_connects_total", "Number of WiFi station connections");
+static Counter wifiDisconnects("ucd_wifi_disconnects_total", "Number of WiFi station disconnections");
 static esp_netif_t* wifi_netif;
 static bool         attempt_reconnect = false;
 
@@ -101,6 +105,10 @@ static void network_wifi_event_handler(void* arg, esp_event_base_t event_base, i
                     "WIFI_EVENT_STA_CONNECTED. Channel: %d, Access point: %s, BSSID: %02x:%02x:%02x:%02x:%02x:%02x",
                     s->channel, ssid, s->bssid[0], s->bssid[1], s->bssid[2], s->bssid[3], s->bssid[4], s->bssid[5]);
             }
+            wifiConnects.inc();
+#if CONFIG_LWIP_IPV6
+            esp_netif_create_ip6_linklocal(wifi_netif);
+#endif
             trigger_connected_event();
 
         } break;
@@ -111,6 +119,7 @@ static void network_wifi_event_handler(void* arg, esp_event_base_t event_base, i
                      "WIFI_EVENT_STA_DISCONNECTED. From BSSID: %02x:%02x:%02x:%02x:%02x:%02x, reason code: %d (%s)",
                      s->bssid[0], s->bssid[1], s->bssid[2], s->bssid[3], s->bssid[4], s->bssid[5], s->reason,
                      get_wifi_disconnection_str(static_cast<wifi_err_reason_t>(s->reason)));
+            wifiDisconnects.inc();
             if (s->reason == WIFI_REASON_ROAMING) {
                 ESP_LOGI(TAG, "WiFi Roaming to new access point");
             } else {
@@ -51,6 +51,7 @@ void Config::setLedBrightness(int value) {
     m_preferences.begin(m_prefGeneral, false);
     m_preferences.putInt("brightness", value);
     m_preferences.end();
+    m_generation++;
 }
 
 int Config::getEthLedBrightness() {
@@ -65,6 +66,7 @@ void Config::setEthLedBrightness(int value) {
     m_preferences.begin(m_prefGeneral, false);
     m_preferences.putInt("eth_brightness", value);
     m_preferences.end();
+    m_generation++;
 }
 
 // getter and setter for dock friendly name
@@ -88,6 +90,7 @@ void Config::setFriendlyName(std::string value) {
     m_preferences.begin(m_prefGeneral, false);
     m_preferences.putString("friendly_name", value.substr(0, 40));
     m_preferences.end();
+    m_generation++;
 }
 
 // getter and setter for wifi credentials
@@ -109,6 +112,7 @@ bool Config::setWifi(std::string ssid, std::string password) {
     m_preferences.putString("ssid", ssid);
     m_preferences.putString("password", password);
     m_preferences.end();
+    m_generation++;
 
     return true;
 }
@@ -120,6 +124,7 @@ bool Config::setLogLevel(UCLog::Level level) {
     m_preferences.putUShort("log_level", level);
 
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -138,6 +143,7 @@ bool Config::setSyslogServer(const std::string& server, uint16_t port) {
     m_preferences.putUShort("syslog_port", port);
 
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -148,6 +154,7 @@ bool Config::enableSyslog(bool enable) {
     m_preferences.putBool("syslog_enabled", enable);
 
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -162,6 +169,7 @@ bool Config::setTestMode(bool enable) {
     m_preferences.putBool("testmode", enable);
 
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -178,6 +186,7 @@ bool Config::setToken(std::string value) {
     }
     m_preferences.putString("token", value);
     m_preferences.end();
+    m_generation++;
 
     return true;
 }
@@ -241,6 +250,7 @@ bool Config::enableNtp(bool enable) {
     m_preferences.putBool("ntp_enabled", enable);
 
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -260,6 +270,7 @@ bool Config::setNtpServer(const std::string& server1, const std::string& server2
     m_preferences.putString("ntp_server2", server2);
 
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -281,6 +292,7 @@ bool Config::setNetwork(network_cfg_t cfg) {
     m_preferences.putUInt("ip_gw", cfg.ip.gw.addr);
 
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -310,6 +322,7 @@ bool Config::setDnsServer(const std::string& server1, const std::string& server2
     m_preferences.putString("dns_server2", server2);
 
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -329,6 +342,7 @@ void Config::setVolume(uint8_t volume) {
     m_preferences.begin(m_prefGeneral, false);
     m_preferences.putUChar("volume", volume);
     m_preferences.end();
+    m_generation++;
 }
 
 ExtPortMode Config::getExternalPortMode(uint8_t port) {
@@ -351,6 +365,7 @@ bool Config::setExternalPortMode(uint8_t port, ExtPortMode mode) {
     m_preferences.putUChar(keyname, mode);
 
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -370,6 +385,7 @@ bool Config::setExternalPortUart(uint8_t port, const char* uart) {
 
     size_t len = m_preferences.putString(keyname, uart);
     m_preferences.end();
+    m_generation++;
     return len > 0;
 }
 
@@ -386,6 +402,7 @@ bool Config::setIrSendCore(uint16_t core) {
     }
     m_preferences.putUShort("irsend_core", core);
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -402,6 +419,7 @@ bool Config::setIrSendPriority(uint16_t priority) {
     }
     m_preferences.putUShort("irsend_prio", priority);
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -418,6 +436,7 @@ bool Config::setIrLearnCore(uint16_t core) {
     }
     m_preferences.putUShort("irlearn_core", core);
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -434,6 +453,7 @@ bool Config::setIrLearnPriority(uint16_t priority) {
     }
     m_preferences.putUShort("irlearn_prio", priority);
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -444,6 +464,7 @@ bool Config::enableGcServer(bool enable) {
     m_preferences.putBool("gc_srv", enable);
 
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -458,6 +479,7 @@ bool Config::enableGcServerBeacon(bool enable) {
     m_preferences.putBool("gc_amxb", enable);
 
     m_preferences.end();
+    m_generation++;
     return true;
 }
 
@@ -465,6 +487,27 @@ bool Config::isGcServerBeaconEnabled() {
     return getBoolSetting(m_prefGeneral, "gc_amxb", false);
 }
 
+std::string Config::getDockGroup() {
+    return getStringSetting(m_prefGeneral, "dock_group", "");
+}
+
+bool Config::setDockGroup(std::string value) {
+    if (value.length() > 32) {
+        return false;
+    }
+    if (!m_preferences.begin(m_prefGeneral, false)) {
+        return false;
+    }
+    m_preferences.putString("dock_group", value);
+    m_preferences.end();
+    m_generation++;
+    return true;
+}
+
+uint32_t Config::getGeneration() const {
+    return m_generation.load();
+}
+
 // reset config to defaults
 void Config::reset() {
     ESP_LOGW(m_ctx, "Resetting configuration.");
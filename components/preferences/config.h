@@ -7,6 +7,7 @@
 #include <nvs.h>
 #include <nvs_flash.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -189,6 +190,20 @@ class Config {
     bool enableGcServerBeacon(bool enable);
     bool isGcServerBeaconEnabled();
 
+    // Multi-dock IR fan-out
+    std::string getDockGroup();
+    /**
+     * Set the dock group for IR fan-out. Maximum length is 32 characters, an empty group disables the IR fan-out.
+     *
+     * Returns true if the group was stored.
+     */
+    bool setDockGroup(std::string value);
+
+    /// @brief Get the configuration generation, which is incremented by every setter.
+    ///
+    /// Allows to cache values derived from the configuration, independent of who changes a setting.
+    uint32_t getGeneration() const;
+
     // reset config to defaults
     void reset();
 
@@ -212,6 +227,8 @@ class Config {
     std::string m_hostname;
     std::string m_swVersion = DOCK_VERSION;
 
+    std::atomic<uint32_t> m_generation{0};
+
     const char* m_prefGeneral = "general";
     const char* m_prefWifi = "wifi";
     const char* m_defToken = "0000";
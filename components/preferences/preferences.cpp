@@ -21,11 +21,26 @@
 
 #include "esp_log.h"
 
+#include "metrics.h"
 #include "nvs.h"
 #include "nvs_flash.h"
 
 static const char* TAG = "Preferences";
 
+static Counter nvsWrites("ucd_nvs_writes_total", "Number of NVS commits");
+static Counter nvsWriteErrors("ucd_nvs_write_errors_total", "Number of failed NVS commits");
+
+/// nvs_commit with write metrics
+static esp_err_t nvs_commit_counted(nvs_handle_t handle) {
+    esp_err_t err = nvs_commit(handle);
+    if (err == ESP_OK) {
+        nvsWrites.inc();
+    } else {
+        nvsWriteErrors.inc();
+    }
+    return err;
+}
+
 const char* nvs_errors[] = {"OTHER",         "NOT_INITIALIZED",  "NOT_FOUND",    "TYPE_MISMATCH",
                             "READ_ONLY",     "NOT_ENOUGH_SPACE", "INVALID_NAME", "INVALID_HANDLE",
                             "REMOVE_FAILED", "KEY_TOO_LONG",     "PAGE_FULL",    "INVALID_STATE",
@@ -83,7 +98,7 @@ bool Preferences::clear() {
         ESP_LOGE(TAG, "nvs_erase_all fail: %s", nvs_error(err));
         return false;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s", nvs_error(err));
         return false;
@@ -104,7 +119,7 @@ bool Preferences::remove(const char* key) {
         ESP_LOGE(TAG, "nvs_erase_key fail: %s %s", key, nvs_error(err));
         return false;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s %s", key, nvs_error(err));
         return false;
@@ -125,7 +140,7 @@ size_t Preferences::putChar(const char* key, int8_t value) {
         ESP_LOGE(TAG, "nvs_set_i8 fail: %s %s", key, nvs_error(err));
         return 0;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s %s", key, nvs_error(err));
         return 0;
@@ -142,7 +157,7 @@ size_t Preferences::putUChar(const char* key, uint8_t value) {
         ESP_LOGE(TAG, "nvs_set_u8 fail: %s %s", key, nvs_error(err));
         return 0;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s %s", key, nvs_error(err));
         return 0;
@@ -159,7 +174,7 @@ size_t Preferences::putShort(const char* key, int16_t value) {
         ESP_LOGE(TAG, "nvs_set_i16 fail: %s %s", key, nvs_error(err));
         return 0;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s %s", key, nvs_error(err));
         return 0;
@@ -176,7 +191,7 @@ size_t Preferences::putUShort(const char* key, uint16_t value) {
         ESP_LOGE(TAG, "nvs_set_u16 fail: %s %s", key, nvs_error(err));
         return 0;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s %s", key, nvs_error(err));
         return 0;
@@ -193,7 +208,7 @@ size_t Preferences::putInt(const char* key, int32_t value) {
         ESP_LOGE(TAG, "nvs_set_i32 fail: %s %s", key, nvs_error(err));
         return 0;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s %s", key, nvs_error(err));
         return 0;
@@ -210,7 +225,7 @@ size_t Preferences::putUInt(const char* key, uint32_t value) {
         ESP_LOGE(TAG, "nvs_set_u32 fail: %s %s", key, nvs_error(err));
         return 0;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s %s", key, nvs_error(err));
         return 0;
@@ -235,7 +250,7 @@ size_t Preferences::putLong64(const char* key, int64_t value) {
         ESP_LOGE(TAG, "nvs_set_i64 fail: %s %s", key, nvs_error(err));
         return 0;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s %s", key, nvs_error(err));
         return 0;
@@ -252,7 +267,7 @@ size_t Preferences::putULong64(const char* key, uint64_t value) {
         ESP_LOGE(TAG, "nvs_set_u64 fail: %s %s", key, nvs_error(err));
         return 0;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s %s", key, nvs_error(err));
         return 0;
@@ -281,7 +296,7 @@ size_t Preferences::putString(const char* key, const char* value) {
         ESP_LOGE(TAG, "nvs_set_str fail: %s %s", key, nvs_error(err));
         return 0;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s %s", key, nvs_error(err));
         return 0;
@@ -302,7 +317,7 @@ size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
         ESP_LOGE(TAG, "nvs_set_blob fail: %s %s", key, nvs_error(err));
         return 0;
     }
-    err = nvs_commit(_handle);
+    err = nvs_commit_counted(_handle);
     if (err) {
         ESP_LOGE(TAG, "nvs_commit fail: %s %s", key, nvs_error(err));
         return 0;
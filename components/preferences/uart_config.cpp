@@ -4,6 +4,7 @@
 
 #include "uart_config.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "board.h"
@@ -58,8 +59,14 @@ std::unique_ptr<UartConfig> UartConfig::fromParams(int baud_rate, uint8_t data_b
 }
 
 std::unique_ptr<UartConfig> UartConfig::fromString(const char* cfg) {
+    if (!cfg) {
+        return nullptr;
+    }
+    // optional serial bridge settings
+    const char* options = strchr(cfg, ',');
+    size_t      length = options ? options - cfg : strlen(cfg);
     // max length is a baudrate in the single megabit with 1.5 stop bits: "1500000:8N1.5"
-    if (!cfg || strlen(cfg) > 13) {
+    if (length > 13) {
         return nullptr;
     }
 
@@ -68,7 +75,10 @@ std::unique_ptr<UartConfig> UartConfig::fromString(const char* cfg) {
     char par;
     // safe to use sscanf: max input length check above with big enough buffer
     char stop[10];
-    if (sscanf(cfg, "%d:%1d%c%3s", &baud_rate, &data, &par, stop) != 4) {
+    char base[14];
+    memcpy(base, cfg, length);
+    base[length] = 0;
+    if (sscanf(base, "%d:%1d%c%3s", &baud_rate, &data, &par, stop) != 4) {
         return nullptr;
     }
 
@@ -124,7 +134,42 @@ std::unique_ptr<UartConfig> UartConfig::fromString(const char* cfg) {
         return nullptr;
     }
 
-    return std::make_unique<UartConfig>(baud_rate, data_bits, parity, stop_bits);
+    auto uart_cfg = std::make_unique<UartConfig>(baud_rate, data_bits, parity, stop_bits);
+
+    while (options && *options == ',') {
+        options++;
+        char* end = nullptr;
+        switch (*options) {
+            case 't': {
+                long timeout = strtol(options + 1, &end, 10);
+                if (end == options + 1 || timeout < MIN_UART_RX_TIMEOUT || timeout > MAX_UART_RX_TIMEOUT) {
+                    return nullptr;
+                }
+                uart_cfg->rx_timeout = timeout;
+                break;
+            }
+            case 'd': {
+                long delimiter = strtol(options + 1, &end, 16);
+                if (end != options + 3 || delimiter < 0 || delimiter > 0xFF) {
+                    return nullptr;
+                }
+                uart_cfg->rx_delimiter = delimiter;
+                break;
+            }
+            case 'x':
+                uart_cfg->xonxoff = true;
+                end = const_cast<char*>(options + 1);
+                break;
+            default:
+                return nullptr;
+        }
+        options = end;
+    }
+    if (options && *options) {
+        return nullptr;
+    }
+
+    return uart_cfg;
 }
 
 std::string UartConfig::toString() {
@@ -145,8 +190,17 @@ std::string UartConfig::toString() {
     const char* stop = stopBitsAsString();
 
     // std::format in C++ 20 would be nice, but still not available on some systems :-(
-    char buff[20];
-    snprintf(buff, sizeof(buff), "%d:%d%c%s", baud_rate, bits, par, stop);
+    char buff[40];
+    int  len = snprintf(buff, sizeof(buff), "%d:%d%c%s", baud_rate, bits, par, stop);
+    if (rx_timeout != DEF_UART_RX_TIMEOUT) {
+        len += snprintf(buff + len, sizeof(buff) - len, ",t%u", rx_timeout);
+    }
+    if (rx_delimiter != UART_RX_NO_DELIMITER) {
+        len += snprintf(buff + len, sizeof(buff) - len, ",d%02X", rx_delimiter);
+    }
+    if (xonxoff) {
+        snprintf(buff + len, sizeof(buff) - len, ",x");
+    }
 
     return buff;
 }
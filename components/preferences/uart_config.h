@@ -11,9 +11,18 @@
 
 #define DEF_EXT_PORT_UART_CFG "9600:8N1"
 
+/// Default idle time in ms after which received data is forwarded.
+#define DEF_UART_RX_TIMEOUT 20
+#define MIN_UART_RX_TIMEOUT 1
+#define MAX_UART_RX_TIMEOUT 2000
+/// No RX delimiter: received data is framed with the idle timeout only.
+#define UART_RX_NO_DELIMITER (-1)
+
 /// @brief User configurable UART settings.
 ///
-/// Convert from and to string representations in format "$BAUDRATE:$DATA_BITS$PARITY$STOP_BITS".
+/// Convert from and to string representations in format "$BAUDRATE:$DATA_BITS$PARITY$STOP_BITS", followed by the
+/// optional serial bridge settings ",t$RX_TIMEOUT", ",d$RX_DELIMITER_HEX" and ",x" for XON/XOFF flow control.
+/// Optional settings with default values are omitted, e.g. "9600:8N1,t50,d0D".
 ///
 /// Internal representation is in IDF UART SDK format.
 class UartConfig {
@@ -43,4 +52,10 @@ class UartConfig {
     uart_parity_t parity;
     // UART stop bits length
     uart_stop_bits_t stop_bits;
+    // RX frame delimiter character, UART_RX_NO_DELIMITER if not used
+    int16_t rx_delimiter = UART_RX_NO_DELIMITER;
+    // RX idle timeout in ms: received data is forwarded if no more data is received within this time
+    uint16_t rx_timeout = DEF_UART_RX_TIMEOUT;
+    // XON/XOFF software flow control
+    bool xonxoff = false;
 };
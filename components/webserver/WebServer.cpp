@@ -19,22 +19,37 @@
 #include "esp_netif.h"
 #include "esp_vfs.h"
 #include "esp_wifi.h"
+#include "frogfs/frogfs.h"
+#include "ir_trace.h"
 #include "lwip/sockets.h"
+#include "mem_tag.h"
+#include "metrics.h"
+#include "object_pool.h"
 
 static const char *TAG = "websrv";
 
+static Counter wsFramesIn("ucd_ws_frames_received_total", "Number of received WebSocket data frames");
+static Counter wsFramesOut("ucd_ws_frames_sent_total", "Number of sent WebSocket data frames");
+static Counter wsSendErrors("ucd_ws_send_errors_total", "Number of failed WebSocket frame sends");
+
 WebServer::WebServer()
-    : server_(nullptr), context_(nullptr), wsHandler_(nullptr), restHandler_(nullptr), otaHandler_(nullptr) {
+    : server_(nullptr),
+      context_(nullptr),
+      keepAliveTimer_(nullptr),
+      wsHandler_(nullptr),
+      restHandler_(nullptr),
+      apiHandler_(nullptr),
+      otaHandler_(nullptr) {
     config_ = HTTPD_DEFAULT_CONFIG();
     // default httpd stack size of 4096 doesn't work with OTA: stack overflow in boot partition activation!
     config_.stack_size = CONFIG_UCD_WEB_TASK_STACKSIZE;
     config_.max_open_sockets = CONFIG_UCD_WEB_MAX_OPEN_SOCKETS;
-}
-
-WebServer::~WebServer() {
-    if (context_) {
-        free(context_);
-    }
+    config_.max_uri_handlers = 12;
+#ifdef CONFIG_UCD_WEB_KEEP_ALIVE
+    // close the least recently used connection if a new client connects and all sockets are in use
+    config_.lru_purge_enable = true;
+    config_.open_fn = session_open;
+#endif
 }
 
 // ---- REST ----
@@ -44,11 +59,31 @@ WebServer::~WebServer() {
 
 typedef struct rest_server_context {
     char base_path[ESP_VFS_PATH_MAX + 1];
-    char scratch[SCRATCH_BUFSIZE];
+    /// Optional embedded FrogFS image to serve files directly from flash.
+    const frogfs_fs_t *fs;
+    /// Web root directory inside the FrogFS image.
+    char fs_root[ESP_VFS_PATH_MAX + 1];
+    /// File read buffer for the VFS fallback. Allocated on first use.
+    char *scratch;
 } rest_server_context_t;
 
 static rest_server_context_t *rest_context;
 
+WebServer::~WebServer() {
+    if (context_) {
+        free(static_cast<rest_server_context_t *>(context_)->scratch);
+        free(context_);
+    }
+}
+
+/// WebSocket session context
+typedef struct {
+    /// Session has been authenticated
+    bool authenticated;
+    /// Subscribed broadcast message topics
+    uint32_t subscriptions;
+} ws_session_t;
+
 /// Function to free context
 static void session_free_func(void *ctx) {
     ESP_LOGI(TAG, "freeing WS session");
@@ -79,14 +114,120 @@ static esp_err_t set_content_type_from_file(httpd_req_t *req, const char *filepa
     return httpd_resp_set_type(req, type);
 }
 
-/// @brief Set Connection: close header and CORS headers if enabled
+// ---- HTTP keep-alive ----
+//
+// Only a limited number of REST connections are kept open. Other connections are closed after the response to
+// leave enough sockets for WebSocket clients. The session table is only accessed from the httpd task: in URI
+// handlers, the session open callback and the idle sweep which is queued as httpd work.
+
+#ifdef CONFIG_UCD_WEB_KEEP_ALIVE
+#define KEEP_ALIVE_SWEEP_INTERVAL_MS 1000
+#define KEEP_ALIVE_STR_(x) #x
+#define KEEP_ALIVE_STR(x) KEEP_ALIVE_STR_(x)
+
+typedef struct {
+    /// Socket file descriptor, -1 if the slot is free
+    int fd;
+    /// Timestamp in microseconds of the last response
+    int64_t last_used;
+} keep_alive_session_t;
+
+static keep_alive_session_t keep_alive_sessions[CONFIG_UCD_WEB_KEEP_ALIVE_MAX_SESSIONS] = {};
+// Keep-alive sessions are only enabled if the idle sweep timer is running, otherwise idle connections would never be
+// closed.
+static bool keep_alive_enabled = false;
+
+static keep_alive_session_t *keep_alive_find(int fd) {
+    for (auto &session : keep_alive_sessions) {
+        if (session.fd == fd) {
+            return &session;
+        }
+    }
+    return NULL;
+}
+
+/// @brief Refresh or acquire a keep-alive slot for the connection.
+/// @param fd client socket
+/// @return true if the connection may be kept open, false if all keep-alive slots are in use or keep-alive is disabled.
+static bool keep_alive_acquire(int fd) {
+    if (!keep_alive_enabled) {
+        return false;
+    }
+    keep_alive_session_t *session = keep_alive_find(fd);
+    if (session == NULL) {
+        session = keep_alive_find(-1);
+    }
+    if (session == NULL) {
+        return false;
+    }
+    session->fd = fd;
+    session->last_used = esp_timer_get_time();
+    return true;
+}
+
+/// @brief Close idle keep-alive connections. Must be called in the httpd task.
+/// @param arg httpd server handle
+static void keep_alive_sweep(void *arg) {
+    httpd_handle_t hd = static_cast<httpd_handle_t>(arg);
+    int64_t        now = esp_timer_get_time();
+
+    for (auto &session : keep_alive_sessions) {
+        if (session.fd < 0) {
+            continue;
+        }
+        // session closed by the client or upgraded to a WebSocket connection
+        if (httpd_ws_get_fd_info(hd, session.fd) != HTTPD_WS_CLIENT_HTTP) {
+            session.fd = -1;
+            continue;
+        }
+        if (now - session.last_used > CONFIG_UCD_WEB_KEEP_ALIVE_TIMEOUT * 1000000LL) {
+            ESP_LOGD(TAG, "Closing idle keep-alive connection: %d", session.fd);
+            httpd_sess_trigger_close(hd, session.fd);
+            session.fd = -1;
+        }
+    }
+}
+#endif
+
+esp_err_t WebServer::session_open(httpd_handle_t hd, int sockfd) {
+#ifdef CONFIG_UCD_WEB_KEEP_ALIVE
+    // socket descriptors are reused: forget a previous session
+    keep_alive_session_t *session = keep_alive_find(sockfd);
+    if (session) {
+        session->fd = -1;
+    }
+#endif
+    return ESP_OK;
+}
+
+void WebServer::keep_alive_timer_cb(void *arg) {
+#ifdef CONFIG_UCD_WEB_KEEP_ALIVE
+    WebServer *server = static_cast<WebServer *>(arg);
+    if (server && server->server_) {
+        httpd_queue_work(server->server_, keep_alive_sweep, server->server_);
+    }
+#endif
+}
+
+/// @brief Set Connection header and CORS headers if enabled
+///
+/// A keep-alive header is set if keep-alive is enabled and a keep-alive slot is available, otherwise the
+/// connection is closed after the response.
 /// @param req http request
 /// @return ESP_OK: On successfully appending new header - ESP_ERR_HTTPD_RESP_HDR : Total additional headers exceed max
 /// allowed - ESP_ERR_HTTPD_INVALID_REQ : Invalid request pointer
 static esp_err_t set_common_headers(httpd_req_t *req) {
-    // Force browsers to close connection, we only have limited resources.
-    // If ESP_FAIL is returned the socket is automatically closed.
-    esp_err_t ret = httpd_resp_set_hdr(req, "Connection", "close");
+    esp_err_t ret;
+#ifdef CONFIG_UCD_WEB_KEEP_ALIVE
+    if (keep_alive_acquire(httpd_req_to_sockfd(req))) {
+        ret = httpd_resp_set_hdr(req, "Keep-Alive", "timeout=" KEEP_ALIVE_STR(CONFIG_UCD_WEB_KEEP_ALIVE_TIMEOUT));
+    } else
+#endif
+    {
+        // Force browsers to close connection, we only have limited resources.
+        // If ESP_FAIL is returned the socket is automatically closed.
+        ret = httpd_resp_set_hdr(req, "Connection", "close");
+    }
 
     if (CONFIG_UCD_WEB_ENABLE_CORS) {
         if (ret == ESP_OK) {
@@ -103,13 +244,118 @@ static esp_err_t set_common_headers(httpd_req_t *req) {
     return ret;
 }
 
+/// @brief Check if the client accepts the given content encoding.
+/// @param req http request
+/// @param encoding content encoding, e.g. `gzip`
+/// @return true if the encoding is listed in the Accept-Encoding header
+static bool accepts_encoding(httpd_req_t *req, const char *encoding) {
+    char   buf[64];
+    size_t len = httpd_req_get_hdr_value_len(req, "Accept-Encoding");
+    if (len == 0 || len >= sizeof(buf)) {
+        return false;
+    }
+    if (httpd_req_get_hdr_value_str(req, "Accept-Encoding", buf, sizeof(buf)) != ESP_OK) {
+        return false;
+    }
+    return strstr(buf, encoding) != NULL;
+}
+
+/// @brief Send the requested file directly from the memory mapped FrogFS image without an intermediate copy.
+///
+/// Compressed files are sent as stored with a matching Content-Encoding header if the client accepts it.
+/// @param req http request
+/// @param rest_context server context with the FrogFS image
+/// @param filepath file path relative to the web root, including the leading slash
+/// @return ESP_OK if the file was sent, ESP_ERR_NOT_FOUND if the file is not in the image or cannot be served raw,
+/// ESP_FAIL if sending failed.
+static esp_err_t send_embedded_file(httpd_req_t *req, rest_server_context_t *rest_context, const char *filepath) {
+    char fs_path[FILE_PATH_MAX];
+    strlcpy(fs_path, rest_context->fs_root, sizeof(fs_path));
+    strlcat(fs_path, filepath, sizeof(fs_path));
+
+    const frogfs_entry_t *entry = frogfs_get_entry(rest_context->fs, fs_path);
+    if (entry == NULL || !frogfs_is_file(entry)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    frogfs_stat_t st;
+    frogfs_stat(rest_context->fs, entry, &st);
+
+    const char *encoding = NULL;
+    switch (st.compression) {
+        case FROGFS_COMP_ALGO_NONE:
+            break;
+        case FROGFS_COMP_ALGO_GZIP:
+            encoding = "gzip";
+            break;
+        case FROGFS_COMP_ALGO_ZLIB:
+            // HTTP "deflate" is the zlib format
+            encoding = "deflate";
+            break;
+        default:
+            // no HTTP equivalent (heatshrink): must be decompressed by the VFS
+            return ESP_ERR_NOT_FOUND;
+    }
+    if (encoding) {
+        // the response depends on Accept-Encoding, also if the file is decompressed by the VFS fallback
+        httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+        if (!accepts_encoding(req, encoding)) {
+            return ESP_ERR_NOT_FOUND;
+        }
+    }
+
+    frogfs_fh_t *fh = frogfs_open(rest_context->fs, entry, FROGFS_OPEN_RAW);
+    if (fh == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const void *data;
+    size_t      len = frogfs_access(fh, &data);
+
+    set_common_headers(req);
+    set_content_type_from_file(req, filepath);
+    if (encoding) {
+        httpd_resp_set_hdr(req, "Content-Encoding", encoding);
+    }
+
+    // the data pointer is valid as long as the image is mapped: no need to copy it into a buffer
+    esp_err_t ret = httpd_resp_send(req, static_cast<const char *>(data), len);
+    frogfs_close(fh);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "File sending failed: %s (%d)", filepath, ret);
+        return ESP_FAIL;
+    }
+    ESP_LOGD(TAG, "Embedded file sending complete: %s (%zu bytes)", filepath, len);
+    return ESP_OK;
+}
+
 /// @brief Send HTTP response with the contents of the requested file
+///
+/// Files in the embedded FrogFS image are sent directly from flash, all other files are read through the VFS.
 /// @param req http request
 /// @return ESP_OK if successfully sent, ESP_FAIL if the url doesn't exist or the file couldn't be read
 static esp_err_t rest_common_get_handler(httpd_req_t *req) {
     char filepath[FILE_PATH_MAX];
 
     rest_server_context_t *rest_context = (rest_server_context_t *)req->user_ctx;
+
+    if (rest_context->fs) {
+        strlcpy(filepath, req->uri, sizeof(filepath));
+        // ignore query parameters
+        char *query = strchr(filepath, '?');
+        if (query) {
+            *query = 0;
+        }
+        if (filepath[strlen(filepath) - 1] == '/') {
+            strlcat(filepath, "index.html", sizeof(filepath));
+        }
+        esp_err_t ret = send_embedded_file(req, rest_context, filepath);
+        if (ret != ESP_ERR_NOT_FOUND) {
+            return ret;
+        }
+    }
+
     strlcpy(filepath, rest_context->base_path, sizeof(filepath));
     strlcat(filepath, req->uri, sizeof(filepath));
     if (req->uri[strlen(req->uri) - 1] == '/') {
@@ -128,6 +374,16 @@ static esp_err_t rest_common_get_handler(httpd_req_t *req) {
         return ESP_FAIL;
     }
 
+    if (rest_context->scratch == NULL) {
+        rest_context->scratch = static_cast<char *>(malloc(SCRATCH_BUFSIZE));
+        if (rest_context->scratch == NULL) {
+            close(fd);
+            ESP_LOGE(TAG, "Failed to allocate file buffer");
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+            return ESP_FAIL;
+        }
+    }
+
     set_common_headers(req);
     set_content_type_from_file(req, filepath);
 
@@ -174,6 +430,21 @@ esp_err_t WebServer::api_handler(httpd_req_t *req) {
     return ESP_FAIL;
 }
 
+/// @brief REST API handler for all /api/ routes except the public info route.
+/// @param req http request
+/// @return ESP_OK if successfully sent, ESP_FAIL if no handler is installed or the connection should be closed
+esp_err_t WebServer::rest_api_handler(httpd_req_t *req) {
+    set_common_headers(req);
+
+    WebServer *server = static_cast<WebServer *>(req->user_ctx);
+    if (server && server->apiHandler_) {
+        return server->apiHandler_(req);
+    }
+
+    httpd_resp_send_json_err(req, HTTPD_404_NOT_FOUND, "No handler configured");
+    return ESP_FAIL;
+}
+
 /// @brief OTA update handler.
 /// @param req http request
 /// @return ESP_OK if successfully processed, ESP_FAIL if the url doesn't exist or no OTA handler is installed
@@ -187,12 +458,25 @@ esp_err_t WebServer::ota_handler(httpd_req_t *req) {
     return ESP_FAIL;
 }
 
+/*
+ * Metrics handler for the /metrics route: all registered metrics in Prometheus text exposition format.
+ */
+esp_err_t WebServer::metrics_handler(httpd_req_t *req) {
+    std::string out;
+    out.reserve(2048);
+    MetricsRegistry::instance().write(out);
+
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    set_common_headers(req);
+    return httpd_resp_send(req, out.c_str(), out.length());
+}
+
 // ---- WebSocket ----
 
 /*
  * Structure holding server handle and internal socket fd in order to use out of request send
  *
- * Attention: the `payload` buffer will automatically be freed after send!
+ * Attention: the `payload` buffer will automatically be released after send!
  */
 struct async_resp_arg {
     httpd_handle_t hd;
@@ -202,10 +486,55 @@ struct async_resp_arg {
     httpd_ws_type_t type;
     /// Pre-allocated data buffer.
     uint8_t *payload;
+    /// Allocation tag of the payload buffer
+    mem_tag_t payload_tag;
     /// Length of the WebSocket data
     size_t len;
+    /// Subscription topic filter for broadcast messages
+    uint32_t subscription;
+    /// IR trace identifier, 0 if not traced
+    uint32_t traceId;
 };
 
+// Send arguments and payload buffers for the frequent small WebSocket messages, e.g. IR send replies, without heap
+// allocations. Sends exceeding the pool or the payload buffer size fall back to heap allocations.
+static ObjectPool<async_resp_arg, CONFIG_UCD_WEB_WS_SEND_POOL_SIZE> wsSendPool;
+static uint8_t wsPayloadSlab[CONFIG_UCD_WEB_WS_SEND_POOL_SIZE][CONFIG_UCD_WEB_WS_SEND_PAYLOAD_SIZE];
+
+static async_resp_arg *acquire_resp_arg() {
+    async_resp_arg *resp_arg = wsSendPool.acquire();
+    if (resp_arg == nullptr) {
+        resp_arg = static_cast<async_resp_arg *>(malloc(sizeof(struct async_resp_arg)));
+    }
+    return resp_arg;
+}
+
+/// Copy the text payload into the pooled payload buffer of the send argument if it fits, otherwise into a heap buffer.
+static bool copy_resp_payload(async_resp_arg *resp_arg, const char *msg, size_t len) {
+    int index = wsSendPool.index(resp_arg);
+    if (index >= 0 && len < CONFIG_UCD_WEB_WS_SEND_PAYLOAD_SIZE) {
+        resp_arg->payload = wsPayloadSlab[index];
+        memcpy(resp_arg->payload, msg, len + 1);
+    } else {
+        resp_arg->payload = (uint8_t *)mem_tag_strdup(MEM_TAG_WEB, msg);
+    }
+    resp_arg->payload_tag = MEM_TAG_WEB;
+    resp_arg->len = len;
+    return resp_arg->payload != nullptr;
+}
+
+static void release_resp_arg(async_resp_arg *resp_arg) {
+    int index = wsSendPool.index(resp_arg);
+    if (resp_arg->payload && (index < 0 || resp_arg->payload != wsPayloadSlab[index])) {
+        mem_tag_free(resp_arg->payload_tag, resp_arg->payload);
+    }
+    if (index < 0) {
+        free(resp_arg);
+    } else {
+        wsSendPool.release(resp_arg);
+    }
+}
+
 /*
  * async send function, which we put into the httpd work queue
  */
@@ -224,11 +553,14 @@ static void ws_async_send(void *arg) {
 
     ESP_LOGI(TAG, "ws_async_send: fd=%d, len=%d, msg=%s", fd, ws_pkt.len, (const char *)ws_pkt.payload);
     esp_err_t ret = httpd_ws_send_frame_async(hd, fd, &ws_pkt);
-    if (ret != ESP_OK) {
+    if (ret == ESP_OK) {
+        wsFramesOut.inc();
+        ir_trace_point(resp_arg->traceId, IrTracePoint::RESPONSE_SENT);
+    } else {
+        wsSendErrors.inc();
         ESP_LOGE(TAG, "Failed to send async: %d", ret);
     }
-    free(resp_arg->payload);
-    free(resp_arg);
+    release_resp_arg(resp_arg);
 }
 
 /*
@@ -254,10 +586,10 @@ esp_err_t WebServer::ws_handler(httpd_req_t *req) {
     // Create session's context for authentication flag if not already available
     if (!req->sess_ctx) {
         ESP_LOGI(TAG, "allocating new WS session");
-        req->sess_ctx = malloc(sizeof(bool));
+        // Note: calloc initializes memory to 0: not authenticated and no subscriptions
+        req->sess_ctx = calloc(1, sizeof(ws_session_t));
         ESP_RETURN_ON_FALSE(req->sess_ctx, ESP_ERR_NO_MEM, TAG, "Failed to allocate sess_ctx");
         req->free_ctx = session_free_func;
-        *(bool *)req->sess_ctx = false;
     }
 
     httpd_ws_frame_t ws_pkt;
@@ -312,10 +644,15 @@ esp_err_t WebServer::ws_handler(httpd_req_t *req) {
         return ret;
     }
 
+    wsFramesIn.inc();
+    // recorded in the IR trace if the message turns out to be an IR send request
+    ir_trace_pending(IrTracePoint::WS_RECEIVED);
+
     auto fd = httpd_req_to_sockfd(req);
-    bool authenticated = *(bool *)req->sess_ctx;
+    bool authenticated = static_cast<ws_session_t *>(req->sess_ctx)->authenticated;
     // TODO let client free buffer? Could be more efficient!
     ret = server->wsHandler_(req, fd, ws_type, buf, ws_pkt.len, authenticated);
+    ir_trace_clear_pending();
 
     free(buf);
     return ret;
@@ -359,6 +696,28 @@ esp_err_t WebServer::startWebServer() {
                                        .supported_subprotocol = NULL};
     httpd_register_uri_handler(server_, &system_info_get_uri);
 
+    // URI handlers for the REST API. Must be registered after the more specific /api/ routes.
+    for (httpd_method_t method : {HTTP_GET, HTTP_POST, HTTP_PUT}) {
+        httpd_uri_t api_uri = {.uri = "/api/*",
+                               .method = method,
+                               .handler = rest_api_handler,
+                               .user_ctx = this,
+                               .is_websocket = false,
+                               .handle_ws_control_frames = false,
+                               .supported_subprotocol = NULL};
+        httpd_register_uri_handler(server_, &api_uri);
+    }
+
+    // Metrics exporter
+    httpd_uri_t metrics_get_uri = {.uri = "/metrics",
+                                   .method = HTTP_GET,
+                                   .handler = metrics_handler,
+                                   .user_ctx = this,
+                                   .is_websocket = false,
+                                   .handle_ws_control_frames = false,
+                                   .supported_subprotocol = NULL};
+    httpd_register_uri_handler(server_, &metrics_get_uri);
+
     // OTA update handler
     httpd_uri_t ota_post_uri = {.uri = "/update",
                                 .method = HTTP_POST,
@@ -379,6 +738,34 @@ esp_err_t WebServer::startWebServer() {
                                   .supported_subprotocol = NULL};
     httpd_register_uri_handler(server_, &common_get_uri);
 
+#ifdef CONFIG_UCD_WEB_KEEP_ALIVE
+    for (auto &session : keep_alive_sessions) {
+        session.fd = -1;
+    }
+    esp_err_t timerRet = ESP_OK;
+    if (!keepAliveTimer_) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = &WebServer::keep_alive_timer_cb,
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "keep-alive",
+            .skip_unhandled_events = true,
+        };
+        timerRet = esp_timer_create(&timer_args, &keepAliveTimer_);
+        if (timerRet != ESP_OK) {
+            keepAliveTimer_ = nullptr;
+        }
+    }
+    if (keepAliveTimer_) {
+        timerRet = esp_timer_start_periodic(keepAliveTimer_, KEEP_ALIVE_SWEEP_INTERVAL_MS * 1000);
+    }
+    // without the idle sweep, every REST response closes the connection
+    keep_alive_enabled = timerRet == ESP_OK;
+    if (!keep_alive_enabled) {
+        ESP_LOGE(TAG, "Failed to start keep-alive timer, keep-alive disabled: %d", timerRet);
+    }
+#endif
+
     return ESP_OK;
 }
 
@@ -386,6 +773,12 @@ esp_err_t WebServer::stopWebServer() {
     if (server_ == NULL) {
         return ESP_OK;
     }
+#ifdef CONFIG_UCD_WEB_KEEP_ALIVE
+    keep_alive_enabled = false;
+#endif
+    if (keepAliveTimer_) {
+        esp_timer_stop(keepAliveTimer_);
+    }
     esp_err_t ret = httpd_stop(server_);
     server_ = NULL;
     if (ret != ESP_OK) {
@@ -471,6 +864,14 @@ esp_err_t WebServer::init(uint16_t port, const char *base_path) {
     return ESP_OK;
 }
 
+void WebServer::setEmbeddedFs(const frogfs_fs_t *fs, const char *fs_root) {
+    if (!rest_context) {
+        return;
+    }
+    rest_context->fs = fs;
+    strlcpy(rest_context->fs_root, fs_root ? fs_root : "", sizeof(rest_context->fs_root));
+}
+
 void WebServer::onWsEvent(WebSocketServerEvent handler) {
     wsHandler_ = handler;
 }
@@ -479,6 +880,10 @@ void WebServer::setRestHandler(RestCallback handler) {
     restHandler_ = handler;
 }
 
+void WebServer::setApiHandler(RestCallback handler) {
+    apiHandler_ = handler;
+}
+
 void WebServer::setOtaHandler(RestCallback handler) {
     otaHandler_ = handler;
 }
@@ -517,41 +922,87 @@ esp_err_t WebServer::setAuthenticated(int id, bool authenticated) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    *(bool *)sess_ctx = authenticated;
+    static_cast<ws_session_t *>(sess_ctx)->authenticated = authenticated;
 
     ESP_LOGI(TAG, "Set connection %d authenticated: %d", id, authenticated);
 
     return ESP_OK;
 }
 
-esp_err_t WebServer::sendWsTxt(int id, std::string &msg) {
-    return sendWsTxt(id, msg.c_str());
+esp_err_t WebServer::setSubscriptions(int id, uint32_t subscriptions) {
+    if (!server_) {
+        return ESP_FAIL;
+    }
+
+    void *sess_ctx = httpd_sess_get_ctx(server_, id);
+    if (!sess_ctx) {
+        ESP_LOGW(TAG, "Cannot set subscriptions: no session available for %d", id);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    static_cast<ws_session_t *>(sess_ctx)->subscriptions = subscriptions;
+
+    ESP_LOGI(TAG, "Set connection %d subscriptions: 0x%lx", id, subscriptions);
+
+    return ESP_OK;
+}
+
+esp_err_t WebServer::sendWsTxt(int id, std::string &msg, uint32_t traceId) {
+    return sendWsTxt(id, msg.c_str(), traceId);
 }
 
-esp_err_t WebServer::sendWsTxt(int id, const char *msg) {
-    return sendWsTxt(id, strdup(msg));
+esp_err_t WebServer::sendWsTxt(int id, const char *msg, uint32_t traceId) {
+    if (!server_) {
+        return ESP_FAIL;
+    }
+
+    if (httpd_ws_get_fd_info(server_, id) != HTTPD_WS_CLIENT_WEBSOCKET) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    async_resp_arg *resp_arg = acquire_resp_arg();
+    if (!resp_arg) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (!copy_resp_payload(resp_arg, msg, strlen(msg))) {
+        release_resp_arg(resp_arg);
+        return ESP_ERR_NO_MEM;
+    }
+    return queueWsTxt(id, resp_arg, traceId);
 }
-esp_err_t WebServer::sendWsTxt(int id, char *msg) {
+
+esp_err_t WebServer::sendWsTxt(int id, char *msg, uint32_t traceId) {
     if (!server_) {
+        mem_tag_free(MEM_TAG_JSON, msg);
         return ESP_FAIL;
     }
 
     if (httpd_ws_get_fd_info(server_, id) != HTTPD_WS_CLIENT_WEBSOCKET) {
+        mem_tag_free(MEM_TAG_JSON, msg);
         return ESP_ERR_INVALID_ARG;
     }
 
+    async_resp_arg *resp_arg = acquire_resp_arg();
+    if (!resp_arg) {
+        mem_tag_free(MEM_TAG_JSON, msg);
+        return ESP_ERR_NO_MEM;
+    }
+    resp_arg->payload = (uint8_t *)msg;
+    resp_arg->payload_tag = MEM_TAG_JSON;
+    resp_arg->len = 0;
+    return queueWsTxt(id, resp_arg, traceId);
+}
+
+esp_err_t WebServer::queueWsTxt(int id, async_resp_arg *resp_arg, uint32_t traceId) {
     // ESP_LOGI(TAG, "Active client (fd=%d) -> sending async message: %s", id, msg);
-    struct async_resp_arg *resp_arg = static_cast<async_resp_arg *>(malloc(sizeof(struct async_resp_arg)));
-    assert(resp_arg);
     resp_arg->hd = server_;
     resp_arg->fd = id;
     resp_arg->type = HTTPD_WS_TYPE_TEXT;
-    // FIXME msg arg & buffer copy
-    resp_arg->payload = (uint8_t *)msg;
-    resp_arg->len = 0;
+    resp_arg->subscription = 0;
+    resp_arg->traceId = traceId;
     esp_err_t ret = httpd_queue_work(resp_arg->hd, ws_async_send, resp_arg);
     if (ret != ESP_OK) {
-        free(resp_arg);
+        release_resp_arg(resp_arg);
         ESP_LOGE(TAG, "httpd_queue_work failed! %d", ret);
     }
 
@@ -574,6 +1025,72 @@ void WebServer::broadcastWsTxt(std::string &msg) {
     }
 }
 
+/*
+ * Broadcast a text message to all subscribed WebSocket clients. Executed in the httpd work queue, which allows
+ * accessing the session contexts.
+ */
+static void ws_async_broadcast(void *arg) {
+    struct async_resp_arg *resp_arg = static_cast<async_resp_arg *>(arg);
+    assert(resp_arg->payload);
+    httpd_handle_t hd = resp_arg->hd;
+    uint32_t       subscription = resp_arg->subscription;
+
+    size_t clients = CONFIG_UCD_WEB_MAX_OPEN_SOCKETS;
+    int    client_fds[CONFIG_UCD_WEB_MAX_OPEN_SOCKETS];
+    if (httpd_get_client_list(hd, &clients, client_fds) == ESP_OK) {
+        httpd_ws_frame_t ws_pkt;
+        memset(&ws_pkt, 0, sizeof(httpd_ws_frame_t));
+        ws_pkt.type = HTTPD_WS_TYPE_TEXT;
+        ws_pkt.payload = resp_arg->payload;
+        ws_pkt.len = resp_arg->len;
+
+        for (size_t i = 0; i < clients; ++i) {
+            int fd = client_fds[i];
+            if (httpd_ws_get_fd_info(hd, fd) != HTTPD_WS_CLIENT_WEBSOCKET) {
+                continue;
+            }
+            ws_session_t *session = static_cast<ws_session_t *>(httpd_sess_get_ctx(hd, fd));
+            if (!session || !session->authenticated || !(session->subscriptions & subscription)) {
+                continue;
+            }
+            esp_err_t ret = httpd_ws_send_frame_async(hd, fd, &ws_pkt);
+            if (ret == ESP_OK) {
+                wsFramesOut.inc();
+            } else {
+                wsSendErrors.inc();
+                ESP_LOGE(TAG, "Failed to send broadcast to %d: %d", fd, ret);
+            }
+        }
+    }
+
+    release_resp_arg(resp_arg);
+}
+
+void WebServer::broadcastWsTxt(const std::string &msg, uint32_t subscription) {
+    if (!server_) {
+        return;
+    }
+
+    async_resp_arg *resp_arg = acquire_resp_arg();
+    if (!resp_arg) {
+        return;
+    }
+    if (!copy_resp_payload(resp_arg, msg.c_str(), msg.length())) {
+        release_resp_arg(resp_arg);
+        return;
+    }
+    resp_arg->hd = server_;
+    resp_arg->fd = -1;
+    resp_arg->subscription = subscription;
+    resp_arg->traceId = 0;
+    resp_arg->type = HTTPD_WS_TYPE_TEXT;
+    esp_err_t ret = httpd_queue_work(resp_arg->hd, ws_async_broadcast, resp_arg);
+    if (ret != ESP_OK) {
+        release_resp_arg(resp_arg);
+        ESP_LOGE(TAG, "httpd_queue_work failed! %d", ret);
+    }
+}
+
 esp_err_t WebServer::getRemoteIp(int fd, struct sockaddr_in6 *addr_in) {
     socklen_t addrlen = sizeof(*addr_in);
     if (lwip_getpeername(fd, (struct sockaddr *)addr_in, &addrlen) != -1) {
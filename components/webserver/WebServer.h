@@ -10,6 +10,9 @@
 #include <string>
 
 #include "esp_http_server.h"
+#include "esp_timer.h"
+#include "frogfs/frogfs.h"
+#include "mem_tag.h"
 
 // TODO plain and simple callbacks exposing esp_http_server internals.
 //      See PsychicHttp for abstraction with Request, Endpoint, Handler classes.
@@ -24,6 +27,8 @@ typedef enum {
     WS_BIN,
 } WsTypeEnum;
 
+struct async_resp_arg;
+
 /**
  * Handler to call for WebSocket events.
  *
@@ -62,6 +67,15 @@ class WebServer {
     ///  - Others: Fail
     esp_err_t init(uint16_t port, const char *base_path);
 
+    /// @brief Serve files directly from an embedded FrogFS image instead of reading them through the VFS.
+    ///
+    /// Files are sent from the memory mapped image without an intermediate buffer copy. Compressed files are sent
+    /// as stored if supported by the client. Files not found in the image are still served from `base_path`.
+    /// Must be called after `init`.
+    /// @param fs FrogFS image handle.
+    /// @param fs_root web root directory inside the image, e.g. `webroot`.
+    void setEmbeddedFs(const frogfs_fs_t *fs, const char *fs_root);
+
     /// @brief WebSocket callback event handler for static /ws route.
     /// @param handler callback function.
     void onWsEvent(WebSocketServerEvent handler);
@@ -70,6 +84,10 @@ class WebServer {
     /// @param handler callback function.
     void setRestHandler(RestCallback handler);
 
+    /// @brief REST API callback handler for all other /api/ routes.
+    /// @param handler callback function.
+    void setApiHandler(RestCallback handler);
+
     /// @brief OTA callback handler for static /update route.
     /// @param handler callback function.
     void setOtaHandler(RestCallback handler);
@@ -88,27 +106,47 @@ class WebServer {
     /// @return ESP_OK if successful
     esp_err_t setAuthenticated(int id, bool authenticated = true);
 
+    /// @brief Set the subscribed broadcast topics of a WebSocket connection.
+    /// @param id client identifier
+    /// @param subscriptions bit mask of subscribed topics, 0 to unsubscribe from all topics.
+    /// @return ESP_OK if successful
+    esp_err_t setSubscriptions(int id, uint32_t subscriptions);
+
     /// @brief Send text message to a WebSocket client
     /// @param id client identifier
-    /// @param msg text message
+    /// @param msg text message. A `char *` message must be allocated by `cJSON_Print*` and is freed after sending!
+    /// @param traceId optional IR trace identifier to record the response sent trace point, 0 if not used.
     /// @return ESP_OK if successful
-    esp_err_t sendWsTxt(int id, std::string &msg);
-    esp_err_t sendWsTxt(int id, const char *msg);
-    esp_err_t sendWsTxt(int id, char *msg);
+    esp_err_t sendWsTxt(int id, std::string &msg, uint32_t traceId = 0);
+    esp_err_t sendWsTxt(int id, const char *msg, uint32_t traceId = 0);
+    esp_err_t sendWsTxt(int id, char *msg, uint32_t traceId = 0);
 
     /// @brief Send a message to all authenticated WebSocket clients
     /// @param msg text message
     void broadcastWsTxt(std::string &msg);
 
+    /// @brief Send a message to all authenticated WebSocket clients which subscribed to the given topic.
+    /// @param msg text message
+    /// @param subscription topic bit mask, see `setSubscriptions`.
+    void broadcastWsTxt(const std::string &msg, uint32_t subscription);
+
     static esp_err_t getRemoteIp(int id, struct sockaddr_in6 *addr_in);
 
  private:
     esp_err_t startWebServer();
     esp_err_t stopWebServer();
 
+    /// Queue a text message for sending. Takes ownership of `resp_arg` with its payload, which are released after send.
+    esp_err_t queueWsTxt(int id, struct async_resp_arg *resp_arg, uint32_t traceId);
+
     static esp_err_t ws_handler(httpd_req_t *req);
     static esp_err_t api_handler(httpd_req_t *req);
+    static esp_err_t rest_api_handler(httpd_req_t *req);
     static esp_err_t ota_handler(httpd_req_t *req);
+    static esp_err_t metrics_handler(httpd_req_t *req);
+
+    static esp_err_t session_open(httpd_handle_t hd, int sockfd);
+    static void      keep_alive_timer_cb(void *arg);
 
     static void connect_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
     static void disconnect_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
@@ -118,9 +156,12 @@ class WebServer {
     httpd_handle_t server_;
     httpd_config_t config_;
     void          *context_;
+    /// Periodic timer to close idle keep-alive connections.
+    esp_timer_handle_t keepAliveTimer_;
 
     WebSocketServerEvent wsHandler_;
     RestCallback         restHandler_;
+    RestCallback         apiHandler_;
     RestCallback         otaHandler_;
 };
 
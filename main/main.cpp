@@ -4,6 +4,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #include "driver/gpio.h"
@@ -28,12 +29,17 @@
 #include "frogfs/vfs.h"
 #include "globalcache_server.h"
 #include "ir_codes.h"
+#include "ir_fanout.h"
 #include "led_pattern.h"
 #include "mdns.h"
+#include "mem_tag.h"
 #include "network.h"
 #include "nvs_flash.h"
 #include "ota.h"
 #include "service_ir.h"
+#include "system_metrics.h"
+#include "task_stats.h"
+#include "uart_bridge.h"
 #include "uc_events.h"
 #include "ucd_api.h"
 
@@ -70,19 +76,29 @@ static esp_err_t init_mdns(Config *cfg) {
     ESP_ERROR_CHECK(mdns_hostname_set(hostname));
     ESP_ERROR_CHECK(mdns_instance_name_set(hostname));
 
+    auto        group = cfg->getDockGroup();
+    std::string peer_port = std::to_string(CONFIG_UCD_IR_FANOUT_PORT);
+
+    // IR fan-out peer discovery: group and peer_port are only advertised if a dock group is configured
     mdns_txt_item_t serviceTxtData[] = {{"ver", version.c_str()},
                                         {"model", cfg->getModel()},
                                         {"rev", cfg->getRevision()},
                                         {"name", friendly_name.c_str()},
-                                        {"ws_path", "/ws"}};
+                                        {"ws_path", "/ws"},
+                                        {"group", group.c_str()},
+                                        {"peer_port", peer_port.c_str()}};
+    size_t          txtCount = sizeof(serviceTxtData) / sizeof(serviceTxtData[0]);
+    if (group.empty()) {
+        txtCount -= 2;
+    }
 
-    return mdns_service_add(NULL, "_uc-dock", "_tcp", CONFIG_UCD_WEB_SERVER_PORT, serviceTxtData,
-                            sizeof(serviceTxtData) / sizeof(serviceTxtData[0]));
+    return mdns_service_add(NULL, "_uc-dock", "_tcp", CONFIG_UCD_WEB_SERVER_PORT, serviceTxtData, txtCount);
 }
 
 /// @brief Initialize FrogFS (embedded) and SPIFFS (partition) filesystems
+/// @param embedded_fs optional output parameter for the embedded FrogFS image handle.
 /// @return ESP_OK or ESP_FAIL
-esp_err_t init_fs(void) {
+esp_err_t init_fs(frogfs_fs_t **embedded_fs = nullptr) {
     frogfs_config_t frogfs_config = {
         .addr = frogfs_bin,
         .part_label = nullptr,
@@ -100,6 +116,9 @@ esp_err_t init_fs(void) {
         .max_files = 5,
     };
     frogfs_vfs_register(&frogfs_vfs_conf);
+    if (embedded_fs) {
+        *embedded_fs = fs;
+    }
 
     esp_vfs_littlefs_conf_t conf = {
         .base_path = "/data",
@@ -315,6 +334,8 @@ static void factoryResetHandler(void *arg, esp_event_base_t event_base, int32_t
 
 extern "C" void app_main(void) {
     esp_err_t ret = ESP_OK;
+    // before any cJSON object is created
+    mem_tag_init_cjson();
     init_gpios();
 
     // to set another timezone
@@ -336,7 +357,8 @@ extern "C" void app_main(void) {
     }
 
     init_led();
-    uc_error_check(init_fs(), uc_errors::UC_ERROR_INIT_FS);
+    frogfs_fs_t *embedded_fs = nullptr;
+    uc_error_check(init_fs(&embedded_fs), uc_errors::UC_ERROR_INIT_FS);
 
     // setup external ports
     auto ports = init_external_ports(&cfg);
@@ -348,11 +370,20 @@ extern "C" void app_main(void) {
     uc_fatal_error_check(web.init(CONFIG_UCD_WEB_SERVER_PORT, CONFIG_UCD_WEB_MOUNT_POINT),
                          uc_errors::UC_ERROR_INIT_WEBSRV);
 
+    // serve embedded web files directly from flash if the web root is located in the embedded FrogFS image
+    const size_t embedded_mount_len = strlen(CONFIG_UCD_EMBEDDED_MOUNT_POINT);
+    if (embedded_fs &&
+        strncmp(CONFIG_UCD_WEB_MOUNT_POINT, CONFIG_UCD_EMBEDDED_MOUNT_POINT, embedded_mount_len) == 0) {
+        web.setEmbeddedFs(embedded_fs, CONFIG_UCD_WEB_MOUNT_POINT + embedded_mount_len);
+    }
+
     web.setRestHandler(on_rest_sysinfo);
     web.setOtaHandler(on_ota_upload);
 
     static DockApi api(&cfg, &web, ports);
     api.init();
+    ESP_ERROR_CHECK_WITHOUT_ABORT(init_system_metrics());
+    ESP_ERROR_CHECK_WITHOUT_ABORT(task_stats_init());
 
     uc_error_check(init_button(), uc_errors::UC_ERROR_INIT_BUTTON);
     if (cfg.hasChargingFeature()) {
@@ -364,14 +395,20 @@ extern "C" void app_main(void) {
     irService.init(ports, cfg.getIrSendCore(), cfg.getIrSendPriority(), cfg.getIrLearnCore(), cfg.getIrLearnPriority(),
                    [=](IrResponse *response) -> esp_err_t {
                        esp_err_t ret;
-                       // check if response is for a specific client (send IR response), or a learning broadcast
+                       // check if response is for a specific client (send IR response), a relay event or a learning broadcast
                        if (response->clientId >= 0) {
-                           ret = web.sendWsTxt(response->clientId, response->message);
+                           // const: the message is copied, the response buffer belongs to the response pool
+                           ret = web.sendWsTxt(response->clientId, static_cast<const char *>(response->message),
+                                               response->traceId);
+                       } else if (response->clientId == IR_CLIENT_RELAY) {
+                           web.broadcastWsTxt(response->message, UCD_SUBSCRIPTION_IR_RELAY);
+                           ret = ESP_OK;
                        } else {
-                           web.broadcastWsTxt(response->message);
+                           std::string msg = response->message;
+                           web.broadcastWsTxt(msg);
                            ret = ESP_OK;
                        }
-                       delete response;
+                       InfraredService::getInstance().releaseResponse(response);
                        return ret;
                    });
 
@@ -379,6 +416,14 @@ extern "C" void app_main(void) {
         GlobalCacheServer *gcServer = new GlobalCacheServer(&irService, &cfg, cfg.isGcServerBeaconEnabled());
     }
 
+    IrFanout::getInstance().init(&irService, &cfg, [=](int16_t clientId, const char *message) {
+        web.sendWsTxt(clientId, message, 0);
+    });
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(UartBridge::getInstance().init(ports, [=](const char *message) {
+        web.broadcastWsTxt(message, UCD_SUBSCRIPTION_UART);
+    }));
+
     // heap_caps_print_heap_info(MALLOC_CAP_INTERNAL);
     // heap_caps_print_heap_info(MALLOC_CAP_SPIRAM);
 }
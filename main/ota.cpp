@@ -60,6 +60,7 @@ static const char *const TAG = "OTA";
 
 /**
  * Create a base64 encoded basic auth value string.
+ * @return auth value, must be freed by the caller. NULL if out of memory.
  * @link https://github.com/espressif/esp-idf/issues/5646
  */
 static char *http_auth_basic(const char *username, const char *password) {
@@ -67,9 +68,15 @@ static char *http_auth_basic(const char *username, const char *password) {
     char  *user_info = NULL;
     char  *digest = NULL;
     size_t n = 0;
-    asprintf(&user_info, "%s:%s", username, password);
+    if (asprintf(&user_info, "%s:%s", username, password) < 0) {
+        return NULL;
+    }
     esp_crypto_base64_encode(NULL, 0, &n, (const unsigned char *)user_info, strlen(user_info));
     digest = static_cast<char *>(calloc(1, 6 + n + 1));
+    if (digest == NULL) {
+        free(user_info);
+        return NULL;
+    }
     strcpy(digest, "Basic ");
     esp_crypto_base64_encode((unsigned char *)digest + 6, n, (size_t *)&out, (const unsigned char *)user_info,
                              strlen(user_info));
@@ -82,7 +89,7 @@ static char *http_auth_basic(const char *username, const char *password) {
  * @return ESP_OK if authenticed, ESP_FAIL otherwise.
  */
 esp_err_t check_auth(httpd_req_t *req) {
-    esp_err_t   ret = ESP_FAIL;
+    esp_err_t   ret = ESP_OK;
     char       *buf = NULL;
     char       *auth_credentials = NULL;
     const char *user = "admin";
@@ -90,24 +97,28 @@ esp_err_t check_auth(httpd_req_t *req) {
 
     size_t buf_len = httpd_req_get_hdr_value_len(req, "Authorization") + 1;
 
-    ESP_GOTO_ON_FALSE(buf_len > 0, ESP_FAIL, err, TAG, "No Authorization header received");
+    ESP_GOTO_ON_FALSE(buf_len > 1, ESP_FAIL, cleanup, TAG, "No Authorization header received");
 
     buf = static_cast<char *>(calloc(1, buf_len));
+    ESP_GOTO_ON_FALSE(buf, ESP_FAIL, cleanup, TAG, "Not enough memory for Authorization header");
     if (httpd_req_get_hdr_value_str(req, "Authorization", buf, buf_len)) {
         ESP_LOGE(TAG, "No auth value received");
     }
 
     auth_credentials = http_auth_basic(user, password.c_str());
-    ESP_GOTO_ON_FALSE(strncmp(auth_credentials, buf, buf_len) == 0, ESP_FAIL, err, TAG, "Not authenticated");
+    ESP_GOTO_ON_FALSE(auth_credentials && strncmp(auth_credentials, buf, buf_len) == 0, ESP_FAIL, cleanup, TAG,
+                      "Not authenticated");
     ESP_LOGD(TAG, "Authenticated!");
 
+cleanup:
+    // every REST request is authenticated: also free the buffers of rejected requests
     free(auth_credentials);
     free(buf);
 
-    return ESP_OK;
-err:
-    httpd_resp_set_hdr(req, "WWW-Authenticate", "Basic realm=\"Dock\"");
-    httpd_resp_send_json_err(req, HTTPD_401_UNAUTHORIZED, "Not authorized");
+    if (ret != ESP_OK) {
+        httpd_resp_set_hdr(req, "WWW-Authenticate", "Basic realm=\"Dock\"");
+        httpd_resp_send_json_err(req, HTTPD_401_UNAUTHORIZED, "Not authorized");
+    }
     return ret;
 }
 
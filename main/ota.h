@@ -11,6 +11,13 @@
 extern "C" {
 #endif
 
+/// @brief Perform basic authentication check on the given request with user `admin` and the API token as password.
+///
+/// An error response is sent if the request is not authenticated.
+/// @param req http request.
+/// @return ESP_OK if authenticated, ESP_FAIL otherwise.
+esp_err_t check_auth(httpd_req_t *req);
+
 /// @brief Quick and dirty blocking HTTPD server callback for uploading an OTA firmware image.
 ///
 /// Attention: this blocks other server requests including WebSocket connections!
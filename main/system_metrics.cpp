@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "system_metrics.h"
+
+#include <stdio.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "mem_tag.h"
+#include "metrics.h"
+#include "network.h"
+
+static const char *const TAG = "METRICS";
+
+/// Heap capabilities to report. Labels are used as `caps` label value.
+static const struct {
+    uint32_t    caps;
+    const char *label;
+} heap_caps[] = {
+    {MALLOC_CAP_INTERNAL, "caps=\"internal\""},
+    {MALLOC_CAP_SPIRAM, "caps=\"spiram\""},
+    {MALLOC_CAP_DMA, "caps=\"dma\""},
+};
+
+static void write_heap_metrics(std::string &out) {
+    metrics_write_header(out, "ucd_heap_free_bytes", "Free heap size", MetricType::GAUGE);
+    for (const auto &heap : heap_caps) {
+        metrics_write_sample(out, "ucd_heap_free_bytes", heap.label, heap_caps_get_free_size(heap.caps));
+    }
+    metrics_write_header(out, "ucd_heap_min_free_bytes", "Heap low-water mark since boot", MetricType::GAUGE);
+    for (const auto &heap : heap_caps) {
+        metrics_write_sample(out, "ucd_heap_min_free_bytes", heap.label, heap_caps_get_minimum_free_size(heap.caps));
+    }
+    metrics_write_header(out, "ucd_heap_largest_free_block_bytes", "Largest free heap block", MetricType::GAUGE);
+    for (const auto &heap : heap_caps) {
+        metrics_write_sample(out, "ucd_heap_largest_free_block_bytes", heap.label,
+                             heap_caps_get_largest_free_block(heap.caps));
+    }
+}
+
+static void write_mem_tag_metrics(std::string &out) {
+    mem_tag_stats_t stats[MEM_TAG_COUNT];
+    char            labels[MEM_TAG_COUNT][16];
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+        mem_tag_get_stats(static_cast<mem_tag_t>(tag), &stats[tag]);
+        snprintf(labels[tag], sizeof(labels[tag]), "tag=\"%s\"", mem_tag_name(static_cast<mem_tag_t>(tag)));
+    }
+
+    metrics_write_header(out, "ucd_mem_tag_bytes", "Allocated bytes per subsystem", MetricType::GAUGE);
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+        metrics_write_sample(out, "ucd_mem_tag_bytes", labels[tag], stats[tag].bytes);
+    }
+    metrics_write_header(out, "ucd_mem_tag_allocs_total", "Allocations per subsystem", MetricType::COUNTER);
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+        metrics_write_sample(out, "ucd_mem_tag_allocs_total", labels[tag], stats[tag].allocs);
+    }
+    metrics_write_header(out, "ucd_mem_tag_alloc_failures_total", "Failed allocations per subsystem",
+                         MetricType::COUNTER);
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+        metrics_write_sample(out, "ucd_mem_tag_alloc_failures_total", labels[tag], stats[tag].failures);
+    }
+}
+
+static void write_task_metrics(std::string &out) {
+#if configUSE_TRACE_FACILITY
+    UBaseType_t   count = uxTaskGetNumberOfTasks();
+    TaskStatus_t *tasks = static_cast<TaskStatus_t *>(malloc(count * sizeof(TaskStatus_t)));
+    if (!tasks) {
+        ESP_LOGW(TAG, "Not enough memory for task metrics");
+        return;
+    }
+    count = uxTaskGetSystemState(tasks, count, NULL);
+
+    char labels[configMAX_TASK_NAME_LEN + 10];
+    metrics_write_header(out, "ucd_task_stack_min_free_bytes", "Task stack high-water mark", MetricType::GAUGE);
+    for (UBaseType_t i = 0; i < count; i++) {
+        snprintf(labels, sizeof(labels), "task=\"%s\"", tasks[i].pcTaskName);
+        // Note: ESP-IDF reports the stack high-water mark in bytes
+        metrics_write_sample(out, "ucd_task_stack_min_free_bytes", labels, tasks[i].usStackHighWaterMark);
+    }
+
+    free(tasks);
+#endif
+}
+
+static void write_system_metrics(std::string &out) {
+    metrics_write_header(out, "ucd_uptime_seconds", "Time since boot", MetricType::COUNTER);
+    metrics_write_sample(out, "ucd_uptime_seconds", nullptr, esp_timer_get_time() / 1000 / 1000);
+
+    write_heap_metrics(out);
+    write_mem_tag_metrics(out);
+    write_task_metrics(out);
+
+    wifi_ap_record_t ap_info;
+    if (is_wifi_up() && esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+        metrics_write_header(out, "ucd_wifi_rssi_dbm", "WiFi signal strength", MetricType::GAUGE);
+        metrics_write_sample(out, "ucd_wifi_rssi_dbm", nullptr, ap_info.rssi);
+    }
+}
+
+esp_err_t init_system_metrics(void) {
+    return MetricsRegistry::instance().addCollector(write_system_metrics) ? ESP_OK : ESP_ERR_NO_MEM;
+}
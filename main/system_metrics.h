@@ -0,0 +1,21 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Register the system metrics collector for heap, task stack and WiFi metrics.
+///
+/// The values are sampled when the metrics are exported with the `/metrics` endpoint.
+/// @return ESP_OK if successful.
+esp_err_t init_system_metrics(void);
+
+#ifdef __cplusplus
+}
+#endif
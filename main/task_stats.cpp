@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "task_stats.h"
+
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/idf_additions.h"
+#include "freertos/semphr.h"
+
+#include "mem_util.h"
+#include "sdkconfig.h"
+
+static const char *const TAG = "TASKS";
+
+/// Maximum number of tasks tracked in a run time sample.
+#define TASK_STATS_MAX_TASKS 32
+
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t     runtime;
+} task_runtime_t;
+
+/// Run time counters of all tasks at a sampling point.
+typedef struct {
+    uint32_t       total;
+    uint8_t        count;
+    task_runtime_t tasks[TASK_STATS_MAX_TASKS];
+} runtime_sample_t;
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS && CONFIG_UCD_TASK_STATS_INTERVAL > 0
+#define TASK_STATS_SAMPLING 1
+// one more sample than the window size: the window is the difference between the oldest and the current sample
+#define TASK_STATS_SAMPLES (CONFIG_UCD_TASK_STATS_WINDOW + 1)
+
+static SemaphoreHandle_t  sample_mutex = NULL;
+static runtime_sample_t  *samples = NULL;
+static size_t             sample_next = 0;
+static size_t             sample_count = 0;
+static TaskStatus_t      *sample_status = NULL;
+static esp_timer_handle_t sample_timer = NULL;
+
+static void task_stats_sample(void *arg) {
+    UBaseType_t count = uxTaskGetSystemState(sample_status, TASK_STATS_MAX_TASKS, NULL);
+    uint32_t    total = portGET_RUN_TIME_COUNTER_VALUE();
+    if (count == 0) {
+        // more tasks than TASK_STATS_MAX_TASKS
+        ESP_LOGW(TAG, "Too many tasks for sampling");
+        return;
+    }
+
+    xSemaphoreTake(sample_mutex, portMAX_DELAY);
+    runtime_sample_t *sample = &samples[sample_next];
+    sample->total = total;
+    sample->count = count;
+    for (UBaseType_t i = 0; i < count; i++) {
+        sample->tasks[i].handle = sample_status[i].xHandle;
+        sample->tasks[i].runtime = sample_status[i].ulRunTimeCounter;
+    }
+    sample_next = (sample_next + 1) % TASK_STATS_SAMPLES;
+    if (sample_count < TASK_STATS_SAMPLES) {
+        sample_count++;
+    }
+    xSemaphoreGive(sample_mutex);
+}
+#endif
+
+esp_err_t task_stats_init(void) {
+#ifdef TASK_STATS_SAMPLING
+    if (sample_timer) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    sample_mutex = xSemaphoreCreateMutex();
+    // samples are only accessed every few seconds: use PSRAM
+    samples = static_cast<runtime_sample_t *>(malloc_init_external(TASK_STATS_SAMPLES * sizeof(runtime_sample_t)));
+    sample_status = static_cast<TaskStatus_t *>(malloc(TASK_STATS_MAX_TASKS * sizeof(TaskStatus_t)));
+    if (!sample_mutex || !samples || !sample_status) {
+        ESP_LOGE(TAG, "Not enough memory for task statistics");
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = &task_stats_sample,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "task_stats",
+        .skip_unhandled_events = true,
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &sample_timer), TAG, "Failed to create timer");
+
+    task_stats_sample(NULL);
+    return esp_timer_start_periodic(sample_timer, CONFIG_UCD_TASK_STATS_INTERVAL * 1000ULL);
+#else
+    return ESP_OK;
+#endif
+}
+
+#if configGENERATE_RUN_TIME_STATS
+/// @brief Calculate the CPU usage of a task in 0.1% of a single core.
+static int16_t cpu_permille(uint32_t runtime, uint32_t total) {
+    if (total == 0) {
+        return -1;
+    }
+    uint64_t permille = static_cast<uint64_t>(runtime) * 1000 / total;
+    return permille > 1000 ? 1000 : static_cast<int16_t>(permille);
+}
+#endif
+
+size_t task_stats_get(task_info_t *tasks, size_t max, uint32_t *window_ms) {
+    *window_ms = 0;
+#if configUSE_TRACE_FACILITY
+    // a few extra entries in case tasks are created in the meantime
+    UBaseType_t   count = uxTaskGetNumberOfTasks() + 4;
+    TaskStatus_t *status = static_cast<TaskStatus_t *>(malloc(count * sizeof(TaskStatus_t)));
+    if (!status) {
+        ESP_LOGW(TAG, "Not enough memory for task statistics");
+        return 0;
+    }
+    count = uxTaskGetSystemState(status, count, NULL);
+
+#if configGENERATE_RUN_TIME_STATS
+    // run time counter is based on esp_timer: µs since boot
+    uint32_t total = portGET_RUN_TIME_COUNTER_VALUE();
+    *window_ms = total / 1000;
+#endif
+
+#ifdef TASK_STATS_SAMPLING
+    // window start: oldest sample
+    const runtime_sample_t *oldest = NULL;
+    xSemaphoreTake(sample_mutex, portMAX_DELAY);
+    if (sample_count > 0) {
+        oldest = &samples[(sample_next + TASK_STATS_SAMPLES - sample_count) % TASK_STATS_SAMPLES];
+        *window_ms = (total - oldest->total) / 1000;
+    }
+#endif
+
+    size_t n = 0;
+    for (UBaseType_t i = 0; i < count && n < max; i++) {
+        const TaskStatus_t *task = &status[i];
+        task_info_t        *info = &tasks[n++];
+
+        strlcpy(info->name, task->pcTaskName, sizeof(info->name));
+        info->state = task->eCurrentState;
+        info->priority = task->uxCurrentPriority;
+        info->base_priority = task->uxBasePriority;
+        BaseType_t core = xTaskGetCoreID(task->xHandle);
+        info->core = core == tskNO_AFFINITY ? -1 : static_cast<int8_t>(core);
+        // Note: ESP-IDF reports the stack high-water mark in bytes
+        info->stack_min_free = task->usStackHighWaterMark;
+        info->cpu_permille = -1;
+
+#if configGENERATE_RUN_TIME_STATS
+#ifdef TASK_STATS_SAMPLING
+        if (oldest) {
+            // tasks created within the window are not in the oldest sample
+            for (uint8_t j = 0; j < oldest->count; j++) {
+                if (oldest->tasks[j].handle == task->xHandle) {
+                    info->cpu_permille =
+                        cpu_permille(task->ulRunTimeCounter - oldest->tasks[j].runtime, total - oldest->total);
+                    break;
+                }
+            }
+            continue;
+        }
+#endif
+        info->cpu_permille = cpu_permille(task->ulRunTimeCounter, total);
+#endif
+    }
+
+#ifdef TASK_STATS_SAMPLING
+    xSemaphoreGive(sample_mutex);
+#endif
+
+    free(status);
+    return n;
+#else
+    return 0;
+#endif
+}
+
+const char *task_state_name(eTaskState state) {
+    switch (state) {
+        case eRunning:
+            return "running";
+        case eReady:
+            return "ready";
+        case eBlocked:
+            return "blocked";
+        case eSuspended:
+            return "suspended";
+        case eDeleted:
+            return "deleted";
+        default:
+            return "invalid";
+    }
+}
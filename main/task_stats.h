@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// FreeRTOS task information.
+typedef struct {
+    char       name[configMAX_TASK_NAME_LEN];
+    eTaskState state;
+    /// Current priority, might be raised by priority inheritance.
+    UBaseType_t priority;
+    UBaseType_t base_priority;
+    /// Pinned core, -1 if the task can run on any core.
+    int8_t core;
+    /// Minimum free stack space in bytes since the task started.
+    uint32_t stack_min_free;
+    /// CPU usage of a single core in 0.1% within the sampling window, -1 if not available.
+    int16_t cpu_permille;
+} task_info_t;
+
+/// @brief Start periodic sampling of the task run time counters for the CPU usage calculation.
+///
+/// The CPU usage is calculated over a sliding window of `CONFIG_UCD_TASK_STATS_WINDOW` samples taken every
+/// `CONFIG_UCD_TASK_STATS_INTERVAL` ms. Without sampling, the CPU usage is calculated since boot.
+/// @return ESP_OK if successful.
+esp_err_t task_stats_init(void);
+
+/// @brief Get information of all tasks.
+/// @param tasks output array.
+/// @param max size of the output array.
+/// @param window_ms set to the CPU usage time window in ms.
+/// @return number of tasks, 0 if not available.
+size_t task_stats_get(task_info_t *tasks, size_t max, uint32_t *window_ms);
+
+/// @brief Get the state name of a task, e.g. `blocked`.
+const char *task_state_name(eTaskState state);
+
+#ifdef __cplusplus
+}
+#endif
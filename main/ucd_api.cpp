@@ -5,8 +5,11 @@
 #include "ucd_api.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
+#include <vector>
+
 #include "esp_check.h"
 #include "esp_chip_info.h"
 #include "esp_event.h"
@@ -14,13 +17,24 @@
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "lwip/sockets.h"
 
 #include "WebServer.h"
 #include "config.h"
+#include "ir_fanout.h"
+#include "ir_peer_protocol.h"
+#include "ir_trace.h"
 #include "led_pattern.h"
+#include "mem_tag.h"
 #include "network.h"
+#include "ota.h"
+#include "response_template.h"
 #include "service_ir.h"
+#include "string_util.h"
+#include "task_stats.h"
 #include "uc_events.h"
 
 static const char *const TAG = "API";
@@ -36,8 +50,8 @@ static const char *msgError = "error";
 static const char *msgToken = "token";
 static const char *msgWifiPwd = "wifi_password";
 
-std::string get_uptime(void) {
-    char     timestring[20];
+/// Format the uptime as `D days HH:MM:SS` into the given buffer.
+static void format_uptime(char *buf, size_t len) {
     uint32_t seconds = static_cast<uint32_t>(esp_timer_get_time() / 1000 / 1000);
     uint16_t days = static_cast<uint16_t>(seconds / (24 * 3600));
     seconds = seconds % (24 * 3600);
@@ -45,61 +59,316 @@ std::string get_uptime(void) {
     seconds = seconds % 3600;
     uint8_t minutes = seconds / 60;
     seconds = seconds % 60;
-    snprintf(timestring, sizeof(timestring), "%u days %02u:%02u:%02lu", days, hours, minutes, seconds);
+    snprintf(buf, len, "%u days %02u:%02u:%02lu", days, hours, minutes, seconds);
+}
+
+/// Format the current local time in ISO 8601 format into the given buffer.
+static void format_time(char *buf, size_t len) {
+    time_t    now;
+    struct tm timeinfo;
+
+    time(&now);
+    localtime_r(&now, &timeinfo);
+    strftime(buf, len, "%FT%T%z", &timeinfo);
+}
+
+std::string get_uptime(void) {
+    char timestring[20];
+    format_uptime(timestring, sizeof(timestring));
 
     return timestring;
 }
 
-void fill_sysinfo_to_json(cJSON *root) {
-    esp_chip_info_t chip_info;
-    esp_chip_info(&chip_info);
+// ---- System information ----
+//
+// The system information is split into three parts:
+// - static fields, which never change at runtime: serialized once.
+// - configuration fields: serialized once and rebuilt after a configuration change, see `Config::getGeneration()`.
+// - dynamic fields (link state, heap, uptime, etc.): formatted on every request without NVS access or cJSON.
+
+/// Cached sysinfo fields
+struct sysinfo_cache_t {
+    /// Serialized static fields without enclosing braces.
+    std::string staticJson;
+    /// Serialized configuration fields without enclosing braces, empty if not yet created.
+    std::string configJson;
+    /// Cached NTP setting to decide if the current time is included in the dynamic fields.
+    bool ntpEnabled = false;
+    /// Configuration generation of the serialized configuration fields.
+    uint32_t configGeneration = 0;
+};
+
+/// Serialize a cJSON object without the enclosing braces to be concatenated with other fields.
+static std::string json_fields(const cJSON *obj) {
+    std::string fields;
+    char       *json = cJSON_PrintUnformatted(obj);
+    if (json) {
+        size_t len = strlen(json);
+        if (len > 2) {
+            fields.assign(json + 1, len - 2);
+        }
+        cJSON_free(json);
+    }
+    return fields;
+}
+
+/// Append `,` to a non-empty JSON field list.
+static void json_fields_separator(std::string &fields) {
+    if (!fields.empty() && fields.back() != '{') {
+        fields += ',';
+    }
+}
+
+/// Get the sysinfo cache. The static fields are created with the first call.
+/// Attention: the returned mutex must be held while accessing the cache!
+static sysinfo_cache_t &sysinfo_cache(SemaphoreHandle_t *mutex) {
+    // function local statics are initialized thread safe
+    static SemaphoreHandle_t sysinfoMutex = xSemaphoreCreateMutex();
+    static sysinfo_cache_t   cache = []() {
+        sysinfo_cache_t c;
+        Config         &cfg = Config::instance();
+
+        cJSON *staticDoc = cJSON_CreateObject();
+        cJSON_AddStringToObject(staticDoc, "hostname", cfg.getHostName());
+        cJSON_AddStringToObject(staticDoc, "version", cfg.getSoftwareVersion().c_str());
+        cJSON_AddStringToObject(staticDoc, "serial", cfg.getSerial());
+        cJSON_AddStringToObject(staticDoc, "model", cfg.getModel());
+        cJSON_AddStringToObject(staticDoc, "revision", cfg.getRevision());
+        cJSON_AddStringToObject(staticDoc, "reset_reason", getResetReason());
+        c.staticJson = json_fields(staticDoc);
+        cJSON_Delete(staticDoc);
+
+        return c;
+    }();
+
+    *mutex = sysinfoMutex;
+    return cache;
+}
 
-    Config &cfg = Config::instance();
+/// Rebuild the configuration fields if required. Must be called with the sysinfo mutex held.
+static void sysinfo_update_config(sysinfo_cache_t &cache) {
+    Config  &cfg = Config::instance();
+    uint32_t generation = cfg.getGeneration();
+    if (!cache.configJson.empty() && generation == cache.configGeneration) {
+        return;
+    }
 
-    cJSON_AddStringToObject(root, "name", cfg.getFriendlyName().c_str());
-    cJSON_AddStringToObject(root, "hostname", cfg.getHostName());
-    cJSON_AddStringToObject(root, "version", cfg.getSoftwareVersion().c_str());
-    cJSON_AddStringToObject(root, "serial", cfg.getSerial());
-    cJSON_AddStringToObject(root, "model", cfg.getModel());
-    cJSON_AddStringToObject(root, "revision", cfg.getRevision());
-    cJSON_AddNumberToObject(root, "led_brightness", cfg.getLedBrightness());
+    // read after the generation: a concurrent change is picked up with the next call
+    cache.configGeneration = generation;
+    cJSON *configDoc = cJSON_CreateObject();
+    cJSON_AddStringToObject(configDoc, "name", cfg.getFriendlyName().c_str());
+    cJSON_AddNumberToObject(configDoc, "led_brightness", cfg.getLedBrightness());
 #if defined(ETH_LED_PWM)
-    cJSON_AddNumberToObject(root, "eth_led_brightness", cfg.getEthLedBrightness());
+    cJSON_AddNumberToObject(configDoc, "eth_led_brightness", cfg.getEthLedBrightness());
 #endif
-    cJSON_AddBoolToObject(root, "ir_learning", InfraredService::getInstance().isIrLearning());
-    cJSON_AddBoolToObject(root, "ethernet", is_eth_link_up());
-    cJSON_AddBoolToObject(root, "wifi", is_wifi_up());
-    cJSON_AddStringToObject(root, "ssid", cfg.getWifiSsid().c_str());
-    cJSON_AddNumberToObject(root, "volume", cfg.getVolume());
-    cJSON_AddStringToObject(root, "uptime", get_uptime().c_str());
-    cJSON_AddBoolToObject(root, "sntp", cfg.isNtpEnabled());
-    cJSON_AddStringToObject(root, "reset_reason", getResetReason());
+    cJSON_AddStringToObject(configDoc, "ssid", cfg.getWifiSsid().c_str());
+    cJSON_AddNumberToObject(configDoc, "volume", cfg.getVolume());
+    cache.ntpEnabled = cfg.isNtpEnabled();
+    cJSON_AddBoolToObject(configDoc, "sntp", cache.ntpEnabled);
+    cache.configJson = json_fields(configDoc);
+    cJSON_Delete(configDoc);
+}
+
+/// Get the configuration fields and the cached NTP setting.
+static std::string sysinfo_config_json(bool *ntpEnabled) {
+    SemaphoreHandle_t mutex;
+    sysinfo_cache_t  &cache = sysinfo_cache(&mutex);
 
-    if (cfg.isNtpEnabled()) {
-        time_t    now;
-        char      strftime_buf[64];
-        struct tm timeinfo;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    sysinfo_update_config(cache);
+    std::string json = cache.configJson;
+    if (ntpEnabled) {
+        *ntpEnabled = cache.ntpEnabled;
+    }
+    xSemaphoreGive(mutex);
+
+    return json;
+}
+
+/// Dynamic system information used for change detection.
+struct sysinfo_dynamic_t {
+    bool     irLearning;
+    bool     ethernet;
+    bool     wifi;
+    /// Wifi signal strength in dBm, 0 if not connected.
+    int8_t   rssi;
+    uint32_t freeHeap;
+};
+
+static sysinfo_dynamic_t get_sysinfo_dynamic() {
+    sysinfo_dynamic_t info = {
+        .irLearning = InfraredService::getInstance().isIrLearning(),
+        .ethernet = is_eth_link_up(),
+        .wifi = is_wifi_up(),
+        .rssi = 0,
+        .freeHeap = static_cast<uint32_t>(heap_caps_get_free_size(MALLOC_CAP_INTERNAL)),
+    };
 
-        time(&now);
-        localtime_r(&now, &timeinfo);
-        strftime(strftime_buf, sizeof(strftime_buf), "%FT%T%z", &timeinfo);
-        cJSON_AddStringToObject(root, "time", strftime_buf);
+    wifi_ap_record_t ap_info;
+    if (info.wifi && esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+        info.rssi = ap_info.rssi;
     }
 
-    char buf[1 + 8 * sizeof(uint32_t)];
-    utoa(heap_caps_get_free_size(MALLOC_CAP_INTERNAL), buf, 10);
-    cJSON_AddStringToObject(root, "free_heap", buf);
+    return info;
+}
+
+/// Append the dynamic fields to a JSON field list.
+/// @param fields field list to append to.
+/// @param info current dynamic system information.
+/// @param prev previously reported system information to only append changed fields, nullptr to append all fields.
+/// Appended fields are updated in `prev`.
+/// @param ntpEnabled include current time. Only applicable if `prev` is nullptr.
+static void append_sysinfo_dynamic(std::string &fields, const sysinfo_dynamic_t &info, sysinfo_dynamic_t *prev,
+                                   bool ntpEnabled) {
+    // Change thresholds to avoid event flooding of slowly changing values
+    static const uint32_t heapThreshold = 1024;
+    static const int8_t   rssiThreshold = 3;
+
+    char buf[64];
+
+    if (!prev || prev->irLearning != info.irLearning) {
+        json_fields_separator(fields);
+        fields += info.irLearning ? "\"ir_learning\":true" : "\"ir_learning\":false";
+        if (prev) {
+            prev->irLearning = info.irLearning;
+        }
+    }
+    if (!prev || prev->ethernet != info.ethernet) {
+        json_fields_separator(fields);
+        fields += info.ethernet ? "\"ethernet\":true" : "\"ethernet\":false";
+        if (prev) {
+            prev->ethernet = info.ethernet;
+        }
+    }
+    if (!prev || prev->wifi != info.wifi) {
+        json_fields_separator(fields);
+        fields += info.wifi ? "\"wifi\":true" : "\"wifi\":false";
+        if (prev) {
+            prev->wifi = info.wifi;
+        }
+    }
+    if (!prev) {
+        if (info.rssi) {
+            json_fields_separator(fields);
+            snprintf(buf, sizeof(buf), "\"wifi_rssi\":%d", info.rssi);
+            fields += buf;
+        }
+    } else if (info.rssi != prev->rssi &&
+               (!info.rssi || !prev->rssi || abs(prev->rssi - info.rssi) >= rssiThreshold)) {
+        // a lost wifi connection is reported with rssi 0
+        json_fields_separator(fields);
+        snprintf(buf, sizeof(buf), "\"wifi_rssi\":%d", info.rssi);
+        fields += buf;
+        prev->rssi = info.rssi;
+    }
+    if (!prev) {
+        char uptime[20];
+        format_uptime(uptime, sizeof(uptime));
+        json_fields_separator(fields);
+        snprintf(buf, sizeof(buf), "\"uptime\":\"%s\"", uptime);
+        fields += buf;
+
+        if (ntpEnabled) {
+            char timestring[40];
+            format_time(timestring, sizeof(timestring));
+            json_fields_separator(fields);
+            snprintf(buf, sizeof(buf), "\"time\":\"%s\"", timestring);
+            fields += buf;
+        }
+    }
+    uint32_t heapDiff = 0;
+    if (prev) {
+        heapDiff = prev->freeHeap > info.freeHeap ? prev->freeHeap - info.freeHeap : info.freeHeap - prev->freeHeap;
+    }
+    if (!prev || heapDiff >= heapThreshold) {
+        json_fields_separator(fields);
+        // free_heap is a string for backward compatibility
+        snprintf(buf, sizeof(buf), "\"free_heap\":\"%lu\"", info.freeHeap);
+        fields += buf;
+        if (prev) {
+            prev->freeHeap = info.freeHeap;
+        }
+    }
+}
+
+/// Append all system information fields to a JSON field list: cached static and configuration fields, followed by the
+/// current dynamic fields.
+static void append_sysinfo_fields(std::string &fields) {
+    SemaphoreHandle_t mutex;
+    sysinfo_cache_t  &cache = sysinfo_cache(&mutex);
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    sysinfo_update_config(cache);
+    json_fields_separator(fields);
+    fields += cache.staticJson;
+    json_fields_separator(fields);
+    fields += cache.configJson;
+    bool ntpEnabled = cache.ntpEnabled;
+    xSemaphoreGive(mutex);
+
+    append_sysinfo_dynamic(fields, get_sysinfo_dynamic(), nullptr, ntpEnabled);
 }
 
 char *get_sysinfo_json(void) {
-    cJSON *root = cJSON_CreateObject();
+    std::string json;
+    json.reserve(512);
+    json += '{';
+    append_sysinfo_fields(json);
+    json += '}';
 
-    fill_sysinfo_to_json(root);
+    return strdup(json.c_str());
+}
 
-    char *sys_info = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
+/// @brief Format a command reply with the system information fields.
+///
+/// `{<header fields>,<sysinfo fields>,<body fields>,"code":<code>}`
+/// @param header optional reply header with `req_id`, `type` and `msg`.
+/// @param body additional reply fields of the command handler.
+/// @param code response code.
+/// @return serialized reply.
+static std::string format_sysinfo_reply(const cJSON *header, const cJSON *body, uint16_t code) {
+    std::string json;
+    json.reserve(768);
+    json += '{';
+    if (header) {
+        json += json_fields(header);
+    }
+    append_sysinfo_fields(json);
+    std::string bodyFields = json_fields(body);
+    if (!bodyFields.empty()) {
+        json_fields_separator(json);
+        json += bodyFields;
+    }
+    json_fields_separator(json);
+    json += "\"code\":";
+    json += std::to_string(code);
+    json += '}';
+
+    return json;
+}
+
+/// Append the changed sysinfo fields since the last call.
+/// Attention: not thread safe, only to be called from the sysinfo event timer.
+/// @return true if at least one field changed.
+static bool get_sysinfo_changes(std::string &fields) {
+    // last reported state. Only accessed from the sysinfo event timer.
+    static sysinfo_dynamic_t lastInfo = get_sysinfo_dynamic();
+    static std::string       lastConfigJson = sysinfo_config_json(nullptr);
+
+    size_t start = fields.length();
+    bool   ntpEnabled;
+
+    // not every configuration change affects the configuration fields
+    std::string configJson = sysinfo_config_json(&ntpEnabled);
+    if (configJson != lastConfigJson) {
+        json_fields_separator(fields);
+        fields += configJson;
+        lastConfigJson = std::move(configJson);
+    }
 
-    return sys_info;
+    append_sysinfo_dynamic(fields, get_sysinfo_dynamic(), &lastInfo, ntpEnabled);
+
+    return fields.length() != start;
 }
 
 static void restart(void *arg) {
@@ -178,6 +447,36 @@ bool cjson_get_bool(const cJSON *root, const char *field, bool *ok = NULL) {
     return false;
 }
 
+/// @brief Format a dock command reply with a response template if it only contains the default fields.
+///
+/// High-frequency replies like `pong`, or `ir_send` repeat and busy replies, don't need to be printed with cJSON.
+/// @return true if formatted, false if the reply must be printed with cJSON.
+static bool format_dock_reply(const cJSON *responseDoc, uint16_t code, char *buf, size_t size) {
+    const cJSON *item = responseDoc->child;
+    const int   *reqId = nullptr;
+    int          id;
+
+    if (item && strcmp(item->string, msgReqId) == 0) {
+        // same integer check as the cJSON number printing
+        if (!cJSON_IsNumber(item) || item->valuedouble != static_cast<double>(item->valueint)) {
+            return false;
+        }
+        id = item->valueint;
+        reqId = &id;
+        item = item->next;
+    }
+    if (!item || strcmp(item->string, msgType) != 0 || !cJSON_IsString(item) ||
+        strcmp(item->valuestring, msgTypeDock) != 0) {
+        return false;
+    }
+    item = item->next;
+    if (!item || strcmp(item->string, msgMsg) != 0 || !cJSON_IsString(item) || item->next) {
+        return false;
+    }
+
+    return response_format_dock(buf, size, reqId, item->valuestring, code) > 0;
+}
+
 DockApi::DockApi(Config *config, WebServer *web, port_map_t ports) : config_(config), web_(web), ports_(ports) {
     assert(config_);
     assert(web_);
@@ -223,6 +522,8 @@ DockApi::DockApi(Config *config, WebServer *web, port_map_t ports) : config_(con
                 return ESP_OK;
         }
     });
+
+    web_->setApiHandler([this](httpd_req_t *req) -> esp_err_t { return processRestRequest(req); });
 }
 
 esp_err_t DockApi::init() {
@@ -231,9 +532,232 @@ esp_err_t DockApi::init() {
         esp_event_handler_instance_register(UC_DOCK_EVENTS, ESP_EVENT_ANY_ID, dockEventHandler, this, NULL), TAG,
         "Registering UC_DOCK_EVENTS failed");
 
+#if CONFIG_UCD_SYSINFO_EVENT_INTERVAL > 0
+    const esp_timer_create_args_t timer_args = {
+        .callback = &sysinfoTimerCb,
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "sysinfo",
+        .skip_unhandled_events = true,
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &sysinfoTimer_), TAG, "Creating sysinfo timer failed");
+    ESP_RETURN_ON_ERROR(esp_timer_start_periodic(sysinfoTimer_, CONFIG_UCD_SYSINFO_EVENT_INTERVAL * 1000), TAG,
+                        "Starting sysinfo timer failed");
+#endif
+
     return ESP_OK;
 }
 
+void DockApi::sysinfoTimerCb(void *arg) {
+    DockApi *that = static_cast<DockApi *>(arg);
+
+    std::string msg = "{\"type\":\"event\",\"msg\":\"sysinfo\"";
+    if (get_sysinfo_changes(msg)) {
+        msg += '}';
+        that->web_->broadcastWsTxt(msg, UCD_SUBSCRIPTION_SYSINFO);
+    }
+}
+
+const DockApi::Command *DockApi::findCommand(const std::string &command) {
+    // Command table shared by the WebSocket and REST API.
+    // Handler return value: response code, or 0 if the response is sent asynchronously.
+    static const Command commands[] = {
+        // Allowed non-authorized commands to the dock
+        {"get_sysinfo", false,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             // the sysinfo fields are added from the cache when the reply is formatted
+             return api->processGetPortModes(responseDoc);
+         },
+         true},
+        // Authorized COMMANDS TO THE DOCK
+        {"set_config", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processSetConfig(root, responseDoc);
+         }},
+        {"set_brightness", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processSetBrightness(root);
+         }},
+        {"set_volume", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             bool ok = false;
+             int  volume = cjson_get_int(root, "volume", &ok);
+             if (ok && volume >= 0 && volume <= 100) {
+                 api->config_->setVolume(volume);
+                 return 200;
+             }
+             return 400;
+         }},
+        {"ir_send", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processIrSend(root, responseDoc, clientId);
+         }},
+        {"ir_repeat_hold", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             bool ok = false;
+             int  handle = cjson_get_int(root, "handle", &ok);
+             if (!ok || handle <= 0 || handle > UINT16_MAX) {
+                 return 400;
+             }
+             return InfraredService::getInstance().holdRepeat(handle);
+         }},
+        {"ir_stop", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             InfraredService::getInstance().stopSend();
+             return 200;
+         }},
+        {"ir_receive_on", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             InfraredService::getInstance().startIrLearn();
+             ESP_LOGD(TAG, "IR Receive on");
+             return 200;
+         }},
+        {"ir_receive_off", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             InfraredService::getInstance().stopIrLearn();
+             ESP_LOGD(TAG, "IR Receive off");
+             return 200;
+         }},
+        {"ir_relay_start", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processIrRelayStart(root);
+         }},
+        {"ir_relay_stop", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             InfraredService::getInstance().stopIrRelay();
+             ESP_LOGD(TAG, "IR relay off");
+             return 200;
+         }},
+        {"remote_charged", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             // TODO m_state->setState(States::NORMAL_FULLYCHARGED);
+             return 200;
+         }},
+        {"remote_lowbattery", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             // TODO  m_state->setState(States::NORMAL_LOWBATTERY);
+             return 200;
+         }},
+        {"remote_normal", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             // TODO m_state->setState(States::NORMAL);
+             return 200;
+         }},
+        {"identify", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             led_pattern(LED_IMPROV_IDENTIFY);
+             ESP_ERROR_CHECK_WITHOUT_ABORT(
+                 esp_event_post(UC_DOCK_EVENTS, UC_ACTION_IDENTIFY, NULL, 0, pdMS_TO_TICKS(200)));
+             return 200;
+         }},
+        {"set_logging", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return 501;  // not yet implemented
+         }},
+        {"set_sntp", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processSetSntp(root);
+         }},
+        {"set_network", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processSetNetwork(root);
+         }},
+        {"get_network", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processGetNetwork(responseDoc);
+         }},
+        {"set_dns", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             // ‼️ Work in progress: API not finalized & static ip configuration is not yet implemented!
+             bool ok = true;
+             if (cJSON_HasObjectItem(root, "dns1") || cJSON_HasObjectItem(root, "dns2")) {
+                 std::string server1 = cjson_get_string(root, "dns1", "");
+                 std::string server2 = cjson_get_string(root, "dns2", "");
+                 ok = api->config_->setDnsServer(server1, server2);
+             }
+             return ok ? 200 : 400;
+         }},
+        {"get_port_modes", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processGetPortModes(responseDoc);
+         }},
+        {"get_port_mode", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processGetPortMode(root, responseDoc);
+         }},
+        {"set_port_mode", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processSetPortMode(root);
+         }},
+        {"get_port_trigger", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processGetPortTrigger(root, responseDoc);
+         }},
+        {"set_port_trigger", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processSetPortTrigger(root);
+         }},
+        {"uart_send", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processUartSend(root);
+         }},
+        {"reboot", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             ESP_LOGW(TAG, "Rebooting");
+             cJSON_AddBoolToObject(responseDoc, "reboot", true);
+             schedule_restart(api->web_, 2000);
+             return 200;
+         }},
+        {"reset", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             ESP_LOGW(TAG, "Reset");
+             cJSON_AddBoolToObject(responseDoc, "reboot", true);
+             schedule_restart(api->web_, 2000, true);
+             return 200;
+         }},
+        {"set_ir_config", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processSetIrConfig(root, responseDoc);
+         }},
+        {"subscribe_events", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processSubscribeEvents(root, clientId);
+         }},
+        {"get_heap", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processGetHeap(responseDoc);
+         }},
+        {"get_tasks", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processGetTasks(responseDoc);
+         }},
+        {"get_trace", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             return api->processGetTrace(root, responseDoc);
+         }},
+        {"get_ir_config", true,
+         [](DockApi *api, const cJSON *root, cJSON *responseDoc, int clientId) -> uint16_t {
+             Config *config = api->config_;
+             cJSON_AddNumberToObject(responseDoc, "irlearn_core", config->getIrLearnCore());
+             cJSON_AddNumberToObject(responseDoc, "irlearn_prio", config->getIrLearnPriority());
+             cJSON_AddNumberToObject(responseDoc, "irsend_core", config->getIrSendCore());
+             cJSON_AddNumberToObject(responseDoc, "irsend_prio", config->getIrSendPriority());
+             cJSON_AddBoolToObject(responseDoc, "itach_emulation", config->isGcServerEnabled());
+             cJSON_AddBoolToObject(responseDoc, "itach_beacon", config->isGcServerBeaconEnabled());
+             cJSON_AddStringToObject(responseDoc, "dock_group", config->getDockGroup().c_str());
+             return 200;
+         }},
+    };
+
+    for (const auto &cmd : commands) {
+        if (command == cmd.command) {
+            return &cmd;
+        }
+    }
+
+    return nullptr;
+}
+
 esp_err_t DockApi::processRequest(httpd_req_t *req, int sockfd, const char *text, size_t len, bool authenticated) {
     WebServer *web = static_cast<WebServer *>(req->user_ctx);
     assert(web);
@@ -246,6 +770,7 @@ esp_err_t DockApi::processRequest(httpd_req_t *req, int sockfd, const char *text
         web->sendWsTxt(sockfd, "{\"code\": 500}");
         return ESP_ERR_INVALID_ARG;
     }
+    ir_trace_pending(IrTracePoint::REQUEST_PARSED);
 
     cJSON *responseDoc = cJSON_CreateObject();
 
@@ -275,7 +800,10 @@ esp_err_t DockApi::processRequest(httpd_req_t *req, int sockfd, const char *text
         msg = value;
     }
 
-    esp_err_t ret = ESP_FAIL;
+    esp_err_t      ret = ESP_FAIL;
+    const Command *cmd = nullptr;
+    // reply fields of a command handler: separate from the header fields for a reply with sysinfo fields
+    cJSON *body = responseDoc;
     // default response code
     uint16_t code = 200;
 
@@ -310,15 +838,18 @@ esp_err_t DockApi::processRequest(httpd_req_t *req, int sockfd, const char *text
         cJSON_AddStringToObject(responseDoc, msgMsg, command.c_str());
     }
 
+    if (type == msgTypeDock) {
+        cmd = findCommand(command);
+    }
+
     // Allowed non-authorized commands to the dock
-    if (type == "dock") {
-        // Get system information
-        if (command == "get_sysinfo") {
-            fill_sysinfo_to_json(responseDoc);
-            processGetPortModes(responseDoc);
-            ret = ESP_OK;
-            goto send_response;
+    if (cmd && !cmd->authRequired) {
+        if (cmd->withSysinfo) {
+            body = cJSON_CreateObject();
         }
+        code = cmd->handler(this, root, body, sockfd);
+        ret = ESP_OK;
+        goto send_response;
     }
 
     // Authorized COMMANDS TO THE DOCK
@@ -337,299 +868,709 @@ esp_err_t DockApi::processRequest(httpd_req_t *req, int sockfd, const char *text
         ESP_LOGD(TAG, "Sending heartbeat");
         cJSON_DeleteItemFromObject(responseDoc, msgCode);
         cJSON_AddStringToObject(responseDoc, msgMsg, "pong");
-    } else if (command == "set_config") {
-        bool field = false;
-        bool ok = false;
-
-        item = cJSON_GetObjectItem(root, "friendly_name");
-        if (item) {
-            field = true;
-            value = cJSON_GetStringValue(item);
-            if (value) {
-                config_->setFriendlyName(value);
-                // retrieve from config again, since it could be adjusted
-                // TODO MdnsService.addFriendlyName(config_->getFriendlyName());
-                ok = true;
-            }
+    } else if (cmd) {
+        if (cmd->withSysinfo) {
+            body = cJSON_CreateObject();
         }
-        item = cJSON_GetObjectItem(root, msgToken);
-        if (item) {
-            field = true;
-            value = cJSON_GetStringValue(item);
-            if (value) {
-                std::string token = value;
-                if (token.empty() || token.length() > 40) {
-                    cJSON_AddStringToObject(responseDoc, msgError, "Token length must be 4..40");
-                } else {
-                    ok = config_->setToken(token);
-                }
+        code = cmd->handler(this, root, body, sockfd);
+        if (code == 0) {
+            // asynchronous reply
+            if (body != responseDoc) {
+                cJSON_Delete(body);
             }
+            cJSON_Delete(responseDoc);
+            cJSON_Delete(root);
+            return ESP_OK;
         }
-        if (!(field && !ok) && (cJSON_HasObjectItem(root, "ssid") || cJSON_HasObjectItem(root, msgWifiPwd))) {
-            auto ssid = cjson_get_string(root, "ssid", "");
-            auto pwd = cjson_get_string(root, msgWifiPwd, "");
+    } else {
+        code = 400;
+        cJSON_AddStringToObject(responseDoc, msgError,
+                                command.empty() ? "Missing command field" : "Unsupported command");
+    }
 
-            if (config_->setWifi(ssid, pwd)) {
-                ESP_LOGD(TAG, "Saving SSID: %s", ssid);
+send_response:
+    char reply[RESPONSE_TEMPLATE_MAX_LENGTH];
+    if (body != responseDoc) {
+        std::string msg = format_sysinfo_reply(responseDoc, body, code);
+        web->sendWsTxt(sockfd, msg);
+        cJSON_Delete(body);
+    } else if (format_dock_reply(responseDoc, code, reply, sizeof(reply))) {
+        web->sendWsTxt(sockfd, static_cast<const char *>(reply));
+    } else {
+        // default response code
+        cJSON_AddNumberToObject(responseDoc, msgCode, code);
+        // Attention: resp gets freed by WebServer!
+        char *resp = cJSON_PrintUnformatted(responseDoc);
+        web->sendWsTxt(sockfd, resp);
+    }
+    cJSON_Delete(responseDoc);
+    cJSON_Delete(root);
+    return ret;
+}
 
-                std::string message;
-                cJSON_AddBoolToObject(responseDoc, "reboot", true);
-                ok = true;
+uint16_t DockApi::processSetConfig(const cJSON *root, cJSON *responseDoc) {
+    bool        field = false;
+    bool        ok = false;
+    const char *value;
 
-                schedule_restart(web, 2000);
+    cJSON *item = cJSON_GetObjectItem(root, "friendly_name");
+    if (item) {
+        field = true;
+        value = cJSON_GetStringValue(item);
+        if (value) {
+            config_->setFriendlyName(value);
+            // retrieve from config again, since it could be adjusted
+            // TODO MdnsService.addFriendlyName(config_->getFriendlyName());
+            ok = true;
+        }
+    }
+    item = cJSON_GetObjectItem(root, msgToken);
+    if (item) {
+        field = true;
+        value = cJSON_GetStringValue(item);
+        if (value) {
+            std::string token = value;
+            if (token.empty() || token.length() > 40) {
+                cJSON_AddStringToObject(responseDoc, msgError, "Token length must be 4..40");
             } else {
-                cJSON_AddStringToObject(responseDoc, msgError, "Invalid SSID or password");
+                ok = config_->setToken(token);
             }
         }
+    }
+    if (!(field && !ok) && (cJSON_HasObjectItem(root, "ssid") || cJSON_HasObjectItem(root, msgWifiPwd))) {
+        auto ssid = cjson_get_string(root, "ssid", "");
+        auto pwd = cjson_get_string(root, msgWifiPwd, "");
 
-        if (!ok) {
-            code = 400;
-        }
-    } else if (command == "set_brightness") {
-        bool ok = false;
-        if (cJSON_HasObjectItem(root, "status_led")) {
-            int brightness = cjson_get_int(root, "status_led", &ok);
-            if (ok) {
-                // TODO m_state->setState(States::LED_SETUP);
-                ESP_LOGD(TAG, "Set LED brightness: %d", brightness);
-                // set new value
-                // TODO m_ledControl->setLedMaxBrightness(brightness);
-                // persist value
-                config_->setLedBrightness(brightness);
-            }
+        if (config_->setWifi(ssid, pwd)) {
+            ESP_LOGD(TAG, "Saving SSID: %s", ssid);
+
+            cJSON_AddBoolToObject(responseDoc, "reboot", true);
+            ok = true;
+
+            schedule_restart(web_, 2000);
+        } else {
+            cJSON_AddStringToObject(responseDoc, msgError, "Invalid SSID or password");
         }
-        if (cJSON_HasObjectItem(root, "eth_led")) {
-            int brightness = cjson_get_int(root, "eth_led", &ok);
-            if (ok) {
-                ESP_LOGD(TAG, "Set ETH brightness: %d", brightness);
-                // persist value
-                config_->setEthLedBrightness(brightness);
-                // set new value if ethernet link is up
-                if (is_eth_link_up()) {
-                    set_eth_led_brightness(config_->getEthLedBrightness());
-                }
+    }
+
+    return ok ? 200 : 400;
+}
+
+uint16_t DockApi::processSetBrightness(const cJSON *root) {
+    bool ok = false;
+    if (cJSON_HasObjectItem(root, "status_led")) {
+        int brightness = cjson_get_int(root, "status_led", &ok);
+        if (ok) {
+            // TODO m_state->setState(States::LED_SETUP);
+            ESP_LOGD(TAG, "Set LED brightness: %d", brightness);
+            // set new value
+            // TODO m_ledControl->setLedMaxBrightness(brightness);
+            // persist value
+            config_->setLedBrightness(brightness);
+        }
+    }
+    if (cJSON_HasObjectItem(root, "eth_led")) {
+        int brightness = cjson_get_int(root, "eth_led", &ok);
+        if (ok) {
+            ESP_LOGD(TAG, "Set ETH brightness: %d", brightness);
+            // persist value
+            config_->setEthLedBrightness(brightness);
+            // set new value if ethernet link is up
+            if (is_eth_link_up()) {
+                set_eth_led_brightness(config_->getEthLedBrightness());
             }
         }
-        if (!ok) {
-            code = 400;
+    }
+
+    return ok ? 200 : 400;
+}
+
+uint16_t DockApi::processIrSend(const cJSON *root, cJSON *responseDoc, int clientId) {
+    const cJSON *codes = cJSON_GetObjectItem(root, "codes");
+    if (codes) {
+        return processIrSendParallel(root, codes, clientId);
+    }
+
+    // no copies: the strings are only valid during request processing, the IR service copies the code
+    const char *ir_code = cjson_get_string(root, "code", "");
+    const char *format = cjson_get_string(root, "format", "");
+
+    ESP_LOGD(TAG, "IR Send, format=%s, code=%s", format, ir_code);
+
+    if (ir_code[0] == '\0' || format[0] == '\0') {
+        return 400;
+    }
+
+    uint16_t repeat = cjson_get_int(root, "repeat");
+    bool     intSide = cjson_get_bool(root, "int_side");
+    bool     intTop = cjson_get_bool(root, "int_top");
+    bool     ext1 = cjson_get_bool(root, "ext1");
+    bool     ext2 = cjson_get_bool(root, "ext2");
+
+    int         reqId = cjson_get_int(root, msgId);
+    const char *group = cjson_get_string(root, "group", "");
+    if (group[0] != '\0') {
+        uint8_t outputs = (intSide ? IR_PEER_OUTPUT_INT_SIDE : 0) | (intTop ? IR_PEER_OUTPUT_INT_TOP : 0) |
+                          (ext1 ? IR_PEER_OUTPUT_EXT1 : 0) | (ext2 ? IR_PEER_OUTPUT_EXT2 : 0);
+        // 0 = asynchronous reply with the aggregated result of all docks
+        return IrFanout::getInstance().send(clientId, reqId, group, ir_code, format, repeat, outputs);
+    }
+    if (cjson_get_bool(root, "hold")) {
+        uint16_t handle = 0;
+        uint16_t code = InfraredService::getInstance().send(clientId, reqId, ir_code, format, repeat, intSide, intTop,
+                                                            ext1, ext2, 0, &handle);
+        if (code != 0 && code != 202) {
+            return code;
+        }
+        // The handle is required right away for the keep-alive messages, the asynchronous reply follows after sending.
+        // 202: IR repeat of the active held IR code, there's no additional asynchronous reply.
+        cJSON_AddNumberToObject(responseDoc, "handle", handle);
+        return 202;
+    }
+    // 0 = asynchronous reply
+    return InfraredService::getInstance().send(clientId, reqId, ir_code, format, repeat, intSide, intTop, ext1, ext2);
+}
+
+uint16_t DockApi::processIrSendParallel(const cJSON *root, const cJSON *codes, int clientId) {
+    if (!cJSON_IsArray(codes)) {
+        return 400;
+    }
+
+    IrParallelCode parallelCodes[IR_PARALLEL_MAX_CODES];
+    size_t         count = 0;
+    const cJSON   *item;
+    cJSON_ArrayForEach(item, codes) {
+        if (count >= IR_PARALLEL_MAX_CODES) {
+            return 400;
+        }
+        IrParallelCode &code = parallelCodes[count++];
+        code.code = cjson_get_string(item, "code", "");
+        code.format = cjson_get_string(item, "format", "");
+        code.internal_side = cjson_get_bool(item, "int_side");
+        code.internal_top = cjson_get_bool(item, "int_top");
+        code.external1 = cjson_get_bool(item, "ext1");
+        code.external2 = cjson_get_bool(item, "ext2");
+        if (code.code[0] == '\0' || code.format[0] == '\0') {
+            return 400;
         }
-    } else if (command == "set_volume") {
-        bool ok = false;
-        int  volume = cjson_get_int(root, "volume", &ok);
-        if (ok && volume >= 0 && volume <= 100) {
-            config_->setVolume(volume);
+    }
+
+    uint16_t repeat = cjson_get_int(root, "repeat");
+    int      reqId = cjson_get_int(root, msgId);
+    // 0 = asynchronous reply
+    return InfraredService::getInstance().sendParallel(clientId, reqId, parallelCodes, count, repeat);
+}
+
+uint16_t DockApi::processIrRelayStart(const cJSON *root) {
+    IrRelaySettings settings = {};
+    const char     *mode = cjson_get_string(root, "mode", "stream");
+    if (strcmp(mode, "stream") == 0) {
+        settings.mode = IrRelayMode::STREAM;
+    } else if (strcmp(mode, "reencode") == 0) {
+        settings.mode = IrRelayMode::REENCODE;
+    } else {
+        return 400;
+    }
+
+    bool ok = false;
+    int  frequency = cjson_get_int(root, "frequency", &ok);
+    settings.frequency = ok ? frequency : 38000;
+    settings.internal_side = cjson_get_bool(root, "int_side");
+    settings.internal_top = cjson_get_bool(root, "int_top");
+    settings.external1 = cjson_get_bool(root, "ext1");
+    settings.external2 = cjson_get_bool(root, "ext2");
+
+    ESP_LOGD(TAG, "IR relay on: %s", mode);
+    return InfraredService::getInstance().startIrRelay(settings);
+}
+
+uint16_t DockApi::processSetSntp(const cJSON *root) {
+    bool ok = true;
+    if (cJSON_HasObjectItem(root, "sntp_server1") || cJSON_HasObjectItem(root, "sntp_server2")) {
+        std::string server1 = cjson_get_string(root, "sntp_server1", "");
+        std::string server2 = cjson_get_string(root, "sntp_server2", "");
+        if (!config_->setNtpServer(server1, server2)) {
+            ok = false;
+        }
+    }
+    cJSON *item = cJSON_GetObjectItem(root, "sntp_enabled");
+    if (item) {
+        bool enabled = cJSON_IsTrue(item);
+        if (!config_->enableNtp(enabled)) {
+            ok = false;
+        }
+    }
+    return ok ? 200 : 400;
+}
+
+uint16_t DockApi::processSubscribeEvents(const cJSON *root, int clientId) {
+    // only available for WebSocket connections
+    if (clientId < 0) {
+        return 400;
+    }
+
+    cJSON *events = cJSON_GetObjectItem(root, "events");
+    if (!cJSON_IsArray(events)) {
+        return 400;
+    }
+
+    uint32_t     subscriptions = 0;
+    const cJSON *event = nullptr;
+    cJSON_ArrayForEach(event, events) {
+        const char *name = cJSON_GetStringValue(event);
+        if (name && strcmp(name, "sysinfo") == 0) {
+            subscriptions |= UCD_SUBSCRIPTION_SYSINFO;
+        } else if (name && strcmp(name, "ir_relay") == 0) {
+            subscriptions |= UCD_SUBSCRIPTION_IR_RELAY;
+        } else if (name && strcmp(name, "uart_rx") == 0) {
+            subscriptions |= UCD_SUBSCRIPTION_UART;
         } else {
-            code = 400;
-        }
-    } else if (command == "ir_send") {
-        std::string ir_code = cjson_get_string(root, "code", "");
-        std::string format = cjson_get_string(root, "format", "");
-        uint16_t    response = 400;
-
-        ESP_LOGD(TAG, "IR Send, format=%s, code=%s", format.c_str(), ir_code.c_str());
-
-        if (!ir_code.empty() && !format.empty()) {
-            uint16_t repeat = cjson_get_int(root, "repeat");
-            bool     intSide = cjson_get_bool(root, "int_side");
-            bool     intTop = cjson_get_bool(root, "int_top");
-            bool     ext1 = cjson_get_bool(root, "ext1");
-            bool     ext2 = cjson_get_bool(root, "ext2");
-
-            int reqId = cjson_get_int(root, msgId);
-            response = InfraredService::getInstance().send(sockfd, reqId, ir_code, format, repeat, intSide, intTop,
-                                                           ext1, ext2);
-            if (response == 0) {
-                // asynchronous reply
-                return ESP_OK;
-            }
+            return 400;
         }
-        code = response;
-    } else if (command == "ir_stop") {
-        InfraredService::getInstance().stopSend();
-        code = 200;
-    } else if (command == "ir_receive_on") {
-        InfraredService::getInstance().startIrLearn();
-        ESP_LOGD(TAG, "IR Receive on");
-    } else if (command == "ir_receive_off") {
-        InfraredService::getInstance().stopIrLearn();
-        ESP_LOGD(TAG, "IR Receive off");
-    } else if (command == "remote_charged") {
-        // TODO m_state->setState(States::NORMAL_FULLYCHARGED);
-    } else if (command == "remote_lowbattery") {
-        // TODO  m_state->setState(States::NORMAL_LOWBATTERY);
-    } else if (command == "remote_normal") {
-        // TODO m_state->setState(States::NORMAL);
-    } else if (command == "identify") {
-        led_pattern(LED_IMPROV_IDENTIFY);
-        ESP_ERROR_CHECK_WITHOUT_ABORT(esp_event_post(UC_DOCK_EVENTS, UC_ACTION_IDENTIFY, NULL, 0, pdMS_TO_TICKS(200)));
-    } else if (command == "set_logging") {
-        code = 501;  // not yet implemented
-    } else if (command == "set_sntp") {
-        bool ok = true;
-        if (cJSON_HasObjectItem(root, "sntp_server1") || cJSON_HasObjectItem(root, "sntp_server2")) {
-            std::string server1 = cjson_get_string(root, "sntp_server1", "");
-            std::string server2 = cjson_get_string(root, "sntp_server2", "");
-            if (!config_->setNtpServer(server1, server2)) {
-                ok = false;
-            }
+    }
+
+    return web_->setSubscriptions(clientId, subscriptions) == ESP_OK ? 200 : 500;
+}
+
+uint16_t DockApi::processGetHeap(cJSON *responseDoc) {
+    static const struct {
+        uint32_t    caps;
+        const char *name;
+    } heaps[] = {
+        {MALLOC_CAP_INTERNAL, "internal"},
+        {MALLOC_CAP_SPIRAM, "spiram"},
+        {MALLOC_CAP_DMA, "dma"},
+    };
+
+    cJSON *caps = cJSON_AddObjectToObject(responseDoc, "caps");
+    for (const auto &heap : heaps) {
+        multi_heap_info_t info;
+        heap_caps_get_info(&info, heap.caps);
+        cJSON *item = cJSON_AddObjectToObject(caps, heap.name);
+        cJSON_AddNumberToObject(item, "free", info.total_free_bytes);
+        cJSON_AddNumberToObject(item, "min_free", info.minimum_free_bytes);
+        cJSON_AddNumberToObject(item, "largest_free_block", info.largest_free_block);
+        cJSON_AddNumberToObject(item, "allocated", info.total_allocated_bytes);
+        cJSON_AddNumberToObject(item, "free_blocks", info.free_blocks);
+    }
+
+    cJSON *tags = cJSON_AddObjectToObject(responseDoc, "tags");
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+        mem_tag_stats_t stats;
+        mem_tag_get_stats(static_cast<mem_tag_t>(tag), &stats);
+        cJSON *item = cJSON_AddObjectToObject(tags, mem_tag_name(static_cast<mem_tag_t>(tag)));
+        cJSON_AddNumberToObject(item, "bytes", stats.bytes);
+        cJSON_AddNumberToObject(item, "peak_bytes", stats.peak_bytes);
+        cJSON_AddNumberToObject(item, "allocs", stats.allocs);
+        cJSON_AddNumberToObject(item, "psram_allocs", stats.psram_allocs);
+        cJSON_AddNumberToObject(item, "frees", stats.frees);
+        cJSON_AddNumberToObject(item, "failures", stats.failures);
+    }
+
+    return 200;
+}
+
+uint16_t DockApi::processGetTasks(cJSON *responseDoc) {
+    // a few extra entries in case tasks are created in the meantime
+    size_t       max = uxTaskGetNumberOfTasks() + 4;
+    task_info_t *tasks = static_cast<task_info_t *>(malloc(max * sizeof(task_info_t)));
+    if (tasks == nullptr) {
+        return 500;
+    }
+
+    uint32_t window = 0;
+    size_t   count = task_stats_get(tasks, max, &window);
+    if (count == 0) {
+        free(tasks);
+        return 501;
+    }
+
+    cJSON_AddNumberToObject(responseDoc, "cpu_window", window);
+    cJSON *items = cJSON_AddArrayToObject(responseDoc, "tasks");
+    for (size_t i = 0; i < count; i++) {
+        const task_info_t *task = &tasks[i];
+        cJSON             *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", task->name);
+        cJSON_AddStringToObject(item, "state", task_state_name(task->state));
+        cJSON_AddNumberToObject(item, "priority", task->priority);
+        cJSON_AddNumberToObject(item, "base_priority", task->base_priority);
+        cJSON_AddNumberToObject(item, "core", task->core);
+        cJSON_AddNumberToObject(item, "stack_min_free", task->stack_min_free);
+        if (task->cpu_permille >= 0) {
+            cJSON_AddNumberToObject(item, "cpu", task->cpu_permille / 10.0);
         }
-        item = cJSON_GetObjectItem(root, "sntp_enabled");
-        if (item) {
-            bool enabled = cJSON_IsTrue(item);
-            if (!config_->enableNtp(enabled)) {
-                ok = false;
-            }
+        cJSON_AddItemToArray(items, item);
+    }
+    free(tasks);
+
+    return 200;
+}
+
+uint16_t DockApi::processGetTrace(const cJSON *root, cJSON *responseDoc) {
+    IrTraceBuffer &trace = ir_trace();
+
+    // snapshot on the heap: the trace buffer can be too large for the httpd task stack
+    IrTraceEntry *entries = static_cast<IrTraceEntry *>(malloc(IrTraceBuffer::capacity * sizeof(IrTraceEntry)));
+    if (entries == nullptr) {
+        return 500;
+    }
+    size_t count = trace.snapshot(entries, IrTraceBuffer::capacity);
+    if (cjson_get_bool(root, "clear")) {
+        trace.clear();
+    }
+
+    cJSON_AddNumberToObject(responseDoc, "capacity", IrTraceBuffer::capacity);
+
+    if (cjson_get_bool(root, "raw")) {
+        cJSON *items = cJSON_AddArrayToObject(responseDoc, "entries");
+        for (size_t i = 0; i < count; i++) {
+            cJSON *item = cJSON_CreateObject();
+            cJSON_AddNumberToObject(item, "id", entries[i].id);
+            cJSON_AddStringToObject(item, "point", ir_trace_point_name(entries[i].point));
+            cJSON_AddNumberToObject(item, "ts", entries[i].timestamp);
+            cJSON_AddItemToArray(items, item);
         }
-        code = ok ? 200 : 400;
-    } else if (command == "set_network") {
-        // ‼️ Work in progress: API not finalized & static ip configuration is not yet implemented!
-        bool          ok = true;
-        network_cfg_t net_cfg;
-        net_cfg.dhcp = cjson_get_bool(root, "dhcp", &ok);
+    }
+
+    IrTraceStats stats[(size_t)IrTracePoint::COUNT];
+    size_t       traces = ir_trace_summary(entries, count, stats);
+    free(entries);
+
+    cJSON_AddNumberToObject(responseDoc, "traces", traces);
+    cJSON *summary = cJSON_AddObjectToObject(responseDoc, "summary");
+    for (size_t p = 0; p < (size_t)IrTracePoint::COUNT; p++) {
+        if (stats[p].count == 0) {
+            continue;
+        }
+        cJSON *item = cJSON_AddObjectToObject(summary, ir_trace_point_name(static_cast<IrTracePoint>(p)));
+        cJSON_AddNumberToObject(item, "count", stats[p].count);
+        cJSON_AddNumberToObject(item, "p50", stats[p].p50);
+        cJSON_AddNumberToObject(item, "p90", stats[p].p90);
+        cJSON_AddNumberToObject(item, "p99", stats[p].p99);
+        cJSON_AddNumberToObject(item, "max", stats[p].max);
+    }
+
+    return 200;
+}
+
+uint16_t DockApi::processSetNetwork(const cJSON *root) {
+    // ‼️ Work in progress: API not finalized & static ip configuration is not yet implemented!
+    bool          ok = true;
+    network_cfg_t net_cfg;
+    net_cfg.dhcp = cjson_get_bool(root, "dhcp", &ok);
+    if (ok) {
+        std::string value = cjson_get_string(root, "ip", "");
+        if (value.empty()) {
+            ok = false;
+        } else {
+            net_cfg.ip.ip.addr = ipaddr_addr(value.c_str());
+        }
+        value = cjson_get_string(root, "mask", "255.255.255.0");
+        if (value.empty()) {
+            ok = false;
+        } else {
+            net_cfg.ip.netmask.addr = ipaddr_addr(value.c_str());
+        }
+        value = cjson_get_string(root, "gw", "");
+        if (value.empty()) {
+            ok = false;
+        } else {
+            net_cfg.ip.gw.addr = ipaddr_addr(value.c_str());
+        }
+
         if (ok) {
-            std::string value = cjson_get_string(root, "ip", "");
-            if (value.empty()) {
-                ok = false;
-            } else {
-                net_cfg.ip.ip.addr = ipaddr_addr(value.c_str());
-            }
-            value = cjson_get_string(root, "mask", "255.255.255.0");
-            if (value.empty()) {
-                ok = false;
-            } else {
-                net_cfg.ip.netmask.addr = ipaddr_addr(value.c_str());
-            }
-            value = cjson_get_string(root, "gw", "");
-            if (value.empty()) {
-                ok = false;
-            } else {
-                net_cfg.ip.gw.addr = ipaddr_addr(value.c_str());
-            }
+            ok = config_->setNetwork(net_cfg);
+        }
+    }
+    return ok ? 200 : 400;
+}
 
-            if (ok) {
-                ok = config_->setNetwork(net_cfg);
-            }
+uint16_t DockApi::processGetNetwork(cJSON *responseDoc) {
+    // ‼️ Work in progress: API not finalized & static ip configuration is not yet implemented!
+    network_cfg_t net_cfg = config_->getNetwork();
+
+    cJSON_AddBoolToObject(responseDoc, "dhcp", net_cfg.dhcp);
+    if (!net_cfg.dhcp && net_cfg.ip.ip.addr && (net_cfg.ip.ip.addr != IPADDR_NONE)) {
+        cJSON_AddStringToObject(responseDoc, "ip", ip4addr_ntoa((ip4_addr_t *)&net_cfg.ip.ip));
+        cJSON_AddStringToObject(responseDoc, "mask", ip4addr_ntoa((ip4_addr_t *)&net_cfg.ip.netmask));
+        cJSON_AddStringToObject(responseDoc, "gw", ip4addr_ntoa((ip4_addr_t *)&net_cfg.ip.gw));
+    }
+    std::string server = config_->getDnsServer1();
+    if (!server.empty()) {
+        cJSON_AddStringToObject(responseDoc, "dns1", server.c_str());
+    }
+    server = config_->getDnsServer2();
+    if (!server.empty()) {
+        cJSON_AddStringToObject(responseDoc, "dns2", server.c_str());
+    }
+    return 200;
+}
+
+uint16_t DockApi::processSetIrConfig(const cJSON *root, cJSON *responseDoc) {
+    bool ok = true;
+
+    if (cJSON_HasObjectItem(root, "irlearn_core")) {
+        uint16_t value = static_cast<uint16_t>(cjson_get_int(root, "irlearn_core", &ok));
+        if (ok && !config_->setIrLearnCore(value)) {
+            ok = false;
         }
-        code = ok ? 200 : 400;
-    } else if (command == "get_network") {
-        // ‼️ Work in progress: API not finalized & static ip configuration is not yet implemented!
-        network_cfg_t net_cfg = config_->getNetwork();
-
-        cJSON_AddBoolToObject(responseDoc, "dhcp", net_cfg.dhcp);
-        if (!net_cfg.dhcp && net_cfg.ip.ip.addr && (net_cfg.ip.ip.addr != IPADDR_NONE)) {
-            cJSON_AddStringToObject(responseDoc, "ip", ip4addr_ntoa((ip4_addr_t *)&net_cfg.ip.ip));
-            cJSON_AddStringToObject(responseDoc, "mask", ip4addr_ntoa((ip4_addr_t *)&net_cfg.ip.netmask));
-            cJSON_AddStringToObject(responseDoc, "gw", ip4addr_ntoa((ip4_addr_t *)&net_cfg.ip.gw));
-        }
-        std::string server = config_->getDnsServer1();
-        if (!server.empty()) {
-            cJSON_AddStringToObject(responseDoc, "dns1", server.c_str());
-        }
-        server = config_->getDnsServer2();
-        if (!server.empty()) {
-            cJSON_AddStringToObject(responseDoc, "dns2", server.c_str());
-        }
-        code = 200;
-    } else if (command == "set_dns") {
-        // ‼️ Work in progress: API not finalized & static ip configuration is not yet implemented!
-        bool ok = true;
-        if (cJSON_HasObjectItem(root, "dns1") || cJSON_HasObjectItem(root, "dns2")) {
-            std::string server1 = cjson_get_string(root, "dns1", "");
-            std::string server2 = cjson_get_string(root, "dns2", "");
-            ok = config_->setDnsServer(server1, server2);
-        }
-        code = ok ? 200 : 400;
-    } else if (command == "get_port_modes") {
-        code = processGetPortModes(responseDoc);
-    } else if (command == "get_port_mode") {
-        code = processGetPortMode(root, responseDoc);
-    } else if (command == "set_port_mode") {
-        code = processSetPortMode(root);
-    } else if (command == "get_port_trigger") {
-        code = processGetPortTrigger(root, responseDoc);
-    } else if (command == "set_port_trigger") {
-        code = processSetPortTrigger(root);
-    } else if (command == "reboot") {
-        ESP_LOGW(TAG, "Rebooting");
-        std::string message;
-        cJSON_AddBoolToObject(responseDoc, "reboot", true);
-        schedule_restart(web, 2000);
-    } else if (command == "reset") {
-        ESP_LOGW(TAG, "Reset");
-        std::string message;
-        cJSON_AddBoolToObject(responseDoc, "reboot", true);
-        schedule_restart(web, 2000, true);
-    } else if (command == "set_ir_config") {
-        bool ok = true;
-
-        if (cJSON_HasObjectItem(root, "irlearn_core")) {
-            uint16_t value = static_cast<uint16_t>(cjson_get_int(root, "irlearn_core", &ok));
-            if (ok && !config_->setIrLearnCore(value)) {
-                ok = false;
-            }
+    }
+    if (cJSON_HasObjectItem(root, "irlearn_prio")) {
+        uint16_t value = static_cast<uint16_t>(cjson_get_int(root, "irlearn_prio", &ok));
+        if (!config_->setIrLearnPriority(value)) {
+            ok = false;
         }
-        if (cJSON_HasObjectItem(root, "irlearn_prio")) {
-            uint16_t value = static_cast<uint16_t>(cjson_get_int(root, "irlearn_prio", &ok));
-            if (!config_->setIrLearnPriority(value)) {
-                ok = false;
+        InfraredService::getInstance().setIrLearnPriority(value);
+    }
+    if (cJSON_HasObjectItem(root, "irsend_core")) {
+        uint16_t value = static_cast<uint16_t>(cjson_get_int(root, "irsend_core", &ok));
+        if (!config_->setIrSendCore(value)) {
+            ok = false;
+        }
+    }
+    if (cJSON_HasObjectItem(root, "irsend_prio")) {
+        uint16_t value = static_cast<uint16_t>(cjson_get_int(root, "irsend_prio", &ok));
+        if (!config_->setIrSendPriority(value)) {
+            ok = false;
+        }
+        InfraredService::getInstance().setIrSendPriority(value);
+    }
+    if (cJSON_HasObjectItem(root, "itach_emulation")) {
+        bool old = config_->isGcServerEnabled();
+        bool enabled = cjson_get_bool(root, "itach_emulation");
+        if (!config_->enableGcServer(enabled)) {
+            ok = false;
+        } else if (old != enabled) {
+            cJSON_AddBoolToObject(responseDoc, "reboot", true);
+            schedule_restart(web_, 2000);
+        }
+    }
+    if (cJSON_HasObjectItem(root, "itach_beacon")) {
+        bool old = config_->isGcServerBeaconEnabled();
+        bool enabled = cjson_get_bool(root, "itach_beacon");
+        if (!config_->enableGcServerBeacon(enabled)) {
+            ok = false;
+        } else if (old != enabled && !cJSON_HasObjectItem(responseDoc, "reboot")) {
+            cJSON_AddBoolToObject(responseDoc, "reboot", true);
+            schedule_restart(web_, 2000);
+        }
+    }
+    if (cJSON_HasObjectItem(root, "dock_group")) {
+        std::string old = config_->getDockGroup();
+        std::string group = cjson_get_string(root, "dock_group", "");
+        if (!config_->setDockGroup(group)) {
+            ok = false;
+        } else if (old != group && !cJSON_HasObjectItem(responseDoc, "reboot")) {
+            cJSON_AddBoolToObject(responseDoc, "reboot", true);
+            schedule_restart(web_, 2000);
+        }
+    }
+    return ok ? 200 : 500;
+}
+
+// ---- REST API ----
+
+/// REST route mapping to a dock API command.
+struct RestRoute {
+    httpd_method_t method;
+    /// URI path. A `{port}` segment is passed as numeric `port` field to the command.
+    const char *path;
+    const char *command;
+};
+
+static const RestRoute restRoutes[] = {
+    {HTTP_GET, "/api/config", "get_sysinfo"},
+    {HTTP_PUT, "/api/config", "set_config"},
+    {HTTP_PUT, "/api/brightness", "set_brightness"},
+    {HTTP_PUT, "/api/volume", "set_volume"},
+    {HTTP_POST, "/api/identify", "identify"},
+    {HTTP_POST, "/api/reboot", "reboot"},
+    {HTTP_POST, "/api/reset", "reset"},
+    {HTTP_POST, "/api/ir/send", "ir_send"},
+    {HTTP_POST, "/api/ir/stop", "ir_stop"},
+    {HTTP_POST, "/api/ir/learn/start", "ir_receive_on"},
+    {HTTP_POST, "/api/ir/learn/stop", "ir_receive_off"},
+    {HTTP_POST, "/api/ir/relay/start", "ir_relay_start"},
+    {HTTP_POST, "/api/ir/relay/stop", "ir_relay_stop"},
+    {HTTP_GET, "/api/ir/config", "get_ir_config"},
+    {HTTP_PUT, "/api/ir/config", "set_ir_config"},
+    {HTTP_GET, "/api/network", "get_network"},
+    {HTTP_PUT, "/api/network", "set_network"},
+    {HTTP_PUT, "/api/network/dns", "set_dns"},
+    {HTTP_PUT, "/api/sntp", "set_sntp"},
+    {HTTP_GET, "/api/heap", "get_heap"},
+    {HTTP_GET, "/api/tasks", "get_tasks"},
+    {HTTP_GET, "/api/trace", "get_trace"},
+    {HTTP_GET, "/api/ports", "get_port_modes"},
+    {HTTP_GET, "/api/ports/{port}", "get_port_mode"},
+    {HTTP_PUT, "/api/ports/{port}", "set_port_mode"},
+    {HTTP_GET, "/api/ports/{port}/trigger", "get_port_trigger"},
+    {HTTP_PUT, "/api/ports/{port}/trigger", "set_port_trigger"},
+    {HTTP_POST, "/api/ports/{port}/uart", "uart_send"},
+};
+
+/// @brief Match a request URI against a route path.
+/// @param path route path with optional `{port}` segment.
+/// @param uri request URI. Query parameters are ignored.
+/// @param port set to the numeric `{port}` segment value, if present.
+/// @return true if the URI matches the path.
+static bool match_rest_route(const char *path, const char *uri, int *port) {
+    static const char *param = "{port}";
+    const size_t       paramLen = strlen(param);
+
+    while (*path) {
+        if (strncmp(path, param, paramLen) == 0) {
+            char *end;
+            long  value = strtol(uri, &end, 10);
+            if (end == uri || value < 0 || value > UINT8_MAX) {
+                return false;
             }
-            InfraredService::getInstance().setIrLearnPriority(value);
+            *port = static_cast<int>(value);
+            path += paramLen;
+            uri = end;
+            continue;
         }
-        if (cJSON_HasObjectItem(root, "irsend_core")) {
-            uint16_t value = static_cast<uint16_t>(cjson_get_int(root, "irsend_core", &ok));
-            if (!config_->setIrSendCore(value)) {
-                ok = false;
+        if (*path != *uri) {
+            return false;
+        }
+        path++;
+        uri++;
+    }
+
+    return *uri == 0 || *uri == '?';
+}
+
+static const char *http_status(uint16_t code) {
+    switch (code) {
+        case 200:
+            return HTTPD_200;
+        case 202:
+            return "202 Accepted";
+        case 400:
+            return HTTPD_400;
+        case 401:
+            return "401 Unauthorized";
+        case 404:
+            return HTTPD_404;
+        case 405:
+            return "405 Method Not Allowed";
+        case 409:
+            return "409 Conflict";
+        case 423:
+            return "423 Locked";
+        case 429:
+            return "429 Too Many Requests";
+        case 501:
+            return "501 Not Implemented";
+        case 503:
+            return "503 Service Unavailable";
+        default:
+            return HTTPD_500;
+    }
+}
+
+esp_err_t DockApi::processRestRequest(httpd_req_t *req) {
+    const RestRoute *route = nullptr;
+    bool             pathFound = false;
+    int              port = -1;
+
+    for (const auto &r : restRoutes) {
+        if (match_rest_route(r.path, req->uri, &port)) {
+            pathFound = true;
+            if (r.method == req->method) {
+                route = &r;
+                break;
             }
         }
-        if (cJSON_HasObjectItem(root, "irsend_prio")) {
-            uint16_t value = static_cast<uint16_t>(cjson_get_int(root, "irsend_prio", &ok));
-            if (!config_->setIrSendPriority(value)) {
-                ok = false;
+    }
+
+    if (!route) {
+        if (pathFound) {
+            httpd_resp_send_json_err(req, HTTPD_405_METHOD_NOT_ALLOWED, "Method not allowed");
+            return ESP_OK;
+        }
+        httpd_resp_send_json_err(req, HTTPD_404_NOT_FOUND, "Not found");
+        return ESP_OK;
+    }
+
+    const Command *cmd = findCommand(route->command);
+    if (!cmd) {
+        httpd_resp_send_json_err(req, HTTPD_404_NOT_FOUND, "Not found");
+        return ESP_OK;
+    }
+
+    // same authentication as the OTA upload: basic auth with the API token
+    if (cmd->authRequired && check_auth(req) != ESP_OK) {
+        return ESP_OK;
+    }
+
+    // request body with the command parameters, same fields as in the WebSocket API
+    cJSON *root = nullptr;
+    if (req->content_len > CONFIG_UCD_WEB_MAX_WS_FRAME_SIZE) {
+        httpd_resp_send_json_err(req, HTTPD_400_BAD_REQUEST, "Request body too large");
+        return ESP_FAIL;
+    }
+    if (req->content_len > 0) {
+        char *buf = static_cast<char *>(malloc(req->content_len));
+        if (buf == nullptr) {
+            httpd_resp_send_json_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+            return ESP_FAIL;
+        }
+        size_t received = 0;
+        while (received < req->content_len) {
+            int ret = httpd_req_recv(req, buf + received, req->content_len - received);
+            if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+                continue;
             }
-            InfraredService::getInstance().setIrSendPriority(value);
-        }
-        if (cJSON_HasObjectItem(root, "itach_emulation")) {
-            bool old = config_->isGcServerEnabled();
-            bool enabled = cjson_get_bool(root, "itach_emulation");
-            if (!config_->enableGcServer(enabled)) {
-                ok = false;
-            } else if (old != enabled) {
-                cJSON_AddBoolToObject(responseDoc, "reboot", true);
-                schedule_restart(web, 2000);
+            if (ret <= 0) {
+                free(buf);
+                return ESP_FAIL;
             }
+            received += ret;
         }
-        if (cJSON_HasObjectItem(root, "itach_beacon")) {
-            bool old = config_->isGcServerBeaconEnabled();
-            bool enabled = cjson_get_bool(root, "itach_beacon");
-            if (!config_->enableGcServerBeacon(enabled)) {
-                ok = false;
-            } else if (old != enabled && !cJSON_HasObjectItem(responseDoc, "reboot")) {
-                cJSON_AddBoolToObject(responseDoc, "reboot", true);
-                schedule_restart(web, 2000);
-            }
+        root = cJSON_ParseWithLength(buf, received);
+        free(buf);
+        if (root == nullptr || !cJSON_IsObject(root)) {
+            cJSON_Delete(root);
+            httpd_resp_send_json_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+            return ESP_OK;
         }
-        code = ok ? 200 : 500;
-    } else if (command == "get_ir_config") {
-        cJSON_AddNumberToObject(responseDoc, "irlearn_core", config_->getIrLearnCore());
-        cJSON_AddNumberToObject(responseDoc, "irlearn_prio", config_->getIrLearnPriority());
-        cJSON_AddNumberToObject(responseDoc, "irsend_core", config_->getIrSendCore());
-        cJSON_AddNumberToObject(responseDoc, "irsend_prio", config_->getIrSendPriority());
-        cJSON_AddBoolToObject(responseDoc, "itach_emulation", config_->isGcServerEnabled());
-        cJSON_AddBoolToObject(responseDoc, "itach_beacon", config_->isGcServerBeaconEnabled());
     } else {
-        code = 400;
-        cJSON_AddStringToObject(responseDoc, msgError,
-                                command.empty() ? "Missing command field" : "Unsupported command");
+        root = cJSON_CreateObject();
     }
 
-send_response:
-    // default response code
+    if (port >= 0) {
+        cJSON_DeleteItemFromObject(root, "port");
+        cJSON_AddNumberToObject(root, "port", port);
+    }
+
+    cJSON *responseDoc = cJSON_CreateObject();
+    // there's no client connection for an asynchronous reply: IR send requests are accepted once queued
+    uint16_t code = cmd->handler(this, root, responseDoc, IR_CLIENT_NONE);
+    if (code == 0) {
+        code = 202;
+    }
+
+    if (cmd->withSysinfo) {
+        std::string resp = format_sysinfo_reply(nullptr, responseDoc, code);
+        cJSON_Delete(responseDoc);
+        cJSON_Delete(root);
+
+        httpd_resp_set_status(req, http_status(code));
+        httpd_resp_set_type(req, HTTPD_TYPE_JSON);
+        return httpd_resp_sendstr(req, resp.c_str());
+    }
     cJSON_AddNumberToObject(responseDoc, msgCode, code);
-    // Attention: resp gets freed by WebServer!
+
     char *resp = cJSON_PrintUnformatted(responseDoc);
-    web->sendWsTxt(sockfd, resp);
     cJSON_Delete(responseDoc);
     cJSON_Delete(root);
+
+    httpd_resp_set_status(req, http_status(code));
+    httpd_resp_set_type(req, HTTPD_TYPE_JSON);
+    esp_err_t ret = httpd_resp_sendstr(req, resp);
+    cJSON_free(resp);
+
     return ret;
 }
 
@@ -694,6 +1635,12 @@ void DockApi::fillPortMode(const std::shared_ptr<ExternalPort> &extPort, cJSON *
             cJSON_AddNumberToObject(uart, "data_bits", cfg->dataBits());
             cJSON_AddStringToObject(uart, "parity", cfg->parityAsString());
             cJSON_AddStringToObject(uart, "stop_bits", cfg->stopBitsAsString());
+            if (cfg->rx_delimiter != UART_RX_NO_DELIMITER) {
+                char delimiter[2] = {static_cast<char>(cfg->rx_delimiter), 0};
+                cJSON_AddStringToObject(uart, "rx_delimiter", delimiter);
+            }
+            cJSON_AddNumberToObject(uart, "rx_timeout", cfg->rx_timeout);
+            cJSON_AddStringToObject(uart, "flow_control", cfg->xonxoff ? "xonxoff" : "none");
         }
     }
 }
@@ -725,6 +1672,32 @@ uint16_t DockApi::processSetPortMode(const cJSON *root) {
         if (uart_cfg == nullptr) {
             return 400;
         }
+
+        // optional serial bridge settings
+        cJSON *item = cJSON_GetObjectItem(uart, "rx_delimiter");
+        if (cJSON_IsString(item)) {
+            const char *delimiter = cJSON_GetStringValue(item);
+            if (strlen(delimiter) > 1) {
+                return 400;
+            }
+            uart_cfg->rx_delimiter = delimiter[0] ? static_cast<uint8_t>(delimiter[0]) : UART_RX_NO_DELIMITER;
+        } else if (item && !cJSON_IsNull(item)) {
+            return 400;
+        }
+        if (cJSON_HasObjectItem(uart, "rx_timeout")) {
+            bool ok = false;
+            int  rx_timeout = cjson_get_int(uart, "rx_timeout", &ok);
+            if (!ok || rx_timeout < MIN_UART_RX_TIMEOUT || rx_timeout > MAX_UART_RX_TIMEOUT) {
+                return 400;
+            }
+            uart_cfg->rx_timeout = rx_timeout;
+        }
+        std::string flow_control = cjson_get_string(uart, "flow_control", "none");
+        if (flow_control == "xonxoff") {
+            uart_cfg->xonxoff = true;
+        } else if (flow_control != "none") {
+            return 400;
+        }
         std::string uart_str = uart_cfg->toString();
         if (ports_[port]->setUartConfig(std::move(uart_cfg)) != ESP_OK) {
             return 400;
@@ -806,6 +1779,50 @@ uint16_t DockApi::processSetPortTrigger(const cJSON *root) {
     }
 }
 
+uint16_t DockApi::processUartSend(const cJSON *root) {
+    uint8_t     port = cjson_get_int(root, "port");
+    std::string format = cjson_get_string(root, "format", "text");
+    const char *data = cJSON_GetStringValue(cJSON_GetObjectItem(root, "data"));
+
+    if (port == 0 || port > EXTERNAL_PORT_COUNT || data == nullptr || data[0] == 0) {
+        return 400;
+    }
+    if (!ports_.contains(port)) {
+        return 503;
+    }
+
+    std::vector<uint8_t> buffer;
+    if (format == "hex") {
+        buffer.resize(strlen(data) / 2);
+        int len = hexDecode(data, buffer.data(), buffer.size());
+        if (len <= 0) {
+            return 400;
+        }
+        buffer.resize(len);
+    } else if (format == "text") {
+        buffer.assign(data, data + strlen(data));
+    } else {
+        return 400;
+    }
+
+    // don't block the web server task: the client has to retry if the TX buffer is full
+    esp_err_t ret = ports_[port]->writeUart(buffer.data(), buffer.size(), 0);
+    switch (ret) {
+        case ESP_OK:
+            return 200;
+        case ESP_ERR_INVALID_SIZE:
+            return 400;
+        // port is not in RS232 mode
+        case ESP_ERR_INVALID_STATE:
+            return 409;
+        // TX buffer full or UART in use
+        case ESP_ERR_TIMEOUT:
+            return 503;
+        default:
+            return 500;
+    }
+}
+
 void DockApi::dockEventHandler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
     DockApi *that = static_cast<DockApi *>(arg);
 
@@ -836,7 +1853,7 @@ void DockApi::dockEventHandler(void *arg, esp_event_base_t event_base, int32_t e
 
             char       *resp = cJSON_PrintUnformatted(responseDoc);
             std::string msg = resp;
-            delete (resp);
+            cJSON_free(resp);
             cJSON_Delete(responseDoc);
 
             that->web_->broadcastWsTxt(msg);
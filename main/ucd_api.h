@@ -9,6 +9,7 @@
 #include <string>
 
 #include "esp_http_server.h"
+#include "esp_timer.h"
 
 #include "WebServer.h"
 #include "cJSON.h"
@@ -21,13 +22,21 @@ extern "C" {
 
 std::string get_uptime(void);
 
-void  fill_sysinfo_to_json(cJSON* root);
+/// @brief Get the system information as JSON object.
+/// @return JSON string, must be freed by the caller.
 char* get_sysinfo_json(void);
 
 #ifdef __cplusplus
 }
 #endif
 
+/// WebSocket event subscription: changed system information.
+#define UCD_SUBSCRIPTION_SYSINFO (1 << 0)
+/// WebSocket event subscription: IR codes received by the IR relay.
+#define UCD_SUBSCRIPTION_IR_RELAY (1 << 1)
+/// WebSocket event subscription: data received on an external port in RS232 mode.
+#define UCD_SUBSCRIPTION_UART (1 << 2)
+
 class DockApi {
  public:
     explicit DockApi(Config* config, WebServer* web, port_map_t ports);
@@ -45,17 +54,59 @@ class DockApi {
     /// @return ESP_OK if the message was successfully handled, otherwise ESP_ERR_## to close the WebSocket.
     esp_err_t processRequest(httpd_req_t* req, int sockfd, const char* text, size_t len, bool authenticated);
 
+    /// @brief Callback for REST API requests.
+    ///
+    /// REST routes are mapped to the same commands as the WebSocket API. Request and response bodies use the same
+    /// JSON fields.
+    /// @param req HTTP request
+    /// @return ESP_OK if the request was handled, otherwise ESP_ERR_## to close the connection.
+    esp_err_t processRestRequest(httpd_req_t* req);
+
+    /// Dock API command, shared by the WebSocket and REST API.
+    struct Command {
+        const char* command;
+        bool        authRequired;
+        /// Command handler. Returns the response code, or 0 if the response is sent asynchronously to clientId.
+        uint16_t (*handler)(DockApi* api, const cJSON* root, cJSON* responseDoc, int clientId);
+        /// Include the cached system information fields in the reply, in front of the fields of responseDoc.
+        bool withSysinfo = false;
+    };
+
+    /// @brief Find a command in the command table.
+    /// @param command command name
+    /// @return the command or nullptr if not found.
+    static const Command* findCommand(const std::string& command);
+
+    uint16_t processSetConfig(const cJSON* root, cJSON* responseDoc);
+    uint16_t processSetBrightness(const cJSON* root);
+    uint16_t processIrSend(const cJSON* root, cJSON* responseDoc, int clientId);
+    uint16_t processIrSendParallel(const cJSON* root, const cJSON* codes, int clientId);
+    uint16_t processIrRelayStart(const cJSON* root);
+    uint16_t processSetSntp(const cJSON* root);
+    uint16_t processSetNetwork(const cJSON* root);
+    uint16_t processGetNetwork(cJSON* responseDoc);
+    uint16_t processSetIrConfig(const cJSON* root, cJSON* responseDoc);
+
     uint16_t processGetPortModes(cJSON* responseDoc);
     uint16_t processGetPortMode(const cJSON* root, cJSON* responseDoc);
     void     fillPortMode(const std::shared_ptr<ExternalPort>& extPort, cJSON* responseDoc);
     uint16_t processSetPortMode(const cJSON* root);
     uint16_t processGetPortTrigger(const cJSON* root, cJSON* responseDoc);
     uint16_t processSetPortTrigger(const cJSON* root);
+    uint16_t processUartSend(const cJSON* root);
+
+    uint16_t processSubscribeEvents(const cJSON* root, int clientId);
+    uint16_t processGetHeap(cJSON* responseDoc);
+    uint16_t processGetTasks(cJSON* responseDoc);
+    uint16_t processGetTrace(const cJSON* root, cJSON* responseDoc);
 
     static void dockEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
+    /// Periodic timer callback to push changed system information to subscribed clients.
+    static void sysinfoTimerCb(void* arg);
 
  private:
-    Config*    config_;
-    WebServer* web_;
-    port_map_t ports_;
+    Config*            config_;
+    WebServer*         web_;
+    port_map_t         ports_;
+    esp_timer_handle_t sysinfoTimer_ = nullptr;
 };
@@ -0,0 +1,318 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Host-native simulation of the dock firmware. The startup sequence mirrors app_main in main/main.cpp, without the
+// hardware specific parts (display, button, charger, GPIO setup, file systems).
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "driver/uart.h"
+#include "esp_efuse.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+
+#include "WebServer.h"
+#include "board.h"
+#include "config.h"
+#include "external_port.h"
+#include "globalcache_server.h"
+#include "ir_fanout.h"
+#include "led_pattern.h"
+#include "mdns.h"
+#include "mem_tag.h"
+#include "nvs_flash.h"
+#include "ota.h"
+#include "service_ir.h"
+#include "sim_adc.h"
+#include "system_metrics.h"
+#include "task_stats.h"
+#include "uart_bridge.h"
+#include "uc_events.h"
+#include "ucd_api.h"
+
+static const char *const TAG = "SIM";
+
+struct sim_options_t {
+    uint16_t    port = 8080;
+    const char *webroot = SIM_WEBROOT;
+    const char *ip = "127.0.0.1";
+    const char *serial = "SIM00001";
+    const char *model = "UCD3";
+    const char *revision = "5.3";
+    bool        itach = false;
+    bool        uartLoopback = false;
+    const char *group = nullptr;
+    /// static IR fan-out peers: IPv4 address in network byte order and peer port
+    std::vector<std::pair<uint32_t, uint16_t>> peers;
+};
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  -p, --port <port>         web server port (default: 8080)\n");
+    printf("  -w, --webroot <dir>       web configurator root directory (default: %s)\n", SIM_WEBROOT);
+    printf("  -i, --ip <addr>           IPv4 address reported by the simulated network interface (default: 127.0.0.1)\n");
+    printf("  -s, --serial <serial>     dock serial number (default: SIM00001)\n");
+    printf("  -m, --model <model>       dock model (default: UCD3)\n");
+    printf("  -g, --itach               enable the iTach (Global Cache) server emulation\n");
+    printf("  -u, --uart-loopback       receive data written to an external port UART on the same UART\n");
+    printf("  -G, --group <name>        dock group for IR fan-out\n");
+    printf("  -f, --peer-port <port>    IR fan-out peer port (default: 4997)\n");
+    printf("  -P, --peer <[addr:]port>  static IR fan-out peer dock in the same group. Can be repeated.\n");
+    printf("  -l, --log-level <[tag=]l> log level e|w|i|d|v, optionally for a single tag. Can be repeated.\n");
+    printf("  -h, --help                show this help\n");
+}
+
+static bool set_log_level(const char *arg) {
+    static const char levels[] = "newidv";
+
+    const char *eq = strchr(arg, '=');
+    const char *level = eq ? eq + 1 : arg;
+    const char *pos = level[0] ? strchr(levels, level[0]) : nullptr;
+    if (pos == nullptr || level[1] != '\0') {
+        return false;
+    }
+    std::string tag = eq ? std::string(arg, eq - arg) : "*";
+    esp_log_level_set(tag.c_str(), static_cast<esp_log_level_t>(pos - levels));
+    return true;
+}
+
+static bool parse_options(int argc, char **argv, sim_options_t *opts) {
+    static const struct option long_options[] = {
+        {"port", required_argument, nullptr, 'p'},   {"webroot", required_argument, nullptr, 'w'},
+        {"ip", required_argument, nullptr, 'i'},     {"serial", required_argument, nullptr, 's'},
+        {"model", required_argument, nullptr, 'm'},  {"log-level", required_argument, nullptr, 'l'},
+        {"itach", no_argument, nullptr, 'g'},        {"uart-loopback", no_argument, nullptr, 'u'},
+        {"group", required_argument, nullptr, 'G'},  {"peer-port", required_argument, nullptr, 'f'},
+        {"peer", required_argument, nullptr, 'P'},   {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:w:i:s:m:l:guG:f:P:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'p': {
+                int port = atoi(optarg);
+                if (port <= 0 || port > 65535) {
+                    fprintf(stderr, "Invalid port: %s\n", optarg);
+                    return false;
+                }
+                opts->port = port;
+                break;
+            }
+            case 'w':
+                opts->webroot = optarg;
+                break;
+            case 'i': {
+                struct in_addr addr;
+                if (inet_aton(optarg, &addr) == 0) {
+                    fprintf(stderr, "Invalid IPv4 address: %s\n", optarg);
+                    return false;
+                }
+                opts->ip = optarg;
+                break;
+            }
+            case 's':
+                opts->serial = optarg;
+                break;
+            case 'm':
+                opts->model = optarg;
+                break;
+            case 'g':
+                opts->itach = true;
+                break;
+            case 'u':
+                opts->uartLoopback = true;
+                break;
+            case 'G':
+                opts->group = optarg;
+                break;
+            case 'f': {
+                int port = atoi(optarg);
+                if (port <= 0 || port > 65535) {
+                    fprintf(stderr, "Invalid peer port: %s\n", optarg);
+                    return false;
+                }
+                sim_ir_fanout_port = port;
+                break;
+            }
+            case 'P': {
+                const char    *colon = strrchr(optarg, ':');
+                std::string    ip = colon ? std::string(optarg, colon - optarg) : "127.0.0.1";
+                int            port = atoi(colon ? colon + 1 : optarg);
+                struct in_addr addr;
+                if (inet_aton(ip.c_str(), &addr) == 0 || port <= 0 || port > 65535) {
+                    fprintf(stderr, "Invalid peer: %s\n", optarg);
+                    return false;
+                }
+                opts->peers.emplace_back(addr.s_addr, port);
+                break;
+            }
+            case 'l':
+                if (!set_log_level(optarg)) {
+                    fprintf(stderr, "Invalid log level: %s\n", optarg);
+                    return false;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Create the external ports with simulated ADC readers: port detection always finds an empty port.
+static port_map_t init_external_ports(Config *cfg) {
+    port_map_t        ports;
+    ext_port_config_t configs[EXTERNAL_PORT_COUNT] = {
+        {
+            .gpio_gnd_switch = SWITCH_GND_1,
+            .gpio_5v_switch = SWITCH_EXT_1,
+            .gpio_rx = RX0,
+            .gpio_tx = TX0,
+            .uart_port = UART_NUM_1,
+        },
+        {
+            .gpio_gnd_switch = SWITCH_GND_2,
+            .gpio_5v_switch = SWITCH_EXT_2,
+            .gpio_rx = RX1,
+            .gpio_tx = TX1,
+            .uart_port = UART_NUM_2,
+        }};
+
+    auto vcc = std::make_shared<SimAdcReader>(3300);
+    for (uint8_t i = 1; i <= EXTERNAL_PORT_COUNT; i++) {
+        ports[i] = std::make_shared<ExternalPort>(i, configs[i - 1], std::make_unique<SimAdcReader>(), vcc);
+
+        auto uart_cfg = UartConfig::fromString(cfg->getExternalPortUart(i).c_str());
+        if (uart_cfg == nullptr) {
+            uart_cfg = UartConfig::defaultCfg();
+        }
+        esp_err_t ret = ports[i]->setUartConfig(std::move(uart_cfg));
+        if (ret == ESP_OK) {
+            ret = ports[i]->init(cfg->getExternalPortMode(i));
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "External port %d could not be initialized. Error %d", i, ret);
+        }
+    }
+
+    return ports;
+}
+
+static esp_err_t on_rest_sysinfo(httpd_req_t *req) {
+    const char *sys_info = get_sysinfo_json();
+    auto        ret = httpd_resp_sendstr(req, sys_info);
+    free((void *)sys_info);
+    return ret;
+}
+
+static void factoryResetHandler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
+    Config::instance().reset();
+}
+
+int main(int argc, char **argv) {
+    sim_options_t opts;
+    if (!parse_options(argc, argv, &opts)) {
+        return 2;
+    }
+
+    struct in_addr addr;
+    inet_aton(opts.ip, &addr);
+    sim_netif_set_ip(addr.s_addr);
+    sim_efuse_set_user_data(opts.serial, opts.model, opts.revision);
+    sim_uart_set_loopback(opts.uartLoopback);
+
+    // before any cJSON object is created
+    mem_tag_init_cjson();
+
+    ESP_ERROR_CHECK(nvs_flash_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    ESP_ERROR_CHECK_WITHOUT_ABORT(
+        esp_event_handler_register(UC_DOCK_EVENTS, UC_ACTION_RESET, factoryResetHandler, NULL));
+
+    Config &cfg = Config::instance();
+    if (opts.itach) {
+        // NVS is not persisted, the option replaces the web configurator setting
+        cfg.enableGcServer(true);
+    }
+    if (opts.group && !cfg.setDockGroup(opts.group)) {
+        ESP_LOGE(TAG, "Invalid dock group: %s", opts.group);
+        return 2;
+    }
+    // mDNS stand-in: the static peers are members of the same dock group
+    for (const auto &[ip, port] : opts.peers) {
+        if (sim_mdns_add_peer(ip, port, cfg.getDockGroup().c_str()) != ESP_OK) {
+            ESP_LOGE(TAG, "Too many peers");
+            return 2;
+        }
+    }
+
+    init_led();
+    auto ports = init_external_ports(&cfg);
+
+    static WebServer web;
+    uc_fatal_error_check(web.init(opts.port, opts.webroot), uc_errors::UC_ERROR_INIT_WEBSRV);
+    web.setRestHandler(on_rest_sysinfo);
+    web.setOtaHandler(on_ota_upload);
+
+    static DockApi api(&cfg, &web, ports);
+    api.init();
+    ESP_ERROR_CHECK_WITHOUT_ABORT(init_system_metrics());
+    ESP_ERROR_CHECK_WITHOUT_ABORT(task_stats_init());
+
+    InfraredService &irService = InfraredService::getInstance();
+    irService.init(ports, cfg.getIrSendCore(), cfg.getIrSendPriority(), cfg.getIrLearnCore(), cfg.getIrLearnPriority(),
+                   [=](IrResponse *response) -> esp_err_t {
+                       esp_err_t ret;
+                       if (response->clientId >= 0) {
+                           ret = web.sendWsTxt(response->clientId, static_cast<const char *>(response->message),
+                                               response->traceId);
+                       } else if (response->clientId == IR_CLIENT_RELAY) {
+                           web.broadcastWsTxt(response->message, UCD_SUBSCRIPTION_IR_RELAY);
+                           ret = ESP_OK;
+                       } else {
+                           std::string msg = response->message;
+                           web.broadcastWsTxt(msg);
+                           ret = ESP_OK;
+                       }
+                       InfraredService::getInstance().releaseResponse(response);
+                       return ret;
+                   });
+
+    if (cfg.isGcServerEnabled()) {
+        new GlobalCacheServer(&irService, &cfg, cfg.isGcServerBeaconEnabled());
+    }
+
+    IrFanout::getInstance().init(&irService, &cfg, [=](int16_t clientId, const char *message) {
+        web.sendWsTxt(clientId, message, 0);
+    });
+
+    ESP_ERROR_CHECK_WITHOUT_ABORT(UartBridge::getInstance().init(ports, [=](const char *message) {
+        web.broadcastWsTxt(message, UCD_SUBSCRIPTION_UART);
+    }));
+
+    // the host network is up: start the web server like the network manager does after receiving an IP address
+    ip_event_got_ip_t got_ip = {};
+    got_ip.esp_netif = esp_netif_get_default_netif();
+    esp_netif_get_ip_info(got_ip.esp_netif, &got_ip.ip_info);
+    ESP_ERROR_CHECK(esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &got_ip, sizeof(got_ip), portMAX_DELAY));
+
+    ESP_LOGI(TAG, "Dock simulation running: http://%s:%u/ (firmware %s)", opts.ip, opts.port, DOCK_VERSION);
+
+    while (true) {
+        pause();
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// eFuse user data block, see components/preferences/efuse_user.csv for the field layout.
+
+#include <string.h>
+
+#include "esp_efuse.h"
+
+/// Simulated EFUSE_BLK3: data version, serial, model, hardware revision and features.
+static uint8_t s_user_data[32] = {1};
+
+void sim_efuse_set_user_data(const char *serial, const char *model, const char *revision) {
+    memset(s_user_data, 0, sizeof(s_user_data));
+    s_user_data[0] = 1;
+    strncpy((char *)&s_user_data[1], serial ? serial : "", 8);
+    strncpy((char *)&s_user_data[9], model ? model : "", 7);
+    strncpy((char *)&s_user_data[16], revision ? revision : "", 3);
+}
+
+esp_err_t esp_efuse_read_field_blob(const esp_efuse_desc_t *field[], void *dst, size_t dst_size_bits) {
+    if (field == NULL || dst == NULL || dst_size_bits == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(dst, 0, (dst_size_bits + 7) / 8);
+
+    uint8_t *out = (uint8_t *)dst;
+    size_t   out_bit = 0;
+    for (int i = 0; field[i] != NULL && out_bit < dst_size_bits; i++) {
+        if (field[i]->efuse_block != EFUSE_BLK3) {
+            // all other blocks are blank
+            out_bit += field[i]->bit_count;
+            continue;
+        }
+        for (size_t bit = 0; bit < field[i]->bit_count && out_bit < dst_size_bits; bit++, out_bit++) {
+            size_t src_bit = field[i]->bit_start + bit;
+            if (src_bit >= sizeof(s_user_data) * 8) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            if (s_user_data[src_bit / 8] & (1 << (src_bit % 8))) {
+                out[out_bit / 8] |= 1 << (out_bit % 8);
+            }
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Default event loop: posted events are copied and dispatched to the registered handlers in the event loop task.
+
+#include <string.h>
+
+#include <mutex>
+#include <vector>
+
+#include "esp_event.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+static const char *const TAG = "SIM_EVENT";
+
+struct SimEventHandler {
+    esp_event_base_t    base;
+    int32_t             id;
+    esp_event_handler_t handler;
+    void               *arg;
+};
+
+struct SimEvent {
+    esp_event_base_t base;
+    int32_t          id;
+    void            *data;
+};
+
+static std::mutex                   s_lock;
+static std::vector<SimEventHandler> s_handlers;
+static QueueHandle_t                s_queue = nullptr;
+
+static bool matches(const SimEventHandler &h, esp_event_base_t base, int32_t id) {
+    // event bases are compared by identity, like in ESP-IDF
+    return (h.base == ESP_EVENT_ANY_BASE || h.base == base) && (h.id == ESP_EVENT_ANY_ID || h.id == id);
+}
+
+static void event_loop_task(void *) {
+    SimEvent event;
+    while (true) {
+        if (xQueueReceive(s_queue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        std::vector<SimEventHandler> handlers;
+        {
+            std::lock_guard<std::mutex> lock(s_lock);
+            for (const auto &h : s_handlers) {
+                if (matches(h, event.base, event.id)) {
+                    handlers.push_back(h);
+                }
+            }
+        }
+        for (const auto &h : handlers) {
+            h.handler(h.arg, event.base, event.id, event.data);
+        }
+        free(event.data);
+    }
+}
+
+esp_err_t esp_event_loop_create_default(void) {
+    if (s_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_queue = xQueueCreate(32, sizeof(SimEvent));
+    if (xTaskCreate(event_loop_task, "sys_evt", 4096, nullptr, 20, nullptr) != pdPASS) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_event_loop_delete_default(void) {
+    // the event loop task can't be terminated from the outside
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                                     esp_event_handler_t event_handler, void *event_handler_arg) {
+    return esp_event_handler_instance_register(event_base, event_id, event_handler, event_handler_arg, nullptr);
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t event_base, int32_t event_id,
+                                              esp_event_handler_t event_handler, void *event_handler_arg,
+                                              esp_event_handler_instance_t *instance) {
+    if (event_handler == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lock(s_lock);
+    s_handlers.push_back({event_base, event_id, event_handler, event_handler_arg});
+    if (instance) {
+        *instance = reinterpret_cast<void *>(event_handler);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_unregister(esp_event_base_t event_base, int32_t event_id,
+                                       esp_event_handler_t event_handler) {
+    std::lock_guard<std::mutex> lock(s_lock);
+    for (auto it = s_handlers.begin(); it != s_handlers.end(); ++it) {
+        if (it->base == event_base && it->id == event_id && it->handler == event_handler) {
+            s_handlers.erase(it);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id, const void *event_data,
+                         size_t event_data_size, TickType_t ticks_to_wait) {
+    if (!s_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    SimEvent event = {event_base, event_id, nullptr};
+    if (event_data && event_data_size) {
+        event.data = malloc(event_data_size);
+        if (!event.data) {
+            return ESP_ERR_NO_MEM;
+        }
+        memcpy(event.data, event_data, event_data_size);
+    }
+    if (xQueueSend(s_queue, &event, ticks_to_wait) != pdTRUE) {
+        free(event.data);
+        ESP_LOGW(TAG, "Event queue full, dropped event %s:%d", event_base, event_id);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
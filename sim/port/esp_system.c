@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// System functions: restart, chip information, MAC address and error names.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "esp_chip_info.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_system.h"
+
+static const char *const TAG = "SIM_SYS";
+
+/// Restart exit code, a supervising script may restart the simulation.
+#define SIM_RESTART_EXIT_CODE 3
+
+void esp_restart(void) {
+    ESP_LOGW(TAG, "Restart requested: exiting simulation");
+    fflush(stdout);
+    _exit(SIM_RESTART_EXIT_CODE);
+}
+
+esp_reset_reason_t esp_reset_reason(void) {
+    return ESP_RST_POWERON;
+}
+
+void esp_chip_info(esp_chip_info_t *out_info) {
+    memset(out_info, 0, sizeof(*out_info));
+    out_info->model = CHIP_POSIX_LINUX;
+    out_info->cores = (uint8_t)sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type) {
+    if (mac == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // locally administered address, derived from the process id to distinguish multiple simulated docks
+    pid_t pid = getpid();
+    mac[0] = 0x02;
+    mac[1] = 0x55;
+    mac[2] = 0x43;
+    mac[3] = (uint8_t)(pid >> 8);
+    mac[4] = (uint8_t)pid;
+    mac[5] = (uint8_t)type;
+    return ESP_OK;
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:
+            return "ESP_OK";
+        case ESP_FAIL:
+            return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:
+            return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:
+            return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:
+            return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:
+            return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:
+            return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:
+            return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:
+            return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE:
+            return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_NOT_ALLOWED:
+            return "ESP_ERR_NOT_ALLOWED";
+        case ESP_ERR_NVS_NOT_FOUND:
+            return "ESP_ERR_NVS_NOT_FOUND";
+        default:
+            return "UNKNOWN ERROR";
+    }
+}
+
+void _esp_error_check_failed(esp_err_t rc, const char *file, int line, const char *function, const char *expression) {
+    fprintf(stderr, "ESP_ERROR_CHECK failed: esp_err_t 0x%x (%s) at %s:%d\nfunction: %s\nexpression: %s\n", rc,
+            esp_err_to_name(rc), file, line, function, expression);
+    abort();
+}
+
+void _esp_error_check_failed_without_abort(esp_err_t rc, const char *file, int line, const char *function,
+                                           const char *expression) {
+    ESP_LOGE(TAG, "ESP_ERROR_CHECK_WITHOUT_ABORT failed: esp_err_t 0x%x (%s) at %s:%d, %s: %s", rc,
+             esp_err_to_name(rc), file, line, function, expression);
+}
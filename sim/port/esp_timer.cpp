@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// High resolution timers: all callbacks are dispatched from a single timer task, like ESP_TIMER_TASK in ESP-IDF.
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void          *arg;
+    const char    *name;
+    bool           skip_unhandled_events;
+    bool           active;
+    int64_t        alarm;
+    uint64_t       period;
+};
+
+static const auto               s_start = std::chrono::steady_clock::now();
+static std::mutex               s_lock;
+static std::condition_variable  s_changed;
+static std::vector<esp_timer *> s_timers;
+static bool                     s_taskStarted = false;
+
+int64_t esp_timer_get_time(void) {
+    auto elapsed = std::chrono::steady_clock::now() - s_start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+static void timer_task(void *) {
+    std::unique_lock<std::mutex> lock(s_lock);
+    while (true) {
+        esp_timer *next = nullptr;
+        for (auto *timer : s_timers) {
+            if (timer->active && (!next || timer->alarm < next->alarm)) {
+                next = timer;
+            }
+        }
+        if (!next) {
+            s_changed.wait(lock);
+            continue;
+        }
+        int64_t now = esp_timer_get_time();
+        if (next->alarm > now) {
+            s_changed.wait_for(lock, std::chrono::microseconds(next->alarm - now));
+            continue;
+        }
+
+        if (next->period) {
+            next->alarm += next->period;
+            if (next->skip_unhandled_events && next->alarm < now) {
+                next->alarm = now + next->period;
+            }
+        } else {
+            next->active = false;
+        }
+        esp_timer_cb_t callback = next->callback;
+        void          *arg = next->arg;
+        lock.unlock();
+        callback(arg);
+        lock.lock();
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    if (create_args == nullptr || create_args->callback == nullptr || out_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    auto *timer = new esp_timer{create_args->callback, create_args->arg, create_args->name,
+                                create_args->skip_unhandled_events, false, 0, 0};
+
+    std::lock_guard<std::mutex> lock(s_lock);
+    if (!s_taskStarted) {
+        if (xTaskCreate(timer_task, "esp_timer", 4096, nullptr, 22, nullptr) != pdPASS) {
+            delete timer;
+            return ESP_ERR_NO_MEM;
+        }
+        s_taskStarted = true;
+    }
+    s_timers.push_back(timer);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period) {
+    if (timer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    {
+        std::lock_guard<std::mutex> lock(s_lock);
+        if (timer->active) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        timer->alarm = esp_timer_get_time() + static_cast<int64_t>(timeout_us);
+        timer->period = period;
+        timer->active = true;
+    }
+    s_changed.notify_one();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    return timer_start(timer, period, period);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (timer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lock(s_lock);
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (timer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lock(s_lock);
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    std::erase(s_timers, timer);
+    delete timer;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    std::lock_guard<std::mutex> lock(s_lock);
+    return timer && timer->active;
+}
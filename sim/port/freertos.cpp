@@ -0,0 +1,335 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// FreeRTOS kernel API on POSIX threads.
+
+#include <pthread.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char *const TAG = "SIM_RTOS";
+
+struct SimTask {
+    char           name[configMAX_TASK_NAME_LEN];
+    TaskFunction_t function;
+    void          *param;
+    UBaseType_t    priority;
+    BaseType_t     core;
+};
+
+struct SimQueue {
+    std::mutex              lock;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    UBaseType_t             length;
+    UBaseType_t             itemSize;
+    // ring buffer, unused for semaphores
+    std::vector<uint8_t> items;
+    UBaseType_t          head = 0;
+    UBaseType_t          count = 0;
+};
+
+struct SimEventGroup {
+    std::mutex              lock;
+    std::condition_variable changed;
+    EventBits_t             bits = 0;
+};
+
+static const auto              s_start = std::chrono::steady_clock::now();
+static std::recursive_mutex    s_critical;
+static std::atomic<UBaseType_t> s_taskCount{1};
+static SimTask                 s_mainTask = {"main", nullptr, nullptr, 1, 0};
+static thread_local SimTask   *s_currentTask = &s_mainTask;
+
+/// @brief Wait on a condition variable for the given number of ticks.
+/// @return the predicate result.
+template <typename Predicate>
+static bool wait_ticks(std::condition_variable &cv, std::unique_lock<std::mutex> &lock, TickType_t ticks,
+                       Predicate predicate) {
+    if (ticks == portMAX_DELAY) {
+        cv.wait(lock, predicate);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(pdTICKS_TO_MS(ticks)), predicate);
+}
+
+void sim_enter_critical(void) {
+    s_critical.lock();
+}
+
+void sim_exit_critical(void) {
+    s_critical.unlock();
+}
+
+BaseType_t xPortGetCoreID(void) {
+    BaseType_t core = s_currentTask->core;
+    return core == 0 || core == 1 ? core : 0;
+}
+
+// ---- Tasks ----
+
+static void *task_entry(void *arg) {
+    SimTask *task = static_cast<SimTask *>(arg);
+    s_currentTask = task;
+    pthread_setname_np(pthread_self(), task->name);
+
+    task->function(task->param);
+
+    // a FreeRTOS task function must not return: treat it like vTaskDelete(NULL)
+    ESP_LOGW(TAG, "Task returned without deleting itself: %s", task->name);
+    vTaskDelete(NULL);
+    return nullptr;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth,
+                                   void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask,
+                                   BaseType_t xCoreID) {
+    // stack depth is ignored: host stack frames are much larger than on the target
+    (void)usStackDepth;
+    SimTask *task = new SimTask();
+    strncpy(task->name, pcName ? pcName : "", sizeof(task->name) - 1);
+    task->function = pxTaskCode;
+    task->param = pvParameters;
+    task->priority = uxPriority;
+    task->core = xCoreID;
+
+    pthread_t thread;
+    if (pthread_create(&thread, nullptr, task_entry, task) != 0) {
+        ESP_LOGE(TAG, "Failed to create task: %s", task->name);
+        delete task;
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    s_taskCount++;
+
+    if (pxCreatedTask) {
+        *pxCreatedTask = task;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete) {
+    if (xTaskToDelete != nullptr && xTaskToDelete != s_currentTask) {
+        // threads can't be safely terminated from the outside
+        ESP_LOGE(TAG, "Deleting another task is not supported: %s", xTaskToDelete->name);
+        return;
+    }
+    SimTask *task = s_currentTask;
+    if (task == &s_mainTask) {
+        ESP_LOGE(TAG, "The main task can't be deleted");
+        return;
+    }
+    s_currentTask = nullptr;
+    s_taskCount--;
+    delete task;
+    pthread_exit(nullptr);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(pdTICKS_TO_MS(xTicksToDelay)));
+}
+
+void sim_task_yield(void) {
+    std::this_thread::yield();
+}
+
+TickType_t xTaskGetTickCount(void) {
+    auto elapsed = std::chrono::steady_clock::now() - s_start;
+    return static_cast<TickType_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return s_currentTask;
+}
+
+char *pcTaskGetName(TaskHandle_t xTaskToQuery) {
+    SimTask *task = xTaskToQuery ? xTaskToQuery : s_currentTask;
+    return task->name;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t xTask) {
+    SimTask *task = xTask ? xTask : s_currentTask;
+    return task->priority;
+}
+
+void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority) {
+    SimTask *task = xTask ? xTask : s_currentTask;
+    task->priority = uxNewPriority;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void) {
+    return s_taskCount;
+}
+
+// ---- Queues and semaphores ----
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize) {
+    if (uxQueueLength == 0) {
+        return nullptr;
+    }
+    SimQueue *queue = new SimQueue();
+    queue->length = uxQueueLength;
+    queue->itemSize = uxItemSize;
+    queue->items.resize(static_cast<size_t>(uxQueueLength) * uxItemSize);
+    return queue;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount) {
+    SimQueue *queue = xQueueCreate(uxMaxCount, 0);
+    if (queue) {
+        queue->count = uxInitialCount > uxMaxCount ? uxMaxCount : uxInitialCount;
+    }
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t xQueue) {
+    delete xQueue;
+}
+
+static BaseType_t queue_send(QueueHandle_t queue, const void *item, TickType_t ticks, bool front) {
+    if (!queue) {
+        return pdFAIL;
+    }
+    std::unique_lock<std::mutex> lock(queue->lock);
+    if (!wait_ticks(queue->notFull, lock, ticks, [queue] { return queue->count < queue->length; })) {
+        return errQUEUE_FULL;
+    }
+    if (queue->itemSize) {
+        UBaseType_t slot;
+        if (front) {
+            queue->head = (queue->head + queue->length - 1) % queue->length;
+            slot = queue->head;
+        } else {
+            slot = (queue->head + queue->count) % queue->length;
+        }
+        memcpy(&queue->items[static_cast<size_t>(slot) * queue->itemSize], item, queue->itemSize);
+    }
+    queue->count++;
+    lock.unlock();
+    queue->notEmpty.notify_one();
+    return pdPASS;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait) {
+    return queue_send(xQueue, pvItemToQueue, xTicksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait) {
+    return queue_send(xQueue, pvItemToQueue, xTicksToWait, true);
+}
+
+static BaseType_t queue_receive(QueueHandle_t queue, void *buffer, TickType_t ticks, bool remove) {
+    if (!queue) {
+        return pdFAIL;
+    }
+    std::unique_lock<std::mutex> lock(queue->lock);
+    if (!wait_ticks(queue->notEmpty, lock, ticks, [queue] { return queue->count > 0; })) {
+        return errQUEUE_EMPTY;
+    }
+    if (queue->itemSize && buffer) {
+        memcpy(buffer, &queue->items[static_cast<size_t>(queue->head) * queue->itemSize], queue->itemSize);
+    }
+    if (!remove) {
+        return pdPASS;
+    }
+    queue->head = queue->itemSize ? (queue->head + 1) % queue->length : 0;
+    queue->count--;
+    lock.unlock();
+    queue->notFull.notify_one();
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait) {
+    return queue_receive(xQueue, pvBuffer, xTicksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait) {
+    return queue_receive(xQueue, pvBuffer, xTicksToWait, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue) {
+    if (!xQueue) {
+        return pdFAIL;
+    }
+    {
+        std::lock_guard<std::mutex> lock(xQueue->lock);
+        xQueue->head = 0;
+        xQueue->count = 0;
+    }
+    xQueue->notFull.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue) {
+    std::lock_guard<std::mutex> lock(xQueue->lock);
+    return xQueue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue) {
+    std::lock_guard<std::mutex> lock(xQueue->lock);
+    return xQueue->length - xQueue->count;
+}
+
+// ---- Event groups ----
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    return new SimEventGroup();
+}
+
+void vEventGroupDelete(EventGroupHandle_t xEventGroup) {
+    delete xEventGroup;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToWaitFor,
+                                const BaseType_t xClearOnExit, const BaseType_t xWaitForAllBits,
+                                TickType_t xTicksToWait) {
+    std::unique_lock<std::mutex> lock(xEventGroup->lock);
+    auto satisfied = [=] {
+        EventBits_t set = xEventGroup->bits & uxBitsToWaitFor;
+        return xWaitForAllBits ? set == uxBitsToWaitFor : set != 0;
+    };
+    bool        ok = wait_ticks(xEventGroup->changed, lock, xTicksToWait, satisfied);
+    EventBits_t bits = xEventGroup->bits;
+    if (ok && xClearOnExit) {
+        xEventGroup->bits &= ~uxBitsToWaitFor;
+    }
+    return bits;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet) {
+    EventBits_t bits;
+    {
+        std::lock_guard<std::mutex> lock(xEventGroup->lock);
+        xEventGroup->bits |= uxBitsToSet;
+        bits = xEventGroup->bits;
+    }
+    xEventGroup->changed.notify_all();
+    return bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToClear) {
+    std::lock_guard<std::mutex> lock(xEventGroup->lock);
+    EventBits_t                 bits = xEventGroup->bits;
+    xEventGroup->bits &= ~uxBitsToClear;
+    return bits;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t xEventGroup) {
+    std::lock_guard<std::mutex> lock(xEventGroup->lock);
+    return xEventGroup->bits;
+}
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// There is no embedded FrogFS image: the web server reads all files from the web root directory.
+
+#include <stddef.h>
+
+#include "frogfs/frogfs.h"
+
+frogfs_fs_t *frogfs_init(const frogfs_config_t *conf) {
+    (void)conf;
+    return NULL;
+}
+
+const frogfs_entry_t *frogfs_get_entry(const frogfs_fs_t *fs, const char *path) {
+    (void)fs;
+    (void)path;
+    return NULL;
+}
+
+int frogfs_is_file(const frogfs_entry_t *entry) {
+    (void)entry;
+    return 0;
+}
+
+void frogfs_stat(const frogfs_fs_t *fs, const frogfs_entry_t *entry, frogfs_stat_t *st) {
+    (void)fs;
+    (void)entry;
+    (void)st;
+}
+
+frogfs_fh_t *frogfs_open(const frogfs_fs_t *fs, const frogfs_entry_t *entry, unsigned int flags) {
+    (void)fs;
+    (void)entry;
+    (void)flags;
+    return NULL;
+}
+
+size_t frogfs_access(frogfs_fh_t *fh, const void **buf) {
+    (void)fh;
+    *buf = NULL;
+    return 0;
+}
+
+void frogfs_close(frogfs_fh_t *fh) {
+    (void)fh;
+}
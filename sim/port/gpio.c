@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// GPIO driver on a simulated pin state.
+
+#include "driver/gpio.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *const TAG = "SIM_GPIO";
+
+/// Output register, written by the IR sender with the set and clear masks.
+gpio_dev_t GPIO;
+
+static uint8_t s_levels[GPIO_NUM_MAX];
+
+esp_err_t gpio_config(const gpio_config_t *pGPIOConfig) {
+    if (pGPIOConfig == NULL || (pGPIOConfig->pin_bit_mask >> GPIO_NUM_MAX) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(NULL);
+    s_levels[gpio_num] = 0;
+    taskEXIT_CRITICAL(NULL);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) {
+    (void)mode;
+    return GPIO_IS_VALID_GPIO(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(NULL);
+    s_levels[gpio_num] = level ? 1 : 0;
+    taskEXIT_CRITICAL(NULL);
+    ESP_LOGV(TAG, "GPIO%d: %u", gpio_num, level);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return 0;
+    }
+    taskENTER_CRITICAL(NULL);
+    int level = s_levels[gpio_num];
+    taskEXIT_CRITICAL(NULL);
+    return level;
+}
+
+void sim_gpio_inject_level(gpio_num_t gpio_num, uint32_t level) {
+    gpio_set_level(gpio_num, level);
+}
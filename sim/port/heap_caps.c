@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Capability based heap allocation on the host heap.
+//
+// All capabilities are served from the host heap. The heap statistics are reported for a simulated internal RAM and
+// PSRAM region of the target size, based on the bytes allocated on the host.
+
+#include <malloc.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+
+#define SIM_INTERNAL_HEAP_SIZE (320 * 1024)
+#define SIM_SPIRAM_HEAP_SIZE (8 * 1024 * 1024)
+
+static size_t s_minimum_free = SIM_INTERNAL_HEAP_SIZE;
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+    (void)caps;
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    (void)caps;
+    return calloc(n, size);
+}
+
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps) {
+    (void)caps;
+    return realloc(ptr, size);
+}
+
+void heap_caps_free(void *ptr) {
+    free(ptr);
+}
+
+void *heap_caps_malloc_prefer(size_t size, size_t num, ...) {
+    (void)num;
+    return malloc(size);
+}
+
+void *heap_caps_calloc_prefer(size_t n, size_t size, size_t num, ...) {
+    (void)num;
+    return calloc(n, size);
+}
+
+size_t heap_caps_get_allocated_size(void *ptr) {
+    return malloc_usable_size(ptr);
+}
+
+static size_t heap_size(uint32_t caps) {
+    return (caps & MALLOC_CAP_SPIRAM) ? SIM_SPIRAM_HEAP_SIZE : SIM_INTERNAL_HEAP_SIZE;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    size_t total = heap_size(caps);
+    size_t used = mallinfo2().uordblks;
+    size_t free_size = used < total ? total - used : 0;
+    if (!(caps & MALLOC_CAP_SPIRAM) && free_size < s_minimum_free) {
+        s_minimum_free = free_size;
+    }
+    return free_size;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+    size_t free_size = heap_caps_get_free_size(caps);
+    return (caps & MALLOC_CAP_SPIRAM) ? free_size : s_minimum_free;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    return heap_caps_get_free_size(caps);
+}
+
+void heap_caps_get_info(multi_heap_info_t *info, uint32_t caps) {
+    struct mallinfo2 mi = mallinfo2();
+    memset(info, 0, sizeof(*info));
+    info->total_free_bytes = heap_caps_get_free_size(caps);
+    info->total_allocated_bytes = heap_size(caps) - info->total_free_bytes;
+    info->largest_free_block = info->total_free_bytes;
+    info->minimum_free_bytes = heap_caps_get_minimum_free_size(caps);
+    info->allocated_blocks = mi.ordblks;
+    info->free_blocks = mi.ordblks;
+    info->total_blocks = mi.ordblks * 2;
+}
+
+uint32_t esp_get_free_heap_size(void) {
+    return heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+}
+
+uint32_t esp_get_minimum_free_heap_size(void) {
+    return heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+}
@@ -0,0 +1,1130 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// HTTP server with WebSocket support on host sockets.
+//
+// Follows the processing model of the ESP-IDF esp_http_server: a single server task waits for new connections,
+// incoming requests, WebSocket frames and queued work items, and processes them sequentially. URI handlers, session
+// contexts and work functions are therefore never called concurrently.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "esp_event.h"
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char *const TAG = "SIM_HTTPD";
+
+ESP_EVENT_DEFINE_BASE(ESP_HTTP_SERVER_EVENT);
+
+#define WS_FIN_BIT 0x80
+#define WS_MASK_BIT 0x80
+#define WS_OPCODE_MASK 0x0F
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+struct SimSession {
+    int                 fd;
+    bool                websocket = false;
+    /// Index of the WebSocket URI handler after the handshake.
+    size_t              wsHandler = 0;
+    bool                closeRequested = false;
+    int64_t             lastUsed = 0;
+    void               *ctx = nullptr;
+    httpd_free_ctx_fn_t freeCtx = nullptr;
+    /// Received bytes which have not been processed yet, e.g. a pipelined request.
+    std::string rx;
+    /// Serializes frames sent from other tasks with responses of the server task.
+    std::mutex sendLock;
+};
+
+struct SimWork {
+    httpd_work_fn_t fn;
+    void           *arg;
+};
+
+struct SimServer {
+    httpd_config_t           config;
+    int                      listenFd = -1;
+    int                      ctrl[2] = {-1, -1};
+    std::vector<httpd_uri_t> handlers;
+    std::vector<std::string> handlerUris;
+    std::map<int, SimSession *> sessions;
+    std::recursive_mutex     lock;
+    std::deque<SimWork>      work;
+    std::atomic<bool>        stop{false};
+    SemaphoreHandle_t        stopped = nullptr;
+    /// Request being processed by a URI handler, its session context is not yet stored in the session.
+    httpd_req_t *current = nullptr;
+    int          currentFd = -1;
+};
+
+struct SimRequest {
+    SimServer                                       *server;
+    SimSession                                      *session;
+    std::vector<std::pair<std::string, std::string>> headers;
+    /// Unread request body bytes.
+    size_t                                           remaining = 0;
+    // response
+    std::string                                      status = HTTPD_200;
+    std::string                                      type = HTTPD_TYPE_TEXT;
+    std::vector<std::pair<std::string, std::string>> respHeaders;
+    bool                                             headersSent = false;
+    bool                                             chunked = false;
+    bool                                             closeAfterResponse = false;
+    // WebSocket frame
+    httpd_ws_type_t                                  wsType = HTTPD_WS_TYPE_TEXT;
+    bool                                             wsFinal = true;
+    size_t                                           wsLen = 0;
+    uint8_t                                          wsMask[4] = {};
+    bool                                             wsMasked = false;
+    bool                                             wsPayloadRead = false;
+};
+
+// ---- SHA-1 and Base64 for the WebSocket handshake ----
+
+static uint32_t rol(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static void sha1(const uint8_t *data, size_t len, uint8_t digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::vector<uint8_t> msg(data, data + len);
+    msg.push_back(0x80);
+    while (msg.size() % 64 != 56) {
+        msg.push_back(0);
+    }
+    uint64_t bits = static_cast<uint64_t>(len) * 8;
+    for (int i = 7; i >= 0; i--) {
+        msg.push_back(static_cast<uint8_t>(bits >> (i * 8)));
+    }
+
+    for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = (msg[chunk + i * 4] << 24) | (msg[chunk + i * 4 + 1] << 16) | (msg[chunk + i * 4 + 2] << 8) |
+                   msg[chunk + i * 4 + 3];
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t temp = rol(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rol(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4] = h[i] >> 24;
+        digest[i * 4 + 1] = h[i] >> 16;
+        digest[i * 4 + 2] = h[i] >> 8;
+        digest[i * 4 + 3] = h[i];
+    }
+}
+
+static std::string base64(const uint8_t *data, size_t len) {
+    static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string       out;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t n = data[i] << 16;
+        if (i + 1 < len) {
+            n |= data[i + 1] << 8;
+        }
+        if (i + 2 < len) {
+            n |= data[i + 2];
+        }
+        out += chars[(n >> 18) & 0x3F];
+        out += chars[(n >> 12) & 0x3F];
+        out += i + 1 < len ? chars[(n >> 6) & 0x3F] : '=';
+        out += i + 2 < len ? chars[n & 0x3F] : '=';
+    }
+    return out;
+}
+
+// ---- Socket helpers ----
+
+static bool send_all(SimSession *session, const void *data, size_t len) {
+    std::lock_guard<std::mutex> lock(session->sendLock);
+    const char                 *p = static_cast<const char *>(data);
+    while (len > 0) {
+        ssize_t sent = send(session->fd, p, len, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += sent;
+        len -= sent;
+    }
+    return true;
+}
+
+/// @brief Read exactly `len` bytes: buffered bytes first, then from the socket.
+/// @return number of bytes read, 0 if the connection was closed, HTTPD_SOCK_ERR_* on error.
+static int recv_exact(SimSession *session, void *buf, size_t len) {
+    char  *out = static_cast<char *>(buf);
+    size_t done = std::min(len, session->rx.size());
+    memcpy(out, session->rx.data(), done);
+    session->rx.erase(0, done);
+    while (done < len) {
+        ssize_t ret = recv(session->fd, out + done, len - done, 0);
+        if (ret == 0) {
+            return 0;
+        }
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+        }
+        done += ret;
+    }
+    return static_cast<int>(done);
+}
+
+static SimRequest *sim_req(httpd_req_t *r) {
+    return r ? static_cast<SimRequest *>(r->aux) : nullptr;
+}
+
+static SimSession *find_session(SimServer *server, int fd) {
+    auto it = server->sessions.find(fd);
+    return it == server->sessions.end() ? nullptr : it->second;
+}
+
+/// @brief Close and remove a session. Must be called with the server lock held.
+static void close_session(SimServer *server, SimSession *session) {
+    int fd = session->fd;
+    server->sessions.erase(fd);
+    if (session->ctx) {
+        if (session->freeCtx) {
+            session->freeCtx(session->ctx);
+        } else {
+            free(session->ctx);
+        }
+    }
+    if (server->config.close_fn) {
+        // the close function is responsible for closing the socket
+        server->config.close_fn(server, fd);
+    } else {
+        close(fd);
+    }
+    delete session;
+    ESP_LOGD(TAG, "Session closed: %d", fd);
+    esp_event_post(ESP_HTTP_SERVER_EVENT, HTTP_SERVER_EVENT_DISCONNECTED, &fd, sizeof(fd), portMAX_DELAY);
+}
+
+// ---- Request processing ----
+
+static const char *const s_methods[] = {"DELETE", "GET", "HEAD", "POST", "PUT", "CONNECT", "OPTIONS", "TRACE"};
+
+static int parse_method(const std::string &method) {
+    for (size_t i = 0; i < sizeof(s_methods) / sizeof(s_methods[0]); i++) {
+        if (method == s_methods[i]) {
+            return static_cast<int>(i);
+        }
+    }
+    if (method == "PATCH") {
+        return HTTP_PATCH;
+    }
+    return -1;
+}
+
+static const char *find_header(SimRequest *req, const char *field) {
+    for (const auto &header : req->headers) {
+        if (strcasecmp(header.first.c_str(), field) == 0) {
+            return header.second.c_str();
+        }
+    }
+    return nullptr;
+}
+
+/// @brief Send an error response before a request handler is called, e.g. for an unknown URI.
+static void send_early_error(httpd_req_t *r, httpd_err_code_t error) {
+    httpd_resp_send_err(r, error, nullptr);
+}
+
+static bool websocket_handshake(SimRequest *req, httpd_req_t *r) {
+    const char *key = find_header(req, "Sec-WebSocket-Key");
+    if (!key) {
+        send_early_error(r, HTTPD_400_BAD_REQUEST);
+        return false;
+    }
+    std::string accept = std::string(key) + WS_GUID;
+    uint8_t     digest[20];
+    sha1(reinterpret_cast<const uint8_t *>(accept.data()), accept.size(), digest);
+
+    std::string resp = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: " +
+                       base64(digest, sizeof(digest)) + "\r\n\r\n";
+    return send_all(req->session, resp.data(), resp.size());
+}
+
+/// @brief Call a URI handler and store the session context set by the handler.
+static esp_err_t invoke_handler(SimServer *server, SimSession *session, const httpd_uri_t *handler, httpd_req_t *r) {
+    {
+        // like ESP-IDF: httpd_sess_get_ctx returns the request's context while the handler is running
+        std::lock_guard<std::recursive_mutex> lock(server->lock);
+        server->current = r;
+        server->currentFd = session->fd;
+    }
+    esp_err_t ret = handler->handler(r);
+
+    std::lock_guard<std::recursive_mutex> lock(server->lock);
+    server->current = nullptr;
+    server->currentFd = -1;
+    if (!r->ignore_sess_ctx_changes || !session->ctx) {
+        session->ctx = r->sess_ctx;
+        session->freeCtx = r->free_ctx;
+    }
+    return ret;
+}
+
+/// @brief Read and process a HTTP request.
+/// @return false if the session must be closed.
+static bool process_http_request(SimServer *server, SimSession *session) {
+    // read the request header
+    size_t end;
+    while ((end = session->rx.find("\r\n\r\n")) == std::string::npos) {
+        if (session->rx.size() > HTTPD_MAX_REQ_HDR_LEN) {
+            ESP_LOGW(TAG, "Request header too long: %d", session->fd);
+            return false;
+        }
+        char    buf[512];
+        ssize_t ret = recv(session->fd, buf, sizeof(buf), 0);
+        if (ret <= 0) {
+            return false;
+        }
+        session->rx.append(buf, ret);
+    }
+    std::string header = session->rx.substr(0, end);
+    session->rx.erase(0, end + 4);
+
+    SimRequest  req;
+    httpd_req_t r = {};
+    req.server = server;
+    req.session = session;
+    r.handle = server;
+    r.aux = &req;
+
+    // request line
+    size_t      lineEnd = header.find("\r\n");
+    std::string line = header.substr(0, lineEnd);
+    size_t      sp1 = line.find(' ');
+    size_t      sp2 = line.rfind(' ');
+    if (sp1 == std::string::npos || sp2 == sp1) {
+        send_early_error(&r, HTTPD_400_BAD_REQUEST);
+        return false;
+    }
+    std::string uri = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    if (uri.size() > HTTPD_MAX_URI_LEN) {
+        send_early_error(&r, HTTPD_414_URI_TOO_LONG);
+        return false;
+    }
+    memcpy(const_cast<char *>(r.uri), uri.c_str(), uri.size() + 1);
+    r.method = parse_method(line.substr(0, sp1));
+    if (r.method < 0) {
+        send_early_error(&r, HTTPD_501_METHOD_NOT_IMPLEMENTED);
+        return false;
+    }
+
+    // header fields
+    size_t pos = lineEnd == std::string::npos ? header.size() : lineEnd + 2;
+    while (pos < header.size()) {
+        size_t next = header.find("\r\n", pos);
+        if (next == std::string::npos) {
+            next = header.size();
+        }
+        std::string field = header.substr(pos, next - pos);
+        size_t      colon = field.find(':');
+        if (colon != std::string::npos) {
+            size_t valueStart = field.find_first_not_of(" \t", colon + 1);
+            req.headers.emplace_back(field.substr(0, colon),
+                                     valueStart == std::string::npos ? "" : field.substr(valueStart));
+        }
+        pos = next + 2;
+    }
+    const char *contentLength = find_header(&req, "Content-Length");
+    r.content_len = contentLength ? strtoul(contentLength, nullptr, 10) : 0;
+    req.remaining = r.content_len;
+    const char *connection = find_header(&req, "Connection");
+    req.closeAfterResponse = connection && strcasestr(connection, "close");
+
+    // find the URI handler, the query string is ignored for matching
+    size_t       matchLen = strcspn(r.uri, "?");
+    httpd_uri_t *handler = nullptr;
+    size_t       handlerIdx = 0;
+    bool         uriMatched = false;
+    for (size_t i = 0; i < server->handlers.size(); i++) {
+        const httpd_uri_t &h = server->handlers[i];
+        bool               match = server->config.uri_match_fn ? server->config.uri_match_fn(h.uri, r.uri, matchLen)
+                                                               : strlen(h.uri) == matchLen &&
+                                                       strncmp(h.uri, r.uri, matchLen) == 0;
+        if (!match) {
+            continue;
+        }
+        uriMatched = true;
+        if (h.method == r.method) {
+            handler = &server->handlers[i];
+            handlerIdx = i;
+            break;
+        }
+    }
+    if (!handler) {
+        ESP_LOGW(TAG, "No handler for %s %s", s_methods[r.method < 8 ? r.method : 0], r.uri);
+        send_early_error(&r, uriMatched ? HTTPD_405_METHOD_NOT_ALLOWED : HTTPD_404_NOT_FOUND);
+        return !req.closeAfterResponse;
+    }
+    r.user_ctx = handler->user_ctx;
+    r.sess_ctx = session->ctx;
+    r.free_ctx = session->freeCtx;
+
+    if (handler->is_websocket) {
+        const char *upgrade = find_header(&req, "Upgrade");
+        if (!upgrade || strcasecmp(upgrade, "websocket") != 0) {
+            send_early_error(&r, HTTPD_400_BAD_REQUEST);
+            return false;
+        }
+        if (!websocket_handshake(&req, &r)) {
+            return false;
+        }
+        session->websocket = true;
+        session->wsHandler = handlerIdx;
+    }
+
+    esp_err_t ret = invoke_handler(server, session, handler, &r);
+    if (ret != ESP_OK) {
+        return false;
+    }
+    if (session->websocket) {
+        return true;
+    }
+
+    // discard the unread request body
+    while (req.remaining > 0) {
+        char buf[512];
+        int  len = httpd_req_recv(&r, buf, sizeof(buf));
+        if (len <= 0) {
+            return false;
+        }
+    }
+    for (const auto &h : req.respHeaders) {
+        if (strcasecmp(h.first.c_str(), "Connection") == 0 && strcasecmp(h.second.c_str(), "close") == 0) {
+            req.closeAfterResponse = true;
+        }
+    }
+    return !req.closeAfterResponse;
+}
+
+/// @brief Read and process a WebSocket frame.
+/// @return false if the session must be closed.
+static bool process_ws_frame(SimServer *server, SimSession *session) {
+    uint8_t hdr[2];
+    if (recv_exact(session, hdr, 2) != 2) {
+        return false;
+    }
+
+    SimRequest  req;
+    httpd_req_t r = {};
+    req.server = server;
+    req.session = session;
+    req.wsFinal = hdr[0] & WS_FIN_BIT;
+    req.wsType = static_cast<httpd_ws_type_t>(hdr[0] & WS_OPCODE_MASK);
+    req.wsMasked = hdr[1] & WS_MASK_BIT;
+
+    uint64_t len = hdr[1] & 0x7F;
+    if (len == 126) {
+        uint8_t ext[2];
+        if (recv_exact(session, ext, 2) != 2) {
+            return false;
+        }
+        len = (ext[0] << 8) | ext[1];
+    } else if (len == 127) {
+        uint8_t ext[8];
+        if (recv_exact(session, ext, 8) != 8) {
+            return false;
+        }
+        len = 0;
+        for (int i = 0; i < 8; i++) {
+            len = (len << 8) | ext[i];
+        }
+    }
+    req.wsLen = len;
+    if (req.wsMasked && recv_exact(session, req.wsMask, 4) != 4) {
+        return false;
+    }
+
+    const httpd_uri_t &handler = server->handlers[session->wsHandler];
+    r.handle = server;
+    r.aux = &req;
+    r.method = 0;
+    r.user_ctx = handler.user_ctx;
+    r.sess_ctx = session->ctx;
+    r.free_ctx = session->freeCtx;
+    strlcpy(const_cast<char *>(r.uri), handler.uri, sizeof(r.uri));
+
+    if (!handler.handle_ws_control_frames && (req.wsType == HTTPD_WS_TYPE_PING || req.wsType == HTTPD_WS_TYPE_PONG ||
+                                              req.wsType == HTTPD_WS_TYPE_CLOSE)) {
+        std::vector<uint8_t> payload(req.wsLen);
+        httpd_ws_frame_t     frame = {};
+        frame.payload = payload.data();
+        if (httpd_ws_recv_frame(&r, &frame, payload.size()) != ESP_OK) {
+            return false;
+        }
+        if (req.wsType == HTTPD_WS_TYPE_PING) {
+            frame.type = HTTPD_WS_TYPE_PONG;
+            return httpd_ws_send_frame(&r, &frame) == ESP_OK;
+        }
+        if (req.wsType == HTTPD_WS_TYPE_CLOSE) {
+            frame.len = 0;
+            httpd_ws_send_frame(&r, &frame);
+            return false;
+        }
+        return true;
+    }
+
+    esp_err_t ret = invoke_handler(server, session, &handler, &r);
+    if (ret != ESP_OK) {
+        return false;
+    }
+    if (!req.wsPayloadRead) {
+        // payload not consumed by the handler
+        std::vector<uint8_t> discard(req.wsLen);
+        if (recv_exact(session, discard.data(), discard.size()) != static_cast<int>(discard.size())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---- Server task ----
+
+static void accept_connection(SimServer *server) {
+    int fd = accept(server->listenFd, nullptr, nullptr);
+    if (fd < 0) {
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(server->lock);
+    if (server->sessions.size() >= server->config.max_open_sockets) {
+        if (!server->config.lru_purge_enable) {
+            ESP_LOGW(TAG, "Maximum number of sessions reached, rejecting connection");
+            close(fd);
+            return;
+        }
+        SimSession *lru = nullptr;
+        for (auto &entry : server->sessions) {
+            if (!lru || entry.second->lastUsed < lru->lastUsed) {
+                lru = entry.second;
+            }
+        }
+        ESP_LOGD(TAG, "Closing least recently used session: %d", lru->fd);
+        close_session(server, lru);
+    }
+
+    struct timeval timeout = {.tv_sec = server->config.recv_wait_timeout, .tv_usec = 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    timeout.tv_sec = server->config.send_wait_timeout;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    if (server->config.open_fn && server->config.open_fn(server, fd) != ESP_OK) {
+        close(fd);
+        return;
+    }
+
+    auto *session = new SimSession();
+    session->fd = fd;
+    session->lastUsed = esp_timer_get_time();
+    server->sessions[fd] = session;
+    ESP_LOGD(TAG, "New session: %d", fd);
+    esp_event_post(ESP_HTTP_SERVER_EVENT, HTTP_SERVER_EVENT_ON_CONNECTED, &fd, sizeof(fd), portMAX_DELAY);
+}
+
+static void run_work(SimServer *server) {
+    char drain[64];
+    while (read(server->ctrl[0], drain, sizeof(drain)) == sizeof(drain)) {
+    }
+
+    while (true) {
+        SimWork work;
+        {
+            std::lock_guard<std::recursive_mutex> lock(server->lock);
+            if (server->work.empty()) {
+                break;
+            }
+            work = server->work.front();
+            server->work.pop_front();
+        }
+        work.fn(work.arg);
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(server->lock);
+    std::vector<SimSession *>             closing;
+    for (auto &entry : server->sessions) {
+        if (entry.second->closeRequested) {
+            closing.push_back(entry.second);
+        }
+    }
+    for (auto *session : closing) {
+        close_session(server, session);
+    }
+}
+
+static void server_task(void *arg) {
+    auto *server = static_cast<SimServer *>(arg);
+
+    while (!server->stop) {
+        fd_set readFds;
+        FD_ZERO(&readFds);
+        FD_SET(server->listenFd, &readFds);
+        FD_SET(server->ctrl[0], &readFds);
+        int maxFd = std::max(server->listenFd, server->ctrl[0]);
+        std::vector<int> fds;
+        {
+            std::lock_guard<std::recursive_mutex> lock(server->lock);
+            for (auto &entry : server->sessions) {
+                fds.push_back(entry.first);
+                FD_SET(entry.first, &readFds);
+                maxFd = std::max(maxFd, entry.first);
+            }
+        }
+
+        int ready = select(maxFd + 1, &readFds, nullptr, nullptr, nullptr);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                ESP_LOGE(TAG, "select failed: %d", errno);
+                vTaskDelay(pdMS_TO_TICKS(100));
+            }
+            continue;
+        }
+        if (server->stop) {
+            break;
+        }
+        if (FD_ISSET(server->ctrl[0], &readFds)) {
+            run_work(server);
+        }
+        for (int fd : fds) {
+            if (!FD_ISSET(fd, &readFds)) {
+                continue;
+            }
+            SimSession *session;
+            {
+                std::lock_guard<std::recursive_mutex> lock(server->lock);
+                session = find_session(server, fd);
+            }
+            if (!session) {
+                continue;
+            }
+            // sessions are only removed by this task: no need to lock while processing
+            session->lastUsed = esp_timer_get_time();
+            bool keep = session->websocket ? process_ws_frame(server, session) : process_http_request(server, session);
+            if (!keep) {
+                std::lock_guard<std::recursive_mutex> lock(server->lock);
+                close_session(server, session);
+            }
+        }
+        if (FD_ISSET(server->listenFd, &readFds)) {
+            accept_connection(server);
+        }
+    }
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(server->lock);
+        while (!server->sessions.empty()) {
+            close_session(server, server->sessions.begin()->second);
+        }
+    }
+    xSemaphoreGive(server->stopped);
+    vTaskDelete(NULL);
+}
+
+static void wake_server(SimServer *server) {
+    char c = 0;
+    if (write(server->ctrl[1], &c, 1) < 0) {
+        ESP_LOGW(TAG, "Failed to wake server task: %d", errno);
+    }
+}
+
+// ---- Public API ----
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config) {
+    if (handle == nullptr || config == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int fd = socket(AF_INET6, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return ESP_ERR_HTTPD_TASK;
+    }
+    int enable = 1;
+    int disable = 0;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    // dual stack like lwip with IPv6 enabled
+    setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &disable, sizeof(disable));
+
+    struct sockaddr_in6 addr = {};
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(config->server_port);
+    if (bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        listen(fd, config->backlog_conn) < 0) {
+        ESP_LOGE(TAG, "Failed to listen on port %u: %s", config->server_port, strerror(errno));
+        close(fd);
+        return ESP_ERR_HTTPD_TASK;
+    }
+
+    auto *server = new SimServer();
+    server->config = *config;
+    server->listenFd = fd;
+    if (pipe(server->ctrl) < 0) {
+        close(fd);
+        delete server;
+        return ESP_ERR_HTTPD_TASK;
+    }
+    fcntl(server->ctrl[0], F_SETFL, O_NONBLOCK);
+    server->stopped = xSemaphoreCreateBinary();
+
+    if (xTaskCreatePinnedToCore(server_task, "httpd", config->stack_size, server, config->task_priority, nullptr,
+                                config->core_id) != pdPASS) {
+        close(fd);
+        close(server->ctrl[0]);
+        close(server->ctrl[1]);
+        vSemaphoreDelete(server->stopped);
+        delete server;
+        return ESP_ERR_HTTPD_TASK;
+    }
+
+    *handle = server;
+    esp_event_post(ESP_HTTP_SERVER_EVENT, HTTP_SERVER_EVENT_START, nullptr, 0, portMAX_DELAY);
+    return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle) {
+    auto *server = static_cast<SimServer *>(handle);
+    if (server == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    server->stop = true;
+    wake_server(server);
+    xSemaphoreTake(server->stopped, portMAX_DELAY);
+
+    close(server->listenFd);
+    close(server->ctrl[0]);
+    close(server->ctrl[1]);
+    vSemaphoreDelete(server->stopped);
+    if (server->config.global_user_ctx) {
+        if (server->config.global_user_ctx_free_fn) {
+            server->config.global_user_ctx_free_fn(server->config.global_user_ctx);
+        } else {
+            free(server->config.global_user_ctx);
+        }
+    }
+    delete server;
+    esp_event_post(ESP_HTTP_SERVER_EVENT, HTTP_SERVER_EVENT_STOP, nullptr, 0, portMAX_DELAY);
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler) {
+    auto *server = static_cast<SimServer *>(handle);
+    if (server == nullptr || uri_handler == nullptr || uri_handler->uri == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::recursive_mutex> lock(server->lock);
+    if (server->handlers.size() >= server->config.max_uri_handlers) {
+        ESP_LOGW(TAG, "No slots left for registering handler: %s", uri_handler->uri);
+        return ESP_ERR_HTTPD_HANDLERS_FULL;
+    }
+    for (const auto &h : server->handlers) {
+        if (h.method == uri_handler->method && strcmp(h.uri, uri_handler->uri) == 0) {
+            return ESP_ERR_HTTPD_HANDLER_EXISTS;
+        }
+    }
+    // the URI string is copied, the handlers refer to the stable copies
+    server->handlerUris.reserve(server->config.max_uri_handlers);
+    server->handlerUris.emplace_back(uri_handler->uri);
+    server->handlers.push_back(*uri_handler);
+    server->handlers.back().uri = server->handlerUris.back().c_str();
+    return ESP_OK;
+}
+
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *arg) {
+    auto *server = static_cast<SimServer *>(handle);
+    if (server == nullptr || work == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    {
+        std::lock_guard<std::recursive_mutex> lock(server->lock);
+        server->work.push_back({work, arg});
+    }
+    wake_server(server);
+    return ESP_OK;
+}
+
+esp_err_t httpd_get_client_list(httpd_handle_t handle, size_t *fds, int *client_fds) {
+    auto *server = static_cast<SimServer *>(handle);
+    if (server == nullptr || fds == nullptr || client_fds == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::recursive_mutex> lock(server->lock);
+    size_t                                count = 0;
+    for (auto &entry : server->sessions) {
+        if (count >= *fds) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        client_fds[count++] = entry.first;
+    }
+    *fds = count;
+    return ESP_OK;
+}
+
+void *httpd_sess_get_ctx(httpd_handle_t handle, int sockfd) {
+    auto *server = static_cast<SimServer *>(handle);
+    if (server == nullptr) {
+        return nullptr;
+    }
+    std::lock_guard<std::recursive_mutex> lock(server->lock);
+    if (server->current && server->currentFd == sockfd) {
+        return server->current->sess_ctx;
+    }
+    SimSession *session = find_session(server, sockfd);
+    return session ? session->ctx : nullptr;
+}
+
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd) {
+    auto *server = static_cast<SimServer *>(handle);
+    if (server == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    {
+        std::lock_guard<std::recursive_mutex> lock(server->lock);
+        SimSession                           *session = find_session(server, sockfd);
+        if (!session) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        session->closeRequested = true;
+    }
+    wake_server(server);
+    return ESP_OK;
+}
+
+int httpd_req_to_sockfd(httpd_req_t *r) {
+    SimRequest *req = sim_req(r);
+    return req ? req->session->fd : -1;
+}
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len) {
+    SimRequest *req = sim_req(r);
+    if (req == nullptr || buf == nullptr) {
+        return HTTPD_SOCK_ERR_INVALID;
+    }
+    size_t len = std::min(buf_len, req->remaining);
+    if (len == 0) {
+        return 0;
+    }
+    SimSession *session = req->session;
+    if (!session->rx.empty()) {
+        len = std::min(len, session->rx.size());
+        memcpy(buf, session->rx.data(), len);
+        session->rx.erase(0, len);
+        req->remaining -= len;
+        return static_cast<int>(len);
+    }
+    ssize_t ret = recv(session->fd, buf, len, 0);
+    if (ret < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
+    if (ret == 0) {
+        return HTTPD_SOCK_ERR_FAIL;
+    }
+    req->remaining -= ret;
+    return static_cast<int>(ret);
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field) {
+    SimRequest *req = sim_req(r);
+    const char *value = req && field ? find_header(req, field) : nullptr;
+    return value ? strlen(value) : 0;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size) {
+    SimRequest *req = sim_req(r);
+    if (req == nullptr || field == nullptr || val == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const char *value = find_header(req, field);
+    if (!value) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    strlcpy(val, value, val_size);
+    return strlen(value) < val_size ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+static bool send_resp_headers(SimRequest *req, ssize_t content_len) {
+    std::string head = "HTTP/1.1 " + req->status + "\r\nContent-Type: " + req->type + "\r\n";
+    if (content_len >= 0) {
+        head += "Content-Length: " + std::to_string(content_len) + "\r\n";
+    } else {
+        head += "Transfer-Encoding: chunked\r\n";
+    }
+    for (const auto &h : req->respHeaders) {
+        head += h.first + ": " + h.second + "\r\n";
+    }
+    head += "\r\n";
+    req->headersSent = true;
+    return send_all(req->session, head.data(), head.size());
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+    SimRequest *req = sim_req(r);
+    if (req == nullptr) {
+        return ESP_ERR_HTTPD_INVALID_REQ;
+    }
+    if (buf == nullptr) {
+        buf_len = 0;
+    } else if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = static_cast<ssize_t>(strlen(buf));
+    }
+    if (!send_resp_headers(req, buf_len) || (buf_len > 0 && !send_all(req->session, buf, buf_len))) {
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+    SimRequest *req = sim_req(r);
+    if (req == nullptr) {
+        return ESP_ERR_HTTPD_INVALID_REQ;
+    }
+    if (buf == nullptr) {
+        buf_len = 0;
+    } else if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = static_cast<ssize_t>(strlen(buf));
+    }
+    if (!req->headersSent) {
+        req->chunked = true;
+        if (!send_resp_headers(req, -1)) {
+            return ESP_ERR_HTTPD_RESP_SEND;
+        }
+    }
+    char size[16];
+    snprintf(size, sizeof(size), "%zx\r\n", static_cast<size_t>(buf_len));
+    if (!send_all(req->session, size, strlen(size)) || (buf_len > 0 && !send_all(req->session, buf, buf_len)) ||
+        !send_all(req->session, "\r\n", 2)) {
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status) {
+    SimRequest *req = sim_req(r);
+    if (req == nullptr || status == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    req->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type) {
+    SimRequest *req = sim_req(r);
+    if (req == nullptr || type == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    req->type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value) {
+    SimRequest *req = sim_req(r);
+    if (req == nullptr || field == nullptr || value == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (req->respHeaders.size() >= req->server->config.max_resp_headers) {
+        return ESP_ERR_HTTPD_RESP_HDR;
+    }
+    req->respHeaders.emplace_back(field, value);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg) {
+    static const char *const status[] = {
+        "500 Internal Server Error", "501 Method Not Implemented", "505 Version Not Supported",
+        "400 Bad Request",           "401 Unauthorized",           "403 Forbidden",
+        "404 Not Found",             "405 Method Not Allowed",     "408 Request Timeout",
+        "411 Length Required",       "414 URI Too Long",           "431 Request Header Fields Too Large",
+    };
+    const char *line = error < HTTPD_ERR_CODE_MAX ? status[error] : status[0];
+    httpd_resp_set_status(req, line);
+    httpd_resp_set_type(req, HTTPD_TYPE_TEXT);
+    esp_err_t ret = httpd_resp_sendstr(req, msg ? msg : line + 4);
+    esp_event_post(ESP_HTTP_SERVER_EVENT, HTTP_SERVER_EVENT_ERROR, &error, sizeof(error), portMAX_DELAY);
+    return ret;
+}
+
+bool httpd_uri_match_wildcard(const char *uri_template, const char *uri_to_match, size_t match_upto) {
+    size_t exact = strlen(uri_template);
+    bool   asterisk = false;
+    bool   quest = false;
+    // trailing "*", "?", "?*" or "*?"
+    for (int i = 0; i < 2 && exact > 0; i++) {
+        if (!asterisk && uri_template[exact - 1] == '*') {
+            asterisk = true;
+            exact--;
+        } else if (!quest && uri_template[exact - 1] == '?') {
+            quest = true;
+            exact--;
+        }
+    }
+
+    auto matches = [&](size_t len) {
+        if (match_upto < len || strncmp(uri_template, uri_to_match, len) != 0) {
+            return false;
+        }
+        return asterisk || match_upto == len;
+    };
+    if (!quest) {
+        return matches(exact);
+    }
+    // the character before '?' is optional
+    if (exact == 0) {
+        return false;
+    }
+    return matches(exact) || matches(exact - 1);
+}
+
+esp_err_t httpd_ws_recv_frame(httpd_req_t *r, httpd_ws_frame_t *pkt, size_t max_len) {
+    SimRequest *req = sim_req(r);
+    if (req == nullptr || pkt == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pkt->type = req->wsType;
+    pkt->final = req->wsFinal;
+    pkt->fragmented = !req->wsFinal || req->wsType == HTTPD_WS_TYPE_CONTINUE;
+    pkt->len = req->wsLen;
+    if (max_len == 0) {
+        return ESP_OK;
+    }
+    if (req->wsPayloadRead) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (pkt->payload == nullptr || max_len < req->wsLen) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (req->wsLen && recv_exact(req->session, pkt->payload, req->wsLen) != static_cast<int>(req->wsLen)) {
+        return ESP_FAIL;
+    }
+    req->wsPayloadRead = true;
+    if (req->wsMasked) {
+        for (size_t i = 0; i < req->wsLen; i++) {
+            pkt->payload[i] ^= req->wsMask[i % 4];
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t ws_send(SimSession *session, httpd_ws_frame_t *frame) {
+    uint8_t header[10];
+    size_t  headerLen = 2;
+    uint8_t opcode = frame->type & WS_OPCODE_MASK;
+    header[0] = (!frame->fragmented || frame->final) ? (WS_FIN_BIT | opcode) : opcode;
+    if (frame->len < 126) {
+        header[1] = static_cast<uint8_t>(frame->len);
+    } else if (frame->len <= 0xFFFF) {
+        header[1] = 126;
+        header[2] = frame->len >> 8;
+        header[3] = frame->len;
+        headerLen = 4;
+    } else {
+        header[1] = 127;
+        for (int i = 0; i < 8; i++) {
+            header[2 + i] = static_cast<uint64_t>(frame->len) >> ((7 - i) * 8);
+        }
+        headerLen = 10;
+    }
+
+    // header and payload in one piece: frames of different tasks must not be interleaved
+    std::vector<uint8_t> data(header, header + headerLen);
+    if (frame->len) {
+        data.insert(data.end(), frame->payload, frame->payload + frame->len);
+    }
+    return send_all(session, data.data(), data.size()) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t httpd_ws_send_frame(httpd_req_t *r, httpd_ws_frame_t *pkt) {
+    SimRequest *req = sim_req(r);
+    if (req == nullptr || pkt == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ws_send(req->session, pkt);
+}
+
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame) {
+    auto *server = static_cast<SimServer *>(hd);
+    if (server == nullptr || frame == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::recursive_mutex> lock(server->lock);
+    SimSession                           *session = find_session(server, fd);
+    if (!session || !session->websocket) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ws_send(session, frame);
+}
+
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd) {
+    auto *server = static_cast<SimServer *>(hd);
+    if (server == nullptr) {
+        return HTTPD_WS_CLIENT_INVALID;
+    }
+    std::lock_guard<std::recursive_mutex> lock(server->lock);
+    SimSession                           *session = find_session(server, fd);
+    if (!session) {
+        return HTTPD_WS_CLIENT_INVALID;
+    }
+    return session->websocket ? HTTPD_WS_CLIENT_WEBSOCKET : HTTPD_WS_CLIENT_HTTP;
+}
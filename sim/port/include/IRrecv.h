@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: IRrecv of the IRremoteESP8266 fork. There is no IR receiver, nothing is ever decoded.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "IRremoteESP8266.h"
+
+typedef struct {
+    uint8_t   recvstate;
+    uint16_t  recvpin;
+    uint16_t *rawbuf;
+    uint16_t  bufsize;
+    uint16_t  rawlen;
+    uint8_t   timer;
+    bool      overflow;
+    uint8_t   timeout;
+} irparams_t;
+
+class decode_results {
+ public:
+    decode_type_t      decode_type = decode_type_t::UNKNOWN;
+    uint64_t           value = 0;
+    uint32_t           address = 0;
+    uint32_t           command = 0;
+    uint16_t           bits = 0;
+    volatile uint16_t *rawbuf = nullptr;
+    uint16_t           rawlen = 0;
+    bool               overflow = false;
+    bool               repeat = false;
+};
+
+class IRrecv {
+ public:
+    IRrecv(const uint16_t recvpin, const uint16_t bufsize, const uint8_t timeout, const bool save_buffer = false);
+
+    void setUnknownThreshold(const uint16_t length);
+
+    void enableIRIn(const bool pullup = false);
+
+    void disableIRIn();
+
+    void resume();
+
+    /// @return always false: no IR signal is received in the simulation.
+    bool decode(decode_results *results, irparams_t *save = nullptr, uint8_t max_skip = 0, uint16_t noise_floor = 0);
+};
@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: IRsend of the IRremoteESP8266 fork without an IR output.
+//
+// Sending takes the same time as on the target: the durations of the marks and spaces are accumulated and the
+// calling task sleeps in real time. IR protocols are not encoded, their duration is estimated from the number of
+// bits.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+
+#include "IRremoteESP8266.h"
+
+class IRsend {
+ public:
+    /// @param modulation Carrier modulation of marks, without effect in the simulation.
+    /// @param w1ts Initial GPIO set mask.
+    /// @param w1tc Initial GPIO clear mask.
+    explicit IRsend(bool modulation, uint64_t w1ts, uint64_t w1tc);
+
+    void begin();
+
+    /// @brief Calibrate the carrier period offset. There is no timing overhead in the simulation.
+    /// @return always 0.
+    int8_t calibrate(uint16_t hz = 38000U);
+
+    /// @brief Set the active outputs. Must not be called while sending.
+    bool setPinMask(uint64_t w1ts, uint64_t w1tc);
+
+    /// @brief Set a callback which is called after each sent IR frame. Sending continues while it returns true.
+    void setRepeatCallback(std::function<bool()> callback);
+
+    void enableIROut(uint32_t freq, uint8_t duty = 50);
+
+    uint16_t mark(uint16_t usec);
+
+    void space(uint32_t usec);
+
+    bool send(const decode_type_t type, const uint64_t data, const uint16_t nbits, const uint16_t repeat = 0);
+
+    bool sendPronto(uint16_t data[], uint16_t len, uint16_t repeat = 0);
+
+    void sendGC(uint16_t buf[], uint16_t len);
+
+ protected:
+    /// Carrier period offset of the last calibration, without effect in the simulation.
+    int8_t periodOffset = 0;
+
+ private:
+    /// @brief Sleep until the accumulated marks and spaces are sent.
+    void flush();
+
+    /// @brief Send a frame repeatedly: as long as the repeat callback requests it, otherwise `repeat` times.
+    void repeatFrame(uint64_t frameUs, uint16_t repeat);
+
+    bool                  m_modulation;
+    uint64_t              m_w1ts;
+    uint64_t              m_w1tc;
+    uint32_t              m_frequency;
+    uint64_t              m_pendingUs;
+    std::function<bool()> m_repeatCallback;
+};
+
+/// @brief Total number of simulated IR frames since startup.
+uint32_t sim_ir_sent_frames();
@@ -0,0 +1,18 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+#include "IRrecv.h"
+
+uint16_t getCorrectedRawLength(const decode_results *const results);
+
+/// @return raw timings in µs, must be freed with delete[].
+uint16_t *resultToRawArray(const decode_results *const decode);
+
+std::string resultToHexidecimal(const decode_results *const result);
@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: GPIO driver. Output levels are stored per pin, inputs read the last written or injected level.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_bit_defs.h"
+#include "esp_err.h"
+#include "soc/gpio_num.h"
+#include "soc/gpio_struct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPIO_IS_VALID_GPIO(gpio_num) ((gpio_num) >= 0 && (gpio_num) < GPIO_NUM_MAX)
+#define GPIO_IS_VALID_OUTPUT_GPIO(gpio_num) GPIO_IS_VALID_GPIO(gpio_num)
+
+typedef enum {
+    GPIO_MODE_DISABLE = 0,
+    GPIO_MODE_INPUT = BIT0,
+    GPIO_MODE_OUTPUT = BIT1,
+    GPIO_MODE_OUTPUT_OD = (BIT1 | BIT2),
+    GPIO_MODE_INPUT_OUTPUT_OD = (BIT0 | BIT1 | BIT2),
+    GPIO_MODE_INPUT_OUTPUT = (BIT0 | BIT1),
+} gpio_mode_t;
+
+typedef enum {
+    GPIO_PULLUP_DISABLE = 0x0,
+    GPIO_PULLUP_ENABLE = 0x1,
+} gpio_pullup_t;
+
+typedef enum {
+    GPIO_PULLDOWN_DISABLE = 0x0,
+    GPIO_PULLDOWN_ENABLE = 0x1,
+} gpio_pulldown_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE = 1,
+    GPIO_INTR_NEGEDGE = 2,
+    GPIO_INTR_ANYEDGE = 3,
+    GPIO_INTR_LOW_LEVEL = 4,
+    GPIO_INTR_HIGH_LEVEL = 5,
+    GPIO_INTR_MAX,
+} gpio_int_type_t;
+
+typedef struct {
+    uint64_t        pin_bit_mask;
+    gpio_mode_t     mode;
+    gpio_pullup_t   pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+esp_err_t gpio_config(const gpio_config_t *pGPIOConfig);
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num);
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode);
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+
+int gpio_get_level(gpio_num_t gpio_num);
+
+/// @brief Simulate an external input level, e.g. a connected peripheral pulling a pin low.
+void sim_gpio_inject_level(gpio_num_t gpio_num, uint32_t level);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: UART driver. The type definitions are shared with the unit test mocks, the driver functions track
+// the installed state of a port and optionally loop written data back to the RX buffer.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/uart_types.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "soc/gpio_num.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UART_PIN_NO_CHANGE (-1)
+#define UART_BITRATE_MAX SOC_UART_BITRATE_MAX
+
+typedef struct {
+    int                   baud_rate;
+    uart_word_length_t    data_bits;
+    uart_parity_t         parity;
+    uart_stop_bits_t      stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+    uint8_t               rx_flow_ctrl_thresh;
+    union {
+        uart_sclk_t source_clk;
+    };
+    struct {
+        uint32_t allow_pd : 1;
+        uint32_t backup_before_sleep : 1;
+    } flags;
+} uart_config_t;
+
+typedef enum {
+    UART_DATA,
+    UART_BREAK,
+    UART_BUFFER_FULL,
+    UART_FIFO_OVF,
+    UART_FRAME_ERR,
+    UART_PARITY_ERR,
+    UART_DATA_BREAK,
+    UART_PATTERN_DET,
+    UART_EVENT_MAX,
+} uart_event_type_t;
+
+typedef struct {
+    uart_event_type_t type;
+    size_t            size;
+    bool              timeout_flag;
+} uart_event_t;
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size,
+                              QueueHandle_t *uart_queue, int intr_alloc_flags);
+
+esp_err_t uart_driver_delete(uart_port_t uart_num);
+
+bool uart_is_driver_installed(uart_port_t uart_num);
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config);
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num);
+
+esp_err_t uart_set_line_inverse(uart_port_t uart_num, uint32_t inverse_mask);
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size);
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait);
+
+esp_err_t uart_flush_input(uart_port_t uart_num);
+
+esp_err_t uart_get_tx_buffer_free_size(uart_port_t uart_num, size_t *size);
+
+esp_err_t uart_set_sw_flow_ctrl(uart_port_t uart_num, bool enable, uint8_t rx_thresh_xon, uint8_t rx_thresh_xoff);
+
+/// @brief Loop written UART data back to the RX buffer of the same UART, like a TX-RX jumper on the serial port.
+/// @param enable true to enable the loopback for all UARTs.
+void sim_uart_set_loopback(bool enable);
+
+#ifdef __cplusplus
+}
+#endif
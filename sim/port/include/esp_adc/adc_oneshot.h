@@ -0,0 +1,21 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: ADC handle types only. ADC readings are provided by the simulation's AdcReader implementation.
+
+#pragma once
+
+#include "esp_err.h"
+#include "hal/adc_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct adc_oneshot_unit_ctx_t *adc_oneshot_unit_handle_t;
+typedef struct adc_cali_scheme_t      *adc_cali_handle_t;
+
+#ifdef __cplusplus
+}
+#endif
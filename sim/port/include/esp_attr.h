@@ -0,0 +1,11 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+// memory placement attributes have no meaning on the host
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
+#define RTC_NOINIT_ATTR
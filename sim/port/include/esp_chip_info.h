@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    CHIP_ESP32 = 1,
+    CHIP_ESP32S2 = 2,
+    CHIP_ESP32S3 = 9,
+    CHIP_POSIX_LINUX = 999,
+} esp_chip_model_t;
+
+#define CHIP_FEATURE_EMB_FLASH (1UL << 0)
+#define CHIP_FEATURE_WIFI_BGN (1UL << 1)
+#define CHIP_FEATURE_BLE (1UL << 4)
+#define CHIP_FEATURE_BT (1UL << 5)
+#define CHIP_FEATURE_EMB_PSRAM (1UL << 7)
+
+typedef struct {
+    esp_chip_model_t model;
+    uint32_t         features;
+    uint16_t         revision;
+    uint8_t          cores;
+} esp_chip_info_t;
+
+/// @brief Report the simulated target: an ESP32-S3 with two cores.
+void esp_chip_info(esp_chip_info_t *out_info);
+
+#ifdef __cplusplus
+}
+#endif
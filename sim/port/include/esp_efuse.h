@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: eFuse fields are read from a simulated user data block.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    EFUSE_BLK0 = 0,
+    EFUSE_BLK1 = 1,
+    EFUSE_BLK2 = 2,
+    EFUSE_BLK3 = 3,
+    EFUSE_BLK_USER_DATA = 3,
+    EFUSE_BLK_MAX,
+} esp_efuse_block_t;
+
+typedef struct {
+    esp_efuse_block_t efuse_block : 8;
+    uint8_t           bit_start;
+    uint16_t          bit_count;
+} esp_efuse_desc_t;
+
+esp_err_t esp_efuse_read_field_blob(const esp_efuse_desc_t *field[], void *dst, size_t dst_size_bits);
+
+/// @brief Program the simulated user data block. Must be called before the first eFuse read.
+/// @param serial Dock serial number, max 8 characters.
+/// @param model Model number, max 7 characters.
+/// @param revision Hardware revision, max 3 characters.
+void sim_efuse_set_user_data(const char *serial, const char *model, const char *revision);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: a single default network interface with the address of the host.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+#include "esp_event_base.h"
+#include "esp_netif_ip_addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef struct {
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+ESP_EVENT_DECLARE_BASE(IP_EVENT);
+
+typedef enum {
+    IP_EVENT_STA_GOT_IP,
+    IP_EVENT_STA_LOST_IP,
+    IP_EVENT_AP_STAIPASSIGNED,
+    IP_EVENT_GOT_IP6,
+    IP_EVENT_ETH_GOT_IP,
+    IP_EVENT_ETH_LOST_IP,
+} ip_event_t;
+
+typedef struct {
+    esp_netif_t        *esp_netif;
+    esp_netif_ip_info_t ip_info;
+    bool                ip_changed;
+} ip_event_got_ip_t;
+
+esp_netif_t *esp_netif_get_default_netif(void);
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info);
+
+/// @return always ESP_FAIL: the simulated interface doesn't have a global IPv6 address.
+esp_err_t esp_netif_get_ip6_global(esp_netif_t *esp_netif, esp_ip6_addr_t *if_ip6);
+
+/// @return always 0: the simulated interface isn't bound to a host network interface.
+int esp_netif_get_netif_impl_index(esp_netif_t *esp_netif);
+
+/// @brief Set the IPv4 address of the simulated default interface.
+/// @param ip IPv4 address in network byte order.
+void sim_netif_set_ip(uint32_t ip);
+
+#ifdef __cplusplus
+}
+#endif
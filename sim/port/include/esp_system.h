@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: system control. A restart terminates the simulation.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+    ESP_RST_USB,
+    ESP_RST_JTAG,
+    ESP_RST_EFUSE,
+    ESP_RST_PWR_GLITCH,
+    ESP_RST_CPU_LOCKUP,
+} esp_reset_reason_t;
+
+/// @brief Exit the simulation process.
+void esp_restart(void) __attribute__((noreturn));
+
+/// @brief The simulation always starts with a power-on reset.
+esp_reset_reason_t esp_reset_reason(void);
+
+uint32_t esp_get_free_heap_size(void);
+
+uint32_t esp_get_minimum_free_heap_size(void);
+
+#ifdef __cplusplus
+}
+#endif
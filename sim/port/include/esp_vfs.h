@@ -0,0 +1,9 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+// Simulation port: the web root is a host directory instead of a VFS mount point. The IDF limit of 15 characters is
+// raised to allow absolute host paths.
+#define ESP_VFS_PATH_MAX 255
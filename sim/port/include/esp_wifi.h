@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: the simulated dock is never connected over WiFi.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_event_base.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+ESP_EVENT_DECLARE_BASE(WIFI_EVENT);
+
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t ssid[33];
+    uint8_t primary;
+    int8_t  rssi;
+} wifi_ap_record_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t reason;
+    int8_t  rssi;
+} wifi_event_sta_disconnected_t;
+
+/// @return ESP_ERR_WIFI_NOT_CONNECT
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info);
+
+#ifdef __cplusplus
+}
+#endif
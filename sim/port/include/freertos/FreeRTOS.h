@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: FreeRTOS kernel API on POSIX threads.
+//
+// Only the subset used by the firmware is implemented. Tasks are detached pthreads, priorities and core affinity are
+// recorded but not enforced. One tick is one millisecond.
+
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t  StackType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdPASS (pdTRUE)
+#define pdFAIL (pdFALSE)
+#define errQUEUE_EMPTY ((BaseType_t)0)
+#define errQUEUE_FULL ((BaseType_t)0)
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / 1000U))
+#define pdTICKS_TO_MS(xTicks) ((TickType_t)((uint64_t)(xTicks) * 1000U / configTICK_RATE_HZ))
+
+#define configMAX_PRIORITIES 25
+#define configMAX_TASK_NAME_LEN 16
+#define configMINIMAL_STACK_SIZE 768
+#define portNUM_PROCESSORS 2
+#define tskNO_AFFINITY ((BaseType_t)0x7FFFFFFF)
+#define tskIDLE_PRIORITY ((UBaseType_t)0U)
+
+/// Critical sections are mapped to a single process wide recursive mutex.
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void sim_enter_critical(void);
+void sim_exit_critical(void);
+
+#define portENTER_CRITICAL(mux) sim_enter_critical()
+#define portEXIT_CRITICAL(mux) sim_exit_critical()
+#define portENTER_CRITICAL_ISR(mux) sim_enter_critical()
+#define portEXIT_CRITICAL_ISR(mux) sim_exit_critical()
+#define taskENTER_CRITICAL(mux) sim_enter_critical()
+#define taskEXIT_CRITICAL(mux) sim_exit_critical()
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+/// @brief Core of the calling task: the core the task was pinned to, 0 otherwise.
+BaseType_t xPortGetCoreID(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+// like ESP-IDF: all kernel object APIs are available after including FreeRTOS.h
+#include "freertos/idf_additions.h"
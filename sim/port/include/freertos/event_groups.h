@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SimEventGroup *EventGroupHandle_t;
+typedef TickType_t            EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+
+void vEventGroupDelete(EventGroupHandle_t xEventGroup);
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToWaitFor,
+                                const BaseType_t xClearOnExit, const BaseType_t xWaitForAllBits,
+                                TickType_t xTicksToWait);
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet);
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToClear);
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t xEventGroup);
+
+#define xEventGroupSetBitsFromISR(xEventGroup, uxBitsToSet, pxHigherPriorityTaskWoken) \
+    (xEventGroupSetBits(xEventGroup, uxBitsToSet), pdPASS)
+
+#ifdef __cplusplus
+}
+#endif
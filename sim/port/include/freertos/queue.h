@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SimQueue *QueueHandle_t;
+
+/// @brief Create a queue. Semaphores are queues with an item size of 0.
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize);
+
+void vQueueDelete(QueueHandle_t xQueue);
+
+BaseType_t xQueueSendToBack(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait);
+
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait);
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait);
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait);
+
+BaseType_t xQueueReset(QueueHandle_t xQueue);
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue);
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue);
+
+#define xQueueSend(xQueue, pvItemToQueue, xTicksToWait) xQueueSendToBack(xQueue, pvItemToQueue, xTicksToWait)
+#define xQueueSendFromISR(xQueue, pvItemToQueue, pxHigherPriorityTaskWoken) \
+    xQueueSendToBack(xQueue, pvItemToQueue, 0)
+#define xQueueSendToBackFromISR(xQueue, pvItemToQueue, pxHigherPriorityTaskWoken) \
+    xQueueSendToBack(xQueue, pvItemToQueue, 0)
+#define xQueueReceiveFromISR(xQueue, pvBuffer, pxHigherPriorityTaskWoken) xQueueReceive(xQueue, pvBuffer, 0)
+
+#ifdef __cplusplus
+}
+#endif
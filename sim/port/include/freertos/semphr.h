@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+/// @brief Create a counting semaphore: a queue of uxMaxCount items with an item size of 0.
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+
+#define xSemaphoreCreateBinary() xSemaphoreCreateCounting(1, 0)
+// no priority inheritance: a mutex is a binary semaphore which is initially available
+#define xSemaphoreCreateMutex() xSemaphoreCreateCounting(1, 1)
+#define vSemaphoreDelete(xSemaphore) vQueueDelete(xSemaphore)
+#define xSemaphoreTake(xSemaphore, xBlockTime) xQueueReceive(xSemaphore, NULL, xBlockTime)
+#define xSemaphoreGive(xSemaphore) xQueueSendToBack(xSemaphore, NULL, 0)
+#define xSemaphoreTakeFromISR(xSemaphore, pxHigherPriorityTaskWoken) xQueueReceive(xSemaphore, NULL, 0)
+#define xSemaphoreGiveFromISR(xSemaphore, pxHigherPriorityTaskWoken) xQueueSendToBack(xSemaphore, NULL, 0)
+#define uxSemaphoreGetCount(xSemaphore) uxQueueMessagesWaiting(xSemaphore)
+
+#ifdef __cplusplus
+}
+#endif
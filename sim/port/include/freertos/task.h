@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SimTask *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum {
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid,
+} eTaskState;
+
+#define taskYIELD() sim_task_yield()
+
+void sim_task_yield(void);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth,
+                                   void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask,
+                                   BaseType_t xCoreID);
+
+static inline BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth,
+                                     void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask) {
+    return xTaskCreatePinnedToCore(pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask,
+                                   tskNO_AFFINITY);
+}
+
+/// @brief Delete a task. Only the calling task can be deleted: `vTaskDelete(NULL)` terminates the thread.
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+
+void vTaskDelay(TickType_t xTicksToDelay);
+
+TickType_t xTaskGetTickCount(void);
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+char *pcTaskGetName(TaskHandle_t xTaskToQuery);
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t xTask);
+
+void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority);
+
+UBaseType_t uxTaskGetNumberOfTasks(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: there is no embedded FrogFS image, web files are served from the host file system.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct frogfs_fs_t    frogfs_fs_t;
+typedef struct frogfs_entry_t frogfs_entry_t;
+typedef struct frogfs_fh_t    frogfs_fh_t;
+
+typedef enum {
+    FROGFS_ENTRY_TYPE_DIR,
+    FROGFS_ENTRY_TYPE_FILE,
+} frogfs_entry_type_t;
+
+typedef enum {
+    FROGFS_COMP_ALGO_NONE,
+    FROGFS_COMP_ALGO_ZLIB,
+    FROGFS_COMP_ALGO_HEATSHRINK,
+    FROGFS_COMP_ALGO_GZIP,
+} frogfs_comp_algo_t;
+
+#define FROGFS_OPEN_RAW (1 << 0)
+
+typedef struct frogfs_stat_t {
+    frogfs_entry_type_t type;
+    uint8_t             compression;
+    size_t              size;
+    size_t              size_compressed;
+} frogfs_stat_t;
+
+typedef struct frogfs_config_t {
+    const void *addr;
+    const char *part_label;
+} frogfs_config_t;
+
+frogfs_fs_t *frogfs_init(const frogfs_config_t *conf);
+
+const frogfs_entry_t *frogfs_get_entry(const frogfs_fs_t *fs, const char *path);
+
+int frogfs_is_file(const frogfs_entry_t *entry);
+
+void frogfs_stat(const frogfs_fs_t *fs, const frogfs_entry_t *entry, frogfs_stat_t *st);
+
+frogfs_fh_t *frogfs_open(const frogfs_fs_t *fs, const frogfs_entry_t *entry, unsigned int flags);
+
+size_t frogfs_access(frogfs_fh_t *fh, const void **buf);
+
+void frogfs_close(frogfs_fh_t *fh);
+
+#ifdef __cplusplus
+}
+#endif
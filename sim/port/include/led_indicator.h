@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: the espressif/led_indicator component is not available, LED patterns are only logged.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *led_indicator_handle_t;
+
+static inline esp_err_t led_indicator_start(led_indicator_handle_t handle, int blink_type) {
+    return ESP_OK;
+}
+
+static inline esp_err_t led_indicator_stop(led_indicator_handle_t handle, int blink_type) {
+    return ESP_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// IPv4 address in network byte order, layout compatible with esp_ip4_addr_t.
+typedef struct ip4_addr {
+    uint32_t addr;
+} ip4_addr_t;
+
+#define IP4ADDR_STRLEN_MAX 16
+#define IPADDR_NONE ((uint32_t)0xffffffffUL)
+#define IPADDR_ANY ((uint32_t)0x00000000UL)
+
+uint32_t ipaddr_addr(const char *cp);
+
+char *ip4addr_ntoa(const ip4_addr_t *addr);
+
+char *ip4addr_ntoa_r(const ip4_addr_t *addr, char *buf, int buflen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: lwIP socket API on the host BSD socket API.
+
+#pragma once
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "lwip/ip4_addr.h"
+
+// lwIP names of the in6_addr members
+#define un __in6_u
+#define u32_addr __u6_addr32
+
+#define lwip_getpeername getpeername
+#define lwip_getsockname getsockname
+#define closesocket close
+
+#define inet_ntoa_r(addr, buf, buflen) ip4addr_ntoa_r((const ip4_addr_t *)&(addr), buf, buflen)
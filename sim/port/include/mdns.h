@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: mDNS is not available. Service registration succeeds without advertising. `_uc-dock._tcp` queries
+// return the static peer docks added with `sim_mdns_add_peer`, other queries return no results.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_netif_ip_addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char *key;
+    const char *value;
+} mdns_txt_item_t;
+
+typedef struct mdns_ip_addr_s {
+    esp_ip_addr_t          addr;
+    struct mdns_ip_addr_s *next;
+} mdns_ip_addr_t;
+
+typedef struct mdns_result_s {
+    struct mdns_result_s *next;
+    void                 *esp_netif;
+    uint32_t              ttl;
+    int                   ip_protocol;
+    char                 *instance_name;
+    char                 *service_type;
+    char                 *proto;
+    char                 *hostname;
+    uint16_t              port;
+    mdns_txt_item_t      *txt;
+    uint8_t              *txt_value_len;
+    size_t                txt_count;
+    mdns_ip_addr_t       *addr;
+} mdns_result_t;
+
+esp_err_t mdns_init(void);
+
+esp_err_t mdns_hostname_set(const char *hostname);
+
+esp_err_t mdns_instance_name_set(const char *instance_name);
+
+esp_err_t mdns_service_add(const char *instance_name, const char *service_type, const char *proto, uint16_t port,
+                           mdns_txt_item_t txt[], size_t num_items);
+
+esp_err_t mdns_service_txt_item_set(const char *service_type, const char *proto, const char *key, const char *value);
+
+esp_err_t mdns_query_ptr(const char *service_type, const char *proto, uint32_t timeout, size_t max_results,
+                         mdns_result_t **results);
+
+void mdns_query_results_free(mdns_result_t *results);
+
+/// Add a static peer dock with IR fan-out to the `_uc-dock._tcp` query results.
+/// @param ip IPv4 address in network byte order.
+/// @param port IR fan-out TCP port of the peer.
+/// @param group dock group of the peer.
+/// @return ESP_ERR_NO_MEM if too many peers are added.
+esp_err_t sim_mdns_add_peer(uint32_t ip, uint16_t port, const char *group);
+
+#ifdef __cplusplus
+}
+#endif
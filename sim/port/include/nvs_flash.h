@@ -0,0 +1,24 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "esp_err.h"
+#include "nvs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t nvs_flash_init(void);
+
+esp_err_t nvs_flash_init_partition(const char *partition_label);
+
+esp_err_t nvs_flash_erase(void);
+
+esp_err_t nvs_flash_erase_partition(const char *part_name);
+
+#ifdef __cplusplus
+}
+#endif
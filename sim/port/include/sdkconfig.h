@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation configuration: Kconfig defaults of the firmware, see sdkconfig.defaults.
+// The web server port differs, privileged ports can't be used without root permissions.
+
+#pragma once
+
+#include <stdint.h>
+
+#define CONFIG_IDF_TARGET "linux"
+#define CONFIG_IDF_TARGET_LINUX 1
+#define CONFIG_FREERTOS_HZ 1000
+#define CONFIG_FREERTOS_NUMBER_OF_CORES 2
+#define CONFIG_LOG_MAXIMUM_LEVEL 5
+#define CONFIG_LOG_DEFAULT_LEVEL 3
+
+#define CONFIG_UCD_HW_REVISION_4 1
+
+// IDF defaults, the host network stack supports both
+#define CONFIG_LWIP_IPV4 1
+#define CONFIG_LWIP_IPV6 1
+
+#define CONFIG_UCD_WEB_SERVER_PORT 8080
+#define CONFIG_UCD_WEB_MOUNT_POINT "/ro/webroot"
+#define CONFIG_UCD_EMBEDDED_MOUNT_POINT "/ro"
+#define CONFIG_UCD_WEB_TASK_STACKSIZE 5120
+#define CONFIG_UCD_WEB_MAX_OPEN_SOCKETS 7
+#define CONFIG_UCD_WEB_MAX_WS_FRAME_SIZE 4096
+#define CONFIG_UCD_WEB_WS_SEND_POOL_SIZE 8
+#define CONFIG_UCD_WEB_WS_SEND_PAYLOAD_SIZE 256
+#define CONFIG_UCD_WEB_KEEP_ALIVE 1
+#define CONFIG_UCD_WEB_KEEP_ALIVE_MAX_SESSIONS 2
+#define CONFIG_UCD_WEB_KEEP_ALIVE_TIMEOUT 5
+#define CONFIG_UCD_WEB_ENABLE_CORS 1
+
+#define CONFIG_UCD_SYSINFO_EVENT_INTERVAL 5000
+#define CONFIG_UCD_TASK_STATS_INTERVAL 1000
+#define CONFIG_UCD_TASK_STATS_WINDOW 10
+
+#define CONFIG_UCD_IR_TRACE_ENTRIES 128
+#define CONFIG_UCD_IR_CODE_MAX_LENGTH 4096
+#define CONFIG_UCD_IR_RESPONSE_POOL_SIZE 4
+#define CONFIG_UCD_IR_REPEAT_HOLD_TIMEOUT 300
+// runtime option to run multiple simulated docks on one host, see `--peer-port`
+#define CONFIG_UCD_IR_FANOUT_PORT sim_ir_fanout_port
+#define CONFIG_UCD_IR_FANOUT_TIMEOUT 10000
+#define CONFIG_UCD_IR_FANOUT_DISCOVERY_INTERVAL 60
+#define CONFIG_UCD_GC_BEACON_INTERVAL_MIN 1
+#define CONFIG_UCD_GC_BEACON_INTERVAL_MAX 30
+#define CONFIG_UCD_UART_BUFFER_SIZE 512
+#define CONFIG_UCD_UART_BRIDGE_TCP_PORT 4999
+#define CONFIG_UCD_UART_BRIDGE_MAX_CLIENTS 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// IR fan-out TCP port of the simulated dock. Default: 4997
+extern uint16_t sim_ir_fanout_port;
+
+#ifdef __cplusplus
+}
+#endif
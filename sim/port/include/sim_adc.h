@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: ADC reader with a fixed voltage.
+
+#pragma once
+
+#include <atomic>
+
+#include "adc_reader.h"
+
+/// @brief ADC reader returning a configurable voltage in mV instead of a measured value.
+///
+/// The default of 0 mV matches the signature of an empty external port.
+class SimAdcReader : public AdcReader {
+ public:
+    explicit SimAdcReader(int voltage = 0) : voltage_(voltage) {}
+
+    esp_err_t read(int *voltage) override;
+
+    /// @brief Set the voltage returned by subsequent reads.
+    void setVoltage(int voltage) { voltage_ = voltage; }
+
+ private:
+    std::atomic<int> voltage_;
+};
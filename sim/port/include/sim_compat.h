@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: newlib functions which are not available in every host C library. Included in all translation
+// units with `-include`.
+
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SIM_HAVE_STRLCPY
+size_t strlcpy(char *dst, const char *src, size_t size);
+size_t strlcat(char *dst, const char *src, size_t size);
+#endif
+
+/// newlib extension: convert an unsigned value to a string in the given base.
+char *utoa(unsigned value, char *str, int base);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation port: GPIO output registers. Writes are accepted but don't change the simulated pin levels.
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef union {
+    struct {
+        uint32_t data : 22;
+        uint32_t reserved22 : 10;
+    };
+    uint32_t val;
+} gpio_out1_reg_t;
+
+typedef volatile struct gpio_dev_s {
+    uint32_t        out;
+    uint32_t        out_w1ts;
+    uint32_t        out_w1tc;
+    gpio_out1_reg_t out1;
+    gpio_out1_reg_t out1_w1ts;
+    gpio_out1_reg_t out1_w1tc;
+} gpio_dev_t;
+
+extern gpio_dev_t GPIO;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,208 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// IRremoteESP8266 send and receive classes without IR hardware, see IRsend.h.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "IRrecv.h"
+#include "IRsend.h"
+#include "IRutils.h"
+#include "esp_log.h"
+
+static const char *const TAG = "SIM_IR";
+
+/// Minimum accumulated duration to sleep for: shorter marks and spaces are collected to avoid oversleeping.
+static constexpr uint64_t kMinSleepUs = 5000;
+/// PRONTO carrier period unit in microseconds.
+static constexpr double kProntoFreqFactor = 0.241246;
+
+static std::atomic<uint32_t> s_sentFrames{0};
+
+uint32_t sim_ir_sent_frames() {
+    return s_sentFrames.load();
+}
+
+IRsend::IRsend(bool modulation, uint64_t w1ts, uint64_t w1tc)
+    : m_modulation(modulation), m_w1ts(w1ts), m_w1tc(w1tc), m_frequency(38000), m_pendingUs(0) {}
+
+void IRsend::begin() {}
+
+int8_t IRsend::calibrate(uint16_t hz) {
+    m_frequency = hz;
+    return 0;
+}
+
+bool IRsend::setPinMask(uint64_t w1ts, uint64_t w1tc) {
+    m_w1ts = w1ts;
+    m_w1tc = w1tc;
+    return true;
+}
+
+void IRsend::setRepeatCallback(std::function<bool()> callback) {
+    m_repeatCallback = callback;
+}
+
+void IRsend::enableIROut(uint32_t freq, uint8_t duty) {
+    (void)duty;
+    m_frequency = freq;
+}
+
+uint16_t IRsend::mark(uint16_t usec) {
+    m_pendingUs += usec;
+    return m_frequency ? static_cast<uint16_t>(static_cast<uint64_t>(usec) * m_frequency / 1000000) : 1;
+}
+
+void IRsend::space(uint32_t usec) {
+    m_pendingUs += usec;
+    if (m_pendingUs >= kMinSleepUs) {
+        flush();
+    }
+}
+
+void IRsend::flush() {
+    if (m_pendingUs) {
+        std::this_thread::sleep_for(std::chrono::microseconds(m_pendingUs));
+        m_pendingUs = 0;
+    }
+}
+
+void IRsend::repeatFrame(uint64_t frameUs, uint16_t repeat) {
+    uint32_t frames = 0;
+    while (true) {
+        m_pendingUs += frameUs;
+        flush();
+        frames++;
+        if (m_repeatCallback ? !m_repeatCallback() : frames > repeat) {
+            break;
+        }
+    }
+    s_sentFrames += frames;
+    ESP_LOGD(TAG, "Sent %u frame(s) of %llu us, outputs: 0x%llx", frames, frameUs, m_w1ts);
+}
+
+bool IRsend::send(const decode_type_t type, const uint64_t data, const uint16_t nbits, const uint16_t repeat) {
+    (void)data;
+    if (type == decode_type_t::UNKNOWN || nbits == 0) {
+        return false;
+    }
+    // pulse distance encoding like NEC: 9 ms header, average bit length of 1.125 ms, ~40 ms frame gap
+    repeatFrame(13500 + static_cast<uint64_t>(nbits) * 1125 + 40000, repeat);
+    return true;
+}
+
+bool IRsend::sendPronto(uint16_t data[], uint16_t len, uint16_t repeat) {
+    // learned code (0000), frequency, intro pairs, repeat pairs, durations
+    if (len < 6 || data[0] != 0 || data[1] == 0) {
+        return false;
+    }
+    uint16_t introPairs = data[2];
+    uint16_t repeatPairs = data[3];
+    if (4U + 2U * (introPairs + repeatPairs) > len) {
+        return false;
+    }
+    double   periodUs = data[1] * kProntoFreqFactor;
+    uint64_t introUs = 0;
+    uint64_t repeatUs = 0;
+    for (uint16_t i = 0; i < 2 * introPairs; i++) {
+        introUs += data[4 + i];
+    }
+    for (uint16_t i = 0; i < 2 * repeatPairs; i++) {
+        repeatUs += data[4 + 2 * introPairs + i];
+    }
+    introUs = static_cast<uint64_t>(introUs * periodUs);
+    repeatUs = static_cast<uint64_t>(repeatUs * periodUs);
+
+    if (introUs) {
+        m_pendingUs += introUs;
+        flush();
+        s_sentFrames++;
+        if (!repeatUs) {
+            return true;
+        }
+        if (m_repeatCallback ? !m_repeatCallback() : repeat == 0) {
+            return true;
+        }
+        repeat = repeat ? repeat - 1 : 0;
+    }
+    repeatFrame(repeatUs, repeat);
+    return true;
+}
+
+void IRsend::sendGC(uint16_t buf[], uint16_t len) {
+    // frequency, repeat count, repeat offset (1 based), durations in carrier periods
+    if (len < 4 || buf[0] == 0) {
+        return;
+    }
+    double   periodUs = 1000000.0 / buf[0];
+    uint16_t repeatOffset = buf[2] >= 1 && buf[2] < len - 2 ? buf[2] - 1 : 0;
+    uint64_t frameUs = 0;
+    uint64_t repeatUs = 0;
+    for (uint16_t i = 3; i < len; i++) {
+        frameUs += buf[i];
+        if (i - 3 >= repeatOffset) {
+            repeatUs += buf[i];
+        }
+    }
+
+    m_pendingUs += static_cast<uint64_t>(frameUs * periodUs);
+    flush();
+    s_sentFrames++;
+    uint16_t repeat = buf[1] > 1 ? buf[1] - 1 : 0;
+    if (m_repeatCallback ? !m_repeatCallback() : repeat == 0) {
+        return;
+    }
+    repeatFrame(static_cast<uint64_t>(repeatUs * periodUs), repeat ? repeat - 1 : 0);
+}
+
+// ---- IRrecv: no IR receiver ----
+
+IRrecv::IRrecv(const uint16_t recvpin, const uint16_t bufsize, const uint8_t timeout, const bool save_buffer) {
+    (void)recvpin;
+    (void)bufsize;
+    (void)timeout;
+    (void)save_buffer;
+}
+
+void IRrecv::setUnknownThreshold(const uint16_t length) {
+    (void)length;
+}
+
+void IRrecv::enableIRIn(const bool pullup) {
+    (void)pullup;
+    ESP_LOGW(TAG, "IR learning is not supported in the simulation: no IR codes will be received");
+}
+
+void IRrecv::disableIRIn() {}
+
+void IRrecv::resume() {}
+
+bool IRrecv::decode(decode_results *results, irparams_t *save, uint8_t max_skip, uint16_t noise_floor) {
+    (void)results;
+    (void)save;
+    (void)max_skip;
+    (void)noise_floor;
+    return false;
+}
+
+uint16_t getCorrectedRawLength(const decode_results *const results) {
+    return results->rawlen > 1 ? results->rawlen - 1 : 0;
+}
+
+uint16_t *resultToRawArray(const decode_results *const decode) {
+    uint16_t  length = getCorrectedRawLength(decode);
+    uint16_t *raw = new uint16_t[length ? length : 1];
+    for (uint16_t i = 0; i < length; i++) {
+        raw[i] = decode->rawbuf[i + 1] * 2;
+    }
+    return raw;
+}
+
+std::string resultToHexidecimal(const decode_results *const result) {
+    char buf[20];
+    snprintf(buf, sizeof(buf), "0x%llX", static_cast<unsigned long long>(result->value));
+    return buf;
+}
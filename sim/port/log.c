@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Logging in the ESP-IDF console format to stdout.
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define MAX_TAG_LEVELS 32
+
+typedef struct {
+    char            tag[32];
+    esp_log_level_t level;
+} tag_level_t;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static esp_log_level_t s_default_level = ESP_LOG_INFO;
+static tag_level_t     s_tag_levels[MAX_TAG_LEVELS];
+static int             s_tag_count = 0;
+
+void esp_log_level_set(const char *tag, esp_log_level_t level) {
+    pthread_mutex_lock(&s_lock);
+    if (strcmp(tag, "*") == 0) {
+        s_default_level = level;
+        s_tag_count = 0;
+    } else {
+        int i;
+        for (i = 0; i < s_tag_count; i++) {
+            if (strcmp(s_tag_levels[i].tag, tag) == 0) {
+                break;
+            }
+        }
+        if (i < MAX_TAG_LEVELS) {
+            strncpy(s_tag_levels[i].tag, tag, sizeof(s_tag_levels[i].tag) - 1);
+            s_tag_levels[i].level = level;
+            if (i == s_tag_count) {
+                s_tag_count++;
+            }
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+esp_log_level_t esp_log_level_get(const char *tag) {
+    esp_log_level_t level = s_default_level;
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < s_tag_count; i++) {
+        if (strcmp(s_tag_levels[i].tag, tag) == 0) {
+            level = s_tag_levels[i].level;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return level;
+}
+
+uint32_t esp_log_timestamp(void) {
+    // like ESP-IDF: milliseconds since startup
+    return pdTICKS_TO_MS(xTaskGetTickCount());
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) {
+    static const char letters[] = {'N', 'E', 'W', 'I', 'D', 'V'};
+
+    char    msg[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(msg, sizeof(msg), format, args);
+    va_end(args);
+
+    // one write per line: messages of concurrent tasks must not be interleaved
+    flockfile(stdout);
+    printf("%c (%u) %s: %s\n", letters[level], esp_log_timestamp(), tag, msg);
+    fflush(stdout);
+    funlockfile(stdout);
+}
@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Network interface, WiFi, mDNS and lwip address helpers on the host network stack.
+
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_eth.h"
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include "lwip/ip4_addr.h"
+#include "mdns.h"
+
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+ESP_EVENT_DEFINE_BASE(ETH_EVENT);
+
+struct esp_netif_obj {
+    esp_netif_ip_info_t ip_info;
+};
+
+static esp_netif_t s_default_netif = {
+    .ip_info = {.ip = {ESP_IP4TOADDR(127, 0, 0, 1)}, .netmask = {ESP_IP4TOADDR(255, 0, 0, 0)}, .gw = {0}},
+};
+
+esp_netif_t *esp_netif_get_default_netif(void) {
+    return &s_default_netif;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info) {
+    if (esp_netif == NULL || ip_info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *ip_info = esp_netif->ip_info;
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_get_ip6_global(esp_netif_t *esp_netif, esp_ip6_addr_t *if_ip6) {
+    (void)esp_netif;
+    (void)if_ip6;
+    return ESP_FAIL;
+}
+
+int esp_netif_get_netif_impl_index(esp_netif_t *esp_netif) {
+    (void)esp_netif;
+    return 0;
+}
+
+void sim_netif_set_ip(uint32_t ip) {
+    s_default_netif.ip_info.ip.addr = ip;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info) {
+    (void)ap_info;
+    return ESP_ERR_WIFI_NOT_CONNECT;
+}
+
+// ---- lwip ----
+
+uint32_t ipaddr_addr(const char *cp) {
+    struct in_addr addr;
+    if (cp == NULL || inet_aton(cp, &addr) == 0) {
+        return IPADDR_NONE;
+    }
+    return addr.s_addr;
+}
+
+char *ip4addr_ntoa_r(const ip4_addr_t *addr, char *buf, int buflen) {
+    struct in_addr in = {.s_addr = addr->addr};
+    if (inet_ntop(AF_INET, &in, buf, buflen) == NULL) {
+        return NULL;
+    }
+    return buf;
+}
+
+char *ip4addr_ntoa(const ip4_addr_t *addr) {
+    static __thread char buf[IP4ADDR_STRLEN_MAX];
+    return ip4addr_ntoa_r(addr, buf, sizeof(buf));
+}
+
+// ---- mDNS ----
+
+#define SIM_MDNS_MAX_PEERS 8
+
+typedef struct {
+    uint32_t ip;
+    char     port[6];
+    char     group[33];
+    char     hostname[INET_ADDRSTRLEN + 6];
+} sim_peer_t;
+
+static sim_peer_t s_peers[SIM_MDNS_MAX_PEERS];
+static size_t     s_peer_count = 0;
+
+uint16_t sim_ir_fanout_port = 4997;
+
+esp_err_t sim_mdns_add_peer(uint32_t ip, uint16_t port, const char *group) {
+    if (s_peer_count >= SIM_MDNS_MAX_PEERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    sim_peer_t    *peer = &s_peers[s_peer_count++];
+    struct in_addr in = {.s_addr = ip};
+    char           addr[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &in, addr, sizeof(addr));
+
+    peer->ip = ip;
+    snprintf(peer->port, sizeof(peer->port), "%u", port);
+    snprintf(peer->group, sizeof(peer->group), "%s", group);
+    // unique name of the peer, the host name of a simulated dock is derived from its process id
+    snprintf(peer->hostname, sizeof(peer->hostname), "%s:%u", addr, port);
+    return ESP_OK;
+}
+
+esp_err_t mdns_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t mdns_hostname_set(const char *hostname) {
+    (void)hostname;
+    return ESP_OK;
+}
+
+esp_err_t mdns_instance_name_set(const char *instance_name) {
+    (void)instance_name;
+    return ESP_OK;
+}
+
+esp_err_t mdns_service_add(const char *instance_name, const char *service_type, const char *proto, uint16_t port,
+                           mdns_txt_item_t txt[], size_t num_items) {
+    (void)instance_name;
+    (void)service_type;
+    (void)proto;
+    (void)port;
+    (void)txt;
+    (void)num_items;
+    return ESP_OK;
+}
+
+esp_err_t mdns_service_txt_item_set(const char *service_type, const char *proto, const char *key, const char *value) {
+    (void)service_type;
+    (void)proto;
+    (void)key;
+    (void)value;
+    return ESP_OK;
+}
+
+esp_err_t mdns_query_ptr(const char *service_type, const char *proto, uint32_t timeout, size_t max_results,
+                         mdns_result_t **results) {
+    (void)timeout;
+    if (results == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *results = NULL;
+    if (strcmp(service_type, "_uc-dock") != 0 || strcmp(proto, "_tcp") != 0) {
+        return ESP_OK;
+    }
+
+    // prepended: the results are in the order the peers were added
+    size_t count = s_peer_count < max_results ? s_peer_count : max_results;
+    for (size_t i = count; i > 0; i--) {
+        sim_peer_t      *peer = &s_peers[i - 1];
+        mdns_result_t   *r = calloc(1, sizeof(mdns_result_t));
+        mdns_txt_item_t *txt = calloc(2, sizeof(mdns_txt_item_t));
+        mdns_ip_addr_t  *a = calloc(1, sizeof(mdns_ip_addr_t));
+        if (r == NULL || txt == NULL || a == NULL) {
+            free(r);
+            free(txt);
+            free(a);
+            mdns_query_results_free(*results);
+            *results = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+        // the strings belong to the static peer list
+        txt[0].key = "group";
+        txt[0].value = peer->group;
+        txt[1].key = "peer_port";
+        txt[1].value = peer->port;
+        a->addr.type = ESP_IPADDR_TYPE_V4;
+        a->addr.u_addr.ip4.addr = peer->ip;
+        r->hostname = peer->hostname;
+        r->txt = txt;
+        r->txt_count = 2;
+        r->addr = a;
+        r->next = *results;
+        *results = r;
+    }
+    return ESP_OK;
+}
+
+void mdns_query_results_free(mdns_result_t *results) {
+    while (results) {
+        mdns_result_t *next = results->next;
+        free(results->txt);
+        free(results->addr);
+        free(results);
+        results = next;
+    }
+}
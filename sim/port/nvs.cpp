@@ -0,0 +1,240 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Non-volatile storage in memory: the simulated dock starts with factory defaults on every start.
+
+#include <string.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "nvs.h"
+#include "nvs_flash.h"
+
+enum class SimNvsType { U8, I8, U16, I16, U32, I32, U64, I64, STR, BLOB };
+
+struct SimNvsEntry {
+    SimNvsType           type;
+    std::vector<uint8_t> data;
+};
+
+struct SimNvsHandle {
+    std::string     ns;
+    nvs_open_mode_t mode;
+};
+
+/// Namespace, key: value.
+static std::map<std::pair<std::string, std::string>, SimNvsEntry> s_entries;
+static std::map<nvs_handle_t, SimNvsHandle>                         s_handles;
+static std::mutex                                                   s_lock;
+static nvs_handle_t                                                 s_nextHandle = 1;
+static bool                                                         s_initialized = false;
+
+esp_err_t nvs_flash_init(void) {
+    std::lock_guard<std::mutex> lock(s_lock);
+    s_initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_init_partition(const char *partition_label) {
+    (void)partition_label;
+    return nvs_flash_init();
+}
+
+esp_err_t nvs_flash_erase(void) {
+    std::lock_guard<std::mutex> lock(s_lock);
+    s_entries.clear();
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase_partition(const char *part_name) {
+    (void)part_name;
+    return nvs_flash_erase();
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    return nvs_open_from_partition(NVS_DEFAULT_PART_NAME, namespace_name, open_mode, out_handle);
+}
+
+esp_err_t nvs_open_from_partition(const char *part_name, const char *namespace_name, nvs_open_mode_t open_mode,
+                                  nvs_handle_t *out_handle) {
+    (void)part_name;
+    if (namespace_name == nullptr || out_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strlen(namespace_name) >= NVS_NS_NAME_MAX_SIZE) {
+        return ESP_ERR_NVS_INVALID_NAME;
+    }
+    std::lock_guard<std::mutex> lock(s_lock);
+    if (!s_initialized) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    if (open_mode == NVS_READONLY) {
+        bool exists = false;
+        for (const auto &entry : s_entries) {
+            if (entry.first.first == namespace_name) {
+                exists = true;
+                break;
+            }
+        }
+        if (!exists) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+    }
+    *out_handle = s_nextHandle++;
+    s_handles[*out_handle] = {namespace_name, open_mode};
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+    std::lock_guard<std::mutex> lock(s_lock);
+    s_handles.erase(handle);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    std::lock_guard<std::mutex> lock(s_lock);
+    return s_handles.count(handle) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    std::lock_guard<std::mutex> lock(s_lock);
+    auto                        it = s_handles.find(handle);
+    if (it == s_handles.end()) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (it->second.mode == NVS_READONLY) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    return s_entries.erase({it->second.ns, key}) ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle) {
+    std::lock_guard<std::mutex> lock(s_lock);
+    auto                        it = s_handles.find(handle);
+    if (it == s_handles.end()) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (it->second.mode == NVS_READONLY) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    std::erase_if(s_entries, [&](const auto &entry) { return entry.first.first == it->second.ns; });
+    return ESP_OK;
+}
+
+static esp_err_t set_entry(nvs_handle_t handle, const char *key, SimNvsType type, const void *value, size_t length) {
+    if (key == nullptr || value == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    std::lock_guard<std::mutex> lock(s_lock);
+    auto                        it = s_handles.find(handle);
+    if (it == s_handles.end()) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (it->second.mode == NVS_READONLY) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    auto *bytes = static_cast<const uint8_t *>(value);
+    s_entries[{it->second.ns, key}] = {type, std::vector<uint8_t>(bytes, bytes + length)};
+    return ESP_OK;
+}
+
+/// @brief Get a stored entry.
+/// @param length In: size of out_value, out: stored size. Fixed size types require an exact size match.
+static esp_err_t get_entry(nvs_handle_t handle, const char *key, SimNvsType type, void *out_value, size_t *length,
+                           bool variable) {
+    if (key == nullptr || length == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lock(s_lock);
+    auto                        handleIt = s_handles.find(handle);
+    if (handleIt == s_handles.end()) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    auto it = s_entries.find({handleIt->second.ns, key});
+    if (it == s_entries.end() || it->second.type != type) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    size_t size = it->second.data.size();
+    if (variable && out_value == nullptr) {
+        *length = size;
+        return ESP_OK;
+    }
+    if (*length < size) {
+        *length = size;
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, it->second.data.data(), size);
+    *length = size;
+    return ESP_OK;
+}
+
+#define NVS_SIM_INTEGER(name, ctype, tag)                                                    \
+    esp_err_t nvs_set_##name(nvs_handle_t handle, const char *key, ctype value) {            \
+        return set_entry(handle, key, SimNvsType::tag, &value, sizeof(value));               \
+    }                                                                                        \
+    esp_err_t nvs_get_##name(nvs_handle_t handle, const char *key, ctype *out_value) {       \
+        if (out_value == nullptr) {                                                          \
+            return ESP_ERR_INVALID_ARG;                                                      \
+        }                                                                                    \
+        size_t length = sizeof(*out_value);                                                  \
+        return get_entry(handle, key, SimNvsType::tag, out_value, &length, false);           \
+    }
+
+NVS_SIM_INTEGER(i8, int8_t, I8)
+NVS_SIM_INTEGER(u8, uint8_t, U8)
+NVS_SIM_INTEGER(i16, int16_t, I16)
+NVS_SIM_INTEGER(u16, uint16_t, U16)
+NVS_SIM_INTEGER(i32, int32_t, I32)
+NVS_SIM_INTEGER(u32, uint32_t, U32)
+NVS_SIM_INTEGER(i64, int64_t, I64)
+NVS_SIM_INTEGER(u64, uint64_t, U64)
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value) {
+    if (value == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return set_entry(handle, key, SimNvsType::STR, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    return set_entry(handle, key, SimNvsType::BLOB, value, length);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length) {
+    return get_entry(handle, key, SimNvsType::STR, out_value, length, true);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    return get_entry(handle, key, SimNvsType::BLOB, out_value, length, true);
+}
+
+esp_err_t nvs_get_stats(const char *part_name, nvs_stats_t *nvs_stats) {
+    (void)part_name;
+    if (nvs_stats == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // size of the 528 KB nvs partition in partition_table/partitions.csv: 132 pages with 126 entries each
+    const size_t total = 132 * 126;
+
+    std::lock_guard<std::mutex> lock(s_lock);
+    size_t                      namespaces = 0;
+    std::string                 last;
+    for (const auto &entry : s_entries) {
+        if (entry.first.first != last) {
+            namespaces++;
+            last = entry.first.first;
+        }
+    }
+    nvs_stats->used_entries = s_entries.size() + namespaces;
+    nvs_stats->total_entries = total;
+    nvs_stats->free_entries = total - nvs_stats->used_entries;
+    nvs_stats->available_entries = nvs_stats->free_entries > 126 ? nvs_stats->free_entries - 126 : 0;
+    nvs_stats->namespace_count = namespaces;
+    return ESP_OK;
+}
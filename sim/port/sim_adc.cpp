@@ -0,0 +1,13 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sim_adc.h"
+
+esp_err_t SimAdcReader::read(int *voltage) {
+    if (voltage == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *voltage = voltage_;
+    return ESP_OK;
+}
@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// IR receive relay and RMT transmitter: there is no RMT peripheral in the simulation.
+
+#include "esp_log.h"
+#include "ir_relay.h"
+#include "ir_rmt.h"
+
+static const char *const TAG = "SIM_IR";
+
+esp_err_t ir_relay_start(const IrRelayConfig *config) {
+    (void)config;
+    ESP_LOGW(TAG, "IR relay is not supported in the simulation");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void ir_relay_stop() {}
+
+bool ir_relay_read_frame(uint32_t *durations, uint16_t size, uint32_t gap, TickType_t timeout, IrRelayFrame *frame) {
+    (void)durations;
+    (void)size;
+    (void)gap;
+    (void)frame;
+    vTaskDelay(timeout);
+    return false;
+}
+
+uint32_t ir_relay_dropped_edges() {
+    return 0;
+}
+
+esp_err_t ir_rmt_send(const IrRmtStream *streams, size_t count) {
+    (void)streams;
+    (void)count;
+    ESP_LOGW(TAG, "RMT IR sending is not supported in the simulation");
+    return ESP_ERR_NOT_SUPPORTED;
+}
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sim_compat.h"
+
+#ifndef SIM_HAVE_STRLCPY
+
+size_t strlcpy(char *dst, const char *src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+size_t strlcat(char *dst, const char *src, size_t size) {
+    size_t dstLen = strnlen(dst, size);
+    if (dstLen == size) {
+        return size + strlen(src);
+    }
+    return dstLen + strlcpy(dst + dstLen, src, size - dstLen);
+}
+
+#endif
+
+char *utoa(unsigned value, char *str, int base) {
+    static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    char              tmp[33];
+    size_t            len = 0;
+    if (base < 2 || base > 36) {
+        str[0] = '\0';
+        return str;
+    }
+    do {
+        tmp[len++] = digits[value % base];
+        value /= base;
+    } while (value);
+    for (size_t i = 0; i < len; i++) {
+        str[i] = tmp[len - 1 - i];
+    }
+    str[len] = '\0';
+    return str;
+}
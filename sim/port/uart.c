@@ -0,0 +1,197 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// UART driver without a serial line: written data is logged and discarded. With the loopback option, written data is
+// received on the same UART instead.
+
+#include "driver/uart.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "freertos/task.h"
+
+static const char *const TAG = "SIM_UART";
+
+typedef struct {
+    bool          installed;
+    QueueHandle_t event_queue;
+    int           tx_buffer_size;
+    // RX ring buffer of the loopback
+    uint8_t *rx_buffer;
+    size_t   rx_size;
+    size_t   rx_head;
+    size_t   rx_len;
+} sim_uart_t;
+
+static sim_uart_t      s_uarts[UART_NUM_MAX];
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool            s_loopback = false;
+
+static bool valid_port(uart_port_t uart_num) {
+    return uart_num >= 0 && uart_num < UART_NUM_MAX;
+}
+
+void sim_uart_set_loopback(bool enable) {
+    s_loopback = enable;
+}
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size,
+                              QueueHandle_t *uart_queue, int intr_alloc_flags) {
+    (void)intr_alloc_flags;
+    if (!valid_port(uart_num) || rx_buffer_size <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_uarts[uart_num].installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    uint8_t *rx_buffer = malloc(rx_buffer_size);
+    if (rx_buffer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    sim_uart_t *uart = &s_uarts[uart_num];
+    if (uart_queue && queue_size > 0) {
+        uart->event_queue = xQueueCreate(queue_size, sizeof(uart_event_t));
+        *uart_queue = uart->event_queue;
+    }
+    uart->tx_buffer_size = tx_buffer_size;
+    uart->rx_buffer = rx_buffer;
+    uart->rx_size = rx_buffer_size;
+    uart->rx_head = 0;
+    uart->rx_len = 0;
+    uart->installed = true;
+    pthread_mutex_unlock(&s_lock);
+
+    ESP_LOGI(TAG, "UART%d driver installed", uart_num);
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t uart_num) {
+    if (!valid_port(uart_num) || !s_uarts[uart_num].installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_mutex_lock(&s_lock);
+    sim_uart_t *uart = &s_uarts[uart_num];
+    // the queue handle might still be referenced by the caller: keep it allocated like a leaked driver object
+    uart->installed = false;
+    uart->event_queue = NULL;
+    free(uart->rx_buffer);
+    uart->rx_buffer = NULL;
+    pthread_mutex_unlock(&s_lock);
+
+    ESP_LOGI(TAG, "UART%d driver deleted", uart_num);
+    return ESP_OK;
+}
+
+bool uart_is_driver_installed(uart_port_t uart_num) {
+    return valid_port(uart_num) && s_uarts[uart_num].installed;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config) {
+    if (!valid_port(uart_num) || uart_config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_LOGI(TAG, "UART%d config: %d baud, data bits: %d, parity: %d, stop bits: %d", uart_num,
+             uart_config->baud_rate, uart_config->data_bits, uart_config->parity, uart_config->stop_bits);
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num) {
+    (void)tx_io_num;
+    (void)rx_io_num;
+    (void)rts_io_num;
+    (void)cts_io_num;
+    return valid_port(uart_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_line_inverse(uart_port_t uart_num, uint32_t inverse_mask) {
+    (void)inverse_mask;
+    return valid_port(uart_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_sw_flow_ctrl(uart_port_t uart_num, bool enable, uint8_t rx_thresh_xon, uint8_t rx_thresh_xoff) {
+    (void)rx_thresh_xon;
+    (void)rx_thresh_xoff;
+    if (!uart_is_driver_installed(uart_num)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ESP_LOGI(TAG, "UART%d software flow control: %s", uart_num, enable ? "on" : "off");
+    return ESP_OK;
+}
+
+/// @brief Append written data to the RX buffer and post the driver event. Must be called with s_lock held.
+static void loopback(sim_uart_t *uart, const uint8_t *data, size_t size) {
+    uart_event_t event = {.type = UART_DATA, .size = size, .timeout_flag = false};
+    if (uart->rx_len + size > uart->rx_size) {
+        event.type = UART_BUFFER_FULL;
+        size = uart->rx_size - uart->rx_len;
+    }
+    for (size_t i = 0; i < size; i++) {
+        uart->rx_buffer[(uart->rx_head + uart->rx_len + i) % uart->rx_size] = data[i];
+    }
+    uart->rx_len += size;
+    if (uart->event_queue) {
+        xQueueSendToBack(uart->event_queue, &event, 0);
+    }
+}
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size) {
+    if (!uart_is_driver_installed(uart_num) || src == NULL) {
+        return -1;
+    }
+    ESP_LOGD(TAG, "UART%d TX: %.*s", uart_num, (int)size, (const char *)src);
+    if (s_loopback) {
+        pthread_mutex_lock(&s_lock);
+        if (s_uarts[uart_num].installed) {
+            loopback(&s_uarts[uart_num], src, size);
+        }
+        pthread_mutex_unlock(&s_lock);
+    }
+    return (int)size;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait) {
+    if (!uart_is_driver_installed(uart_num)) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    sim_uart_t *uart = &s_uarts[uart_num];
+    size_t      len = uart->rx_len < length ? uart->rx_len : length;
+    for (size_t i = 0; i < len; i++) {
+        ((uint8_t *)buf)[i] = uart->rx_buffer[(uart->rx_head + i) % uart->rx_size];
+    }
+    uart->rx_head = (uart->rx_head + len) % uart->rx_size;
+    uart->rx_len -= len;
+    pthread_mutex_unlock(&s_lock);
+
+    if (len == 0 && ticks_to_wait > 0) {
+        vTaskDelay(ticks_to_wait == portMAX_DELAY ? pdMS_TO_TICKS(1000) : ticks_to_wait);
+    }
+    return (int)len;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num) {
+    if (!uart_is_driver_installed(uart_num)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_mutex_lock(&s_lock);
+    s_uarts[uart_num].rx_head = 0;
+    s_uarts[uart_num].rx_len = 0;
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_get_tx_buffer_free_size(uart_port_t uart_num, size_t *size) {
+    if (!uart_is_driver_installed(uart_num) || size == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // data is sent immediately: the TX buffer is always empty
+    *size = s_uarts[uart_num].tx_buffer_size;
+    return ESP_OK;
+}
@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Simulation replacements for firmware modules which depend on hardware or IDF components without a host port:
+// network manager, LED driver, OTA and task statistics.
+
+#include "esp_log.h"
+#include "esp_system.h"
+
+#include "led_pattern.h"
+#include "network.h"
+#include "ota.h"
+#include "task_stats.h"
+#include "uc_events.h"
+
+static const char *const TAG = "SIM";
+
+// defined in the display driver on the target
+ESP_EVENT_DEFINE_BASE(UC_DOCK_EVENTS);
+
+// ---- Network manager: the host network is always up ----
+
+esp_err_t network_start(void) {
+    return ESP_OK;
+}
+
+void trigger_link_up_event(void) {}
+
+void trigger_link_down_event(void) {}
+
+void trigger_eth_got_ip_event(void) {}
+
+void trigger_connected_event(void) {}
+
+void trigger_wifi_got_ip_event(void) {}
+
+void trigger_connect_to_ap_event(const char *ssid, const char *password) {
+    ESP_LOGW(TAG, "Ignoring WiFi connect request to: %s", ssid ? ssid : "");
+}
+
+void trigger_lost_connection_event(wifi_event_sta_disconnected_t *disconnected_event) {}
+
+void trigger_delete_wifi_event(void) {
+    ESP_LOGW(TAG, "Ignoring WiFi delete request");
+}
+
+void trigger_button_press_event(void) {}
+
+void trigger_reboot_event(void) {
+    esp_restart();
+}
+
+bool is_eth_link_up(void) {
+    return false;
+}
+
+bool is_eth_connected(void) {
+    return false;
+}
+
+bool is_wifi_up(void) {
+    return true;
+}
+
+bool network_is_interface_connected(esp_netif_t *interface) {
+    return interface != nullptr;
+}
+
+esp_err_t network_get_ip_info_for_netif(esp_netif_t *netif, esp_netif_ip_info_t *ipInfo) {
+    return esp_netif_get_ip_info(netif, ipInfo);
+}
+
+esp_err_t eth_pwm_led_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t set_eth_led_brightness(int value) {
+    ESP_LOGD(TAG, "ETH LED brightness: %d", value);
+    return ESP_OK;
+}
+
+esp_err_t set_static_ip(esp_netif_t *netif, esp_netif_ip_info_t ip, uint32_t dns1, uint32_t dns2) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+// ---- LED: patterns are logged in led_pattern.c ----
+
+void init_led() {}
+
+// ---- OTA ----
+
+esp_err_t check_auth(httpd_req_t *req) {
+    // the web configurator password is not enforced in the simulation
+    return ESP_OK;
+}
+
+esp_err_t on_ota_upload(httpd_req_t *req) {
+    return httpd_resp_send_err(req, HTTPD_501_METHOD_NOT_IMPLEMENTED, "OTA is not supported in the simulation");
+}
+
+// ---- Task statistics: host threads are not enumerable ----
+
+esp_err_t task_stats_init(void) {
+    return ESP_OK;
+}
+
+size_t task_stats_get(task_info_t *tasks, size_t max, uint32_t *window_ms) {
+    if (window_ms) {
+        *window_ms = 0;
+    }
+    return 0;
+}
+
+const char *task_state_name(eTaskState state) {
+    switch (state) {
+        case eRunning:
+            return "running";
+        case eReady:
+            return "ready";
+        case eBlocked:
+            return "blocked";
+        case eSuspended:
+            return "suspended";
+        case eDeleted:
+            return "deleted";
+        default:
+            return "invalid";
+    }
+}
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <string>
+
+#include "hmac_sha256.h"
+#include "string_util.h"
+
+static std::string sha256Hex(const std::string &data) {
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    sha256(reinterpret_cast<const uint8_t *>(data.data()), data.size(), digest);
+    return hexEncode(digest, sizeof(digest));
+}
+
+static std::string hmacHex(const std::string &key, const std::string &data) {
+    uint8_t mac[SHA256_DIGEST_SIZE];
+    hmacSha256(reinterpret_cast<const uint8_t *>(key.data()), key.size(), reinterpret_cast<const uint8_t *>(data.data()),
+               data.size(), mac);
+    return hexEncode(mac, sizeof(mac));
+}
+
+TEST(HmacSha256Test, Sha256) {
+    EXPECT_EQ("E3B0C44298FC1C149AFBF4C8996FB92427AE41E4649B934CA495991B7852B855", sha256Hex(""));
+    EXPECT_EQ("BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD", sha256Hex("abc"));
+    EXPECT_EQ("248D6A61D20638B8E5C026930C3E6039A33CE45964FF2167F6ECEDD419DB06C1",
+              sha256Hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"));
+}
+
+TEST(HmacSha256Test, Sha256MultipleBlocks) {
+    EXPECT_EQ("CDC76E5C9914FB9281A1C7E284D73E67F1809A48A497200E046D39CCC7112CD0", sha256Hex(std::string(1000000, 'a')));
+}
+
+// RFC 4231 test cases
+TEST(HmacSha256Test, Rfc4231TestCase1) {
+    EXPECT_EQ("B0344C61D8DB38535CA8AFCEAF0BF12B881DC200C9833DA726E9376C2E32CFF7",
+              hmacHex(std::string(20, '\x0b'), "Hi There"));
+}
+
+TEST(HmacSha256Test, Rfc4231TestCase2) {
+    EXPECT_EQ("5BDCC146BF60754E6A042426089575C75A003F089D2739839DEC58B964EC3843",
+              hmacHex("Jefe", "what do ya want for nothing?"));
+}
+
+TEST(HmacSha256Test, Rfc4231TestCase6LongKey) {
+    EXPECT_EQ("60E431591EE0B67F0D8A26AACBF5B77F8E0BC6213728C5140546040F0EE37F54",
+              hmacHex(std::string(131, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First"));
+}
+
+TEST(HmacSha256Test, ConstantTimeEqual) {
+    const uint8_t a[] = {1, 2, 3};
+    const uint8_t b[] = {1, 2, 4};
+    EXPECT_TRUE(constantTimeEqual(a, a, sizeof(a)));
+    EXPECT_FALSE(constantTimeEqual(a, b, sizeof(a)));
+    EXPECT_TRUE(constantTimeEqual(a, b, 2));
+}
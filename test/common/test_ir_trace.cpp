@@ -0,0 +1,171 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "ir_trace.h"
+
+static const size_t points = (size_t)IrTracePoint::COUNT;
+
+TEST(IrTraceTest, PointNames) {
+    EXPECT_STREQ("ws_received", ir_trace_point_name(IrTracePoint::WS_RECEIVED));
+    EXPECT_STREQ("response_sent", ir_trace_point_name(IrTracePoint::RESPONSE_SENT));
+    EXPECT_STREQ("unknown", ir_trace_point_name(IrTracePoint::COUNT));
+}
+
+TEST(IrTraceTest, NextIdIsNeverZero) {
+    IrTraceBuffer buffer;
+
+    EXPECT_EQ(1, buffer.nextId());
+    EXPECT_EQ(2, buffer.nextId());
+}
+
+TEST(IrTraceTest, SnapshotReturnsEntriesInRecordingOrder) {
+    IrTraceBuffer buffer;
+    IrTraceEntry  entries[IrTraceBuffer::capacity];
+
+    buffer.record(1, IrTracePoint::ENQUEUED, 100);
+    buffer.record(1, IrTracePoint::DEQUEUED, 150);
+
+    ASSERT_EQ(2, buffer.snapshot(entries, IrTraceBuffer::capacity));
+    EXPECT_EQ(1, entries[0].id);
+    EXPECT_EQ(IrTracePoint::ENQUEUED, entries[0].point);
+    EXPECT_EQ(100, entries[0].timestamp);
+    EXPECT_EQ(IrTracePoint::DEQUEUED, entries[1].point);
+    EXPECT_EQ(150, entries[1].timestamp);
+}
+
+TEST(IrTraceTest, RingBufferOverwritesOldestEntries) {
+    IrTraceBuffer buffer;
+    IrTraceEntry  entries[IrTraceBuffer::capacity];
+
+    for (uint32_t i = 0; i < IrTraceBuffer::capacity + 10; i++) {
+        buffer.record(i + 1, IrTracePoint::ENQUEUED, i);
+    }
+
+    ASSERT_EQ(IrTraceBuffer::capacity, buffer.snapshot(entries, IrTraceBuffer::capacity));
+    EXPECT_EQ(11, entries[0].id);
+    EXPECT_EQ(IrTraceBuffer::capacity + 10, entries[IrTraceBuffer::capacity - 1].id);
+}
+
+TEST(IrTraceTest, SnapshotIsLimitedByOutputSize) {
+    IrTraceBuffer buffer;
+    IrTraceEntry  entries[2];
+
+    for (uint32_t i = 0; i < 5; i++) {
+        buffer.record(1, IrTracePoint::ENQUEUED, i);
+    }
+
+    EXPECT_EQ(2, buffer.snapshot(entries, 2));
+}
+
+TEST(IrTraceTest, Clear) {
+    IrTraceBuffer buffer;
+    IrTraceEntry  entries[IrTraceBuffer::capacity];
+
+    buffer.record(1, IrTracePoint::ENQUEUED, 100);
+    buffer.clear();
+
+    EXPECT_EQ(0, buffer.snapshot(entries, IrTraceBuffer::capacity));
+}
+
+TEST(IrTraceTest, SummaryWithoutEntries) {
+    IrTraceStats stats[points];
+
+    EXPECT_EQ(0, ir_trace_summary(nullptr, 0, stats));
+    EXPECT_EQ(0, stats[0].count);
+}
+
+TEST(IrTraceTest, SummaryLatenciesRelativeToTraceStart) {
+    // two interleaved traces
+    IrTraceEntry entries[] = {
+        {1, 1000, IrTracePoint::WS_RECEIVED}, {1, 1100, IrTracePoint::ENQUEUED}, {2, 2000, IrTracePoint::WS_RECEIVED},
+        {1, 1500, IrTracePoint::FIRST_MARK},  {2, 2300, IrTracePoint::ENQUEUED}, {2, 2400, IrTracePoint::FIRST_MARK},
+    };
+    IrTraceStats stats[points];
+
+    EXPECT_EQ(2, ir_trace_summary(entries, sizeof(entries) / sizeof(entries[0]), stats));
+
+    IrTraceStats &start = stats[(size_t)IrTracePoint::WS_RECEIVED];
+    EXPECT_EQ(2, start.count);
+    EXPECT_EQ(0, start.max);
+
+    IrTraceStats &enqueued = stats[(size_t)IrTracePoint::ENQUEUED];
+    EXPECT_EQ(2, enqueued.count);
+    EXPECT_EQ(100, enqueued.p50);
+    EXPECT_EQ(300, enqueued.p90);
+    EXPECT_EQ(300, enqueued.max);
+
+    IrTraceStats &firstMark = stats[(size_t)IrTracePoint::FIRST_MARK];
+    EXPECT_EQ(2, firstMark.count);
+    EXPECT_EQ(400, firstMark.p50);
+    EXPECT_EQ(500, firstMark.max);
+
+    EXPECT_EQ(0, stats[(size_t)IrTracePoint::RESPONSE_SENT].count);
+}
+
+TEST(IrTraceTest, SummaryPercentiles) {
+    IrTraceEntry entries[200];
+    for (uint32_t i = 0; i < 100; i++) {
+        entries[i * 2] = {i + 1, 0, IrTracePoint::ENQUEUED};
+        entries[i * 2 + 1] = {i + 1, (i + 1) * 10, IrTracePoint::LAST_SPACE};
+    }
+    IrTraceStats stats[points];
+
+    EXPECT_EQ(100, ir_trace_summary(entries, 200, stats));
+
+    IrTraceStats &lastSpace = stats[(size_t)IrTracePoint::LAST_SPACE];
+    EXPECT_EQ(100, lastSpace.count);
+    EXPECT_EQ(500, lastSpace.p50);
+    EXPECT_EQ(900, lastSpace.p90);
+    EXPECT_EQ(990, lastSpace.p99);
+    EXPECT_EQ(1000, lastSpace.max);
+}
+
+TEST(IrTraceTest, SummaryHandlesTimestampWrapAround) {
+    IrTraceEntry entries[] = {
+        {1, 0xFFFFFF00, IrTracePoint::ENQUEUED},
+        {1, 0x00000100, IrTracePoint::DEQUEUED},
+    };
+    IrTraceStats stats[points];
+
+    EXPECT_EQ(1, ir_trace_summary(entries, 2, stats));
+    EXPECT_EQ(0x200, stats[(size_t)IrTracePoint::DEQUEUED].max);
+}
+
+TEST(IrTraceTest, PendingPointsAreRecordedWithBegin) {
+    IrTraceEntry entries[IrTraceBuffer::capacity];
+    ir_trace().clear();
+
+    ir_trace_pending(IrTracePoint::WS_RECEIVED);
+    ir_trace_pending(IrTracePoint::REQUEST_PARSED);
+    uint32_t id = ir_trace_begin();
+    ir_trace_point(id, IrTracePoint::ENQUEUED);
+    // pending points are consumed
+    uint32_t id2 = ir_trace_begin();
+    ir_trace_point(id2, IrTracePoint::ENQUEUED);
+    // ignored
+    ir_trace_point(0, IrTracePoint::ENQUEUED);
+
+    ASSERT_EQ(4, ir_trace().snapshot(entries, IrTraceBuffer::capacity));
+    EXPECT_EQ(id, entries[0].id);
+    EXPECT_EQ(IrTracePoint::WS_RECEIVED, entries[0].point);
+    EXPECT_EQ(id, entries[1].id);
+    EXPECT_EQ(IrTracePoint::REQUEST_PARSED, entries[1].point);
+    EXPECT_EQ(id, entries[2].id);
+    EXPECT_EQ(IrTracePoint::ENQUEUED, entries[2].point);
+    EXPECT_EQ(id2, entries[3].id);
+    EXPECT_EQ(IrTracePoint::ENQUEUED, entries[3].point);
+}
+
+TEST(IrTraceTest, ClearPending) {
+    IrTraceEntry entries[IrTraceBuffer::capacity];
+    ir_trace().clear();
+
+    ir_trace_pending(IrTracePoint::WS_RECEIVED);
+    ir_trace_clear_pending();
+    ir_trace_begin();
+
+    EXPECT_EQ(0, ir_trace().snapshot(entries, IrTraceBuffer::capacity));
+}
@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "mem_tag.h"
+
+TEST(MemTagTest, Names) {
+    EXPECT_STREQ("ir", mem_tag_name(MEM_TAG_IR));
+    EXPECT_STREQ("json", mem_tag_name(MEM_TAG_JSON));
+    EXPECT_STREQ("ui", mem_tag_name(MEM_TAG_UI));
+    EXPECT_STREQ("unknown", mem_tag_name(MEM_TAG_COUNT));
+}
+
+TEST(MemTagTest, AllocAndFreeAreCounted) {
+    mem_tag_stats_t before;
+    mem_tag_stats_t stats;
+    mem_tag_get_stats(MEM_TAG_UI, &before);
+
+    void *ptr = mem_tag_malloc(MEM_TAG_UI, 100);
+    ASSERT_NE(nullptr, ptr);
+    mem_tag_get_stats(MEM_TAG_UI, &stats);
+    EXPECT_EQ(before.allocs + 1, stats.allocs);
+    EXPECT_EQ(before.frees, stats.frees);
+    EXPECT_GE(stats.bytes - before.bytes, 100);
+    EXPECT_GE(stats.peak_bytes, stats.bytes);
+
+    mem_tag_free(MEM_TAG_UI, ptr);
+    mem_tag_get_stats(MEM_TAG_UI, &stats);
+    EXPECT_EQ(before.frees + 1, stats.frees);
+    EXPECT_EQ(before.bytes, stats.bytes);
+    EXPECT_GE(stats.peak_bytes - before.bytes, 100);
+}
+
+TEST(MemTagTest, Calloc) {
+    mem_tag_stats_t before;
+    mem_tag_stats_t stats;
+    mem_tag_get_stats(MEM_TAG_WEB, &before);
+
+    uint8_t *ptr = static_cast<uint8_t *>(mem_tag_calloc(MEM_TAG_WEB, 16, 4));
+    ASSERT_NE(nullptr, ptr);
+    for (int i = 0; i < 64; i++) {
+        EXPECT_EQ(0, ptr[i]);
+    }
+    mem_tag_get_stats(MEM_TAG_WEB, &stats);
+    EXPECT_EQ(before.allocs + 1, stats.allocs);
+
+    mem_tag_free(MEM_TAG_WEB, ptr);
+    mem_tag_get_stats(MEM_TAG_WEB, &stats);
+    EXPECT_EQ(before.bytes, stats.bytes);
+}
+
+TEST(MemTagTest, Strdup) {
+    char *str = mem_tag_strdup(MEM_TAG_WEB, "{\"code\":200}");
+
+    ASSERT_NE(nullptr, str);
+    EXPECT_STREQ("{\"code\":200}", str);
+    mem_tag_free(MEM_TAG_WEB, str);
+}
+
+TEST(MemTagTest, TagsAreCountedSeparately) {
+    mem_tag_stats_t before;
+    mem_tag_stats_t stats;
+    mem_tag_get_stats(MEM_TAG_IR, &before);
+
+    void *ptr = mem_tag_malloc(MEM_TAG_JSON, 32);
+    mem_tag_get_stats(MEM_TAG_IR, &stats);
+    EXPECT_EQ(before.allocs, stats.allocs);
+    EXPECT_EQ(before.bytes, stats.bytes);
+
+    mem_tag_free(MEM_TAG_JSON, ptr);
+}
+
+TEST(MemTagTest, FreeNullIsIgnored) {
+    mem_tag_stats_t before;
+    mem_tag_stats_t stats;
+    mem_tag_get_stats(MEM_TAG_UI, &before);
+
+    mem_tag_free(MEM_TAG_UI, nullptr);
+
+    mem_tag_get_stats(MEM_TAG_UI, &stats);
+    EXPECT_EQ(before.frees, stats.frees);
+}
+
+TEST(MemTagTest, InvalidTag) {
+    mem_tag_stats_t stats;
+
+    EXPECT_EQ(nullptr, mem_tag_malloc(MEM_TAG_COUNT, 10));
+    mem_tag_get_stats(MEM_TAG_COUNT, &stats);
+    EXPECT_EQ(0, stats.allocs);
+}
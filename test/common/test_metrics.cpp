@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "metrics.h"
+
+TEST(MetricsTest, EmptyRegistry) {
+    MetricsRegistry registry;
+    std::string     out;
+
+    registry.write(out);
+
+    EXPECT_EQ("", out);
+}
+
+TEST(MetricsTest, Counter) {
+    MetricsRegistry registry;
+    Counter         counter("test_total", "Test counter", nullptr, registry);
+    std::string     out;
+
+    counter.inc();
+    counter.inc(2);
+    registry.write(out);
+
+    EXPECT_EQ(3, counter.value());
+    EXPECT_EQ(
+        "# HELP test_total Test counter\n"
+        "# TYPE test_total counter\n"
+        "test_total 3\n",
+        out);
+}
+
+TEST(MetricsTest, GaugeWithNegativeValue) {
+    MetricsRegistry registry;
+    Gauge           gauge("test_rssi", "Test gauge", nullptr, registry);
+    std::string     out;
+
+    gauge.set(-60);
+    gauge.dec(2);
+    registry.write(out);
+
+    EXPECT_EQ(
+        "# HELP test_rssi Test gauge\n"
+        "# TYPE test_rssi gauge\n"
+        "test_rssi -62\n",
+        out);
+}
+
+TEST(MetricsTest, MetricFamilyWithLabelsIsGrouped) {
+    MetricsRegistry registry;
+    Counter         pronto("test_sends_total", "Sends", "format=\"pronto\"", registry);
+    Gauge           other("test_other", "Other", nullptr, registry);
+    Counter         hex("test_sends_total", "Sends", "format=\"hex\"", registry);
+    std::string     out;
+
+    pronto.inc();
+    hex.inc(5);
+    registry.write(out);
+
+    EXPECT_EQ(
+        "# HELP test_sends_total Sends\n"
+        "# TYPE test_sends_total counter\n"
+        "test_sends_total{format=\"pronto\"} 1\n"
+        "test_sends_total{format=\"hex\"} 5\n"
+        "# HELP test_other Other\n"
+        "# TYPE test_other gauge\n"
+        "test_other 0\n",
+        out);
+}
+
+TEST(MetricsTest, HistogramBucketsAreCumulative) {
+    static const uint32_t bounds[] = {10, 100};
+    MetricsRegistry       registry;
+    HistogramN<2>         histogram("test_duration_ms", "Duration", nullptr, bounds, registry);
+    std::string           out;
+
+    histogram.observe(5);
+    histogram.observe(10);
+    histogram.observe(50);
+    histogram.observe(1000);
+    registry.write(out);
+
+    EXPECT_EQ(4, histogram.count());
+    EXPECT_EQ(1065, histogram.sum());
+    EXPECT_EQ(
+        "# HELP test_duration_ms Duration\n"
+        "# TYPE test_duration_ms histogram\n"
+        "test_duration_ms_bucket{le=\"10\"} 2\n"
+        "test_duration_ms_bucket{le=\"100\"} 3\n"
+        "test_duration_ms_bucket{le=\"+Inf\"} 4\n"
+        "test_duration_ms_sum 1065\n"
+        "test_duration_ms_count 4\n",
+        out);
+}
+
+TEST(MetricsTest, HistogramWithLabels) {
+    static const uint32_t bounds[] = {1};
+    MetricsRegistry       registry;
+    HistogramN<1>         histogram("test_wait_ms", "Wait", "format=\"gc\"", bounds, registry);
+    std::string           out;
+
+    histogram.observe(2);
+    registry.write(out);
+
+    EXPECT_EQ(
+        "# HELP test_wait_ms Wait\n"
+        "# TYPE test_wait_ms histogram\n"
+        "test_wait_ms_bucket{format=\"gc\",le=\"1\"} 0\n"
+        "test_wait_ms_bucket{format=\"gc\",le=\"+Inf\"} 1\n"
+        "test_wait_ms_sum{format=\"gc\"} 2\n"
+        "test_wait_ms_count{format=\"gc\"} 1\n",
+        out);
+}
+
+TEST(MetricsTest, DestroyedMetricIsRemoved) {
+    MetricsRegistry registry;
+    Counter         first("test_first", "First", nullptr, registry);
+    std::string     out;
+
+    {
+        Counter second("test_second", "Second", nullptr, registry);
+    }
+    Counter third("test_third", "Third", nullptr, registry);
+    registry.write(out);
+
+    EXPECT_EQ(
+        "# HELP test_first First\n"
+        "# TYPE test_first counter\n"
+        "test_first 0\n"
+        "# HELP test_third Third\n"
+        "# TYPE test_third counter\n"
+        "test_third 0\n",
+        out);
+}
+
+static void test_collector(std::string &out) {
+    metrics_write_header(out, "test_task_stack", "Stack", MetricType::GAUGE);
+    metrics_write_sample(out, "test_task_stack", "task=\"IR send\"", 512);
+}
+
+TEST(MetricsTest, Collector) {
+    MetricsRegistry registry;
+    std::string     out;
+
+    EXPECT_TRUE(registry.addCollector(test_collector));
+    registry.write(out);
+
+    EXPECT_EQ(
+        "# HELP test_task_stack Stack\n"
+        "# TYPE test_task_stack gauge\n"
+        "test_task_stack{task=\"IR send\"} 512\n",
+        out);
+}
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "object_pool.h"
+
+struct PoolItem {
+    PoolItem() = default;
+    PoolItem(int value, int *destroyed) : value(value), destroyed(destroyed) {}
+    ~PoolItem() {
+        if (destroyed) {
+            (*destroyed)++;
+        }
+    }
+
+    int  value = 0;
+    int *destroyed = nullptr;
+};
+
+TEST(ObjectPoolTest, AcquireConstructsObject) {
+    ObjectPool<PoolItem, 2> pool;
+
+    PoolItem *item = pool.acquire(42, nullptr);
+
+    ASSERT_NE(nullptr, item);
+    EXPECT_EQ(42, item->value);
+    EXPECT_EQ(1, pool.used());
+    EXPECT_EQ(2, pool.capacity());
+}
+
+TEST(ObjectPoolTest, ExhaustedPoolReturnsNull) {
+    ObjectPool<PoolItem, 2> pool;
+
+    PoolItem *first = pool.acquire();
+    PoolItem *second = pool.acquire();
+
+    ASSERT_NE(nullptr, first);
+    ASSERT_NE(nullptr, second);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(nullptr, pool.acquire());
+    EXPECT_EQ(2, pool.used());
+    EXPECT_EQ(1, pool.exhausted());
+}
+
+TEST(ObjectPoolTest, ReleaseDestroysObjectAndFreesSlot) {
+    ObjectPool<PoolItem, 1> pool;
+    int                     destroyed = 0;
+
+    PoolItem *item = pool.acquire(1, &destroyed);
+    pool.release(item);
+
+    EXPECT_EQ(1, destroyed);
+    EXPECT_EQ(0, pool.used());
+    PoolItem *again = pool.acquire(2, nullptr);
+    EXPECT_EQ(item, again);
+    EXPECT_EQ(2, again->value);
+}
+
+TEST(ObjectPoolTest, ReleaseIgnoresForeignObjects) {
+    ObjectPool<PoolItem, 2> pool;
+    int                     destroyed = 0;
+    PoolItem                other(1, &destroyed);
+
+    pool.acquire();
+    pool.release(nullptr);
+    pool.release(&other);
+
+    EXPECT_EQ(1, pool.used());
+    EXPECT_EQ(0, destroyed);
+    other.destroyed = nullptr;
+}
+
+TEST(ObjectPoolTest, Index) {
+    ObjectPool<PoolItem, 3> pool;
+    PoolItem                other;
+
+    PoolItem *first = pool.acquire();
+    PoolItem *second = pool.acquire();
+
+    EXPECT_EQ(0, pool.index(first));
+    EXPECT_EQ(1, pool.index(second));
+    EXPECT_EQ(-1, pool.index(&other));
+    EXPECT_EQ(-1, pool.index(nullptr));
+}
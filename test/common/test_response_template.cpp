@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <climits>
+#include <string>
+
+#include "response_template.h"
+
+#ifdef HAVE_CJSON
+#include <cJSON.h>
+
+// Same document as previously built in the IR send task
+static std::string cjsonIrSend(uint32_t reqId, uint16_t code) {
+    cJSON *doc = cJSON_CreateObject();
+    cJSON_AddStringToObject(doc, "type", "dock");
+    cJSON_AddStringToObject(doc, "msg", "ir_send");
+    cJSON_AddNumberToObject(doc, "req_id", reqId);
+    cJSON_AddNumberToObject(doc, "code", code);
+    char       *out = cJSON_PrintUnformatted(doc);
+    std::string result = out;
+    cJSON_free(out);
+    cJSON_Delete(doc);
+    return result;
+}
+
+// Same document as built in DockApi::processRequest
+static std::string cjsonDock(const char *request, const char *msg, uint16_t code) {
+    cJSON *root = cJSON_Parse(request);
+    cJSON *doc = cJSON_CreateObject();
+    cJSON *item = cJSON_GetObjectItem(root, "id");
+    if (item) {
+        cJSON_AddItemReferenceToObject(doc, "req_id", item);
+    }
+    cJSON_AddStringToObject(doc, "type", "dock");
+    cJSON_AddStringToObject(doc, "msg", msg);
+    cJSON_AddNumberToObject(doc, "code", code);
+    char       *out = cJSON_PrintUnformatted(doc);
+    std::string result = out;
+    cJSON_free(out);
+    cJSON_Delete(doc);
+    cJSON_Delete(root);
+    return result;
+}
+#endif
+
+static std::string irSend(uint32_t reqId, uint16_t code) {
+    char buf[RESPONSE_TEMPLATE_MAX_LENGTH];
+    EXPECT_GT(response_format_ir_send(buf, sizeof(buf), reqId, code), 0);
+    return buf;
+}
+
+static std::string dock(const int *reqId, const char *msg, uint16_t code) {
+    char buf[RESPONSE_TEMPLATE_MAX_LENGTH];
+    EXPECT_GT(response_format_dock(buf, sizeof(buf), reqId, msg, code), 0);
+    return buf;
+}
+
+TEST(ResponseTemplateTest, IrSend) {
+    EXPECT_EQ("{\"type\":\"dock\",\"msg\":\"ir_send\",\"req_id\":123,\"code\":200}", irSend(123, 200));
+    EXPECT_EQ("{\"type\":\"dock\",\"msg\":\"ir_send\",\"req_id\":0,\"code\":400}", irSend(0, 400));
+    EXPECT_EQ("{\"type\":\"dock\",\"msg\":\"ir_send\",\"req_id\":4294967295,\"code\":200}", irSend(UINT32_MAX, 200));
+}
+
+TEST(ResponseTemplateTest, Dock) {
+    int id = 42;
+    EXPECT_EQ("{\"req_id\":42,\"type\":\"dock\",\"msg\":\"pong\",\"code\":200}", dock(&id, "pong", 200));
+    id = -1;
+    EXPECT_EQ("{\"req_id\":-1,\"type\":\"dock\",\"msg\":\"ir_send\",\"code\":429}", dock(&id, "ir_send", 429));
+    EXPECT_EQ("{\"type\":\"dock\",\"msg\":\"pong\",\"code\":200}", dock(nullptr, "pong", 200));
+}
+
+TEST(ResponseTemplateTest, DockRejectsNamesRequiringEscaping) {
+    char buf[RESPONSE_TEMPLATE_MAX_LENGTH];
+    EXPECT_EQ(-1, response_format_dock(buf, sizeof(buf), nullptr, "a\"b", 200));
+    EXPECT_EQ(-1, response_format_dock(buf, sizeof(buf), nullptr, "a\\b", 200));
+    EXPECT_EQ(-1, response_format_dock(buf, sizeof(buf), nullptr, "Pong", 200));
+    EXPECT_EQ(-1, response_format_dock(buf, sizeof(buf), nullptr, "", 200));
+    EXPECT_EQ(-1, response_format_dock(buf, sizeof(buf), nullptr, nullptr, 200));
+}
+
+TEST(ResponseTemplateTest, BufferTooSmall) {
+    char buf[16];
+    int  id = 1;
+    EXPECT_EQ(-1, response_format_ir_send(buf, sizeof(buf), 1, 200));
+    EXPECT_EQ(-1, response_format_dock(buf, sizeof(buf), &id, "pong", 200));
+    EXPECT_EQ(-1, response_format_dock(buf, 0, &id, "pong", 200));
+}
+
+TEST(ResponseTemplateTest, MaxLengthFitsLargestValues) {
+    char buf[RESPONSE_TEMPLATE_MAX_LENGTH];
+    int  id = INT_MIN;
+    EXPECT_GT(response_format_ir_send(buf, sizeof(buf), UINT32_MAX, UINT16_MAX), 0);
+    EXPECT_GT(response_format_dock(buf, sizeof(buf), &id, "get_sysinfo", UINT16_MAX), 0);
+}
+
+#ifdef HAVE_CJSON
+TEST(ResponseTemplateTest, IrSendIdenticalToCJson) {
+    const uint32_t ids[] = {0, 1, 123, 65535, INT_MAX - 1, INT_MAX, static_cast<uint32_t>(INT_MAX) + 1, UINT32_MAX};
+    for (auto id : ids) {
+        for (uint16_t code : {200, 400}) {
+            EXPECT_EQ(cjsonIrSend(id, code), irSend(id, code)) << "id=" << id;
+        }
+    }
+}
+
+TEST(ResponseTemplateTest, DockIdenticalToCJson) {
+    const int ids[] = {0, 1, -1, 42, 1000, INT_MAX, INT_MIN};
+    for (auto id : ids) {
+        std::string request = "{\"id\":" + std::to_string(id) + "}";
+        EXPECT_EQ(cjsonDock(request.c_str(), "pong", 200), dock(&id, "pong", 200)) << request;
+        EXPECT_EQ(cjsonDock(request.c_str(), "ir_send", 429), dock(&id, "ir_send", 429)) << request;
+    }
+    EXPECT_EQ(cjsonDock("{}", "pong", 200), dock(nullptr, "pong", 200));
+    // exponent notation is parsed as integral number
+    int id = 1000;
+    EXPECT_EQ(cjsonDock("{\"id\":1e3}", "pong", 200), dock(&id, "pong", 200));
+}
+#endif
@@ -81,3 +81,37 @@ TEST(StringUtilTest, ReplacecharMultiMatch) {
     EXPECT_EQ(2, replacechar(buf, 'o', 'u'));
     EXPECT_STREQ("fuubar", buf);
 }
+
+TEST(StringUtilTest, IsTextData) {
+    EXPECT_TRUE(isTextData(reinterpret_cast<const uint8_t *>(""), 0));
+    EXPECT_TRUE(isTextData(reinterpret_cast<const uint8_t *>("PWR ON\r\n"), 8));
+    EXPECT_TRUE(isTextData(reinterpret_cast<const uint8_t *>("a\tb~"), 4));
+    EXPECT_FALSE(isTextData(reinterpret_cast<const uint8_t *>("\x02PWR\x03"), 5));
+    EXPECT_FALSE(isTextData(reinterpret_cast<const uint8_t *>("a\0b"), 3));
+    EXPECT_FALSE(isTextData(reinterpret_cast<const uint8_t *>("\xc3\xa4"), 2));
+}
+
+TEST(StringUtilTest, HexEncode) {
+    const uint8_t data[] = {0x00, 0x1f, 0xa0, 0xff};
+    EXPECT_EQ("", hexEncode(data, 0));
+    EXPECT_EQ("001FA0FF", hexEncode(data, sizeof(data)));
+}
+
+TEST(StringUtilTest, HexDecode) {
+    uint8_t out[4];
+    EXPECT_EQ(0, hexDecode("", out, sizeof(out)));
+    ASSERT_EQ(4, hexDecode("001fA0FF", out, sizeof(out)));
+    EXPECT_EQ(0x00, out[0]);
+    EXPECT_EQ(0x1f, out[1]);
+    EXPECT_EQ(0xa0, out[2]);
+    EXPECT_EQ(0xff, out[3]);
+}
+
+TEST(StringUtilTest, HexDecodeInvalidInput) {
+    uint8_t out[4];
+    EXPECT_EQ(-1, hexDecode(NULL, out, sizeof(out)));
+    EXPECT_EQ(-1, hexDecode("0", out, sizeof(out)));
+    EXPECT_EQ(-1, hexDecode("0g", out, sizeof(out)));
+    EXPECT_EQ(-1, hexDecode("00 11", out, sizeof(out)));
+    EXPECT_EQ(-1, hexDecode("0011223344", out, sizeof(out)));
+}
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "uart_framer.h"
+
+class UartFramerTest : public ::testing::Test {
+ protected:
+    UartFramer create(int16_t delimiter, size_t maxLength) {
+        return UartFramer(delimiter, maxLength,
+                          [this](const uint8_t *data, size_t len) { frames.emplace_back((const char *)data, len); });
+    }
+
+    void feed(UartFramer &framer, const std::string &data) {
+        framer.feed(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+    }
+
+    std::vector<std::string> frames;
+};
+
+TEST_F(UartFramerTest, delimiterEndsFrame) {
+    auto framer = create('\r', 64);
+    feed(framer, "PWR ON\rPWR?\r");
+    ASSERT_EQ(2, frames.size());
+    EXPECT_EQ("PWR ON\r", frames[0]);
+    EXPECT_EQ("PWR?\r", frames[1]);
+    EXPECT_EQ(0, framer.pending());
+}
+
+TEST_F(UartFramerTest, segmentedFrame) {
+    auto framer = create('\n', 64);
+    feed(framer, "VOL");
+    feed(framer, "=12");
+    EXPECT_EQ(0, frames.size());
+    EXPECT_EQ(6, framer.pending());
+    feed(framer, "\nVOL");
+    ASSERT_EQ(1, frames.size());
+    EXPECT_EQ("VOL=12\n", frames[0]);
+    EXPECT_EQ(3, framer.pending());
+}
+
+TEST_F(UartFramerTest, flushEmitsPendingData) {
+    auto framer = create(-1, 64);
+    feed(framer, std::string("\x02\x01\x00\x03", 4));
+    EXPECT_EQ(0, frames.size());
+    framer.flush();
+    ASSERT_EQ(1, frames.size());
+    EXPECT_EQ(4, frames[0].size());
+
+    // nothing pending
+    framer.flush();
+    EXPECT_EQ(1, frames.size());
+}
+
+TEST_F(UartFramerTest, maxLengthSplitsFrames) {
+    auto framer = create('\r', 4);
+    feed(framer, "0123456789\r");
+    ASSERT_EQ(3, frames.size());
+    EXPECT_EQ("0123", frames[0]);
+    EXPECT_EQ("4567", frames[1]);
+    EXPECT_EQ("89\r", frames[2]);
+}
+
+TEST_F(UartFramerTest, binaryDelimiter) {
+    auto framer = create(0x00, 16);
+    framer.feed(reinterpret_cast<const uint8_t *>("\xAA\x00\xBB\xCC\x00"), 5);
+    ASSERT_EQ(2, frames.size());
+    EXPECT_EQ(std::string("\xAA\x00", 2), frames[0]);
+    EXPECT_EQ(std::string("\xBB\xCC\x00", 3), frames[1]);
+}
+
+TEST_F(UartFramerTest, resetDiscardsPendingData) {
+    auto framer = create('\r', 16);
+    feed(framer, "garbage");
+    framer.reset();
+    feed(framer, "OK\r");
+    ASSERT_EQ(1, frames.size());
+    EXPECT_EQ("OK\r", frames[0]);
+}
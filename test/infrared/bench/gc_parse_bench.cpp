@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Micro-benchmark of the GlobalCache sendir request parsing: the previous multi-pass parsing compared with the
+// single-pass parser `parseGcSendIr`.
+// Usage: ./build/infrared/gc_parse_bench [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+#include "globalcache.h"
+#include "ir_codes.h"
+
+static const char *const request =
+    "sendir,1:1,4711,38000,1,1,342,171,21,21,21,21,21,64,21,21,21,21,21,21,21,21,21,21,21,64,21,64,21,21,21,64,21,"
+    "64,21,64,21,64,21,64,21,21,21,21,21,21,21,64,21,21,21,21,21,21,21,21,21,64,21,64,21,64,21,21,21,64,21,64,21,64,"
+    "21,64,21,1517";
+
+// sink to prevent the compiler from optimizing away the parsing
+static volatile uint32_t sink;
+
+/// Parsing steps of a sendir request before the single-pass parser: header validation in `sendGlobalCache`, code
+/// array conversion in the IR send task and the module:port lookup for the `completeir` response.
+static bool multiPass(const char *sendir) {
+    if (strncmp(sendir, "sendir,1:", 9) != 0) {
+        return false;
+    }
+    const char *next = strchr(sendir + 9, ',');
+    if (next == NULL) {
+        return false;
+    }
+    auto port = atoi(sendir + 9);
+    next = strchr(next + 1, ',');
+    if (next == NULL) {
+        return false;
+    }
+    next = strchr(next + 1, ',');
+    if (next == NULL) {
+        return false;
+    }
+    auto repeat = atoi(next + 1);
+
+    uint16_t  count;
+    uint16_t *code = globalCacheBufferToArray(sendir, &count);
+    if (code == NULL) {
+        return false;
+    }
+    sink = code[count - 1] + port + repeat;
+    free(code);
+
+    GCMsg req;
+    if (parseGcRequest(sendir, &req) != 0) {
+        return false;
+    }
+    sink = req.module + req.port;
+    return true;
+}
+
+static bool singlePass(const char *sendir) {
+    static uint16_t code[512];
+    GCSendIr        parsed;
+    if (parseGcSendIr(sendir, &parsed, code, 512) != 0) {
+        return false;
+    }
+    sink = code[parsed.count - 1] + parsed.port + parsed.repeat;
+    return true;
+}
+
+template <typename F>
+static double measure(const char *name, F parse, uint32_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        if (!parse(request)) {
+            fprintf(stderr, "%s: parsing failed\n", name);
+            exit(1);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    double                                   perRequest = elapsed.count() / iterations;
+    printf("%-12s %10.1f ns/request\n", name, perRequest);
+    return perRequest;
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 200000;
+    if (iterations == 0) {
+        fprintf(stderr, "Invalid number of iterations\n");
+        return 1;
+    }
+
+    printf("sendir request: %zu characters, %u iterations\n", strlen(request), iterations);
+    double before = measure("multi-pass", multiPass, iterations);
+    double after = measure("single-pass", singlePass, iterations);
+    printf("speedup      %10.2fx\n", before / after);
+    return 0;
+}
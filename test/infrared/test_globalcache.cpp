@@ -4,7 +4,11 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
 #include "globalcache.h"
+#include "ir_codes.h"
 
 TEST(GlobalCacheTest, parseGcRequest_nullInput) {
     const char *request = "blink";
@@ -118,3 +122,299 @@ TEST(GlobalCacheTest, parseGcRequest_invalidPort) {
     EXPECT_EQ(3, parseGcRequest("stopir,1:a", &msg));
     EXPECT_EQ(3, parseGcRequest("stopir,1:a,2", &msg));
 }
+
+TEST(GlobalCacheTest, parseGcSendIr_nullInput) {
+    GCSendIr sendir;
+    uint16_t code[16];
+    EXPECT_EQ(23, parseGcSendIr(nullptr, &sendir, code, 16));
+    EXPECT_EQ(23, parseGcSendIr("sendir,1:1,1,38000,1,1,342,171", nullptr, code, 16));
+    EXPECT_EQ(23, parseGcSendIr("sendir,1:1,1,38000,1,1,342,171", &sendir, nullptr, 16));
+}
+
+TEST(GlobalCacheTest, parseGcSendIr_full) {
+    GCSendIr sendir;
+    uint16_t code[16];
+    ASSERT_EQ(0, parseGcSendIr("sendir,1:3,4711,38000,2,3,342,171,21,21,21,1517", &sendir, code, 16));
+    EXPECT_EQ(1, sendir.module);
+    EXPECT_EQ(3, sendir.port);
+    EXPECT_EQ(4711, sendir.id);
+    EXPECT_EQ(38000, sendir.frequency);
+    EXPECT_EQ(2, sendir.repeat);
+    EXPECT_EQ(3, sendir.offset);
+    ASSERT_EQ(9, sendir.count);
+    EXPECT_EQ(code, sendir.code);
+    const uint16_t expected[] = {38000, 2, 3, 342, 171, 21, 21, 21, 1517};
+    for (int i = 0; i < 9; i++) {
+        EXPECT_EQ(expected[i], code[i]) << "index " << i;
+    }
+}
+
+TEST(GlobalCacheTest, parseGcSendIr_codeOnly) {
+    GCSendIr sendir;
+    uint16_t code[16];
+    ASSERT_EQ(0, parseGcSendIr("36000,1,1,96,24,48,24", &sendir, code, 16));
+    EXPECT_EQ(0, sendir.module);
+    EXPECT_EQ(0, sendir.port);
+    EXPECT_EQ(0, sendir.id);
+    EXPECT_EQ(36000, sendir.frequency);
+    ASSERT_EQ(7, sendir.count);
+    EXPECT_EQ(24, code[6]);
+}
+
+TEST(GlobalCacheTest, parseGcSendIr_spaces) {
+    GCSendIr sendir;
+    uint16_t code[16];
+    ASSERT_EQ(0, parseGcSendIr("sendir,1:1, 5,38000,1,1, 342,171 ,21, 1517", &sendir, code, 16));
+    EXPECT_EQ(5, sendir.id);
+    EXPECT_EQ(7, sendir.count);
+    EXPECT_EQ(1517, code[6]);
+}
+
+TEST(GlobalCacheTest, parseGcSendIr_sameAsGlobalCacheBufferToArray) {
+    const char *request =
+        "sendir,1:1,1,37000,1,1,128,64,16,16,16,16,16,48,16,16,16,48,16,16,16,48,16,16,16,16,16,48,16,16,16,16,16,48,"
+        "16,48,16,16,16,16,16,16,16,16,16,16,16,16,16,48,16,16,16,48,16,16,16,48,16,16,16,16,16,16,16,48,16,48,16,16,"
+        "16,16,16,16,16,16,16,16,16,16,16,16,16,16,16,48,16,16,16,48,16,16,16,16,16,16,16,16,16,48,16,16,16,16,16,2765";
+    GCSendIr sendir;
+    uint16_t code[256];
+    ASSERT_EQ(0, parseGcSendIr(request, &sendir, code, 256));
+
+    uint16_t  count = 0;
+    uint16_t *expected = globalCacheBufferToArray(request, &count);
+    ASSERT_NE(nullptr, expected);
+    ASSERT_EQ(count, sendir.count);
+    for (int i = 0; i < count; i++) {
+        EXPECT_EQ(expected[i], code[i]) << "index " << i;
+    }
+    free(expected);
+}
+
+TEST(GlobalCacheTest, parseGcSendIr_invalidModule) {
+    GCSendIr sendir;
+    uint16_t code[16];
+    EXPECT_EQ(2, parseGcSendIr("sendir,2:1,1,38000,1,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(2, parseGcSendIr("sendir,0:1,1,38000,1,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(2, parseGcSendIr("sendir,a:1,1,38000,1,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(2, parseGcSendIr("sendir,1,1,38000,1,1,342,171", &sendir, code, 16));
+}
+
+TEST(GlobalCacheTest, parseGcSendIr_invalidPort) {
+    GCSendIr sendir;
+    uint16_t code[16];
+    EXPECT_EQ(0, parseGcSendIr("sendir,1:15,1,38000,1,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(3, parseGcSendIr("sendir,1:0,1,38000,1,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(3, parseGcSendIr("sendir,1:16,1,38000,1,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(3, parseGcSendIr("sendir,1:,1,38000,1,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(3, parseGcSendIr("sendir,1:1", &sendir, code, 16));
+}
+
+TEST(GlobalCacheTest, parseGcSendIr_invalidHeader) {
+    GCSendIr sendir;
+    uint16_t code[16];
+    EXPECT_EQ(4, parseGcSendIr("sendir,1:1,", &sendir, code, 16));
+    EXPECT_EQ(4, parseGcSendIr("sendir,1:1,a,38000,1,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(5, parseGcSendIr("sendir,1:1,1,", &sendir, code, 16));
+    EXPECT_EQ(5, parseGcSendIr("sendir,1:1,1,14999,1,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(5, parseGcSendIr("sendir,1:1,1,455000,1,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(5, parseGcSendIr("foobar", &sendir, code, 16));
+    EXPECT_EQ(6, parseGcSendIr("sendir,1:1,1,38000,0,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(6, parseGcSendIr("sendir,1:1,1,38000,51,1,342,171", &sendir, code, 16));
+    EXPECT_EQ(6, parseGcSendIr("sendir,1:1,1,38000,1", &sendir, code, 16));
+    EXPECT_EQ(7, parseGcSendIr("sendir,1:1,1,38000,1,", &sendir, code, 16));
+}
+
+TEST(GlobalCacheTest, parseGcSendIr_invalidOffset) {
+    GCSendIr sendir;
+    uint16_t code[16];
+    EXPECT_EQ(0, parseGcSendIr("38000,1,3,342,171,21,1517", &sendir, code, 16));
+    EXPECT_EQ(7, parseGcSendIr("38000,1,0,342,171,21,1517", &sendir, code, 16));
+    EXPECT_EQ(7, parseGcSendIr("38000,1,2,342,171,21,1517", &sendir, code, 16));
+    EXPECT_EQ(7, parseGcSendIr("38000,1,5,342,171,21,1517", &sendir, code, 16));
+}
+
+TEST(GlobalCacheTest, parseGcSendIr_invalidTimings) {
+    GCSendIr sendir;
+    uint16_t code[16];
+    EXPECT_EQ(9, parseGcSendIr("38000,1,1,", &sendir, code, 16));
+    EXPECT_EQ(9, parseGcSendIr("38000,1,1,342,171,", &sendir, code, 16));
+    EXPECT_EQ(9, parseGcSendIr("38000,1,1,342,,171", &sendir, code, 16));
+    EXPECT_EQ(9, parseGcSendIr("38000,1,1,342,0", &sendir, code, 16));
+    EXPECT_EQ(9, parseGcSendIr("38000,1,1,342,65536", &sendir, code, 16));
+    EXPECT_EQ(9, parseGcSendIr("38000,1,1,342,171x", &sendir, code, 16));
+    EXPECT_EQ(8, parseGcSendIr("38000,1,1,342", &sendir, code, 16));
+    EXPECT_EQ(10, parseGcSendIr("38000,1,1,342,171,21", &sendir, code, 16));
+}
+
+TEST(GlobalCacheTest, parseGcSendIr_bufferTooSmall) {
+    GCSendIr sendir;
+    uint16_t code[7];
+    EXPECT_EQ(0, parseGcSendIr("38000,1,1,342,171,21,1517", &sendir, code, 7));
+    EXPECT_EQ(20, parseGcSendIr("38000,1,1,342,171,21,21,21,1517", &sendir, code, 7));
+}
+
+TEST(GlobalCacheTest, gcSendIrEqual) {
+    GCSendIr a, b;
+    uint16_t codeA[16], codeB[16];
+    ASSERT_EQ(0, parseGcSendIr("sendir,1:1,1,38000,1,1,342,171", &a, codeA, 16));
+    ASSERT_EQ(0, parseGcSendIr("sendir,1:1,1,38000,1,1,342,171", &b, codeB, 16));
+    EXPECT_TRUE(gcSendIrEqual(&a, &b));
+    ASSERT_EQ(0, parseGcSendIr("sendir,1:1,2,38000,1,1,342,171", &b, codeB, 16));
+    EXPECT_FALSE(gcSendIrEqual(&a, &b));
+    ASSERT_EQ(0, parseGcSendIr("sendir,1:2,1,38000,1,1,342,171", &b, codeB, 16));
+    EXPECT_FALSE(gcSendIrEqual(&a, &b));
+    ASSERT_EQ(0, parseGcSendIr("sendir,1:1,1,38000,1,1,342,172", &b, codeB, 16));
+    EXPECT_FALSE(gcSendIrEqual(&a, &b));
+    EXPECT_FALSE(gcSendIrEqual(&a, nullptr));
+}
+
+TEST(GlobalCacheTest, formatGcSendIr) {
+    const uint16_t durations[] = {9000, 4500, 560, 560, 560, 1690};
+    char           buf[128];
+    const char    *expected = "sendir,1:1,1,38000,1,1,342,171,21,21,21,64";
+    EXPECT_EQ(strlen(expected), formatGcSendIr(durations, 6, 38000, buf, sizeof(buf)));
+    EXPECT_STREQ(expected, buf);
+}
+
+TEST(GlobalCacheTest, formatGcSendIr_trailingGap) {
+    const uint16_t durations[] = {9000, 4500, 560};
+    char           buf[128];
+    ASSERT_GT(formatGcSendIr(durations, 3, 38000, buf, sizeof(buf)), 0);
+    EXPECT_STREQ("sendir,1:1,1,38000,1,1,342,171,21,1520", buf);
+}
+
+TEST(GlobalCacheTest, formatGcSendIr_cycleRange) {
+    const uint16_t durations[] = {1, 65535};
+    char           buf[128];
+    ASSERT_GT(formatGcSendIr(durations, 2, 65535, buf, sizeof(buf)), 0);
+    // at least one cycle, at most the largest iTach value
+    EXPECT_STREQ("sendir,1:1,1,65535,1,1,1,4295", buf);
+}
+
+TEST(GlobalCacheTest, formatGcSendIr_invalidInput) {
+    const uint16_t durations[] = {9000, 4500};
+    char           buf[128];
+    EXPECT_EQ(-1, formatGcSendIr(nullptr, 2, 38000, buf, sizeof(buf)));
+    EXPECT_EQ(-1, formatGcSendIr(durations, 1, 38000, buf, sizeof(buf)));
+    EXPECT_EQ(-1, formatGcSendIr(durations, 2, 14999, buf, sizeof(buf)));
+    EXPECT_EQ(-1, formatGcSendIr(durations, 2, 38000, nullptr, sizeof(buf)));
+}
+
+TEST(GlobalCacheTest, formatGcSendIr_bufferSize) {
+    const uint16_t durations[] = {9000, 4500};
+    const char    *expected = "sendir,1:1,1,38000,1,1,342,171";
+    char           buf[64];
+    size_t         length = strlen(expected);
+    EXPECT_EQ(length, formatGcSendIr(durations, 2, 38000, buf, length + 1));
+    EXPECT_STREQ(expected, buf);
+    EXPECT_EQ(-1, formatGcSendIr(durations, 2, 38000, buf, length));
+    EXPECT_EQ(-1, formatGcSendIr(durations, 2, 38000, buf, 5));
+}
+
+TEST(GlobalCacheTest, formatGcSendIr_parseRoundTrip) {
+    const uint16_t durations[] = {2400, 600, 1200, 600, 600, 600, 1200, 600, 600, 25000};
+    char           buf[128];
+    ASSERT_GT(formatGcSendIr(durations, 10, 40000, buf, sizeof(buf)), 0);
+
+    GCSendIr sendir;
+    uint16_t code[16];
+    ASSERT_EQ(0, parseGcSendIr(buf, &sendir, code, 16));
+    EXPECT_EQ(40000, sendir.frequency);
+    ASSERT_EQ(13, sendir.count);
+    EXPECT_EQ(96, code[3]);
+    EXPECT_EQ(1000, code[12]);
+}
+
+TEST(GlobalCacheTest, isGcBeaconProbe) {
+    EXPECT_TRUE(isGcBeaconProbe("AMXB", 4));
+    EXPECT_TRUE(isGcBeaconProbe("AMXB<-SDKClass=Utility>", 23));
+    // length limits the data, not the NUL terminator
+    EXPECT_TRUE(isGcBeaconProbe("AMXB<-UUID=x>", 4));
+
+    const char *beacon = "AMXB<-UUID=GlobalCache_000C1E000000><-SDKClass=Utility><-Make=GlobalCache>";
+    EXPECT_FALSE(isGcBeaconProbe(beacon, strlen(beacon)));
+    EXPECT_FALSE(isGcBeaconProbe("AMX", 3));
+    EXPECT_FALSE(isGcBeaconProbe("amxb", 4));
+    EXPECT_FALSE(isGcBeaconProbe("getversion", 10));
+    EXPECT_FALSE(isGcBeaconProbe(nullptr, 4));
+}
+
+/// Feed data into the framer and collect all messages, oversized messages are prefixed with `!`.
+static std::vector<std::string> feedFramer(GcRequestFramer *framer, const std::string &data) {
+    std::vector<std::string> messages;
+    size_t                   offset = 0;
+    do {
+        size_t available;
+        char  *buf = framer->rxBuffer(&available);
+        EXPECT_GT(available, 0u);
+        size_t length = std::min(available, data.size() - offset);
+        memcpy(buf, data.data() + offset, length);
+        framer->received(length);
+        offset += length;
+
+        const char             *msg;
+        GcRequestFramer::Result result;
+        while ((result = framer->next(&msg)) != GcRequestFramer::Result::NEED_MORE) {
+            messages.push_back(result == GcRequestFramer::Result::OVERSIZED ? "!" + std::string(msg, 7) : msg);
+        }
+    } while (offset < data.size());
+    return messages;
+}
+
+TEST(GlobalCacheTest, requestFramer_singleMessage) {
+    GcRequestFramer framer;
+    EXPECT_EQ(std::vector<std::string>{"getdevices"}, feedFramer(&framer, "getdevices\r"));
+}
+
+TEST(GlobalCacheTest, requestFramer_pipelinedMessages) {
+    GcRequestFramer framer;
+    auto            messages = feedFramer(&framer, "getversion\rgetdevices\r\nstopir,1:1\r\n");
+    EXPECT_EQ((std::vector<std::string>{"getversion", "getdevices", "stopir,1:1"}), messages);
+    // trailing line feed of the last CRLF terminator is skipped with the next message
+    EXPECT_EQ(std::vector<std::string>{"blink,1"}, feedFramer(&framer, "blink,1\r"));
+}
+
+TEST(GlobalCacheTest, requestFramer_emptyMessagesAreIgnored) {
+    GcRequestFramer framer;
+    EXPECT_EQ(std::vector<std::string>{"getmac"}, feedFramer(&framer, "\r\r\n \t\rgetmac\r\r"));
+}
+
+TEST(GlobalCacheTest, requestFramer_splitMessage) {
+    GcRequestFramer framer;
+    EXPECT_TRUE(feedFramer(&framer, "sendir,1:1,1,38000,").empty());
+    EXPECT_TRUE(feedFramer(&framer, "1,1,20,20").empty());
+    EXPECT_EQ((std::vector<std::string>{"sendir,1:1,1,38000,1,1,20,20", "getversion"}),
+              feedFramer(&framer, "\rgetversion\rgetdev"));
+    EXPECT_EQ(std::vector<std::string>{"getdevices"}, feedFramer(&framer, "ices\r"));
+}
+
+TEST(GlobalCacheTest, requestFramer_maxLengthMessage) {
+    GcRequestFramer framer;
+    std::string     request = "sendir," + std::string(GC_REQUEST_MAX_LENGTH - 7, '1');
+    auto            messages = feedFramer(&framer, request);
+    EXPECT_TRUE(messages.empty());
+    messages = feedFramer(&framer, "\r");
+    ASSERT_EQ(1u, messages.size());
+    EXPECT_EQ(request, messages[0]);
+}
+
+TEST(GlobalCacheTest, requestFramer_oversizedMessageIsDiscarded) {
+    GcRequestFramer framer;
+    std::string     request = "sendir," + std::string(2 * GC_REQUEST_MAX_LENGTH, '1');
+    // reported once, the rest of the message up to the terminator is skipped
+    EXPECT_EQ((std::vector<std::string>{"!sendir,", "getversion"}), feedFramer(&framer, request + "\rgetversion\r"));
+}
+
+TEST(GlobalCacheTest, requestFramer_oversizedMessageAfterCrLf) {
+    GcRequestFramer framer;
+    EXPECT_EQ(std::vector<std::string>{"getversion"}, feedFramer(&framer, "getversion\r"));
+    // the line feed of the previous CRLF terminator is not part of the oversized message
+    std::string request = "\nsendir," + std::string(GC_REQUEST_MAX_LENGTH, '1');
+    EXPECT_EQ(std::vector<std::string>{"!sendir,"}, feedFramer(&framer, request));
+    EXPECT_EQ(std::vector<std::string>{"getdevices"}, feedFramer(&framer, "1\rgetdevices\r"));
+}
+
+TEST(GlobalCacheTest, requestFramer_oversizedOtherMessage) {
+    GcRequestFramer framer;
+    auto            messages = feedFramer(&framer, std::string(GC_REQUEST_MAX_LENGTH + 1, 'x') + "\r");
+    EXPECT_EQ(std::vector<std::string>{"!xxxxxxx"}, messages);
+}
@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 
 #include "ir_codes.h"
+#include "mem_tag.h"
 
 TEST(IrCodesTest, ParseUint32WithNullInput) {
     int error;
@@ -63,6 +64,25 @@ TEST(IrCodesTest, BuildIRHexData) {
     EXPECT_EQ(1, data.repeat);
 }
 
+TEST(IrCodesTest, BuildIRHexDataFromCString) {
+    struct IRHexData data;
+    EXPECT_TRUE(buildIRHexData("17;0x2A4C0A8A0282FFFF;64;0", &data));
+    EXPECT_EQ(17, data.protocol);
+    EXPECT_EQ(0x2A4C0A8A0282FFFF, data.command);
+    EXPECT_EQ(64, data.bits);
+    EXPECT_EQ(0, data.repeat);
+}
+
+TEST(IrCodesTest, BuildIRHexDataTooManyFields) {
+    struct IRHexData data;
+    EXPECT_FALSE(buildIRHexData("4;0x640C;15;1;2", &data));
+}
+
+TEST(IrCodesTest, BuildIRHexDataFieldTooLong) {
+    struct IRHexData data;
+    EXPECT_FALSE(buildIRHexData("4;0x00000000000000000000000000000001;15;1", &data));
+}
+
 TEST(IrCodesTest, BuildIRHexDataEmptyString) {
     struct IRHexData data;
     std::string      msg;
@@ -181,7 +201,7 @@ TEST(IrCodesTest, ProntoBufferToArrayMinLength) {
     auto     buffer = prontoBufferToArray("0000 0066 0000 0001 0050 0051", ' ', &codeCount);
     EXPECT_EQ(6, codeCount);
     EXPECT_NE(buffer, nullptr);
-    free(buffer);
+    mem_tag_free(MEM_TAG_IR, buffer);
 }
 
 TEST(IrCodesTest, ProntoBufferToArray) {
@@ -194,7 +214,54 @@ TEST(IrCodesTest, ProntoBufferToArray) {
         ',', &codeCount, &memError);
     EXPECT_EQ(0, memError);
     EXPECT_NE(buffer, nullptr);
-    free(buffer);
+    mem_tag_free(MEM_TAG_IR, buffer);
+}
+
+TEST(IrCodesTest, ParseProntoCode) {
+    uint16_t   buffer[8];
+    ProntoCode pronto = {};
+    ASSERT_TRUE(parseProntoCode("0000 006D 0000 0001 0050 0051", 0, buffer, 8, &pronto));
+    EXPECT_EQ(buffer, pronto.code);
+    EXPECT_EQ(6, pronto.count);
+    EXPECT_EQ(0x51, buffer[5]);
+    EXPECT_EQ(prontoFrequency(buffer, 6), pronto.frequency);
+    EXPECT_EQ(4, pronto.sequences.repeatStart);
+    EXPECT_EQ(2, pronto.sequences.repeatLength);
+}
+
+TEST(IrCodesTest, ParseProntoCodeDetectsCommaSeparator) {
+    uint16_t   buffer[8];
+    ProntoCode pronto = {};
+    ASSERT_TRUE(parseProntoCode("0000,006D,0000,0001,0050,0051", 0, buffer, 8, &pronto));
+    EXPECT_EQ(6, pronto.count);
+    EXPECT_EQ(0x50, buffer[4]);
+}
+
+TEST(IrCodesTest, ParseProntoCodeBufferTooSmall) {
+    uint16_t   buffer[8];
+    ProntoCode pronto = {};
+    EXPECT_FALSE(parseProntoCode("0000 006D 0000 0001 0050 0051", 0, buffer, 5, &pronto));
+    EXPECT_TRUE(parseProntoCode("0000 006D 0000 0001 0050 0051", 0, buffer, 6, &pronto));
+}
+
+TEST(IrCodesTest, ParseProntoCodeInvalid) {
+    uint16_t   buffer[8];
+    ProntoCode pronto = {};
+    EXPECT_FALSE(parseProntoCode("", 0, buffer, 8, &pronto));
+    EXPECT_FALSE(parseProntoCode("0000 006D 0000 0001 0050", 0, buffer, 8, &pronto));
+    EXPECT_FALSE(parseProntoCode("0000 006D 0000 0002 0050 0051", 0, buffer, 8, &pronto));
+    EXPECT_FALSE(parseProntoCode("0100 006D 0000 0001 0050 0051", 0, buffer, 8, &pronto));
+}
+
+TEST(IrCodesTest, ProntoCodeEqual) {
+    uint16_t   buffer1[8], buffer2[8];
+    ProntoCode a = {}, b = {};
+    ASSERT_TRUE(parseProntoCode("0000 006D 0000 0001 0050 0051", 0, buffer1, 8, &a));
+    ASSERT_TRUE(parseProntoCode("0000,006d,0000,0001,0050,0051", 0, buffer2, 8, &b));
+    EXPECT_TRUE(prontoCodeEqual(&a, &b));
+    ASSERT_TRUE(parseProntoCode("0000 006D 0000 0001 0050 0052", 0, buffer2, 8, &b));
+    EXPECT_FALSE(prontoCodeEqual(&a, &b));
+    EXPECT_FALSE(prontoCodeEqual(&a, nullptr));
 }
 
 TEST(IrCodesTest, GlobalCacheBufferToArrayEmptyInput) {
@@ -215,7 +282,7 @@ TEST(IrCodesTest, GlobalCacheBufferToArrayShort) {
     EXPECT_EQ(75, codeCount);
     EXPECT_EQ(38000, buffer[0]);
     EXPECT_EQ(3678, buffer[codeCount - 1]);
-    free(buffer);
+    mem_tag_free(MEM_TAG_IR, buffer);
 }
 
 TEST(IrCodesTest, GlobalCacheBufferToArrayFull) {
@@ -231,5 +298,234 @@ TEST(IrCodesTest, GlobalCacheBufferToArrayFull) {
     EXPECT_EQ(75, codeCount);
     EXPECT_EQ(38000, buffer[0]);
     EXPECT_EQ(3678, buffer[codeCount - 1]);
-    free(buffer);
+    mem_tag_free(MEM_TAG_IR, buffer);
+}
+
+TEST(IrCodesTest, ProntoToTimings) {
+    // 38 kHz, 1 intro pair, 1 repeat pair
+    uint16_t  code[] = {0x0000, 0x006D, 0x0001, 0x0001, 0x0010, 0x0020, 0x0030, 0x0040};
+    IrTimings timings;
+
+    ASSERT_TRUE(prontoToTimings(code, 8, 2, &timings));
+    EXPECT_EQ(38028, timings.frequency);
+    ASSERT_EQ(6, timings.count);
+    uint32_t expected[] = {420, 841, 1262, 1683, 1262, 1683};
+    for (int i = 0; i < 6; i++) {
+        EXPECT_EQ(expected[i], timings.durations[i]) << "index " << i;
+    }
+    freeTimings(&timings);
+    EXPECT_EQ(nullptr, timings.durations);
+}
+
+TEST(IrCodesTest, ProntoToTimingsWithoutIntroSendsRepeatOnce) {
+    uint16_t  code[] = {0x0000, 0x006D, 0x0000, 0x0001, 0x0010, 0x0020};
+    IrTimings timings;
+
+    ASSERT_TRUE(prontoToTimings(code, 6, 0, &timings));
+    ASSERT_EQ(2, timings.count);
+    EXPECT_EQ(420, timings.durations[0]);
+    EXPECT_EQ(841, timings.durations[1]);
+    freeTimings(&timings);
+}
+
+TEST(IrCodesTest, ProntoToTimingsInvalid) {
+    uint16_t  notRaw[] = {0x0100, 0x006D, 0x0000, 0x0001, 0x0010, 0x0020};
+    uint16_t  tooShort[] = {0x0000, 0x006D, 0x0001, 0x0001, 0x0010, 0x0020};
+    uint16_t  code[] = {0x0000, 0x006D, 0x0000, 0x0001, 0x0010, 0x0020};
+    IrTimings timings;
+
+    EXPECT_FALSE(prontoToTimings(notRaw, 6, 0, &timings));
+    EXPECT_FALSE(prontoToTimings(tooShort, 6, 0, &timings));
+    EXPECT_FALSE(prontoToTimings(code, 6, IR_TIMINGS_MAX_DURATIONS, &timings));
+}
+
+TEST(IrCodesTest, GlobalCacheToTimings) {
+    // 40 kHz, 2 emits, repeat from 3rd duration. Last mark is below the minimum of 80us.
+    uint16_t  code[] = {40000, 2, 3, 10, 20, 30, 40, 1};
+    IrTimings timings;
+
+    ASSERT_TRUE(globalCacheToTimings(code, 8, &timings));
+    EXPECT_EQ(40000, timings.frequency);
+    // the repeat starts with a mark: merged with the last mark of the first emit
+    uint32_t expected[] = {250, 500, 750, 1000, 830, 1000, 80};
+    ASSERT_EQ(7, timings.count);
+    for (int i = 0; i < 7; i++) {
+        EXPECT_EQ(expected[i], timings.durations[i]) << "index " << i;
+    }
+    freeTimings(&timings);
+}
+
+TEST(IrCodesTest, GlobalCacheToTimingsRepeatStartingWithSpace) {
+    uint16_t  code[] = {40000, 2, 2, 10, 20, 30, 40};
+    IrTimings timings;
+
+    ASSERT_TRUE(globalCacheToTimings(code, 7, &timings));
+    uint32_t expected[] = {250, 500, 750, 1000 + 500, 750, 1000};
+    ASSERT_EQ(6, timings.count);
+    for (int i = 0; i < 6; i++) {
+        EXPECT_EQ(expected[i], timings.durations[i]) << "index " << i;
+    }
+    freeTimings(&timings);
+}
+
+TEST(IrCodesTest, GlobalCacheToTimingsInvalid) {
+    uint16_t  noFrequency[] = {0, 1, 1, 10, 20};
+    uint16_t  noOffset[] = {40000, 1, 0, 10, 20};
+    uint16_t  offsetTooBig[] = {40000, 1, 3, 10, 20};
+    uint16_t  noEmits[] = {40000, 0, 1, 10, 20};
+    IrTimings timings;
+
+    EXPECT_FALSE(globalCacheToTimings(noFrequency, 5, &timings));
+    EXPECT_FALSE(globalCacheToTimings(noOffset, 5, &timings));
+    EXPECT_FALSE(globalCacheToTimings(offsetTooBig, 5, &timings));
+    EXPECT_FALSE(globalCacheToTimings(noEmits, 5, &timings));
+}
+
+TEST(IrCodesTest, ProntoFrequency) {
+    uint16_t code36[] = {0x0000, 0x0073};
+    uint16_t code38[] = {0x0000, 0x006D};
+    uint16_t code40[] = {0x0000, 0x0066};
+    uint16_t code455[] = {0x0000, 0x0009};
+    uint16_t invalid[] = {0x0000, 0x0000};
+
+    EXPECT_EQ(36044, prontoFrequency(code36, 2));
+    EXPECT_EQ(38028, prontoFrequency(code38, 2));
+    EXPECT_EQ(40638, prontoFrequency(code40, 2));
+    EXPECT_EQ(460571, prontoFrequency(code455, 2));
+    EXPECT_EQ(0, prontoFrequency(invalid, 2));
+    EXPECT_EQ(0, prontoFrequency(code38, 1));
+    EXPECT_EQ(0, prontoFrequency(nullptr, 2));
+}
+
+TEST(IrCodesTest, ProntoBufferToArrayFrequency) {
+    uint16_t codeCount;
+    uint32_t frequency = 0;
+    auto     buffer = prontoBufferToArray("0000 0073 0000 0001 0050 0051", ' ', &codeCount, nullptr, &frequency);
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(36044, frequency);
+    mem_tag_free(MEM_TAG_IR, buffer);
+}
+
+TEST(IrCodesTest, GlobalCacheFrequency) {
+    uint16_t code[] = {56000, 1, 1, 10, 20};
+
+    EXPECT_EQ(56000, globalCacheFrequency(code, 5));
+    EXPECT_EQ(0, globalCacheFrequency(code, 0));
+    EXPECT_EQ(0, globalCacheFrequency(nullptr, 5));
+}
+
+TEST(IrCodesTest, GlobalCacheBufferToArrayFrequency) {
+    uint16_t codeCount;
+    uint32_t frequency = 0;
+    auto     buffer =
+        globalCacheBufferToArray("sendir,1:1,1,56000,1,1,340,171,21,21,21,3678", &codeCount, nullptr, &frequency);
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(56000, frequency);
+    mem_tag_free(MEM_TAG_IR, buffer);
+}
+
+TEST(IrCodesTest, CalibrationCache) {
+    IrCalibrationCache cache;
+    int8_t             offset = 0;
+
+    EXPECT_FALSE(cache.get(38000, &offset));
+    cache.put(38000, -5);
+    ASSERT_TRUE(cache.get(38000, &offset));
+    EXPECT_EQ(-5, offset);
+    // same 1 kHz group
+    ASSERT_TRUE(cache.get(38028, &offset));
+    EXPECT_EQ(-5, offset);
+    EXPECT_FALSE(cache.get(36044, &offset));
+
+    // update
+    cache.put(38028, -4);
+    ASSERT_TRUE(cache.get(38000, &offset));
+    EXPECT_EQ(-4, offset);
+    EXPECT_EQ(1, cache.size());
+}
+
+TEST(IrCodesTest, ProtocolFrequency) {
+    EXPECT_EQ(38000, protocolFrequency(NEC));
+    EXPECT_EQ(38000, protocolFrequency(SAMSUNG));
+    EXPECT_EQ(36000, protocolFrequency(RC5));
+    EXPECT_EQ(36000, protocolFrequency(RC6));
+    EXPECT_EQ(40000, protocolFrequency(SONY));
+    EXPECT_EQ(36700, protocolFrequency(PANASONIC));
+}
+
+TEST(IrCodesTest, CalibrationCacheReplacesOldestEntry) {
+    IrCalibrationCache cache;
+    int8_t             offset;
+
+    for (int i = 0; i < IrCalibrationCache::CAPACITY; i++) {
+        cache.put(30000 + i * 1000, i);
+    }
+    EXPECT_EQ(IrCalibrationCache::CAPACITY, cache.size());
+    cache.put(56000, 10);
+    EXPECT_EQ(IrCalibrationCache::CAPACITY, cache.size());
+    EXPECT_FALSE(cache.get(30000, &offset));
+    ASSERT_TRUE(cache.get(31000, &offset));
+    EXPECT_EQ(1, offset);
+    ASSERT_TRUE(cache.get(56000, &offset));
+    EXPECT_EQ(10, offset);
+}
+
+TEST(IrCodesTest, ProntoBufferToArraySequences) {
+    uint16_t        codeCount;
+    ProntoSequences seq;
+    auto            buffer = prontoBufferToArray("0000 006D 0002 0001 0010 0020 0030 0040 0050 0060", ' ', &codeCount,
+                                                 nullptr, nullptr, &seq);
+    ASSERT_NE(nullptr, buffer);
+    EXPECT_EQ(4, seq.introStart);
+    EXPECT_EQ(4, seq.introLength);
+    EXPECT_EQ(8, seq.repeatStart);
+    EXPECT_EQ(2, seq.repeatLength);
+    mem_tag_free(MEM_TAG_IR, buffer);
+}
+
+TEST(IrCodesTest, ProntoSequencesInvalid) {
+    uint16_t        notRaw[] = {0x0100, 0x006D, 0x0000, 0x0001, 0x0010, 0x0020};
+    uint16_t        introTooLong[] = {0x0000, 0x006D, 0x0002, 0x0000, 0x0010, 0x0020};
+    uint16_t        repeatTooLong[] = {0x0000, 0x006D, 0x0001, 0x0001, 0x0010, 0x0020};
+    ProntoSequences seq;
+
+    EXPECT_FALSE(prontoSequences(notRaw, 6, &seq));
+    EXPECT_FALSE(prontoSequences(introTooLong, 6, &seq));
+    EXPECT_FALSE(prontoSequences(repeatTooLong, 6, &seq));
+    EXPECT_FALSE(prontoSequences(nullptr, 6, &seq));
+}
+
+TEST(IrCodesTest, ProntoSequenceToTimings) {
+    // NEC style: long intro frame, short repeat burst
+    uint16_t  code[] = {0x0000, 0x006D, 0x0002, 0x0001, 0x0010, 0x0020, 0x0030, 0x0040, 0x0001, 0x0002};
+    IrTimings intro;
+    IrTimings repeat;
+
+    ASSERT_TRUE(prontoSequenceToTimings(code, 10, false, &intro));
+    ASSERT_TRUE(prontoSequenceToTimings(code, 10, true, &repeat));
+    EXPECT_EQ(38028, intro.frequency);
+    EXPECT_EQ(38028, repeat.frequency);
+    ASSERT_EQ(4, intro.count);
+    EXPECT_EQ(420, intro.durations[0]);
+    EXPECT_EQ(1683, intro.durations[3]);
+    ASSERT_EQ(2, repeat.count);
+    EXPECT_EQ(26, repeat.durations[0]);
+    EXPECT_EQ(52, repeat.durations[1]);
+    freeTimings(&intro);
+    freeTimings(&repeat);
+}
+
+TEST(IrCodesTest, ProntoSequenceToTimingsWithoutIntro) {
+    uint16_t  code[] = {0x0000, 0x006D, 0x0000, 0x0001, 0x0010, 0x0020};
+    uint16_t  introOnly[] = {0x0000, 0x006D, 0x0001, 0x0000, 0x0010, 0x0020};
+    IrTimings timings;
+
+    // intro is the implied first repeat sequence
+    ASSERT_TRUE(prontoSequenceToTimings(code, 6, false, &timings));
+    ASSERT_EQ(2, timings.count);
+    EXPECT_EQ(420, timings.durations[0]);
+    freeTimings(&timings);
+
+    EXPECT_FALSE(prontoSequenceToTimings(introOnly, 6, true, &timings));
+    freeTimings(&timings);
 }
@@ -0,0 +1,205 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "ir_compact.h"
+
+// Tolerance of IRrecv for matching timings
+static const uint32_t kTolerancePercent = 25;
+
+static void addPair(std::vector<uint32_t> *durations, uint32_t mark, uint32_t space) {
+    durations->push_back(mark);
+    durations->push_back(space);
+}
+
+// NEC capture with receiver jitter: frame, followed by two repeat codes. Ends with the last mark.
+static std::vector<uint32_t> necCapture() {
+    std::vector<uint32_t> d;
+    uint32_t              data = 0x20DF10EF;
+    addPair(&d, 9020, 4470);
+    for (int i = 0; i < 32; i++) {
+        int jitter = (i % 3 - 1) * 30;
+        addPair(&d, 580 + jitter, (data >> (31 - i)) & 1 ? 1670 + jitter : 540 + jitter);
+    }
+    addPair(&d, 600, 39950);
+    addPair(&d, 8990, 2230);
+    addPair(&d, 590, 96100);
+    d.push_back(9010);
+    d.push_back(2250);
+    d.push_back(600);
+    return d;
+}
+
+// Sony SIRC 12 bit: the whole frame is sent three times.
+static std::vector<uint32_t> sonyCapture() {
+    std::vector<uint32_t> d;
+    uint16_t              data = 0x0A90;
+    for (int frame = 0; frame < 3; frame++) {
+        addPair(&d, 2420, 580);
+        for (int i = 0; i < 12; i++) {
+            addPair(&d, (data >> (11 - i)) & 1 ? 1210 : 610, i == 11 ? 25000 : 590);
+        }
+    }
+    // capture ends with the last mark
+    d.pop_back();
+    return d;
+}
+
+// Compare an expanded waveform with the captured one. The trailing capture gap is not part of the capture.
+static void expectEquivalent(const std::vector<uint32_t> &captured, const IrTimings &timings) {
+    ASSERT_GE(timings.count, captured.size());
+    for (size_t i = 0; i < captured.size(); i++) {
+        uint32_t diff = timings.durations[i] > captured[i] ? timings.durations[i] - captured[i]
+                                                           : captured[i] - timings.durations[i];
+        EXPECT_LE(diff * 100, captured[i] * kTolerancePercent)
+            << "index " << i << ": expected " << captured[i] << ", got " << timings.durations[i];
+    }
+}
+
+static std::string format(const IrCompactCode &code) {
+    char buf[512];
+    EXPECT_GT(irCompactFormat(&code, buf, sizeof(buf)), 0);
+    return buf;
+}
+
+TEST(IrCompactTest, NecSplitsIntroAndRepeat) {
+    auto          captured = necCapture();
+    IrCompactCode code;
+
+    ASSERT_TRUE(irCompactFromTimings(captured.data(), captured.size(), 38000, &code));
+    EXPECT_NEAR(560, code.unit, 30);
+    EXPECT_EQ(34, code.introLength);
+    EXPECT_EQ(2, code.repeatLength);
+    EXPECT_EQ(2, code.repeatCount);
+    EXPECT_EQ(6, code.pairCount);
+
+    IrTimings timings;
+    ASSERT_TRUE(irCompactToTimings(&code, code.repeatCount, &timings));
+    EXPECT_EQ(38000, timings.frequency);
+    expectEquivalent(captured, timings);
+    freeTimings(&timings);
+}
+
+TEST(IrCompactTest, SonyWithoutIntro) {
+    auto          captured = sonyCapture();
+    IrCompactCode code;
+
+    ASSERT_TRUE(irCompactFromTimings(captured.data(), captured.size(), 40000, &code));
+    EXPECT_NEAR(600, code.unit, 30);
+    EXPECT_EQ(0, code.introLength);
+    EXPECT_EQ(13, code.repeatLength);
+    EXPECT_EQ(3, code.repeatCount);
+
+    // without intro the repeat sequence is sent an additional time
+    IrTimings timings;
+    ASSERT_TRUE(irCompactToTimings(&code, code.repeatCount - 1, &timings));
+    EXPECT_EQ(captured.size() + 1, timings.count);
+    expectEquivalent(captured, timings);
+    freeTimings(&timings);
+}
+
+TEST(IrCompactTest, SingleFrameWithoutRepeat) {
+    std::vector<uint32_t> captured = {3000, 1000, 1000, 1000, 1000, 2000, 1000};
+    IrCompactCode         code;
+
+    ASSERT_TRUE(irCompactFromTimings(captured.data(), captured.size(), 38000, &code));
+    EXPECT_EQ(1000, code.unit);
+    EXPECT_EQ(4, code.introLength);
+    EXPECT_EQ(0, code.repeatLength);
+    EXPECT_EQ("UCC1;38000;1000;3.1,1.1,1.2,1.40;ABCD;", format(code));
+
+    // the intro sequence is the repeat frame
+    IrTimings timings;
+    ASSERT_TRUE(irCompactSequenceToTimings(&code, true, &timings));
+    EXPECT_EQ(8, timings.count);
+    freeTimings(&timings);
+}
+
+TEST(IrCompactTest, UsesFractionOfShortestDuration) {
+    // 1:2.5 ratio can't be quantized with the shortest duration
+    std::vector<uint32_t> captured = {1000, 400, 400, 1000, 400, 400, 1000};
+    IrCompactCode         code;
+
+    ASSERT_TRUE(irCompactFromTimings(captured.data(), captured.size(), 38000, &code));
+    EXPECT_EQ(200, code.unit);
+    EXPECT_EQ(5, code.pairs[0].mark);
+    EXPECT_EQ(2, code.pairs[0].space);
+}
+
+TEST(IrCompactTest, FormatRunLengthEncoded) {
+    std::vector<uint32_t> captured;
+    addPair(&captured, 2000, 1000);
+    for (int i = 0; i < 8; i++) {
+        addPair(&captured, 500, 500);
+    }
+    addPair(&captured, 500, 1500);
+    captured.push_back(500);
+    IrCompactCode code;
+
+    ASSERT_TRUE(irCompactFromTimings(captured.data(), captured.size(), 36000, &code));
+    EXPECT_EQ("UCC1;36000;500;4.2,1.1,1.3,1.80;AB8CD;", format(code));
+}
+
+TEST(IrCompactTest, NecIsSmallerThanPronto) {
+    auto          captured = necCapture();
+    IrCompactCode code;
+
+    ASSERT_TRUE(irCompactFromTimings(captured.data(), captured.size(), 38000, &code));
+    std::string compact = format(code);
+    // PRONTO: 4 header words and 36 pairs, 5 characters per word
+    EXPECT_LT(compact.size() * 3, (4 + 36 * 2) * 5);
+}
+
+TEST(IrCompactTest, ParseRoundTrip) {
+    auto          captured = necCapture();
+    IrCompactCode code;
+    IrCompactCode parsed;
+
+    ASSERT_TRUE(irCompactFromTimings(captured.data(), captured.size(), 38000, &code));
+    std::string compact = format(code);
+    ASSERT_TRUE(irCompactParse(compact.c_str(), &parsed));
+    EXPECT_EQ(compact, format(parsed));
+    EXPECT_EQ(code.introLength, parsed.introLength);
+    EXPECT_EQ(code.repeatLength, parsed.repeatLength);
+
+    IrTimings intro;
+    ASSERT_TRUE(irCompactSequenceToTimings(&parsed, false, &intro));
+    EXPECT_EQ(68, intro.count);
+    freeTimings(&intro);
+}
+
+TEST(IrCompactTest, ParseInvalid) {
+    IrCompactCode code;
+
+    EXPECT_FALSE(irCompactParse(nullptr, &code));
+    EXPECT_FALSE(irCompactParse("", &code));
+    EXPECT_FALSE(irCompactParse("UCC2;38000;500;1.1;A;", &code));
+    EXPECT_FALSE(irCompactParse("UCC1;38000;500;1.1;A", &code));
+    EXPECT_FALSE(irCompactParse("UCC1;38000;500;1.1;B;", &code));
+    EXPECT_FALSE(irCompactParse("UCC1;38000;500;1.1;A1;", &code));
+    EXPECT_FALSE(irCompactParse("UCC1;38000;500;1.0;A;", &code));
+    EXPECT_FALSE(irCompactParse("UCC1;38000;10;1.1;A;", &code));
+    EXPECT_FALSE(irCompactParse("UCC1;0;500;1.1;A;", &code));
+    EXPECT_FALSE(irCompactParse("UCC1;38000;500;1.1;;", &code));
+    EXPECT_FALSE(irCompactParse("UCC1;38000;500;1.1;A513;", &code));
+    EXPECT_FALSE(irCompactParse("UCC1;38000;500;1.1;A;A ", &code));
+
+    EXPECT_TRUE(irCompactParse("UCC1;38000;500;1.1;A;", &code));
+    EXPECT_TRUE(irCompactParse("UCC1;38000;500;1.1;;A", &code));
+    EXPECT_TRUE(irCompactParse("UCC1;38000;500;1.1,2.2;A512;", &code));
+}
+
+TEST(IrCompactTest, TooManyPairs) {
+    std::vector<uint32_t> captured;
+    for (int i = 0; i < IR_COMPACT_MAX_PAIRS + 1; i++) {
+        addPair(&captured, 500 * (i % 5 + 1), 500 * (i / 5 + 1));
+    }
+    IrCompactCode code;
+
+    EXPECT_FALSE(irCompactFromTimings(captured.data(), captured.size(), 38000, &code));
+}
@@ -0,0 +1,209 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "ir_peer_protocol.h"
+
+static const char *kPronto = "0000 006D 0002 0000 0157 00AC 0015 0689";
+static const char *kGroup = "living";
+static const char *kToken = "0000";
+/// Size of a send frame without the IR code with group `kGroup`.
+static const int kSendFrameSize = IR_PEER_HEADER_SIZE + IR_PEER_SEND_SIZE + 6 + IR_PEER_TAG_SIZE;
+
+TEST(IrPeerProtocolTest, HexRoundTrip) {
+    uint8_t buf[128];
+    int     length =
+        irPeerEncodeSend(0x1234, kGroup, "4;0x640C;15;0", "hex", 2, IR_PEER_OUTPUT_EXT1, kToken, buf, sizeof(buf));
+    ASSERT_EQ(kSendFrameSize + 13, length);
+
+    IrPeerHeader header;
+    ASSERT_TRUE(irPeerParseHeader(buf, &header));
+    EXPECT_EQ(IrPeerFrameType::SEND, header.type);
+    EXPECT_EQ(0x1234, header.sequence);
+    EXPECT_EQ(length - IR_PEER_HEADER_SIZE, header.length);
+    EXPECT_TRUE(irPeerVerifySend(buf, header, kToken));
+
+    IrPeerSend send;
+    char       code[64];
+    ASSERT_TRUE(irPeerDecodeSend(buf + IR_PEER_HEADER_SIZE, header.length, &send, code, sizeof(code)));
+    EXPECT_STREQ(kGroup, send.group);
+    EXPECT_STREQ("hex", send.format);
+    EXPECT_EQ(IR_PEER_OUTPUT_EXT1, send.outputs);
+    EXPECT_EQ(2, send.repeat);
+    EXPECT_STREQ("4;0x640C;15;0", code);
+}
+
+TEST(IrPeerProtocolTest, ProntoIsPackedAsWords) {
+    uint8_t buf[128];
+    int length = irPeerEncodeSend(1, kGroup, kPronto, "pronto", 0, IR_PEER_OUTPUT_INT_SIDE, kToken, buf, sizeof(buf));
+    // 8 words instead of 39 characters
+    ASSERT_EQ(kSendFrameSize + 16, length);
+
+    IrPeerHeader header;
+    IrPeerSend   send;
+    char         code[64];
+    ASSERT_TRUE(irPeerParseHeader(buf, &header));
+    ASSERT_TRUE(irPeerDecodeSend(buf + IR_PEER_HEADER_SIZE, header.length, &send, code, sizeof(code)));
+    EXPECT_STREQ("pronto", send.format);
+    EXPECT_STREQ(kPronto, code);
+
+    // exact fit: 8 words with 4 digits, 7 separators and NUL terminator
+    EXPECT_TRUE(irPeerDecodeSend(buf + IR_PEER_HEADER_SIZE, header.length, &send, code, 40));
+    EXPECT_FALSE(irPeerDecodeSend(buf + IR_PEER_HEADER_SIZE, header.length, &send, code, 39));
+}
+
+TEST(IrPeerProtocolTest, ProntoLowerCaseAndExtraWhitespace) {
+    uint8_t buf[128];
+    int     length =
+        irPeerEncodeSend(1, kGroup, " 0000  006d 0001 0000\t0157 00ac ", "pronto", 0, 0, kToken, buf, sizeof(buf));
+    ASSERT_GT(length, 0);
+
+    IrPeerHeader header;
+    IrPeerSend   send;
+    char         code[64];
+    ASSERT_TRUE(irPeerParseHeader(buf, &header));
+    ASSERT_TRUE(irPeerDecodeSend(buf + IR_PEER_HEADER_SIZE, header.length, &send, code, sizeof(code)));
+    EXPECT_STREQ("0000 006D 0001 0000 0157 00AC", code);
+}
+
+TEST(IrPeerProtocolTest, EncodeInvalid) {
+    uint8_t buf[64];
+    EXPECT_EQ(-1, irPeerEncodeSend(1, kGroup, "0000 006D", "raw", 0, 0, kToken, buf, sizeof(buf)));
+    EXPECT_EQ(-1, irPeerEncodeSend(1, kGroup, "0000 0G6D", "pronto", 0, 0, kToken, buf, sizeof(buf)));
+    EXPECT_EQ(-1, irPeerEncodeSend(1, kGroup, "0000 1006D", "pronto", 0, 0, kToken, buf, sizeof(buf)));
+    EXPECT_EQ(-1, irPeerEncodeSend(1, kGroup, "", "hex", 0, 0, kToken, buf, sizeof(buf)));
+    EXPECT_EQ(-1, irPeerEncodeSend(1, kGroup, nullptr, "hex", 0, 0, kToken, buf, sizeof(buf)));
+    EXPECT_EQ(-1, irPeerEncodeSend(1, kGroup, "4;0x640C;15;0", "hex", 0, 0, nullptr, buf, sizeof(buf)));
+    // invalid group
+    EXPECT_EQ(-1, irPeerEncodeSend(1, "", "4;0x640C;15;0", "hex", 0, 0, kToken, buf, sizeof(buf)));
+    EXPECT_EQ(-1, irPeerEncodeSend(1, nullptr, "4;0x640C;15;0", "hex", 0, 0, kToken, buf, sizeof(buf)));
+    EXPECT_EQ(-1, irPeerEncodeSend(1, std::string(IR_PEER_GROUP_MAX_LENGTH + 1, 'g').c_str(), "4;0x640C;15;0", "hex",
+                                   0, 0, kToken, buf, sizeof(buf)));
+    // buffer too small
+    EXPECT_EQ(-1, irPeerEncodeSend(1, kGroup, "4;0x640C;15;0;0x640C;15;0", "hex", 0, 0, kToken, buf, kSendFrameSize));
+    EXPECT_EQ(-1, irPeerEncodeResult(1, 200, buf, IR_PEER_HEADER_SIZE + 1));
+}
+
+TEST(IrPeerProtocolTest, VerifyRejectsWrongTokenAndModifiedFrame) {
+    uint8_t buf[128];
+    int     length = irPeerEncodeSend(7, kGroup, "4;0x640C;15;0", "hex", 1, 0, kToken, buf, sizeof(buf));
+    ASSERT_GT(length, 0);
+
+    IrPeerHeader header;
+    ASSERT_TRUE(irPeerParseHeader(buf, &header));
+    EXPECT_TRUE(irPeerVerifySend(buf, header, kToken));
+    EXPECT_FALSE(irPeerVerifySend(buf, header, "1234"));
+    EXPECT_FALSE(irPeerVerifySend(buf, header, ""));
+
+    // every byte of the header and payload is authenticated
+    for (int i = 0; i < length; i++) {
+        buf[i] ^= 0x01;
+        IrPeerHeader modified;
+        EXPECT_FALSE(irPeerParseHeader(buf, &modified) && modified.length == header.length &&
+                     irPeerVerifySend(buf, modified, kToken))
+            << "byte " << i;
+        buf[i] ^= 0x01;
+    }
+
+    // tag missing
+    header.length = IR_PEER_SEND_SIZE + IR_PEER_TAG_SIZE - 1;
+    EXPECT_FALSE(irPeerVerifySend(buf, header, kToken));
+}
+
+TEST(IrPeerProtocolTest, DecodeOtherGroup) {
+    uint8_t buf[128];
+    int     length = irPeerEncodeSend(1, "kitchen", "4;0x640C;15;0", "hex", 0, 0, kToken, buf, sizeof(buf));
+    ASSERT_GT(length, 0);
+
+    IrPeerHeader header;
+    IrPeerSend   send;
+    char         code[64];
+    ASSERT_TRUE(irPeerParseHeader(buf, &header));
+    ASSERT_TRUE(irPeerDecodeSend(buf + IR_PEER_HEADER_SIZE, header.length, &send, code, sizeof(code)));
+    EXPECT_STREQ("kitchen", send.group);
+    EXPECT_STRNE(kGroup, send.group);
+}
+
+TEST(IrPeerProtocolTest, ResultRoundTrip) {
+    uint8_t buf[16];
+    ASSERT_EQ(IR_PEER_HEADER_SIZE + 2, irPeerEncodeResult(0xBEEF, 429, buf, sizeof(buf)));
+
+    IrPeerHeader header;
+    uint16_t     status = 0;
+    ASSERT_TRUE(irPeerParseHeader(buf, &header));
+    EXPECT_EQ(IrPeerFrameType::RESULT, header.type);
+    EXPECT_EQ(0xBEEF, header.sequence);
+    ASSERT_TRUE(irPeerDecodeResult(buf + IR_PEER_HEADER_SIZE, header.length, &status));
+    EXPECT_EQ(429, status);
+    EXPECT_FALSE(irPeerDecodeResult(buf + IR_PEER_HEADER_SIZE, 3, &status));
+}
+
+TEST(IrPeerProtocolTest, ParseInvalidHeader) {
+    uint8_t      buf[16];
+    IrPeerHeader header;
+    ASSERT_GT(irPeerEncodeResult(1, 200, buf, sizeof(buf)), 0);
+
+    buf[0] = 'X';
+    EXPECT_FALSE(irPeerParseHeader(buf, &header));
+    buf[0] = 'U';
+    buf[2] = IR_PEER_VERSION + 1;
+    EXPECT_FALSE(irPeerParseHeader(buf, &header));
+    buf[2] = IR_PEER_VERSION;
+    buf[3] = 3;
+    EXPECT_FALSE(irPeerParseHeader(buf, &header));
+}
+
+TEST(IrPeerProtocolTest, DecodeInvalidSend) {
+    // payloads with group "g" and a zeroed authentication tag
+    auto withTag = [](std::initializer_list<uint8_t> fields) {
+        std::string payload(fields.begin(), fields.end());
+        payload.append(IR_PEER_TAG_SIZE, '\0');
+        return payload;
+    };
+    IrPeerSend  send;
+    char        code[16];
+    std::string valid = withTag({1, 'g', 0, 0, 0, 0, 'A'});
+    std::string unknownFormat = withTag({1, 'g', 9, 0, 0, 0, 'A'});
+    std::string oddPronto = withTag({1, 'g', 1, 0, 0, 0, 0x00, 0x6D, 0x01});
+    std::string embeddedNul = withTag({1, 'g', 0, 0, 0, 0, 'A', 0, 'B'});
+    std::string noCode = withTag({1, 'g', 0, 0, 0, 0});
+    std::string noGroup = withTag({0, 0, 0, 0, 0, 'A'});
+    std::string groupTooLong = withTag({2, 'g', 0, 0, 0, 0});
+    std::string groupWithNul = withTag({2, 'g', 0, 0, 0, 0, 0, 'A'});
+
+    auto decode = [&](const std::string &payload) {
+        return irPeerDecodeSend(reinterpret_cast<const uint8_t *>(payload.data()), payload.size(), &send, code,
+                                sizeof(code));
+    };
+    EXPECT_TRUE(decode(valid));
+    EXPECT_STREQ("g", send.group);
+    EXPECT_STREQ("A", code);
+    EXPECT_FALSE(decode(unknownFormat));
+    EXPECT_FALSE(decode(oddPronto));
+    EXPECT_FALSE(decode(embeddedNul));
+    EXPECT_FALSE(decode(noCode));
+    EXPECT_FALSE(decode(noGroup));
+    EXPECT_FALSE(decode(groupTooLong));
+    EXPECT_FALSE(decode(groupWithNul));
+    // tag missing
+    EXPECT_FALSE(decode(valid.substr(0, valid.size() - 1)));
+}
+
+TEST(IrPeerProtocolTest, AggregateReportsFirstFailure) {
+    IrPeerAggregate aggregate(3);
+    EXPECT_FALSE(aggregate.complete(200));
+    EXPECT_FALSE(aggregate.complete(429));
+    EXPECT_FALSE(aggregate.isDone());
+    EXPECT_TRUE(aggregate.complete(503));
+    EXPECT_TRUE(aggregate.isDone());
+    EXPECT_EQ(429, aggregate.status());
+
+    IrPeerAggregate ok(1);
+    EXPECT_TRUE(ok.complete(200));
+    EXPECT_EQ(200, ok.status());
+}
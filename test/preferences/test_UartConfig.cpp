@@ -116,3 +116,52 @@ TEST(UartConfigTest, toString) {
     UartConfig cfg(9600, UART_DATA_8_BITS, UART_PARITY_DISABLE, UART_STOP_BITS_1);
     EXPECT_EQ("9600:8N1", cfg.toString());
 }
+
+TEST(UartConfigTest, fromStringWithBridgeOptions) {
+    auto cfg = UartConfig::fromString("9600:8N1");
+    ASSERT_NE(nullptr, cfg);
+    EXPECT_EQ(UART_RX_NO_DELIMITER, cfg->rx_delimiter);
+    EXPECT_EQ(DEF_UART_RX_TIMEOUT, cfg->rx_timeout);
+    EXPECT_FALSE(cfg->xonxoff);
+
+    cfg = UartConfig::fromString("115200:8N1.5,t100,d0D,x");
+    ASSERT_NE(nullptr, cfg);
+    EXPECT_EQ(115200, cfg->baud_rate);
+    EXPECT_EQ(UART_STOP_BITS_1_5, cfg->stop_bits);
+    EXPECT_EQ(0x0D, cfg->rx_delimiter);
+    EXPECT_EQ(100, cfg->rx_timeout);
+    EXPECT_TRUE(cfg->xonxoff);
+
+    cfg = UartConfig::fromString("9600:7E2,dff");
+    ASSERT_NE(nullptr, cfg);
+    EXPECT_EQ(0xFF, cfg->rx_delimiter);
+    EXPECT_EQ(DEF_UART_RX_TIMEOUT, cfg->rx_timeout);
+}
+
+TEST(UartConfigTest, fromStringReturnsNullWithInvalidBridgeOptions) {
+    EXPECT_EQ(nullptr, UartConfig::fromString("9600:8N1,"));
+    EXPECT_EQ(nullptr, UartConfig::fromString("9600:8N1,t"));
+    EXPECT_EQ(nullptr, UartConfig::fromString("9600:8N1,t0"));
+    EXPECT_EQ(nullptr, UartConfig::fromString("9600:8N1,t2001"));
+    EXPECT_EQ(nullptr, UartConfig::fromString("9600:8N1,d"));
+    EXPECT_EQ(nullptr, UartConfig::fromString("9600:8N1,d1"));
+    EXPECT_EQ(nullptr, UartConfig::fromString("9600:8N1,d100"));
+    EXPECT_EQ(nullptr, UartConfig::fromString("9600:8N1,xx"));
+    EXPECT_EQ(nullptr, UartConfig::fromString("9600:8N1,y"));
+    EXPECT_EQ(nullptr, UartConfig::fromString("9600:8N1;t20"));
+}
+
+TEST(UartConfigTest, toStringWithBridgeOptions) {
+    UartConfig cfg(9600, UART_DATA_8_BITS, UART_PARITY_DISABLE, UART_STOP_BITS_1);
+    cfg.rx_timeout = 50;
+    EXPECT_EQ("9600:8N1,t50", cfg.toString());
+    cfg.rx_delimiter = '\n';
+    EXPECT_EQ("9600:8N1,t50,d0A", cfg.toString());
+    cfg.rx_timeout = DEF_UART_RX_TIMEOUT;
+    cfg.xonxoff = true;
+    EXPECT_EQ("9600:8N1,d0A,x", cfg.toString());
+
+    auto parsed = UartConfig::fromString(cfg.toString().c_str());
+    ASSERT_NE(nullptr, parsed);
+    EXPECT_EQ(cfg.toString(), parsed->toString());
+}
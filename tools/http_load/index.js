@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// HTTP load test for the REST API. Measures requests/s with and without HTTP keep-alive.
+//
+// Usage:
+// node index.js URL [REQUESTS] [CONCURRENCY]
+//   default requests:    200
+//   default concurrency: 1
+// Example:
+// node index.js http://172.16.16.123/api/pub/info 500 2
+//
+const http = require('http');
+
+let requests = 200;
+let concurrency = 1;
+
+if (process.argv.length < 3) {
+    console.error('Usage: node index.js URL [REQUESTS] [CONCURRENCY]');
+    console.error('  default requests   : %d', requests);
+    console.error('  default concurrency: %d', concurrency);
+    process.exit(1);
+}
+
+const url = process.argv[2];
+if (process.argv.length > 3) {
+    requests = parseInt(process.argv[3]);
+    if (isNaN(requests) || requests < 1) {
+        console.error('Invalid requests parameter');
+        process.exit(1);
+    }
+}
+if (process.argv.length > 4) {
+    concurrency = parseInt(process.argv[4]);
+    if (isNaN(concurrency) || concurrency < 1) {
+        console.error('Invalid concurrency parameter');
+        process.exit(1);
+    }
+}
+
+function get(agent, sockets) {
+    return new Promise((resolve) => {
+        const req = http.get(url, { agent }, (res) => {
+            // consume response body to free the socket
+            res.resume();
+            res.on('end', () => resolve(res.statusCode === 200));
+        });
+        req.on('socket', (socket) => sockets.add(socket));
+        req.on('error', () => resolve(false));
+    });
+}
+
+async function run(keepAlive) {
+    // without keep-alive: a new connection for every request
+    const agent = keepAlive ? new http.Agent({ keepAlive, maxSockets: concurrency }) : false;
+    const sockets = new Set();
+
+    let next = 0;
+    let failed = 0;
+    const start = process.hrtime.bigint();
+
+    async function worker() {
+        while (next < requests) {
+            next++;
+            if (!(await get(agent, sockets))) {
+                failed++;
+            }
+        }
+    }
+
+    await Promise.all(Array.from({ length: concurrency }, worker));
+    const elapsedMs = Number(process.hrtime.bigint() - start) / 1e6;
+    if (agent) {
+        agent.destroy();
+    }
+
+    return {
+        keepAlive,
+        requests,
+        failed,
+        connections: sockets.size,
+        elapsedMs: Math.round(elapsedMs),
+        requestsPerSec: Math.round((requests / elapsedMs) * 1000 * 10) / 10,
+    };
+}
+
+(async () => {
+    console.log('Testing %s: %d requests, concurrency %d', url, requests, concurrency);
+    for (const keepAlive of [false, true]) {
+        const result = await run(keepAlive);
+        console.log(
+            'keep-alive %s: %s req/s, %d ms, %d connections, %d failed',
+            keepAlive ? 'on ' : 'off',
+            result.requestsPerSec,
+            result.elapsedMs,
+            result.connections,
+            result.failed
+        );
+    }
+})();
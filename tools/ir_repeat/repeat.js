@@ -5,9 +5,10 @@
 // IR repeat test app. Send an IR command, followed by repeat commands for a given duration
 //
 // Usage:
-// node repeat.js ws://UCD3-xxxxxx.local:946/ CODE REPEAT [DURATION] [DELAY]
+// node repeat.js ws://UCD3-xxxxxx.local:946/ CODE REPEAT [DURATION] [DELAY] [hold]
 //   default duration: 2000ms
 //   default delay:     200ms
+//   hold: keep the repeat alive with `ir_repeat_hold` messages instead of sending the IR code again
 // Example:
 // node repeat.js ws://172.16.16.123/ws "17;0x2A4C0A8A0282;48;3" 3
 //
@@ -33,14 +34,23 @@ const stopMsg = {
     "command": "ir_stop"
 };
 
+const holdMsg = {
+    "type": "dock",
+    "id": 0,
+    "command": "ir_repeat_hold",
+    "handle": 0
+};
+
 let msgId = 0;
+// IR repeat hold handle, 0 if not holding
+let holdHandle = 0;
 // delay between repeat commands
 let delayMs = 200;
 // total duration of repeat
 let transmitDurationMs = 2000;
 
 if (process.argv.length < 5) {
-    console.error('Usage: node repeat.js URL CODE REPEAT [DURATION] [DELAY]');
+    console.error('Usage: node repeat.js URL CODE REPEAT [DURATION] [DELAY] [hold]');
     console.error('  default duration: %dms', transmitDurationMs);
     console.error('  default delay   : %dms', delayMs);
     process.exit(1);
@@ -75,6 +85,9 @@ if (process.argv.length > 6) {
         process.exit(1);
     }
 }
+if (process.argv.length > 7 && process.argv[7] === 'hold') {
+    msg.hold = true;
+}
 
 console.log('Using dock command: %s', JSON.stringify(msg));
 
@@ -98,6 +111,10 @@ ws.on('open', function open() {
 
 ws.on('message', function message(data) {
     console.log('received: %s', data);
+    const reply = JSON.parse(data);
+    if (reply.msg === 'ir_send' && reply.handle) {
+        holdHandle = reply.handle;
+    }
 });
 
 ws.on('error', function error(msg) {
@@ -111,6 +128,13 @@ ws.on('close', function close() {
 
 function send_ir() {
     msgId++;
+    if (holdHandle) {
+        holdMsg.id = msgId;
+        holdMsg.handle = holdHandle;
+        console.log('Sending keep-alive: %d', msgId);
+        ws.send(JSON.stringify(holdMsg));
+        return;
+    }
     msg.id = msgId;
     console.log('Sending IR: %d', msgId);
     ws.send(JSON.stringify(msg));
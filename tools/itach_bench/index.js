@@ -0,0 +1,329 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// iTach API emulation conformance test and throughput benchmark.
+//
+// The conformance test replays typical iTach client traffic (pipelined and segmented requests, stopir, getdevices,
+// invalid and oversized codes) and verifies the replies. The throughput benchmark sends sendir requests from
+// concurrent clients and measures commands/s and the completion latency until `completeir`.
+// The result is printed as JSON. The exit code is 1 if a conformance test failed.
+//
+// Usage:
+// node index.js HOST [options]
+//   --port N         iTach TCP port. Default: 4998
+//   --clients N      number of concurrent connections for the throughput test. Default: 4
+//   --duration S     throughput test duration in seconds, 0 to skip. Default: 10
+//   --code CODE      sendir code without the `sendir,1:1,ID,` prefix. Default: NEC code at 38 kHz
+//   --timeout MS     reply timeout in ms. Default: 5000
+//   --output FILE    write the JSON result to a file instead of stdout
+//
+// Example:
+// node index.js 172.16.16.123 --clients 8 --duration 30
+// node index.js localhost --output sim.json
+//
+const fs = require('fs');
+const net = require('net');
+
+const options = {
+    port: 4998,
+    clients: 4,
+    duration: 10,
+    code:
+        '38000,1,1,342,171,21,21,21,21,21,64,21,21,21,21,21,21,21,21,21,21,21,64,21,64,21,21,21,64,21,64,21,64,21,64,' +
+        '21,64,21,21,21,21,21,21,21,64,21,21,21,21,21,21,21,21,21,64,21,64,21,64,21,21,21,64,21,64,21,64,21,64,21,1517',
+    timeout: 5000,
+    output: undefined,
+};
+
+function usage() {
+    console.error('Usage: node index.js HOST [--port N] [--clients N] [--duration S] [--code CODE] [--timeout MS]');
+    console.error('                          [--output FILE]');
+    process.exit(1);
+}
+
+if (process.argv.length < 3 || process.argv[2].startsWith('--')) {
+    usage();
+}
+const host = process.argv[2];
+for (let i = 3; i < process.argv.length; i += 2) {
+    const key = process.argv[i].replace(/^--/, '');
+    const value = process.argv[i + 1];
+    if (!(key in options) || value === undefined) {
+        usage();
+    }
+    options[key] = typeof options[key] === 'number' ? parseFloat(value) : value;
+    if (typeof options[key] === 'number' && (isNaN(options[key]) || options[key] < 0)) {
+        console.error('Invalid %s parameter', key);
+        process.exit(1);
+    }
+}
+
+function sendir(id, port = 1, code = options.code) {
+    return `sendir,1:${port},${id},${code}`;
+}
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+/// Client connection splitting received data into carriage return terminated reply lines.
+class Client {
+    connect() {
+        return new Promise((resolve, reject) => {
+            this.lines = [];
+            this.waiting = undefined;
+            this.buffer = '';
+            this.socket = net.createConnection({ host, port: options.port }, resolve);
+            this.socket.setNoDelay(true);
+            this.socket.on('error', reject);
+            this.socket.on('data', (data) => {
+                this.buffer += data.toString();
+                let end;
+                while ((end = this.buffer.indexOf('\r')) >= 0) {
+                    this.lines.push(this.buffer.substring(0, end));
+                    this.buffer = this.buffer.substring(end + 1);
+                }
+                if (this.waiting && this.lines.length) {
+                    this.waiting();
+                }
+            });
+        });
+    }
+
+    write(data) {
+        this.socket.write(data);
+    }
+
+    /// Read the next reply line. Resolves with undefined on timeout.
+    async readLine(timeout = options.timeout) {
+        if (this.lines.length === 0) {
+            await new Promise((resolve) => {
+                const timer = setTimeout(resolve, timeout);
+                this.waiting = () => {
+                    clearTimeout(timer);
+                    resolve();
+                };
+            });
+            this.waiting = undefined;
+        }
+        return this.lines.shift();
+    }
+
+    close() {
+        this.socket.destroy();
+    }
+}
+
+/// Send a request and verify the reply lines.
+/// @param client connection
+/// @param request request data, written as is
+/// @param expected list of regular expressions matching the reply lines in order
+async function expectReplies(client, request, expected) {
+    if (request) {
+        client.write(request);
+    }
+    for (const pattern of expected) {
+        const line = await client.readLine();
+        if (line === undefined) {
+            throw new Error(`no reply, expected ${pattern}`);
+        }
+        if (!pattern.test(line)) {
+            throw new Error(`unexpected reply '${line.substring(0, 80)}', expected ${pattern}`);
+        }
+    }
+}
+
+async function expectNoReply(client, timeout = 300) {
+    const line = await client.readLine(timeout);
+    if (line !== undefined) {
+        throw new Error(`unexpected reply '${line.substring(0, 80)}'`);
+    }
+}
+
+let firmware = undefined;
+
+const conformanceTests = {
+    getversion: async (c) => {
+        c.write('getversion\r');
+        firmware = await c.readLine();
+        if (!firmware || !/^[0-9A-Za-z-]+$/.test(firmware)) {
+            throw new Error(`invalid version '${firmware}'`);
+        }
+    },
+    getdevices: (c) =>
+        expectReplies(c, 'getdevices\r', [
+            /^device,0,0 ETHERNET$/,
+            /^device,0,0 WIFI$/,
+            /^device,1,\d+ IR$/,
+            /^endlistdevices$/,
+        ]),
+    getmac: (c) => expectReplies(c, 'getmac\r', [/^MACaddress,\S+$/]),
+    sendir: (c) => expectReplies(c, sendir(101) + '\r', [/^completeir,1:1,101$/]),
+    sendir_crlf: (c) => expectReplies(c, sendir(102) + '\r\n', [/^completeir,1:1,102$/]),
+    sendir_segmented: async (c) => {
+        const request = sendir(103) + '\r';
+        const parts = [10, 50, request.length];
+        let pos = 0;
+        for (const end of parts) {
+            c.write(request.substring(pos, end));
+            pos = end;
+            await sleep(50);
+        }
+        await expectReplies(c, undefined, [/^completeir,1:1,103$/]);
+    },
+    pipelined_queries: (c) =>
+        expectReplies(c, 'getversion\rgetmac\rgetdevices\r', [
+            /^[0-9A-Za-z-]+$/,
+            /^MACaddress,/,
+            /^device,0,0 ETHERNET$/,
+            /^device,0,0 WIFI$/,
+            /^device,1,\d+ IR$/,
+            /^endlistdevices$/,
+        ]),
+    pipelined_sendir: async (c) => {
+        // the second request is either queued or rejected while the first one is sent
+        c.write(sendir(104) + '\r' + sendir(105) + '\r');
+        const replies = [await c.readLine(), await c.readLine()];
+        if (!replies.includes('completeir,1:1,104')) {
+            throw new Error(`missing completeir for 104: ${JSON.stringify(replies)}`);
+        }
+        if (!replies.includes('completeir,1:1,105') && !replies.includes('busyir')) {
+            throw new Error(`missing completeir or busyir for 105: ${JSON.stringify(replies)}`);
+        }
+    },
+    stopir: (c) => expectReplies(c, 'stopir,1:1\r', [/^stopir,1:1$/]),
+    ir_learner: (c) =>
+        expectReplies(c, 'get_IRL\rstop_IRL\r', [/^IR Learner Enabled$/, /^IR Learner Disabled$/]),
+    empty_lines: async (c) => {
+        c.write('\r\r\n\r');
+        await expectNoReply(c);
+        await expectReplies(c, 'getversion\r', [/^[0-9A-Za-z-]+$/]);
+    },
+    unknown_command: (c) => expectReplies(c, 'foobar\r', [/^ERR_\d:\d+,001$/]),
+    invalid_module: (c) => expectReplies(c, 'sendir,2:1,106,' + options.code + '\r', [/^ERR_1:1,002$/]),
+    invalid_port: (c) => expectReplies(c, sendir(107, 16) + '\r', [/^ERR_1:1,003$/]),
+    invalid_repeat: (c) => expectReplies(c, sendir(108, 1, '38000,0,1,342,171,21,1517') + '\r', [/^ERR_1:1,006$/]),
+    oversized_code: async (c) => {
+        // more than the 1 KB request limit of the dock. The connection must recover with the next request.
+        const timing = Array(300).fill('21,21').join(',');
+        await expectReplies(c, sendir(109, 1, `38000,1,1,${timing}`) + '\r', [/^ERR[ _].*020$/]);
+        await expectReplies(c, 'getversion\r', [/^[0-9A-Za-z-]+$/]);
+    },
+};
+
+async function runConformance() {
+    const cases = [];
+    for (const [name, test] of Object.entries(conformanceTests)) {
+        const client = new Client();
+        const result = { name, passed: true };
+        try {
+            await client.connect();
+            await test(client);
+        } catch (err) {
+            result.passed = false;
+            result.error = err.message;
+        }
+        client.close();
+        cases.push(result);
+        console.error('%s %s%s', result.passed ? 'PASS' : 'FAIL', name, result.error ? ': ' + result.error : '');
+    }
+    return {
+        passed: cases.filter((c) => c.passed).length,
+        failed: cases.filter((c) => !c.passed).length,
+        cases,
+    };
+}
+
+/// Percentile with the nearest-rank method on a sorted array.
+function percentile(sorted, p) {
+    if (sorted.length === 0) {
+        return null;
+    }
+    const rank = Math.ceil((p / 100) * sorted.length);
+    return sorted[Math.max(0, rank - 1)];
+}
+
+function round(value) {
+    return value === null ? null : Math.round(value * 100) / 100;
+}
+
+async function runThroughput() {
+    const stats = { sent: 0, completed: 0, busy: 0, errors: 0, timeouts: 0, latencies: [] };
+    const end = Date.now() + options.duration * 1000;
+
+    async function worker(index) {
+        const client = new Client();
+        await client.connect();
+        let id = index * 100000;
+        while (Date.now() < end) {
+            id++;
+            const start = process.hrtime.bigint();
+            client.write(sendir(id) + '\r');
+            stats.sent++;
+            const reply = await client.readLine();
+            if (reply === undefined) {
+                stats.timeouts++;
+                // resynchronize: the reply might still arrive
+                client.close();
+                await client.connect();
+            } else if (reply === `completeir,1:1,${id}`) {
+                stats.completed++;
+                stats.latencies.push(Number(process.hrtime.bigint() - start) / 1e6);
+            } else if (reply === 'busyir') {
+                stats.busy++;
+                // like iTach clients: retry after a short delay
+                await sleep(10);
+            } else {
+                stats.errors++;
+            }
+        }
+        client.close();
+    }
+
+    const start = process.hrtime.bigint();
+    await Promise.all(Array.from({ length: options.clients }, (_, i) => worker(i)));
+    const elapsedMs = Number(process.hrtime.bigint() - start) / 1e6;
+
+    const sorted = stats.latencies.sort((a, b) => a - b);
+    return {
+        clients: options.clients,
+        durationMs: Math.round(elapsedMs),
+        sent: stats.sent,
+        completed: stats.completed,
+        busy: stats.busy,
+        errors: stats.errors,
+        timeouts: stats.timeouts,
+        commandsPerSec: round((stats.completed / elapsedMs) * 1000),
+        busyPercent: stats.sent ? round((stats.busy / stats.sent) * 100) : 0,
+        completionLatencyMs: {
+            min: round(sorted.length ? sorted[0] : null),
+            p50: round(percentile(sorted, 50)),
+            p95: round(percentile(sorted, 95)),
+            p99: round(percentile(sorted, 99)),
+            max: round(sorted.length ? sorted[sorted.length - 1] : null),
+        },
+    };
+}
+
+(async () => {
+    const result = { host, port: options.port, timestamp: new Date().toISOString() };
+    try {
+        result.conformance = await runConformance();
+        result.firmware = firmware;
+        if (options.duration > 0) {
+            console.error('Throughput test: %d clients, %d s', options.clients, options.duration);
+            result.throughput = await runThroughput();
+        }
+    } catch (err) {
+        console.error('Failed to connect: %s', err.message);
+        process.exit(1);
+    }
+
+    const json = JSON.stringify(result, null, 2);
+    if (options.output) {
+        fs.writeFileSync(options.output, json + '\n');
+        console.error('Result written to %s', options.output);
+    } else {
+        console.log(json);
+    }
+    process.exit(result.conformance.failed ? 1 : 0);
+})();
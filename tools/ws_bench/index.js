@@ -0,0 +1,301 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 Unfolded Circle ApS and/or its affiliates <hello@unfoldedcircle.com>
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// WebSocket API load and latency benchmark. Opens concurrent authenticated sessions, sends a mix of commands at fixed
+// rates and reports round-trip latency percentiles and response code rates per command as JSON.
+//
+// Usage:
+// node index.js URL [options]
+//   --clients N      number of concurrent WebSocket sessions. Default: 4
+//   --duration S     test duration in seconds. Default: 10
+//   --mix LIST       comma separated COMMAND=RATE list, rate in messages/s per session.
+//                    Commands: ir_send, get_sysinfo, ping, get_port_modes
+//                    Default: ir_send=2,get_sysinfo=1,ping=5,get_port_modes=1
+//   --code CODE      IR code for ir_send. Default: NEC hex code
+//   --token TOKEN    API access token. Default: 0000
+//   --timeout MS     response timeout in ms. Default: 5000
+//   --output FILE    write the JSON result to a file instead of stdout
+//
+// Example:
+// node index.js ws://172.16.16.123/ws --clients 8 --duration 30 --mix ir_send=4,ping=10
+// node index.js ws://localhost:8080/ws --output sim.json
+//
+const fs = require('fs');
+const WebSocket = require('ws');
+
+const options = {
+    clients: 4,
+    duration: 10,
+    mix: 'ir_send=2,get_sysinfo=1,ping=5,get_port_modes=1',
+    code: '3;0x20DF10EF;32;0',
+    token: '0000',
+    timeout: 5000,
+    output: undefined,
+};
+
+function usage() {
+    console.error('Usage: node index.js URL [--clients N] [--duration S] [--mix CMD=RATE,...] [--code CODE]');
+    console.error('                         [--token TOKEN] [--timeout MS] [--output FILE]');
+    process.exit(1);
+}
+
+if (process.argv.length < 3 || process.argv[2].startsWith('--')) {
+    usage();
+}
+const url = process.argv[2];
+for (let i = 3; i < process.argv.length; i += 2) {
+    const key = process.argv[i].replace(/^--/, '');
+    const value = process.argv[i + 1];
+    if (!(key in options) || value === undefined) {
+        usage();
+    }
+    options[key] = typeof options[key] === 'number' ? parseFloat(value) : value;
+    if (typeof options[key] === 'number' && (isNaN(options[key]) || options[key] <= 0)) {
+        console.error('Invalid %s parameter', key);
+        process.exit(1);
+    }
+}
+
+function irFormat(code) {
+    if (code.startsWith('sendir')) {
+        return 'gc';
+    }
+    return code.includes(';') ? 'hex' : 'pronto';
+}
+
+// Message factories. The request id is added by the session.
+const commands = {
+    ir_send: () => ({
+        type: 'dock',
+        command: 'ir_send',
+        code: options.code,
+        format: irFormat(options.code),
+        int_side: true,
+        int_top: false,
+        ext1: false,
+        ext2: false,
+    }),
+    get_sysinfo: () => ({ type: 'dock', command: 'get_sysinfo' }),
+    ping: () => ({ type: 'dock', msg: 'ping' }),
+    get_port_modes: () => ({ type: 'dock', command: 'get_port_modes' }),
+};
+
+const mix = {};
+for (const entry of options.mix.split(',')) {
+    const [name, rate] = entry.split('=');
+    if (!(name in commands) || isNaN(parseFloat(rate)) || parseFloat(rate) <= 0) {
+        console.error('Invalid mix entry: %s', entry);
+        process.exit(1);
+    }
+    mix[name] = parseFloat(rate);
+}
+
+function newStats() {
+    return { sent: 0, received: 0, timeouts: 0, codes: {}, latencies: [] };
+}
+
+const stats = {};
+for (const name of Object.keys(mix)) {
+    stats[name] = newStats();
+}
+
+let firmware = undefined;
+let disconnects = 0;
+
+/// Percentile with the nearest-rank method on a sorted array.
+function percentile(sorted, p) {
+    if (sorted.length === 0) {
+        return null;
+    }
+    const rank = Math.ceil((p / 100) * sorted.length);
+    return sorted[Math.max(0, rank - 1)];
+}
+
+function round(value) {
+    return value === null ? null : Math.round(value * 100) / 100;
+}
+
+function summarize(s) {
+    const sorted = s.latencies.slice().sort((a, b) => a - b);
+    const sum = sorted.reduce((a, b) => a + b, 0);
+    const rate = (code) => (s.received ? round(((s.codes[code] || 0) / s.received) * 100) : 0);
+    return {
+        sent: s.sent,
+        received: s.received,
+        timeouts: s.timeouts,
+        codes: s.codes,
+        rate429Percent: rate(429),
+        rate503Percent: rate(503),
+        latencyMs: {
+            min: round(sorted.length ? sorted[0] : null),
+            mean: round(sorted.length ? sum / sorted.length : null),
+            p50: round(percentile(sorted, 50)),
+            p95: round(percentile(sorted, 95)),
+            p99: round(percentile(sorted, 99)),
+            max: round(sorted.length ? sorted[sorted.length - 1] : null),
+        },
+    };
+}
+
+class Session {
+    constructor(index) {
+        this.index = index;
+        this.nextId = index * 1000000 + 1;
+        this.pending = new Map();
+        this.timers = [];
+        this.running = false;
+    }
+
+    /// Connect and authenticate. Resolves once the session is ready to send commands.
+    connect() {
+        return new Promise((resolve, reject) => {
+            this.ws = new WebSocket(url);
+            this.ws.on('error', (err) => reject(err));
+            this.ws.on('close', () => {
+                if (this.running) {
+                    disconnects++;
+                }
+                this.stop();
+            });
+            this.ws.on('message', (data) => {
+                let msg;
+                try {
+                    msg = JSON.parse(data);
+                } catch (e) {
+                    return;
+                }
+                if (msg.type === 'auth_required') {
+                    firmware = msg.version;
+                    this.ws.send(JSON.stringify({ type: 'auth', token: options.token }));
+                } else if (msg.type === 'authentication') {
+                    if (msg.code === 200) {
+                        resolve();
+                    } else {
+                        reject(new Error(`Session ${this.index}: authentication failed with code ${msg.code}`));
+                    }
+                } else {
+                    this.onReply(msg);
+                }
+            });
+        });
+    }
+
+    start() {
+        this.running = true;
+        for (const [name, rate] of Object.entries(mix)) {
+            const interval = 1000 / rate;
+            // random phase: don't send all commands of all sessions at the same time
+            const timer = setTimeout(() => {
+                this.send(name);
+                this.timers.push(setInterval(() => this.send(name), interval));
+            }, Math.random() * interval);
+            this.timers.push(timer);
+        }
+    }
+
+    stop() {
+        this.running = false;
+        for (const timer of this.timers) {
+            clearTimeout(timer);
+            clearInterval(timer);
+        }
+        this.timers = [];
+    }
+
+    send(name) {
+        if (!this.running || this.ws.readyState !== WebSocket.OPEN) {
+            return;
+        }
+        const msg = commands[name]();
+        msg.id = this.nextId++;
+        const timer = setTimeout(() => {
+            this.pending.delete(msg.id);
+            stats[name].timeouts++;
+        }, options.timeout);
+        this.pending.set(msg.id, { name, start: process.hrtime.bigint(), timer });
+        stats[name].sent++;
+        this.ws.send(JSON.stringify(msg));
+    }
+
+    onReply(msg) {
+        // broadcasts and events don't have a request id
+        const request = this.pending.get(msg.req_id);
+        if (!request) {
+            return;
+        }
+        this.pending.delete(msg.req_id);
+        clearTimeout(request.timer);
+
+        const s = stats[request.name];
+        // pong replies don't have a code
+        const code = msg.code === undefined ? 200 : msg.code;
+        s.received++;
+        s.codes[code] = (s.codes[code] || 0) + 1;
+        s.latencies.push(Number(process.hrtime.bigint() - request.start) / 1e6);
+    }
+
+    /// Wait for outstanding replies, at most the response timeout.
+    async drain() {
+        const end = Date.now() + options.timeout;
+        while (this.pending.size > 0 && Date.now() < end) {
+            await new Promise((resolve) => setTimeout(resolve, 10));
+        }
+    }
+
+    close() {
+        this.stop();
+        this.ws.close();
+    }
+}
+
+(async () => {
+    const sessions = Array.from({ length: options.clients }, (_, i) => new Session(i));
+    try {
+        await Promise.all(sessions.map((s) => s.connect()));
+    } catch (err) {
+        console.error('Failed to connect: %s', err.message);
+        process.exit(1);
+    }
+
+    console.error('Testing %s: %d sessions, %d s, mix %s', url, options.clients, options.duration, options.mix);
+    const start = process.hrtime.bigint();
+    sessions.forEach((s) => s.start());
+    await new Promise((resolve) => setTimeout(resolve, options.duration * 1000));
+    sessions.forEach((s) => s.stop());
+    await Promise.all(sessions.map((s) => s.drain()));
+    const elapsedMs = Number(process.hrtime.bigint() - start) / 1e6;
+    sessions.forEach((s) => s.close());
+
+    const total = newStats();
+    const result = {
+        url,
+        firmware,
+        timestamp: new Date().toISOString(),
+        clients: options.clients,
+        durationMs: Math.round(elapsedMs),
+        mix,
+        disconnects,
+        commands: {},
+    };
+    for (const [name, s] of Object.entries(stats)) {
+        result.commands[name] = summarize(s);
+        total.sent += s.sent;
+        total.received += s.received;
+        total.timeouts += s.timeouts;
+        total.latencies.push(...s.latencies);
+        for (const [code, count] of Object.entries(s.codes)) {
+            total.codes[code] = (total.codes[code] || 0) + count;
+        }
+    }
+    result.total = summarize(total);
+    result.total.messagesPerSec = round((total.received / elapsedMs) * 1000);
+
+    const json = JSON.stringify(result, null, 2);
+    if (options.output) {
+        fs.writeFileSync(options.output, json + '\n');
+        console.error('Result written to %s', options.output);
+    } else {
+        console.log(json);
+    }
+})();